@@ -4,6 +4,191 @@
 
 #include "inner.h"
 
+#if FNDSA_AVX2
+/*
+ * AVX2 kernels for the fixed-size codecs. Each kernel processes a number
+ * of full blocks from the start of the data; the generic code then
+ * finishes with the remaining values. In order to use plain unaligned
+ * 16-byte loads and stores, the kernels may read or write a few bytes
+ * past the last block they process; callers must make sure that at least
+ * one more block follows (the bytes written past a block are then
+ * overwritten by the generic code).
+ */
+
+/* Encode num blocks of 32 values, nbits = 5, 6 or 7 (4*nbits bytes per
+   block). Adjacent values are merged pairwise in 16-bit, 32-bit and
+   then 64-bit lanes, so that each 64-bit lane ends up with the 8*nbits
+   bits of 8 values; the output bytes are then extracted in big-endian
+   order. */
+TARGET_AVX2
+static void
+avx2_trim_i8_encode_x32(const int8_t *f, unsigned nbits, uint8_t *d,
+	size_t num)
+{
+	uint8_t sidx[16];
+	for (unsigned k = 0; k < 16; k ++) {
+		sidx[k] = 0x80;
+	}
+	for (unsigned k = 0; k < nbits; k ++) {
+		sidx[k] = (uint8_t)(nbits - 1 - k);
+		sidx[nbits + k] = (uint8_t)(8 + nbits - 1 - k);
+	}
+	__m256i ysh = _mm256_broadcastsi128_si256(
+		_mm_loadu_si128((const __m128i *)sidx));
+	__m256i ymask = _mm256_set1_epi8((int8_t)((1 << nbits) - 1));
+	__m256i ym8 = _mm256_set1_epi16(0x00FF);
+	__m256i ym16 = _mm256_set1_epi32(0x0000FFFF);
+	__m256i ym32 = _mm256_set1_epi64x(0xFFFFFFFF);
+	__m128i c1 = _mm_cvtsi32_si128((int)nbits);
+	__m128i c2 = _mm_cvtsi32_si128((int)(2 * nbits));
+	__m128i c4 = _mm_cvtsi32_si128((int)(4 * nbits));
+	for (size_t u = 0; u < num; u ++) {
+		__m256i x = _mm256_loadu_si256((const __m256i *)f + u);
+		x = _mm256_and_si256(x, ymask);
+		x = _mm256_or_si256(
+			_mm256_sll_epi16(_mm256_and_si256(x, ym8), c1),
+			_mm256_srli_epi16(x, 8));
+		x = _mm256_or_si256(
+			_mm256_sll_epi32(_mm256_and_si256(x, ym16), c2),
+			_mm256_srli_epi32(x, 16));
+		x = _mm256_or_si256(
+			_mm256_sll_epi64(_mm256_and_si256(x, ym32), c4),
+			_mm256_srli_epi64(x, 32));
+		x = _mm256_shuffle_epi8(x, ysh);
+		_mm_storeu_si128((__m128i *)d,
+			_mm256_castsi256_si128(x));
+		_mm_storeu_si128((__m128i *)(d + 2 * nbits),
+			_mm256_extracti128_si256(x, 1));
+		d += 4 * nbits;
+	}
+}
+
+/* Decode num blocks of 32 values, nbits = 5, 6, 7 or 8. Returned value
+   is 1 on success, 0 if a forbidden value (-2^(nbits-1)) was found. For
+   nbits < 8, each value is obtained from a 16-bit lane that holds the
+   two source bytes containing its bits; the per-lane right shift is
+   done with a multiplication (AVX2 has no variable 16-bit shift). */
+TARGET_AVX2
+static int
+avx2_trim_i8_decode_x32(const uint8_t *d, int8_t *f, unsigned nbits,
+	size_t num)
+{
+	__m256i yerr = _mm256_setzero_si256();
+	if (nbits == 8) {
+		__m256i ym = _mm256_set1_epi8(-128);
+		for (size_t u = 0; u < num; u ++) {
+			__m256i x = _mm256_loadu_si256((const __m256i *)d + u);
+			yerr = _mm256_or_si256(yerr, _mm256_cmpeq_epi8(x, ym));
+			_mm256_storeu_si256((__m256i *)f + u, x);
+		}
+		return _mm256_testz_si256(yerr, yerr);
+	}
+
+	uint8_t sidx[32];
+	uint16_t smul[16];
+	for (unsigned k = 0; k < 8; k ++) {
+		unsigned p = nbits * k;
+		unsigned b = p >> 3;
+		unsigned o = p & 7;
+		sidx[2 * k + 0] = (uint8_t)(b + 1);
+		sidx[2 * k + 1] = (uint8_t)b;
+		sidx[16 + 2 * k + 0] = (uint8_t)(nbits + b + 1);
+		sidx[16 + 2 * k + 1] = (uint8_t)(nbits + b);
+		smul[k] = (uint16_t)(1u << (o + nbits));
+		smul[8 + k] = smul[k];
+	}
+	__m256i ysh = _mm256_loadu_si256((const __m256i *)sidx);
+	__m256i ymul = _mm256_loadu_si256((const __m256i *)smul);
+	__m256i ym1 = _mm256_set1_epi16((int16_t)((1 << nbits) - 1));
+	__m256i ym2 = _mm256_set1_epi16((int16_t)(1 << (nbits - 1)));
+	for (size_t u = 0; u < num; u ++) {
+		__m256i xa = _mm256_broadcastsi128_si256(
+			_mm_loadu_si128((const __m128i *)d));
+		__m256i xb = _mm256_broadcastsi128_si256(
+			_mm_loadu_si128((const __m128i *)(d + 2 * nbits)));
+		xa = _mm256_and_si256(ym1, _mm256_mulhi_epu16(
+			_mm256_shuffle_epi8(xa, ysh), ymul));
+		xb = _mm256_and_si256(ym1, _mm256_mulhi_epu16(
+			_mm256_shuffle_epi8(xb, ysh), ymul));
+		yerr = _mm256_or_si256(yerr, _mm256_or_si256(
+			_mm256_cmpeq_epi16(xa, ym2),
+			_mm256_cmpeq_epi16(xb, ym2)));
+		xa = _mm256_sub_epi16(_mm256_xor_si256(xa, ym2), ym2);
+		xb = _mm256_sub_epi16(_mm256_xor_si256(xb, ym2), ym2);
+		__m256i x = _mm256_permute4x64_epi64(
+			_mm256_packs_epi16(xa, xb), 0xD8);
+		_mm256_storeu_si256((__m256i *)f + u, x);
+		d += 4 * nbits;
+	}
+	return _mm256_testz_si256(yerr, yerr);
+}
+
+/* Encode num blocks of 16 values (28 bytes per block). Each 64-bit lane
+   receives 4 values (56 bits), merged pairwise with a multiply-add, then
+   the output bytes are extracted in big-endian order. */
+TARGET_AVX2
+static void
+avx2_mqpoly_encode_x16(const uint16_t *h, uint8_t *d, size_t num)
+{
+	__m256i ysh = _mm256_setr_epi8(
+		6, 5, 4, 3, 2, 1, 0, 14, 13, 12, 11, 10, 9, 8, -1, -1,
+		6, 5, 4, 3, 2, 1, 0, 14, 13, 12, 11, 10, 9, 8, -1, -1);
+	__m256i ymul = _mm256_set1_epi32(0x00014000);
+	__m256i ym32 = _mm256_set1_epi64x(0xFFFFFFFF);
+	for (size_t u = 0; u < num; u ++) {
+		__m256i x = _mm256_loadu_si256((const __m256i *)h + u);
+		x = _mm256_madd_epi16(x, ymul);
+		x = _mm256_or_si256(
+			_mm256_slli_epi64(_mm256_and_si256(x, ym32), 28),
+			_mm256_srli_epi64(x, 32));
+		x = _mm256_shuffle_epi8(x, ysh);
+		_mm_storeu_si128((__m128i *)d,
+			_mm256_castsi256_si128(x));
+		_mm_storeu_si128((__m128i *)(d + 14),
+			_mm256_extracti128_si256(x, 1));
+		d += 28;
+	}
+}
+
+/* Decode num blocks of 16 values (28 bytes per block). Returned value is
+   1 on success, 0 if a value is out-of-range. If to_int is non-zero, the
+   values are converted to internal representation (0 becomes q). Each
+   value is obtained from a 32-bit lane that holds the three source bytes
+   containing its bits. */
+TARGET_AVX2
+static int
+avx2_mqpoly_decode_x16(const uint8_t *d, uint16_t *h, size_t num,
+	int to_int)
+{
+	__m256i ysh = _mm256_setr_epi8(
+		-1,  2,  1,  0, -1,  3,  2,  1, -1,  5,  4,  3, -1, -1,  6,  5,
+		-1,  9,  8,  7, -1, 10,  9,  8, -1, 12, 11, 10, -1, -1, 13, 12);
+	__m256i ycnt = _mm256_setr_epi32(18, 12, 14, 16, 18, 12, 14, 16);
+	__m256i ym = _mm256_set1_epi32(0x3FFF);
+	__m256i yqm1 = _mm256_set1_epi16(12288);
+	__m256i yq = _mm256_set1_epi16(to_int ? 12289 : 0);
+	__m256i yerr = _mm256_setzero_si256();
+	for (size_t u = 0; u < num; u ++) {
+		__m256i xa = _mm256_broadcastsi128_si256(
+			_mm_loadu_si128((const __m128i *)d));
+		__m256i xb = _mm256_broadcastsi128_si256(
+			_mm_loadu_si128((const __m128i *)(d + 14)));
+		xa = _mm256_and_si256(ym, _mm256_srlv_epi32(
+			_mm256_shuffle_epi8(xa, ysh), ycnt));
+		xb = _mm256_and_si256(ym, _mm256_srlv_epi32(
+			_mm256_shuffle_epi8(xb, ysh), ycnt));
+		__m256i x = _mm256_permute4x64_epi64(
+			_mm256_packus_epi32(xa, xb), 0xD8);
+		yerr = _mm256_or_si256(yerr, _mm256_cmpgt_epi16(x, yqm1));
+		x = _mm256_add_epi16(x, _mm256_and_si256(yq,
+			_mm256_cmpeq_epi16(x, _mm256_setzero_si256())));
+		_mm256_storeu_si256((__m256i *)h + u, x);
+		d += 28;
+	}
+	return _mm256_testz_si256(yerr, yerr);
+}
+#endif
+
 /* see inner.h */
 size_t
 trim_i8_encode(unsigned logn, const int8_t *f, unsigned nbits, uint8_t *d)
@@ -13,11 +198,20 @@ trim_i8_encode(unsigned logn, const int8_t *f, unsigned nbits, uint8_t *d)
 		memmove(d, f, n);
 		return n;
 	}
+	size_t i = 0;
 	size_t j = 0;
+#if FNDSA_AVX2
+	if (logn >= 6 && has_avx2()) {
+		size_t num = (n >> 5) - 1;
+		avx2_trim_i8_encode_x32(f, nbits, d, num);
+		i = num << 5;
+		j = num * (4 * nbits);
+	}
+#endif
 	uint32_t acc = 0;
 	unsigned acc_len = 0;
 	uint32_t mask = ((uint32_t)1 << nbits) - 1;
-	for (size_t i = 0; i < n; i ++) {
+	for (; i < n; i ++) {
 		acc = (acc << nbits) | ((uint32_t)f[i] & mask);
 		acc_len += nbits;
 		if (acc_len >= 8) {
@@ -33,12 +227,23 @@ size_t
 trim_i8_decode(unsigned logn, const uint8_t *d, int8_t *f, unsigned nbits)
 {
 	size_t needed = ((size_t)nbits << logn) >> 3;
+	size_t i = 0;
 	size_t j = 0;
+#if FNDSA_AVX2
+	if (logn >= 6 && has_avx2()) {
+		size_t num = ((size_t)1 << (logn - 5)) - 1;
+		if (!avx2_trim_i8_decode_x32(d, f, nbits, num)) {
+			return 0;
+		}
+		i = num * (4 * nbits);
+		j = num << 5;
+	}
+#endif
 	uint32_t acc = 0;
 	unsigned acc_len = 0;
 	uint32_t mask1 = (1 << nbits) - 1;
 	uint32_t mask2 = 1 << (nbits - 1);
-	for (size_t i = 0; i < needed; i ++) {
+	for (; i < needed; i ++) {
 		acc = (acc << 8) | d[i];
 		acc_len += 8;
 		while (acc_len >= nbits) {
@@ -59,8 +264,17 @@ size_t
 mqpoly_encode(unsigned logn, const uint16_t *h, uint8_t *d)
 {
 	size_t n = (size_t)1 << logn;
+	size_t i = 0;
 	size_t j = 0;
-	for (size_t i = 0; i < n; i += 4) {
+#if FNDSA_AVX2
+	if (logn >= 5 && has_avx2()) {
+		size_t num = (n >> 4) - 1;
+		avx2_mqpoly_encode_x16(h, d, num);
+		i = num << 4;
+		j = num * 28;
+	}
+#endif
+	for (; i < n; i += 4) {
 		uint32_t h0 = h[i + 0];
 		uint32_t h1 = h[i + 1];
 		uint32_t h2 = h[i + 2];
@@ -77,15 +291,29 @@ mqpoly_encode(unsigned logn, const uint16_t *h, uint8_t *d)
 	return j;
 }
 
-#if !FNDSA_ASM_CORTEXM4
-/* see inner.h */
-size_t
-mqpoly_decode(unsigned logn, const uint8_t *d, uint16_t *h)
+/* Decode polynomial h (14 bits per value), and check that all values are
+   lower than q. If to_int is non-zero, the values are also converted to
+   internal representation (0 becomes q), so that callers need not make
+   a second pass over the data. */
+static size_t
+mqpoly_decode_inner(unsigned logn, const uint8_t *d, uint16_t *h, int to_int)
 {
 	size_t n = (size_t)1 << logn;
+	size_t i = 0;
 	size_t j = 0;
 	uint32_t ov = 0xFFFFFFFF;
-	for (size_t i = 0; i < n; i += 4) {
+#if FNDSA_AVX2
+	if (logn >= 5 && has_avx2()) {
+		size_t num = (n >> 4) - 1;
+		if (!avx2_mqpoly_decode_x16(d, h, num, to_int)) {
+			return 0;
+		}
+		i = num << 4;
+		j = num * 28;
+	}
+#endif
+	uint32_t qm = to_int ? 12289 : 0;
+	for (; i < n; i += 4) {
 		uint32_t d0 = d[j + 0];
 		uint32_t d1 = d[j + 1];
 		uint32_t d2 = d[j + 2];
@@ -98,14 +326,14 @@ mqpoly_decode(unsigned logn, const uint8_t *d, uint16_t *h)
 		uint32_t h1 = ((d1 << 12) | (d2 << 4) | (d3 >> 4)) & 0x3FFF;
 		uint32_t h2 = ((d3 << 10) | (d4 << 2) | (d5 >> 6)) & 0x3FFF;
 		uint32_t h3 = ((d5 << 8) | d6) & 0x3FFF;
-		h[i + 0] = h0;
-		h[i + 1] = h1;
-		h[i + 2] = h2;
-		h[i + 3] = h3;
 		ov &= h0 - 12289;
 		ov &= h1 - 12289;
 		ov &= h2 - 12289;
 		ov &= h3 - 12289;
+		h[i + 0] = h0 + (qm & ((h0 - 1) >> 16));
+		h[i + 1] = h1 + (qm & ((h1 - 1) >> 16));
+		h[i + 2] = h2 + (qm & ((h2 - 1) >> 16));
+		h[i + 3] = h3 + (qm & ((h3 - 1) >> 16));
 	}
 	if ((ov >> 16) == 0) {
 		return 0;
@@ -113,18 +341,59 @@ mqpoly_decode(unsigned logn, const uint8_t *d, uint16_t *h)
 		return j;
 	}
 }
+
+#if !FNDSA_ASM_CORTEXM4
+/* see inner.h */
+size_t
+mqpoly_decode(unsigned logn, const uint8_t *d, uint16_t *h)
+{
+	return mqpoly_decode_inner(logn, d, h, 0);
+}
 #endif
 
+/* see inner.h */
+size_t
+mqpoly_decode_int(unsigned logn, const uint8_t *d, uint16_t *h)
+{
+	return mqpoly_decode_inner(logn, d, h, 1);
+}
+
+/* Big-endian encoding and decoding of 32-bit and 64-bit words. */
+static inline void
+enc32be(uint8_t *d, uint32_t x)
+{
+	d[0] = (uint8_t)(x >> 24);
+	d[1] = (uint8_t)(x >> 16);
+	d[2] = (uint8_t)(x >> 8);
+	d[3] = (uint8_t)x;
+}
+
+static inline uint64_t
+dec64be(const uint8_t *d)
+{
+	return ((uint64_t)d[0] << 56) | ((uint64_t)d[1] << 48)
+		| ((uint64_t)d[2] << 40) | ((uint64_t)d[3] << 32)
+		| ((uint64_t)d[4] << 24) | ((uint64_t)d[5] << 16)
+		| ((uint64_t)d[6] << 8) | (uint64_t)d[7];
+}
+
 /* see inner.h */
 int
 comp_encode(unsigned logn, const int16_t *s, uint8_t *d, size_t dlen)
 {
+	/*
+	 * Each value is appended as a single code of 9 to 24 bits: sign
+	 * bit, low 7 bits of the absolute value, then the high bits in
+	 * unary (a run of zeros and a terminating one). The accumulator
+	 * is flushed 32 bits at a time (byte by byte near the end of the
+	 * output buffer).
+	 */
 	size_t n = (size_t)1 << logn;
-	uint32_t acc = 0;
+	uint64_t acc = 0;
 	unsigned acc_len = 0;
 	size_t j = 0;
 	for (size_t i = 0; i < n; i ++) {
-		/* Invariant: acc_len <= 7 */
+		/* Invariant: acc_len <= 31 */
 		int32_t x = s[i];
 		if (x < -2047 || x > +2047) {
 			return 0;
@@ -134,28 +403,40 @@ comp_encode(unsigned logn, const int16_t *s, uint8_t *d, size_t dlen)
 		uint32_t sw = (uint32_t)(x >> 16);
 		uint32_t w = ((uint32_t)x ^ sw) - sw;
 
-		/* Encode sign bit and low 7 bits of the absolute value. */
-		acc = (acc << 8) | (sw & 0x80) | (w & 0x7F);
-		acc_len += 8;
-
-		/* Encode the high bits. Since |x| <= 2047, the high bits
-		   have a value on [0,15], hence we add at most 16 bits. */
+		/* Since |x| <= 2047, the high bits have a value on [0,15],
+		   hence the code has length at most 8 + 15 + 1 = 24 bits,
+		   and the total accumulated length is at most 55 bits. */
 		unsigned wh = (w >> 7) + 1;
-		acc = (acc << wh) | 1;
-		acc_len += wh;
+		uint32_t code = (((sw & 0x80) | (w & 0x7F)) << wh) | 1;
+		acc = (acc << (8 + wh)) | code;
+		acc_len += 8 + wh;
 
-		/* We appended at most 8 + 15 + 1 = 24 bits, so the total
-		   accumulated length in acc is at most 31 bits. */
-		while (acc_len >= 8) {
-			acc_len -= 8;
-			if (j >= dlen) {
-				return 0;
+		if (acc_len >= 32) {
+			acc_len -= 32;
+			if (dlen - j >= 4) {
+				enc32be(d + j, (uint32_t)(acc >> acc_len));
+				j += 4;
+			} else {
+				acc_len += 32;
+				while (acc_len >= 8) {
+					acc_len -= 8;
+					if (j >= dlen) {
+						return 0;
+					}
+					d[j ++] = (uint8_t)(acc >> acc_len);
+				}
 			}
-			d[j ++] = (uint8_t)(acc >> acc_len);
 		}
 	}
 
 	/* Flush remaining bits (if any). */
+	while (acc_len >= 8) {
+		acc_len -= 8;
+		if (j >= dlen) {
+			return 0;
+		}
+		d[j ++] = (uint8_t)(acc >> acc_len);
+	}
 	if (acc_len > 0) {
 		if (j >= dlen) {
 			return 0;
@@ -171,61 +452,108 @@ comp_encode(unsigned logn, const int16_t *s, uint8_t *d, size_t dlen)
 }
 
 #if !FNDSA_ASM_CORTEXM4
+/* Get the number of leading zeros of a non-zero 64-bit value. This is
+   used on public data only, hence it needs not be constant-time. */
+static inline unsigned
+lzcnt64_nonzero_vartime(uint64_t x)
+{
+#if defined __GNUC__ || defined __clang__
+	return (unsigned)__builtin_clzll(x);
+#else
+	uint32_t hi = (uint32_t)(x >> 32);
+	return hi != 0 ? lzcnt(hi) : 32 + lzcnt((uint32_t)x);
+#endif
+}
+
+/* Decode one value from the top bits of *buf (at least 24 bits must be
+   available, or all remaining source bits). The two shortest unary
+   parts (|value| < 256) are tested directly, so that the code length is
+   usually predicted and the next decode need not wait for it; otherwise
+   the unary part is located with a leading zero count, and a guard bit
+   stops the count at 16 zeros, which is always invalid (value above
+   2047). Code length is returned, or 0 on error ("-0" or too many
+   zeros). */
+static inline unsigned
+comp_decode_one(uint64_t *buf, int16_t *s)
+{
+	uint64_t b = *buf;
+	uint32_t t = (uint32_t)(b >> 63);
+	uint32_t m = (uint32_t)(b >> 56) & 0x7F;
+	unsigned z;
+	if (((b >> 55) & 1) != 0) {
+		z = 0;
+	} else if (((b >> 54) & 1) != 0) {
+		z = 1;
+	} else {
+		z = lzcnt64_nonzero_vartime(
+			(b & (((uint64_t)1 << 56) - 1))
+			| ((uint64_t)1 << 39)) - 8;
+		if (z == 16) {
+			return 0;
+		}
+	}
+	m += (uint32_t)z << 7;
+
+	/* Reject "-0" (which is an invalid encoding). */
+	if (m == 0 && t != 0) {
+		return 0;
+	}
+	m = (m ^ -t) + t;
+	*s = (int16_t)*(int32_t *)&m;
+	*buf = b << (9 + z);
+	return 9 + z;
+}
+
 /* see inner.h */
 int
 comp_decode(unsigned logn, const uint8_t *d, size_t dlen, int16_t *s)
 {
+	/*
+	 * Unread bits are kept left-aligned in buf, with buf_len valid
+	 * bits; the bits beyond buf_len are the next source bits, or zeros
+	 * if the source has been completely read. While the source has at
+	 * least 8 more bytes, each refill yields at least 56 bits, enough
+	 * for two values (at most 24 bits each). The last values are
+	 * decoded with byte-by-byte refills and length checks.
+	 */
 	size_t n = (size_t)1 << logn;
-	uint32_t acc = 0;
-	unsigned acc_len = 0;
+	uint64_t buf = 0;
+	unsigned buf_len = 0;
 	size_t j = 0;
-	for (size_t i = 0; i < n; i ++) {
-		/* Invariant: acc_len <= 7 */
-
-		/* Get next 8 bits and split into sign bit (t) and low
-		   bits of the absolute value (m). */
-		if (j >= dlen) {
+	size_t i = 0;
+	while ((i + 1) < n && (dlen - j) >= 8) {
+		buf |= dec64be(d + j) >> buf_len;
+		j += (63 - buf_len) >> 3;
+		buf_len |= 56;
+		unsigned c0 = comp_decode_one(&buf, s + i);
+		if (c0 == 0) {
 			return 0;
 		}
-		acc = (acc << 8) | d[j ++];
-		uint32_t m = acc >> acc_len;
-		uint32_t t = (m >> 7) & 1;
-		m &= 0x7F;
-
-		/* Get next bits until a 1 is reached.
-		   We'll need up to two extra bytes. */
-		for (;;) {
-			if (acc_len == 0) {
-				if (j >= dlen) {
-					return 0;
-				}
-				acc = (acc << 8) | d[j ++];
-				acc_len = 8;
-			}
-			acc_len --;
-			if (((acc >> acc_len) & 1) != 0) {
-				break;
-			}
-			m += 0x80;
-			if (m > 2047) {
-				return 0;
-			}
+		unsigned c1 = comp_decode_one(&buf, s + i + 1);
+		if (c1 == 0) {
+			return 0;
 		}
-
-		/* Reject "-0" (which is an invalid encoding). */
-		if (m == 0 && t != 0) {
+		buf_len -= c0 + c1;
+		i += 2;
+	}
+	for (; i < n; i ++) {
+		while (buf_len <= 56 && j < dlen) {
+			buf |= (uint64_t)d[j ++] << (56 - buf_len);
+			buf_len += 8;
+		}
+		if (buf_len < 9) {
 			return 0;
 		}
-
-		m = (m ^ -t) + t;
-		s[i] = (int16_t)*(int32_t *)&m;
+		unsigned c = comp_decode_one(&buf, s + i);
+		if (c == 0 || c > buf_len) {
+			return 0;
+		}
+		buf_len -= c;
 	}
 
 	/* Check that the unused bits are all zero. */
-	if (acc_len > 0) {
-		if ((acc & ((1 << acc_len) - 1)) != 0) {
-			return 0;
-		}
+	if (buf_len > 0 && (buf >> (64 - buf_len)) != 0) {
+		return 0;
 	}
 	while (j < dlen) {
 		if (d[j ++] != 0) {
@@ -43,6 +43,18 @@
 	(1u + ((12u - ((logn) >= 6) - ((logn) >= 8) - ((logn) >= 10)) \
 	<< ((logn) - 2)))
 
+/*
+ * Prepared verifying key size, in bytes, for 2 <= logn <= 10 (see
+ * fndsa_verify_key_prepare()).
+ */
+#define FNDSA_VRFY_KEY_PREPARED_SIZE(logn)   (127u + (2u << (logn)))
+
+/*
+ * Expanded signing key size, in bytes, for 2 <= logn <= 10 (see
+ * fndsa_sign_key_expand()).
+ */
+#define FNDSA_SIGN_KEY_EXPANDED_SIZE(logn)   (127u + (52u << (logn)))
+
 /*
  * Verifying (public) key size, in bytes, for 2 <= logn <= 10.
  */
@@ -180,6 +192,64 @@ int fndsa_keygen_seeded_temp(unsigned logn,
 	const void *seed, size_t seed_len, void *sign_key, void *vrfy_key,
 	void *tmp, size_t tmp_len);
 
+/*
+ * Multi-threaded variants of fndsa_keygen() and fndsa_keygen_seeded().
+ * Up to num_threads threads (including the calling thread) are used to
+ * solve the NTRU equation; values 0 and 1 use only the calling thread,
+ * and larger values are capped to 64. The threads only exist for the
+ * duration of the call. The output does not depend on the number of
+ * threads: for a given seed, fndsa_keygen_seeded_mt() returns the same
+ * key pair as fndsa_keygen_seeded(). If threads cannot be created (or
+ * the library was compiled without thread support, with
+ * FNDSA_KEYGEN_MT=0), then fewer threads are used.
+ */
+int fndsa_keygen_mt(unsigned logn, unsigned num_threads,
+	void *sign_key, void *vrfy_key);
+void fndsa_keygen_seeded_mt(unsigned logn, unsigned num_threads,
+	const void *seed, size_t seed_len, void *sign_key, void *vrfy_key);
+
+/*
+ * Key pair pool (optional). Background worker threads keep a bounded
+ * ring of ready key pairs, so that fndsa_keypool_take() normally returns
+ * a new key pair without having to wait for a key generation (whose
+ * duration varies, since candidate (f,g) values are rejected a random
+ * number of times). Each worker has its own random generator, seeded
+ * from the system RNG when the pool is created and ratcheted after each
+ * key pair. The pool is supported only on systems with POSIX threads;
+ * on other systems (or with FNDSA_KEYGEN_MT=0), fndsa_keypool_size()
+ * returns 0 and no pool can be created. The pool is not fork-safe: it
+ * must be created in the process that uses it.
+ *
+ * The pool state, including the ring, is kept in a caller-provided
+ * memory area mem[], of size mem_len bytes. Its minimum size is returned
+ * by fndsa_keypool_size(), for the degree logn (2 to 10), the ring
+ * capacity (1 to 65536 key pairs), and the number of worker threads
+ * (1 to 256). The area must not be modified, moved or released until
+ * fndsa_keypool_destroy() has returned. fndsa_keypool_create() returns a
+ * pointer to the pool (within mem[]), or NULL on error (invalid
+ * parameters, undersized memory area, thread creation failure, system
+ * RNG failure). The workers start filling the ring immediately.
+ *
+ * fndsa_keypool_take() removes the oldest key pair from the ring and
+ * writes it into sign_key and vrfy_key (either may be NULL to discard
+ * that half); it returns 1. If the ring is empty, then it returns 0 if
+ * wait is 0, or waits for a key pair otherwise. Key pairs are erased
+ * from the ring when taken. fndsa_keypool_available() returns the
+ * number of ready key pairs (a snapshot). Both functions are
+ * thread-safe. fndsa_keypool_destroy() stops the workers (waiting for
+ * the key generations in progress) and erases the ring; it must be
+ * called exactly once, with no concurrent or later use of the pool.
+ */
+typedef struct fndsa_keypool_ fndsa_keypool;
+size_t fndsa_keypool_size(unsigned logn,
+	size_t capacity, unsigned num_threads);
+fndsa_keypool *fndsa_keypool_create(unsigned logn,
+	size_t capacity, unsigned num_threads, void *mem, size_t mem_len);
+int fndsa_keypool_take(fndsa_keypool *kp,
+	void *sign_key, void *vrfy_key, int wait);
+size_t fndsa_keypool_available(fndsa_keypool *kp);
+void fndsa_keypool_destroy(fndsa_keypool *kp);
+
 /*
  * Sign a message.
  *    sign_key, sign_key_len   signing key (encoded)
@@ -201,6 +271,15 @@ int fndsa_keygen_seeded_temp(unsigned logn,
  * buffer is large enough, and the signature generation succeeds (i.e. the
  * system random generator does not fail), then the signature is written
  * in sig[] and the signature length (in bytes) is returned.
+ *
+ * The temporary area used for signature generation is allocated on the
+ * stack: 59*n+31 bytes for degree n (60447 bytes for n = 1024), in
+ * addition to the regular stack frames. If the library is compiled with
+ * FNDSA_SIGN_LARGE_TMP=1, then that area is 110*n+31 bytes (112671 bytes
+ * for n = 1024) instead, which avoids recomputing the key-dependent values
+ * when signature generation restarts; this may exceed small thread stacks
+ * (e.g. 128 kB). fndsa_sign_temp() can be used to provide the area
+ * explicitly.
  */
 size_t fndsa_sign(const void *sign_key, size_t sign_key_len,
 	const void *ctx, size_t ctx_len,
@@ -244,6 +323,12 @@ size_t fndsa_sign_seeded(const void *sign_key, size_t sign_key_len,
  *
  * (Formula is: 59*n+31 bytes, for degree n = 2^logn)
  *
+ * If the temporary area has size at least 110*n+31 bytes (56351 bytes for
+ * n = 512, 112671 bytes for n = 1024), then the key-dependent
+ * precomputations are kept in it across internal restarts of the
+ * signature generation process, which makes the worst-case signing time
+ * lower; the signature value is the same in both cases.
+ *
  * An undersized temporary area triggers an error (returned value is zero).
  */
 size_t fndsa_sign_temp(const void *sign_key, size_t sign_key_len,
@@ -290,6 +375,301 @@ size_t fndsa_sign_weak_seeded_temp(const void *sign_key, size_t sign_key_len,
 	void *sig, size_t max_sig_len,
 	void *tmp, size_t tmp_len);
 
+/*
+ * Expand a signing key for faster signing. Each signature generation
+ * starts with some key-dependent computations (decoding of the key,
+ * recomputation of G and of the verifying key, conversion of the lattice
+ * basis to FFT representation, computation of the Gram matrix); when
+ * many signatures are computed with the same key, these computations can
+ * be done once, and their result kept in an "expanded signing key". The
+ * expanded key is written in the caller-provided esk[] buffer, of size
+ * esk_len bytes, which must be at least FNDSA_SIGN_KEY_EXPANDED_SIZE(logn):
+ *
+ *    logn   esk_len
+ *   ---------------
+ *      9     26751
+ *     10     53375
+ *
+ * (Formula is: 52*n+127 bytes, for degree n = 2^logn; degrees 4 to 256
+ * are also supported, for use with the fndsa_sign_weak_expanded*()
+ * functions.)
+ *
+ * Returned value is 1 on success, 0 on error (signing key cannot be
+ * decoded, or buffer is too small).
+ *
+ * The expanded key contains floating-point values in the in-memory
+ * format of the current platform, and its internal layout depends on
+ * the alignment of esk; thus, it MUST NOT be stored, transmitted, or
+ * moved to another address. Like the signing key itself, it is secret;
+ * the caller is responsible for clearing it when it is no longer needed.
+ * A given expanded key is not modified by signature generation and may
+ * be used by several threads concurrently.
+ */
+int fndsa_sign_key_expand(const void *sign_key, size_t sign_key_len,
+	void *esk, size_t esk_len);
+
+/*
+ * Sign a message with an expanded signing key (as computed by
+ * fndsa_sign_key_expand()). esk and esk_len must be the same values as
+ * used for the expansion. These functions are otherwise similar to
+ * fndsa_sign(), fndsa_sign_seeded(), fndsa_sign_temp() and
+ * fndsa_sign_seeded_temp(), respectively; for the same key and seed,
+ * the same signature is obtained. Temporary area sizes are:
+ *
+ *    logn   min tmp_len   security
+ *   -----------------------------------------
+ *      9      29727       standard (level I)
+ *     10      59423       standard (level V)
+ *
+ *      2        263       none
+ *      3        495       none
+ *      4        959       none
+ *      5       1887       none
+ *      6       3743       none
+ *      7       7455       very weak
+ *      8      14879       presumed weak
+ *
+ * (Formula is: 58*n+31 bytes, for degree n = 2^logn)
+ */
+size_t fndsa_sign_expanded(const void *esk, size_t esk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len,
+	void *sig, size_t max_sig_len);
+size_t fndsa_sign_expanded_seeded(const void *esk, size_t esk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len,
+	const void *seed, size_t seed_len,
+	void *sig, size_t max_sig_len);
+size_t fndsa_sign_expanded_temp(const void *esk, size_t esk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len,
+	void *sig, size_t max_sig_len,
+	void *tmp, size_t tmp_len);
+size_t fndsa_sign_expanded_seeded_temp(const void *esk, size_t esk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len,
+	const void *seed, size_t seed_len,
+	void *sig, size_t max_sig_len,
+	void *tmp, size_t tmp_len);
+
+/*
+ * Versions of the fndsa_sign_expanded*() functions for weak degrees
+ * (4 to 256), meant for tests and research only.
+ */
+size_t fndsa_sign_weak_expanded(const void *esk, size_t esk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len,
+	void *sig, size_t max_sig_len);
+size_t fndsa_sign_weak_expanded_seeded(const void *esk, size_t esk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len,
+	const void *seed, size_t seed_len,
+	void *sig, size_t max_sig_len);
+size_t fndsa_sign_weak_expanded_temp(const void *esk, size_t esk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len,
+	void *sig, size_t max_sig_len,
+	void *tmp, size_t tmp_len);
+size_t fndsa_sign_weak_expanded_seeded_temp(const void *esk, size_t esk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len,
+	const void *seed, size_t seed_len,
+	void *sig, size_t max_sig_len,
+	void *tmp, size_t tmp_len);
+
+/*
+ * Signing randomness pool (optional), for offline/online signing. Each
+ * signing attempt needs a new 40-byte nonce and a stream of random bytes
+ * for the Gaussian sampler (about 20 kB at degree 512, 40 kB at degree
+ * 1024), which is normally obtained from the system RNG and expanded
+ * with SHAKE256 during signature generation. With a pool, background
+ * worker threads pre-compute these values, so that the signing path
+ * (with an expanded key) only hashes the message, applies the basis and
+ * runs the sampler; this lowers the signing time and makes it more
+ * predictable. The randomness does not depend on the key: a pool can be
+ * shared by any number of keys of its degree, and by several threads.
+ * Each worker has its own random generator, seeded from the system RNG
+ * when the pool is created and ratcheted after each entry. The pool is
+ * supported only on systems with POSIX threads; on other systems (or
+ * with FNDSA_SIGN_ENGINE=0), fndsa_randpool_size() returns 0 and no pool
+ * can be created. The pool is not fork-safe: it must be created in the
+ * process that uses it (a child process must not use a pool inherited
+ * from its parent, since both would then consume the same entries).
+ *
+ * The pool state is kept in a caller-provided memory area mem[], of size
+ * mem_len bytes. Its minimum size is returned by fndsa_randpool_size(),
+ * for the degree logn (2 to 10), the capacity (1 to 65536 entries), and
+ * the number of worker threads (1 to 256). The area must not be
+ * modified, moved or released until fndsa_randpool_destroy() has
+ * returned. fndsa_randpool_create() returns a pointer to the pool
+ * (within mem[]), or NULL on error (invalid parameters, undersized
+ * memory area, thread creation failure, system RNG failure). The workers
+ * start filling the pool immediately.
+ *
+ * fndsa_sign_expanded_pooled() and fndsa_sign_weak_expanded_pooled() are
+ * similar to fndsa_sign_expanded() and fndsa_sign_weak_expanded(), but
+ * take the randomness from the pool rp, which must have the degree of
+ * the key (otherwise, 0 is returned); rp may also be NULL, in which case
+ * fresh randomness is used, as in fndsa_sign_expanded(). Consumption
+ * semantics:
+ *
+ *  - Each signing attempt consumes exactly one entry (a signature
+ *    usually needs a single attempt, but a few percent need more). An
+ *    entry is removed from the pool when taken and is never given out
+ *    again; it is refilled with new values by a worker after use.
+ *
+ *  - If the pool has no ready entry, then the attempt does not wait: it
+ *    uses fresh randomness from the system RNG, as without a pool. The
+ *    signature is then as secure as usual, only slower.
+ *
+ *  - If an attempt needs more sampler bytes than the entry holds (this
+ *    is very rare), the stream continues with SHAKE256 from the point
+ *    where the entry ends, computed on the fly.
+ *
+ * fndsa_randpool_available() returns the number of ready entries (a
+ * snapshot); it and the signing functions are thread-safe.
+ * fndsa_randpool_destroy() stops the workers and erases all entries; it
+ * must be called exactly once, with no concurrent or later use of the
+ * pool.
+ */
+typedef struct fndsa_randpool_ fndsa_randpool;
+size_t fndsa_randpool_size(unsigned logn,
+	size_t capacity, unsigned num_threads);
+fndsa_randpool *fndsa_randpool_create(unsigned logn,
+	size_t capacity, unsigned num_threads, void *mem, size_t mem_len);
+size_t fndsa_randpool_available(fndsa_randpool *rp);
+void fndsa_randpool_destroy(fndsa_randpool *rp);
+size_t fndsa_sign_expanded_pooled(fndsa_randpool *rp,
+	const void *esk, size_t esk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len,
+	void *sig, size_t max_sig_len);
+size_t fndsa_sign_weak_expanded_pooled(fndsa_randpool *rp,
+	const void *esk, size_t esk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len,
+	void *sig, size_t max_sig_len);
+
+/*
+ * Batch signature generation: several messages are signed with the same
+ * signing key, and the key-dependent computations (decoding of the key,
+ * recomputation of G and of the verifying key, and, if the temporary
+ * area is large enough, conversion of the basis to FFT representation
+ * and computation of the Gram matrix) are done only once for the whole
+ * batch. Each message is described by a fndsa_sign_msg structure, whose
+ * fields have the same meaning as the corresponding parameters of
+ * fndsa_sign().
+ *
+ * The num signatures are written consecutively in sigs[], each with
+ * size FNDSA_SIGNATURE_SIZE(logn) bytes (signature i starts at offset
+ * i*FNDSA_SIGNATURE_SIZE(logn)); max_sigs_len is the size of sigs[]. The
+ * returned value is the number of generated signatures, which is num on
+ * success. On error, 0 is returned if the signing key cannot be decoded,
+ * uses a weak degree, or the output buffer is too small; if the system
+ * random generator fails, then the returned value is the number of
+ * signatures that were generated before the failure.
+ *
+ * fndsa_sign_batch() allocates its temporary area on the stack, with the
+ * same size as fndsa_sign(). fndsa_sign_batch_temp() uses the provided
+ * tmp[] area instead; its minimum size is the same as for
+ * fndsa_sign_temp() (59*n+31 bytes), but a temporary area of at least
+ * 110*n+31 bytes is recommended, since it allows all key-dependent
+ * computations to be shared by all messages in the batch.
+ *
+ * fndsa_sign_weak_batch() and fndsa_sign_weak_batch_temp() are similar,
+ * for weak degrees (4 to 256); they are meant for tests and research
+ * only.
+ */
+typedef struct {
+	const void *ctx;
+	size_t ctx_len;
+	const char *id;
+	const void *hv;
+	size_t hv_len;
+} fndsa_sign_msg;
+size_t fndsa_sign_batch(const void *sign_key, size_t sign_key_len,
+	const fndsa_sign_msg *msgs, size_t num,
+	void *sigs, size_t max_sigs_len);
+size_t fndsa_sign_batch_temp(const void *sign_key, size_t sign_key_len,
+	const fndsa_sign_msg *msgs, size_t num,
+	void *sigs, size_t max_sigs_len,
+	void *tmp, size_t tmp_len);
+size_t fndsa_sign_weak_batch(const void *sign_key, size_t sign_key_len,
+	const fndsa_sign_msg *msgs, size_t num,
+	void *sigs, size_t max_sigs_len);
+size_t fndsa_sign_weak_batch_temp(const void *sign_key, size_t sign_key_len,
+	const fndsa_sign_msg *msgs, size_t num,
+	void *sigs, size_t max_sigs_len,
+	void *tmp, size_t tmp_len);
+
+/*
+ * Multi-threaded signing engine (optional). The engine runs a pool of
+ * worker threads which take signing jobs from a bounded lock-free queue.
+ * Each worker owns its temporary area and its own random generator
+ * (seeded from the system RNG when the worker starts, and ratcheted
+ * after each signature), so that signature generation does not use
+ * bulky stack buffers nor invoke the system RNG for each signature.
+ *
+ * The engine is supported only on systems with POSIX threads (Linux,
+ * BSD, macOS); on other systems, fndsa_sign_engine_size() returns 0 and
+ * no engine can be started. The engine is not fork-safe: it must be
+ * started in the process that uses it.
+ *
+ * The engine state is kept in a caller-provided memory area mem[], of
+ * size mem_len bytes. Its minimum size is returned by
+ * fndsa_sign_engine_size(), for the maximum supported degree logn
+ * (9 or 10), the number of worker threads (1 to 256), and the queue
+ * length (a power of two, 2 to 65536). The area must not be modified,
+ * moved or released until fndsa_sign_engine_stop() has returned.
+ *
+ * fndsa_sign_engine_start() returns a pointer to the engine (within
+ * mem[]), or NULL on error (invalid parameters, undersized memory area,
+ * thread creation failure, system RNG failure).
+ *
+ * A job is described by a fndsa_sign_job structure, which the caller
+ * allocates and fills; the parameters have the same meaning as for
+ * fndsa_sign(). fndsa_sign_engine_submit() adds the job to the queue
+ * and returns 1, or returns 0 if the queue is full (in which case the
+ * job has not been submitted, and the caller may retry later). The job
+ * structure and all buffers it references must remain valid until the
+ * job is completed. Upon completion, the sig_len field receives the
+ * value that fndsa_sign() would have returned (signature length, or 0
+ * on error); then, if the callback field is not NULL, the callback is
+ * invoked (from the worker thread) with the job as parameter; finally,
+ * the job is marked as completed, which can be observed with
+ * fndsa_sign_job_done() (polling). The user field is not used by the
+ * engine. The callback must not wait for a full queue to have room,
+ * since it runs on a worker thread that would then not dequeue jobs.
+ *
+ * fndsa_sign_engine_submit() and fndsa_sign_job_done() are thread-safe.
+ * fndsa_sign_engine_stop() processes all jobs that are still in the
+ * queue, then terminates the worker threads; it must be called exactly
+ * once, and no job may be submitted concurrently or afterwards.
+ */
+typedef struct fndsa_sign_job_ {
+	const void *sign_key;
+	size_t sign_key_len;
+	const void *ctx;
+	size_t ctx_len;
+	const char *id;
+	const void *hv;
+	size_t hv_len;
+	void *sig;
+	size_t max_sig_len;
+	void (*callback)(struct fndsa_sign_job_ *job);
+	void *user;
+	size_t sig_len;
+	int done;
+} fndsa_sign_job;
+typedef struct fndsa_sign_engine_ fndsa_sign_engine;
+size_t fndsa_sign_engine_size(unsigned logn,
+	unsigned num_threads, size_t queue_len);
+fndsa_sign_engine *fndsa_sign_engine_start(unsigned logn,
+	unsigned num_threads, size_t queue_len, void *mem, size_t mem_len);
+int fndsa_sign_engine_submit(fndsa_sign_engine *engine, fndsa_sign_job *job);
+int fndsa_sign_job_done(const fndsa_sign_job *job);
+void fndsa_sign_engine_stop(fndsa_sign_engine *engine);
+
 /* TODO: add an API for deriving the public key from the private key?
    The code is mostly already there. */
 
@@ -357,4 +737,247 @@ int fndsa_verify_weak_temp(const void *sig, size_t sig_len,
 	const char *id, const void *hv, size_t hv_len,
 	void *tmp, size_t tmp_len);
 
+/*
+ * Prepare a verifying key for faster verification. Each verification
+ * starts with some key-dependent computations (hashing of the encoded
+ * key, decoding of the public polynomial h, and conversion of h to NTT
+ * representation); when many signatures are verified against the same
+ * key, these computations can be done once, and their result kept in a
+ * "prepared verifying key". The prepared key is written in the
+ * caller-provided pvk[] buffer, of size pvk_len bytes, which must be at
+ * least FNDSA_VRFY_KEY_PREPARED_SIZE(logn):
+ *
+ *    logn   pvk_len
+ *   ---------------
+ *      9      1151
+ *     10      2175
+ *
+ * (Formula is: 2*n+127 bytes, for degree n = 2^logn; degrees 4 to 256
+ * are also supported, for use with the fndsa_verify_weak_prepared*()
+ * functions.)
+ *
+ * Returned value is 1 on success, 0 on error (verifying key cannot be
+ * decoded, or buffer is too small).
+ *
+ * The internal layout of the prepared key depends on the alignment of
+ * pvk and on the platform; thus, it MUST NOT be stored, transmitted, or
+ * moved to another address. A given prepared key is not modified by
+ * verification and may be used by several threads concurrently.
+ */
+int fndsa_verify_key_prepare(const void *vrfy_key, size_t vrfy_key_len,
+	void *pvk, size_t pvk_len);
+
+/*
+ * Verify a signature against a prepared verifying key (as computed by
+ * fndsa_verify_key_prepare()). pvk and pvk_len must be the same values
+ * as used for the preparation. These functions are otherwise similar to
+ * fndsa_verify(), fndsa_verify_weak(), fndsa_verify_temp() and
+ * fndsa_verify_weak_temp(), respectively, and return the same results;
+ * the temporary area sizes are the same as for fndsa_verify_temp().
+ */
+int fndsa_verify_prepared(const void *sig, size_t sig_len,
+	const void *pvk, size_t pvk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len);
+int fndsa_verify_weak_prepared(const void *sig, size_t sig_len,
+	const void *pvk, size_t pvk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len);
+int fndsa_verify_prepared_temp(const void *sig, size_t sig_len,
+	const void *pvk, size_t pvk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len,
+	void *tmp, size_t tmp_len);
+int fndsa_verify_weak_prepared_temp(const void *sig, size_t sig_len,
+	const void *pvk, size_t pvk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len,
+	void *tmp, size_t tmp_len);
+
+/*
+ * Batch signature verification: num signatures are verified, each
+ * described by a fndsa_verify_msg structure, whose fields have the same
+ * meaning as the corresponding parameters of fndsa_verify(). Signatures
+ * may use the same verifying key or different keys; consecutive
+ * signatures with the same key share the key decoding. The hashing of
+ * the messages into polynomials is done for four signatures at a time,
+ * which is faster on x86 CPUs with AVX2 support.
+ *
+ * The result for signature i is written as bit (i mod 8) of results[i/8]
+ * (1 if the signature is valid, 0 otherwise); results[] must have room
+ * for (num+7)/8 bytes. The returned value is the number of valid
+ * signatures (num if all signatures are valid).
+ *
+ * These functions use about 27 kB of stack space. fndsa_verify_batch()
+ * accepts only the standard degrees (512 or 1024); fndsa_verify_weak_batch()
+ * accepts only the weak degrees (4 to 256); other signatures are reported
+ * as invalid.
+ */
+typedef struct {
+	const void *sig;
+	size_t sig_len;
+	const void *vrfy_key;
+	size_t vrfy_key_len;
+	const void *ctx;
+	size_t ctx_len;
+	const char *id;
+	const void *hv;
+	size_t hv_len;
+} fndsa_verify_msg;
+size_t fndsa_verify_batch(const fndsa_verify_msg *msgs, size_t num,
+	uint8_t *results);
+size_t fndsa_verify_weak_batch(const fndsa_verify_msg *msgs, size_t num,
+	uint8_t *results);
+
+/*
+ * Streaming signature verification: the message is provided in several
+ * chunks instead of a single buffer, which allows verifying very large
+ * messages (e.g. read from a file) without buffering them or pre-hashing
+ * them separately.
+ *
+ * fndsa_verify_init() takes the signature, verifying key, context and
+ * hash identifier, with the same meaning as for fndsa_verify(); it
+ * decodes the key and the signature and does all the key-dependent and
+ * signature-dependent computations. It returns 1 on success, or 0 if the
+ * key or signature cannot be decoded, or if the degree is not acceptable
+ * (fndsa_verify_init() accepts only the standard degrees, 512 or 1024,
+ * and fndsa_verify_weak_init() only the weak degrees, 4 to 256). The
+ * signature and key buffers are not referenced afterwards.
+ *
+ * fndsa_verify_update() injects the next len bytes of the message (the
+ * raw message, or the pre-hashed value if a pre-hash identifier was
+ * used); it may be called any number of times, with arbitrary lengths.
+ * fndsa_verify_final() returns 1 if the signature is valid for the
+ * concatenation of all injected chunks, 0 otherwise (including when
+ * fndsa_verify_init() failed); the result is the same as with
+ * fndsa_verify() on the complete message. The context must then be
+ * initialized again before any further use.
+ *
+ * The context contains no pointer and can be cloned with memcpy(), e.g.
+ * to verify several messages that share a common prefix.
+ */
+typedef struct {
+	uint64_t opaque[284];
+} fndsa_verify_context;
+int fndsa_verify_init(fndsa_verify_context *vc,
+	const void *sig, size_t sig_len,
+	const void *vrfy_key, size_t vrfy_key_len,
+	const void *ctx, size_t ctx_len, const char *id);
+int fndsa_verify_weak_init(fndsa_verify_context *vc,
+	const void *sig, size_t sig_len,
+	const void *vrfy_key, size_t vrfy_key_len,
+	const void *ctx, size_t ctx_len, const char *id);
+void fndsa_verify_update(fndsa_verify_context *vc,
+	const void *data, size_t len);
+int fndsa_verify_final(fndsa_verify_context *vc);
+
+/*
+ * Pre-hash contexts: the library can compute the pre-hash of a message
+ * with any of the hash functions which have a standard identifier (see
+ * the FNDSA_HASH_ID_* macros above, except FNDSA_HASH_ID_RAW). SHA-3 and
+ * SHAKE use the internal Keccak implementation; SHA-256 uses the SHA
+ * extensions of x86 CPUs, when available.
+ *
+ * fndsa_prehash_init() sets the context for the hash function designated
+ * by the provided identifier; it returns 1 on success, or 0 if the
+ * identifier is not supported. fndsa_prehash_update() injects the next
+ * len bytes of the message. fndsa_prehash_final() writes the hash value
+ * into out (at most 64 bytes) and returns its length; for SHAKE128 and
+ * SHAKE256, the output lengths are 32 and 64 bytes, respectively. The
+ * context is then reset to the same hash function, for a new message.
+ *
+ * fndsa_sign_prehash() and fndsa_verify_prehash() (and the weak variants)
+ * finalize the provided context and use the hash value and identifier,
+ * with the same results as fndsa_sign() and fndsa_verify() with that
+ * identifier and the value returned by fndsa_prehash_final(). If the
+ * context was not initialized with a supported identifier, they return
+ * 0.
+ *
+ * The context contains no pointer and can be cloned with memcpy().
+ */
+typedef struct {
+	uint64_t opaque[48];
+} fndsa_prehash_context;
+int fndsa_prehash_init(fndsa_prehash_context *pc, const char *id);
+void fndsa_prehash_update(fndsa_prehash_context *pc,
+	const void *data, size_t len);
+size_t fndsa_prehash_final(fndsa_prehash_context *pc, void *out);
+size_t fndsa_sign_prehash(const void *sign_key, size_t sign_key_len,
+	const void *ctx, size_t ctx_len, fndsa_prehash_context *pc,
+	void *sig, size_t max_sig_len);
+size_t fndsa_sign_weak_prehash(const void *sign_key, size_t sign_key_len,
+	const void *ctx, size_t ctx_len, fndsa_prehash_context *pc,
+	void *sig, size_t max_sig_len);
+int fndsa_verify_prehash(const void *sig, size_t sig_len,
+	const void *vrfy_key, size_t vrfy_key_len,
+	const void *ctx, size_t ctx_len, fndsa_prehash_context *pc);
+int fndsa_verify_weak_prehash(const void *sig, size_t sig_len,
+	const void *vrfy_key, size_t vrfy_key_len,
+	const void *ctx, size_t ctx_len, fndsa_prehash_context *pc);
+
+
+/*
+ * Multi-buffer SHAKE256: four (or eight) independent SHAKE256 instances
+ * which are processed together, so that the Keccak-f permutations run
+ * in parallel (with AVX2 for four instances, AVX-512 for eight; without
+ * the relevant instructions, a portable code path is used, which yields
+ * the same outputs).
+ *
+ * The context is initialized with fndsa_shake256_x4_init(). Inputs are
+ * injected with fndsa_shake256_x4_inject(): in[j] and len[j] are the
+ * data and length for instance j, and the lengths may differ (a length
+ * may be zero, in which case in[j] may be NULL). Injection may be done
+ * in several calls. fndsa_shake256_x4_flip() then switches all instances
+ * to output mode, and fndsa_shake256_x4_extract() writes len bytes of
+ * output of instance j into out[j], for each j. Output lengths are the
+ * same for all instances in a given extraction call, but extraction may
+ * be done in several calls, of arbitrary lengths. The output of instance
+ * j is the same as what a plain SHAKE256 would produce on the
+ * concatenation of all data injected in instance j.
+ *
+ * The fndsa_shake256_x8_*() functions work in the same way, over eight
+ * instances. Contexts do not contain pointers and can be cloned with a
+ * simple memcpy().
+ */
+typedef struct {
+	uint64_t opaque[104];
+} fndsa_shake256_x4_context;
+void fndsa_shake256_x4_init(fndsa_shake256_x4_context *sc);
+void fndsa_shake256_x4_inject(fndsa_shake256_x4_context *sc,
+	const void *const *in, const size_t *len);
+void fndsa_shake256_x4_flip(fndsa_shake256_x4_context *sc);
+void fndsa_shake256_x4_extract(fndsa_shake256_x4_context *sc,
+	void *const *out, size_t len);
+
+typedef struct {
+	uint64_t opaque[206];
+} fndsa_shake256_x8_context;
+void fndsa_shake256_x8_init(fndsa_shake256_x8_context *sc);
+void fndsa_shake256_x8_inject(fndsa_shake256_x8_context *sc,
+	const void *const *in, const size_t *len);
+void fndsa_shake256_x8_flip(fndsa_shake256_x8_context *sc);
+void fndsa_shake256_x8_extract(fndsa_shake256_x8_context *sc,
+	void *const *out, size_t len);
+
+
+/*
+ * SIMD implementation tiers. On x86, the library detects once (when it
+ * is loaded, or on first use) whether the CPU supports AVX2 and AVX-512,
+ * and then uses the best supported code. The base tier is the code
+ * selected at compile-time (SSE2 or plain C); on other architectures,
+ * only the base tier exists.
+ *
+ * fndsa_set_simd_tier_max() sets a cap on the tier that may be used,
+ * e.g. to compare tiers in benchmarks; it is not thread-safe and should
+ * not be called while other threads use the library. The environment
+ * variable FNDSA_SIMD_TIER, read once at detection time, may also be set
+ * to "base" or "avx2" to hide the features of the higher tiers.
+ * fndsa_get_simd_tier() returns the highest tier currently in use.
+ */
+#define FNDSA_SIMD_TIER_BASE     0
+#define FNDSA_SIMD_TIER_AVX2     1
+#define FNDSA_SIMD_TIER_AVX512   2
+void fndsa_set_simd_tier_max(unsigned tier);
+unsigned fndsa_get_simd_tier(void);
+
 #endif
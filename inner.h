@@ -45,6 +45,59 @@
 #define TARGET_AVX2
 #endif
 
+/* Define FNDSA_AVX512 to 1 in order to add AVX-512 support, 0 otherwise.
+   AVX-512 support requires AVX2 support. */
+#ifndef FNDSA_AVX512
+#define FNDSA_AVX512   FNDSA_AVX2
+#elif FNDSA_AVX512 && !FNDSA_AVX2
+#undef FNDSA_AVX512
+#define FNDSA_AVX512   0
+#endif
+
+/* TARGET_AVX512 is applied to a function definition and allows use of
+   AVX-512F (and AVX2) intrinsics in that function. AVX-512F includes
+   fused multiply-add opcodes, which GCC would use to merge separate
+   multiplications and additions; this is prevented, since the signing
+   code must get exactly the same results as the SSE2 and AVX2 code. */
+#if FNDSA_AVX512
+#if defined __clang__
+#define TARGET_AVX512    __attribute__((target("avx512f,avx2,lzcnt")))
+#elif defined __GNUC__
+#define TARGET_AVX512    __attribute__((target("avx512f,avx2,lzcnt"), \
+                                        optimize("fp-contract=off")))
+#else
+#define TARGET_AVX512
+#endif
+#else
+#define TARGET_AVX512
+#endif
+
+/* TARGET_AVX512BW is similar to TARGET_AVX512, but also allows use of
+   AVX-512BW intrinsics (for integer code on 16-bit lanes). */
+#if FNDSA_AVX512 && (defined __GNUC__ || defined __clang__)
+#define TARGET_AVX512BW   __attribute__((target("avx512bw,avx512f,avx2,lzcnt")))
+#else
+#define TARGET_AVX512BW
+#endif
+
+/* TARGET_AVX512VBMI2 is similar to TARGET_AVX512, but also allows use of
+   AVX-512BW and AVX-512VBMI2 intrinsics. It is meant for integer code
+   only, hence there is no floating-point contraction setting. */
+#if FNDSA_AVX512 && (defined __GNUC__ || defined __clang__)
+#define TARGET_AVX512VBMI2   __attribute__(( \
+	target("avx512vbmi2,avx512bw,avx512f,avx2,lzcnt")))
+#else
+#define TARGET_AVX512VBMI2
+#endif
+
+/* TARGET_SHANI is applied to a function definition and allows use of the
+   SHA extensions ("SHA-NI", for SHA-256) along with AVX2 intrinsics. */
+#if FNDSA_AVX2 && (defined __GNUC__ || defined __clang__)
+#define TARGET_SHANI   __attribute__((target("sha,avx2")))
+#else
+#define TARGET_SHANI
+#endif
+
 /* ALIGN32 is applied to a declarator and will try to make the declared
    object aligned at a 32-byte boundary in memory. */
 #if defined __GNUC__ || defined __clang__
@@ -182,6 +235,42 @@
 #endif
 #endif
 
+/* If FNDSA_SIGN_ENGINE is 1, then the multi-threaded signing engine
+   (sign_engine.c) is compiled; it uses POSIX threads and the GCC/Clang
+   atomic builtins, and is enabled by default on the Unix-like systems
+   where these are known to be available. When it is 0, the engine
+   functions are still defined but always report an error. */
+#ifndef FNDSA_SIGN_ENGINE
+#if (defined __GNUC__ || defined __clang__) && !FNDSA_ASM_CORTEXM4 \
+	&& (defined __linux__ \
+	|| defined __FreeBSD__ \
+	|| defined __NetBSD__ \
+	|| defined __OpenBSD__ \
+	|| defined __DragonFly__ \
+	|| (defined __APPLE__ && defined __MACH__))
+#define FNDSA_SIGN_ENGINE   1
+#else
+#define FNDSA_SIGN_ENGINE   0
+#endif
+#endif
+
+/* If FNDSA_KEYGEN_MT is 1, then fndsa_keygen_mt() spreads the work of
+   solving the NTRU equation over several POSIX threads (kgen_mt.c). It
+   defaults to the same setting as the signing engine; when it is 0,
+   fndsa_keygen_mt() runs on the calling thread only. */
+#ifndef FNDSA_KEYGEN_MT
+#define FNDSA_KEYGEN_MT   FNDSA_SIGN_ENGINE
+#endif
+
+/* If FNDSA_KEYGEN_CACHE is 1, then the NTT tables used in key pair
+   generation are computed once, on first use, and kept in a global
+   read-only cache (about 32 kB) instead of being recomputed on each key
+   pair generation (kgen_mp31.c). Initialization uses pthread_once(), so
+   this defaults to the same setting as FNDSA_KEYGEN_MT. */
+#ifndef FNDSA_KEYGEN_CACHE
+#define FNDSA_KEYGEN_CACHE   FNDSA_KEYGEN_MT
+#endif
+
 /* Automatically recognize some architectures as being "64-bit", which
    mostly means that we assume that 64-bit shifts are constant-time
    with regard to the shift count. */
@@ -292,6 +381,13 @@ void shake_flip(shake_context *sc);
    RAM (especially stack space) on embedded systems. */
 void shake_extract(shake_context *sc, void *out, size_t len);
 
+/* Initialize a four-state multi-buffer SHAKE256 context (see fndsa.h)
+   from four SHAKE256 contexts (src[0] to src[3]), which MUST all be in
+   output mode and at the end of their current block (as is the case
+   right after shake_flip()). */
+#define shake256_x4_set   fndsa_shake256_x4_set
+void shake256_x4_set(fndsa_shake256_x4_context *sc, const shake_context *src);
+
 /* Get the next byte from a SHAKE context. */
 static inline uint8_t
 shake_next_u8(shake_context *sc)
@@ -490,6 +586,7 @@ void sha3_close(sha3_context *sc, void *out);
 #define trim_i8_decode   fndsa_trim_i8_decode
 #define mqpoly_encode    fndsa_mqpoly_encode
 #define mqpoly_decode    fndsa_mqpoly_decode
+#define mqpoly_decode_int   fndsa_mqpoly_decode_int
 #define comp_encode      fndsa_comp_encode
 #define comp_decode      fndsa_comp_decode
 
@@ -516,6 +613,11 @@ size_t mqpoly_encode(unsigned logn, const uint16_t *h, uint8_t *d);
    returned. On error (a value is out-of-range), 0 is returned. */
 size_t mqpoly_decode(unsigned logn, const uint8_t *d, uint16_t *h);
 
+/* Same as mqpoly_decode(), except that the decoded values are converted
+   to internal representation (value 0 is replaced with q), as would
+   be done by mqpoly_ext_to_int(). */
+size_t mqpoly_decode_int(unsigned logn, const uint8_t *d, uint16_t *h);
+
 /* Encode polynomial s into destination buffer d (of size dlen bytes),
    using compressed (Golomb-Rice) format. If any of the source values is
    outside of [-2047,+2047], this function fails and returns 0. If the
@@ -703,6 +805,31 @@ uint32_t avx2_mqpoly_sqnorm_ext(unsigned logn, const uint16_t *a);
 uint32_t avx2_mqpoly_sqnorm_signed(unsigned logn, const uint16_t *a);
 #endif
 
+/* AVX-512BW variants (32 lanes); for degrees lower than 64, they use the
+   AVX2 code. Callers must check has_avx512bw(). */
+#if FNDSA_AVX512
+#define avx512_mqpoly_signed_to_int       fndsa_avx512_mqpoly_signed_to_int
+#define avx512_mqpoly_ext_to_int          fndsa_avx512_mqpoly_ext_to_int
+#define avx512_mqpoly_int_to_ext          fndsa_avx512_mqpoly_int_to_ext
+#define avx512_mqpoly_int_to_ntt          fndsa_avx512_mqpoly_int_to_ntt
+#define avx512_mqpoly_ntt_to_int          fndsa_avx512_mqpoly_ntt_to_int
+#define avx512_mqpoly_mul_ntt             fndsa_avx512_mqpoly_mul_ntt
+#define avx512_mqpoly_div_ntt             fndsa_avx512_mqpoly_div_ntt
+#define avx512_mqpoly_sub                 fndsa_avx512_mqpoly_sub
+#define avx512_mqpoly_sqnorm_ext          fndsa_avx512_mqpoly_sqnorm_ext
+#define avx512_mqpoly_sqnorm_signed       fndsa_avx512_mqpoly_sqnorm_signed
+void avx512_mqpoly_signed_to_int(unsigned logn, uint16_t *d);
+void avx512_mqpoly_ext_to_int(unsigned logn, uint16_t *d);
+void avx512_mqpoly_int_to_ext(unsigned logn, uint16_t *d);
+void avx512_mqpoly_int_to_ntt(unsigned logn, uint16_t *d);
+void avx512_mqpoly_ntt_to_int(unsigned logn, uint16_t *d);
+void avx512_mqpoly_mul_ntt(unsigned logn, uint16_t *a, const uint16_t *b);
+int avx512_mqpoly_div_ntt(unsigned logn, uint16_t *a, const uint16_t *b);
+void avx512_mqpoly_sub(unsigned logn, uint16_t *a, const uint16_t *b);
+uint32_t avx512_mqpoly_sqnorm_ext(unsigned logn, const uint16_t *a);
+uint32_t avx512_mqpoly_sqnorm_signed(unsigned logn, const uint16_t *a);
+#endif
+
 /* ==================================================================== */
 /*
  * Utility functions.
@@ -723,12 +850,78 @@ void hash_to_point(unsigned logn,
 	const char *hash_id, const void *hv, size_t hv_len,
 	uint16_t *c);
 
+/* Inject into a SHAKE256 context (freshly initialized by the caller)
+   the input of hash_to_point(), and flip it to output mode. */
+#define hash_to_point_start   fndsa_hash_to_point_start
+void hash_to_point_start(shake_context *sc,
+	const uint8_t *nonce, const uint8_t *hashed_vrfy_key,
+	const void *ctx, size_t ctx_len,
+	const char *hash_id, const void *hv, size_t hv_len);
+
+/* Inject into a SHAKE256 context (freshly initialized by the caller)
+   the input of hash_to_point() that precedes the message (nonce, hashed
+   key, context and hash identifier). The caller then injects the
+   message, possibly in several chunks, flips the context to output
+   mode, and calls hash_to_point_finish(). */
+#define hash_to_point_begin   fndsa_hash_to_point_begin
+void hash_to_point_begin(shake_context *sc,
+	const uint8_t *nonce, const uint8_t *hashed_vrfy_key,
+	const void *ctx, size_t ctx_len, const char *hash_id);
+
+/* Finish hash_to_point() with a context prepared with
+   hash_to_point_start() (or hash_to_point_begin(), then flipped); the
+   output polynomial has degree 2^logn and is written into c. */
+#define hash_to_point_finish   fndsa_hash_to_point_finish
+void hash_to_point_finish(unsigned logn, shake_context *sc, uint16_t *c);
+
+/* Finish hash_to_point() for num contexts at once (1 <= num <= 4), each
+   prepared with hash_to_point_start(); output polynomial j has degree
+   2^logn[j] and is written into c[j]. Four contexts MUST be provided;
+   the ones beyond num only need to be initialized and flipped. */
+#define hash_to_point_x4   fndsa_hash_to_point_x4
+void hash_to_point_x4(shake_context *sc, size_t num,
+	const unsigned *logn, uint16_t *const *c);
+
 #if FNDSA_AVX2
 #define has_avx2   fndsa_has_avx2
 /* Check for AVX2 support by the current CPU. */
 int has_avx2(void);
 #endif
 
+#if FNDSA_AVX2
+#define has_shani   fndsa_has_shani
+/* Check for SHA extensions support by the current CPU (this includes a
+   check for AVX2 support). */
+int has_shani(void);
+#endif
+
+#if FNDSA_AVX512
+#define has_avx512   fndsa_has_avx512
+/* Check for AVX-512F support by the current CPU (this includes a check
+   for AVX2 support). */
+int has_avx512(void);
+
+#define has_avx512bw   fndsa_has_avx512bw
+/* Check for AVX-512F and AVX-512BW support by the current CPU (this
+   includes a check for AVX2 support). */
+int has_avx512bw(void);
+
+#define has_avx512vbmi2   fndsa_has_avx512vbmi2
+/* Check for AVX-512F, AVX-512BW and AVX-512VBMI2 support by the current
+   CPU (this includes a check for AVX2 support). */
+int has_avx512vbmi2(void);
+#endif
+
+/* Runtime-selected SIMD tiers (x86 only); see fndsa_set_simd_tier_max()
+   in fndsa.h. The base tier is whatever was selected at compile-time
+   (SSE2 or plain code); the AVX2 and AVX-512 tiers are used when
+   has_avx2() and has_avx512() report support, respectively. CPU
+   features are detected only once, so these calls are inexpensive. */
+#define SIMD_TIER_BASE     FNDSA_SIMD_TIER_BASE
+#define SIMD_TIER_AVX2     FNDSA_SIMD_TIER_AVX2
+#define SIMD_TIER_AVX512   FNDSA_SIMD_TIER_AVX512
+#define set_simd_tier_max   fndsa_set_simd_tier_max
+
 /* Expand the top bit of a 32-bit word into a full 32-bit mask (i.e. return
    0xFFFFFFFF if x >= 0x80000000, or 0x00000000 otherwise). */
 static inline uint32_t
@@ -767,6 +960,10 @@ lzcnt(uint32_t x)
    TODO: on x86, this can be implemented with the bsr opcode. */
 #define lzcnt_nonzero   lzcnt
 
+/* Round a length up to a multiple of 64 (used to lay out the areas of
+   the thread pools on cache line boundaries). */
+#define ROUND64(x)   (((x) + (size_t)63) & ~(size_t)63)
+
 /* Obtain fresh randomness from the operating system. This function shall
    ensure that the requested entropy is achieved. If the operating system
    does not have a secure random source, or if that source fails, then
@@ -774,6 +971,25 @@ lzcnt(uint32_t x)
 #define sysrng   fndsa_sysrng
 int sysrng(void *dst, size_t len);
 
+/* Erase a buffer that held secret values. The writes are performed
+   through volatile accesses, so that they are kept even when the buffer
+   is not read afterwards. */
+#define secure_wipe   fndsa_secure_wipe
+void secure_wipe(void *buf, size_t len);
+
+/* Initialize a SHAKE256 context, ready for output, with a 48-byte seed
+   obtained from sysrng(). Returned value is 1 on success, 0 if the
+   system RNG failed. */
+#define sysrng_shake_init   fndsa_sysrng_shake_init
+int sysrng_shake_init(shake_context *rng);
+
+/* Extract len bytes from a SHAKE256 context initialized with
+   sysrng_shake_init(), then reinitialize it from 32 further output
+   bytes. A later leak of the context does not reveal the bytes that
+   were extracted before the call. */
+#define shake_ratchet   fndsa_shake_ratchet
+void shake_ratchet(shake_context *rng, void *dst, size_t len);
+
 /* ==================================================================== */
 
 #endif
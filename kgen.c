@@ -6,8 +6,15 @@
 
 static void
 keygen_inner(unsigned logn, const void *seed, size_t seed_len,
-	void *sign_key, void *vrfy_key, void *tmp)
+	void *sign_key, void *vrfy_key, void *tmp,
+	kgen_pool *kp, keygen_stats *st)
 {
+	keygen_stats st_dummy;
+	if (st == NULL) {
+		memset(&st_dummy, 0, sizeof st_dummy);
+		st = &st_dummy;
+	}
+
 	/* Ensure that tmp is 32-byte aligned. */
 	tmp = (void *)(((uintptr_t)tmp + 31) & ~(uintptr_t)31);
 
@@ -31,6 +38,7 @@ keygen_inner(unsigned logn, const void *seed, size_t seed_len,
 		/* Sample f and g, both with odd parity. */
 		sample_f(logn, &pc, f);
 		sample_f(logn, &pc, g);
+		st->candidates ++;
 
 		/* Ensure that ||(g, -f)|| < 1.17*sqrt(q),
 		   i.e. that ||(g, -f)||^2 < (1.17^2)*q = 16822.4121  */
@@ -41,21 +49,25 @@ keygen_inner(unsigned logn, const void *seed, size_t seed_len,
 			sn += xf * xf + xg * xg;
 		}
 		if (sn >= 16823) {
+			st->rej_norm ++;
 			continue;
 		}
 
 		/* f must be invertible modulo X^n+1 modulo q. */
 		if (!mqpoly_is_invertible(logn, f, tmp)) {
+			st->rej_invert ++;
 			continue;
 		}
 
 		/* (f,g) must have an acceptable orthogonalized norm. */
 		if (!check_ortho_norm(logn, f, g, tmp)) {
+			st->rej_ortho ++;
 			continue;
 		}
 
 		/* Try to solve the NTRU equation. */
-		if (!solve_NTRU(logn, f, g, tmp)) {
+		if (!solve_NTRU(logn, f, g, tmp, kp)) {
+			st->rej_solve ++;
 			continue;
 		}
 
@@ -99,8 +111,15 @@ keygen_inner(unsigned logn, const void *seed, size_t seed_len,
 TARGET_AVX2
 static void
 avx2_keygen_inner(unsigned logn, const void *seed, size_t seed_len,
-	void *sign_key, void *vrfy_key, void *tmp)
+	void *sign_key, void *vrfy_key, void *tmp,
+	kgen_pool *kp, keygen_stats *st)
 {
+	keygen_stats st_dummy;
+	if (st == NULL) {
+		memset(&st_dummy, 0, sizeof st_dummy);
+		st = &st_dummy;
+	}
+
 	/* Ensure that tmp is 32-byte aligned. */
 	tmp = (void *)(((uintptr_t)tmp + 31) & ~(uintptr_t)31);
 
@@ -122,33 +141,34 @@ avx2_keygen_inner(unsigned logn, const void *seed, size_t seed_len,
 
 	for (;;) {
 		/* Sample f and g, both with odd parity. */
-		sample_f(logn, &pc, f);
-		sample_f(logn, &pc, g);
+		avx2_sample_f(logn, &pc, f);
+		avx2_sample_f(logn, &pc, g);
+		st->candidates ++;
 
 		/* Ensure that ||(g, -f)|| < 1.17*sqrt(q),
 		   i.e. that ||(g, -f)||^2 < (1.17^2)*q = 16822.4121  */
-		int32_t sn = 0;
-		for (size_t i = 0; i < n; i ++) {
-			int32_t xf = f[i];
-			int32_t xg = g[i];
-			sn += xf * xf + xg * xg;
-		}
+		uint32_t sn = avx2_poly_sqnorm(logn, f)
+			+ avx2_poly_sqnorm(logn, g);
 		if (sn >= 16823) {
+			st->rej_norm ++;
 			continue;
 		}
 
 		/* f must be invertible modulo X^n+1 modulo q. */
 		if (!avx2_mqpoly_is_invertible(logn, f, tmp)) {
+			st->rej_invert ++;
 			continue;
 		}
 
 		/* (f,g) must have an acceptable orthogonolized norm. */
 		if (!avx2_check_ortho_norm(logn, f, g, tmp)) {
+			st->rej_ortho ++;
 			continue;
 		}
 
 		/* Try to solve the NTRU equation. */
-		if (!avx2_solve_NTRU(logn, f, g, tmp)) {
+		if (!avx2_solve_NTRU(logn, f, g, tmp, kp)) {
+			st->rej_solve ++;
 			continue;
 		}
 
@@ -195,25 +215,28 @@ avx2_keygen_inner(unsigned logn, const void *seed, size_t seed_len,
 #define KEYGEN_WRAP(sz)   \
 	static void keygen_ ## sz(unsigned logn, \
 		const void *seed, size_t seed_len, \
-		void *sign_key, void *vrfy_key) \
+		void *sign_key, void *vrfy_key, \
+		kgen_pool *kp, keygen_stats *st) \
 	{ \
 		uint8_t tmp[(sz) * 26 + 31]; \
 		if (has_avx2()) { \
 			avx2_keygen_inner(logn, \
-				seed, seed_len, sign_key, vrfy_key, tmp); \
+				seed, seed_len, sign_key, vrfy_key, tmp, kp, st); \
 		} else { \
 			keygen_inner(logn, \
-				seed, seed_len, sign_key, vrfy_key, tmp); \
+				seed, seed_len, sign_key, vrfy_key, tmp, kp, st); \
 		} \
 	}
 #else
 #define KEYGEN_WRAP(sz)   \
 	static void keygen_ ## sz(unsigned logn, \
 		const void *seed, size_t seed_len, \
-		void *sign_key, void *vrfy_key) \
+		void *sign_key, void *vrfy_key, \
+		kgen_pool *kp, keygen_stats *st) \
 	{ \
 		uint8_t tmp[(sz) * 26 + 31]; \
-		keygen_inner(logn, seed, seed_len, sign_key, vrfy_key, tmp); \
+		keygen_inner(logn, \
+			seed, seed_len, sign_key, vrfy_key, tmp, kp, st); \
 	}
 #endif
 
@@ -224,53 +247,104 @@ KEYGEN_WRAP(256)
 KEYGEN_WRAP(512)
 KEYGEN_WRAP(1024)
 
-static int
-keygen(unsigned logn, const void *seed, size_t seed_len,
-	void *sign_key, void *vrfy_key, void *tmp, size_t tmp_len)
+/* Parameters for a key pair generation, passed to keygen_pool(). */
+typedef struct {
+	unsigned logn;
+	const void *seed;
+	size_t seed_len;
+	void *sign_key;
+	void *vrfy_key;
+	void *tmp;
+	keygen_stats *st;
+} keygen_args;
+
+/* Run a key pair generation with the threads of kp (if not NULL). */
+static void
+keygen_pool(kgen_pool *kp, void *ctx)
 {
-	/* If no seed is provided, uses the system RNG to get a
-	   32-byte seed. */
-	uint8_t seedbuf[32];
-	if (seed == NULL) {
-		if (!sysrng(seedbuf, sizeof seedbuf)) {
-			goto fail;
-		}
-		seed = seedbuf;
-		seed_len = sizeof seedbuf;
-	}
+	keygen_args *ka = ctx;
+	unsigned logn = ka->logn;
+	const void *seed = ka->seed;
+	size_t seed_len = ka->seed_len;
+	void *sign_key = ka->sign_key;
+	void *vrfy_key = ka->vrfy_key;
+	keygen_stats *st = ka->st;
 
-	if (tmp == NULL) {
+	if (ka->tmp == NULL) {
 		/* If no temporary area is provided, call the relevant
 		   wrapper to allocate it on the stack. */
 		switch (logn) {
 		case 6:
-			keygen_64(logn, seed, seed_len, sign_key, vrfy_key);
+			keygen_64(logn, seed, seed_len,
+				sign_key, vrfy_key, kp, st);
 			break;
 		case 7:
-			keygen_128(logn, seed, seed_len, sign_key, vrfy_key);
+			keygen_128(logn, seed, seed_len,
+				sign_key, vrfy_key, kp, st);
 			break;
 		case 8:
-			keygen_256(logn, seed, seed_len, sign_key, vrfy_key);
+			keygen_256(logn, seed, seed_len,
+				sign_key, vrfy_key, kp, st);
 			break;
 		case 9:
-			keygen_512(logn, seed, seed_len, sign_key, vrfy_key);
+			keygen_512(logn, seed, seed_len,
+				sign_key, vrfy_key, kp, st);
 			break;
 		case 10:
-			keygen_1024(logn, seed, seed_len, sign_key, vrfy_key);
+			keygen_1024(logn, seed, seed_len,
+				sign_key, vrfy_key, kp, st);
 			break;
 		default:
-			keygen_32(logn, seed, seed_len, sign_key, vrfy_key);
+			keygen_32(logn, seed, seed_len,
+				sign_key, vrfy_key, kp, st);
 			break;
 		}
 	} else {
-		/* Check that the provided temporary area is large enough.
-		   We want 24*n bytes + enough room to ensure 32-byte
-		   alilgnment. */
-		if (tmp_len < (31 + ((size_t)24 << logn))) {
+#if FNDSA_AVX2
+		if (has_avx2()) {
+			avx2_keygen_inner(logn, seed, seed_len,
+				sign_key, vrfy_key, ka->tmp, kp, st);
+			return;
+		}
+#endif
+		keygen_inner(logn, seed, seed_len,
+			sign_key, vrfy_key, ka->tmp, kp, st);
+	}
+}
+
+static int
+keygen(unsigned logn, const void *seed, size_t seed_len,
+	void *sign_key, void *vrfy_key, void *tmp, size_t tmp_len,
+	unsigned num_threads, keygen_stats *st)
+{
+	/* If no seed is provided, uses the system RNG to get a
+	   32-byte seed. */
+	uint8_t seedbuf[32];
+	if (seed == NULL) {
+		if (!sysrng(seedbuf, sizeof seedbuf)) {
 			goto fail;
 		}
-		keygen_inner(logn, seed, seed_len, sign_key, vrfy_key, tmp);
+		seed = seedbuf;
+		seed_len = sizeof seedbuf;
 	}
+
+	/* Check that the provided temporary area (if any) is large
+	   enough. We want 24*n bytes + enough room to ensure 32-byte
+	   alilgnment. */
+	if (tmp != NULL && tmp_len < (31 + ((size_t)24 << logn))) {
+		goto fail;
+	}
+
+	/* The output does not depend on the number of threads. */
+	keygen_args ka;
+	ka.logn = logn;
+	ka.seed = seed;
+	ka.seed_len = seed_len;
+	ka.sign_key = sign_key;
+	ka.vrfy_key = vrfy_key;
+	ka.tmp = tmp;
+	ka.st = st;
+	kgen_pool_call(num_threads, keygen_pool, &ka);
 	return 1;
 
 fail:
@@ -287,7 +361,8 @@ fail:
 int
 fndsa_keygen(unsigned logn, void *sign_key, void *vrfk_key)
 {
-	return keygen(logn, NULL, 0, sign_key, vrfk_key, NULL, 0);
+	return keygen(logn, NULL, 0, sign_key, vrfk_key,
+		NULL, 0, 1, NULL);
 }
 
 /* see fndsa.h */
@@ -295,7 +370,8 @@ int
 fndsa_keygen_temp(unsigned logn, void *sign_key, void *vrfk_key,
 	void *tmp, size_t tmp_len)
 {
-	return keygen(logn, NULL, 0, sign_key, vrfk_key, tmp, tmp_len);
+	return keygen(logn, NULL, 0, sign_key, vrfk_key,
+		tmp, tmp_len, 1, NULL);
 }
 
 /* see fndsa.h */
@@ -303,7 +379,8 @@ void
 fndsa_keygen_seeded(unsigned logn, const void *seed, size_t seed_len,
 	void *sign_key, void *vrfk_key)
 {
-	(void)keygen(logn, seed, seed_len, sign_key, vrfk_key, NULL, 0);
+	(void)keygen(logn, seed, seed_len, sign_key, vrfk_key,
+		NULL, 0, 1, NULL);
 }
 
 /* see fndsa.h */
@@ -311,5 +388,33 @@ int
 fndsa_keygen_seeded_temp(unsigned logn, const void *seed, size_t seed_len,
 	void *sign_key, void *vrfk_key, void *tmp, size_t tmp_len)
 {
-	return keygen(logn, seed, seed_len, sign_key, vrfk_key, tmp, tmp_len);
+	return keygen(logn, seed, seed_len, sign_key, vrfk_key,
+		tmp, tmp_len, 1, NULL);
+}
+
+/* see fndsa.h */
+int
+fndsa_keygen_mt(unsigned logn, unsigned num_threads,
+	void *sign_key, void *vrfy_key)
+{
+	return keygen(logn, NULL, 0, sign_key, vrfy_key,
+		NULL, 0, num_threads, NULL);
+}
+
+/* see fndsa.h */
+void
+fndsa_keygen_seeded_mt(unsigned logn, unsigned num_threads,
+	const void *seed, size_t seed_len, void *sign_key, void *vrfy_key)
+{
+	(void)keygen(logn, seed, seed_len, sign_key, vrfy_key,
+		NULL, 0, num_threads, NULL);
+}
+
+/* see kgen_inner.h */
+void
+keygen_seeded_stats(unsigned logn, const void *seed, size_t seed_len,
+	void *sign_key, void *vrfy_key, keygen_stats *st)
+{
+	(void)keygen(logn, seed, seed_len, sign_key, vrfy_key,
+		NULL, 0, 1, st);
 }
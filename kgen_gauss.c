@@ -103,3 +103,88 @@ sample_f(unsigned logn, shake_context *pc, int8_t *f)
 		}
 	}
 }
+
+#if FNDSA_AVX2
+/* see kgen_inner.h */
+TARGET_AVX2
+#if FNDSA_SHAKE256X4
+void
+avx2_sample_f(unsigned logn, shake256x4_context *pc, int8_t *f)
+#else
+void
+avx2_sample_f(unsigned logn, shake_context *pc, int8_t *f)
+#endif
+{
+	/* For degrees lower than 256, several samples are added together,
+	   and the result may have to be resampled; we use the generic
+	   code for these (small) degrees. */
+	const uint16_t *tab;
+	size_t tab_len;
+	switch (logn) {
+	case 8:
+		tab = gauss_256;
+		tab_len = (sizeof gauss_256) / sizeof(uint16_t);
+		break;
+	case 9:
+		tab = gauss_512;
+		tab_len = (sizeof gauss_512) / sizeof(uint16_t);
+		break;
+	case 10:
+		tab = gauss_1024;
+		tab_len = (sizeof gauss_1024) / sizeof(uint16_t);
+		break;
+	default:
+		sample_f(logn, pc, f);
+		return;
+	}
+	size_t n = (size_t)1 << logn;
+
+	/* Each value is -kmax plus the number of table entries which are
+	   lower than y (as in sample_f()); 16 values are computed in
+	   parallel with signed 16-bit comparisons, hence the XOR with
+	   0x8000 on both operands. The random words are obtained in the
+	   same order as in sample_f(), so the output is the same. */
+	__m256i ykmax = _mm256_set1_epi16((int16_t)(tab_len >> 1));
+	__m256i y8000 = _mm256_set1_epi16((int16_t)0x8000);
+	for (;;) {
+		__m256i yp = _mm256_setzero_si256();
+		for (size_t i = 0; i < n; i += 16) {
+			uint16_t yy[16];
+			for (size_t j = 0; j < 16; j ++) {
+#if FNDSA_SHAKE256X4
+				yy[j] = shake256x4_next_u16(pc);
+#else
+				yy[j] = shake_next_u16(pc);
+#endif
+			}
+			__m256i y = _mm256_xor_si256(y8000,
+				_mm256_loadu_si256((const __m256i *)yy));
+			__m256i ys = _mm256_setzero_si256();
+			for (size_t k = 0; k < tab_len; k ++) {
+				__m256i yt = _mm256_set1_epi16(
+					(int16_t)(tab[k] ^ 0x8000));
+				ys = _mm256_sub_epi16(ys,
+					_mm256_cmpgt_epi16(y, yt));
+			}
+			ys = _mm256_sub_epi16(ys, ykmax);
+			yp = _mm256_xor_si256(yp, ys);
+			__m256i yb = _mm256_permute4x64_epi64(
+				_mm256_packs_epi16(ys, ys), 0x08);
+			_mm_storeu_si128((__m128i *)(f + i),
+				_mm256_castsi256_si128(yb));
+		}
+
+		/* Parity is the XOR of the low bits of all values; we
+		   keep odd-parity polynomials only. */
+		uint32_t r = (uint32_t)_mm256_movemask_epi8(
+			_mm256_slli_epi16(yp, 7)) & 0x55555555;
+		r ^= r >> 16;
+		r ^= r >> 8;
+		r ^= r >> 4;
+		r ^= r >> 2;
+		if ((r & 1) != 0) {
+			break;
+		}
+	}
+}
+#endif
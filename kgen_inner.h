@@ -9,6 +9,53 @@
 
 #include "inner.h"
 
+/* ==================================================================== */
+/*
+ * Optional thread pool (multi-threaded key pair generation).
+ *
+ * Parts of the NTRU solver which work independently on each small prime
+ * modulus, or on each coefficient, are expressed as tasks over a range
+ * of indices; kgen_run() splits that range into contiguous chunks, one
+ * per thread. The split depends only on the range and the number of
+ * threads, and each index is processed exactly as in the sequential
+ * code, so that the output does not depend on the pool. Functions which
+ * accept a kgen_pool pointer also accept NULL (single-threaded).
+ */
+
+typedef struct kgen_pool_ kgen_pool;
+
+/* A task processes indices start to end-1. The scratch[] area is
+   private to the thread; tasks may use at most KGEN_SCRATCH_WORDS words
+   of it (the calling thread provides its own area, of the size that the
+   task needs). */
+typedef void (*kgen_task)(void *ctx, size_t start, size_t end,
+	uint32_t *scratch);
+#define KGEN_SCRATCH_WORDS   ((size_t)4 << 10)
+
+/* Maximum number of threads in a pool (including the calling thread). */
+#define KGEN_MAX_THREADS   64
+
+/* Waking up threads is not free: a chunk should represent at least
+   that much work (in units of about one modular multiplication). */
+#define KGEN_MIN_WORK   ((size_t)1 << 14)
+
+/* Run a task over indices 0 to num-1. cost is an estimate of the work
+   for one index (same unit as KGEN_MIN_WORK); fewer threads are used
+   for small workloads. The calling thread processes the first chunk
+   with the provided scratch area; the function returns when all chunks
+   have been processed. */
+#define kgen_run   fndsa_kgen_run
+void kgen_run(kgen_pool *kp, size_t num, size_t cost,
+	kgen_task task, void *ctx, uint32_t *scratch);
+
+/* Start a pool of num_threads threads (including the calling thread),
+   call fn(kp, ctx), then stop the pool. If no extra thread can be
+   started (or thread support is not compiled in), then fn() is called
+   with kp = NULL. */
+#define kgen_pool_call   fndsa_kgen_pool_call
+void kgen_pool_call(unsigned num_threads,
+	void (*fn)(kgen_pool *kp, void *ctx), void *ctx);
+
 /* ==================================================================== */
 /*
  * Computations modulo small 31-bit primes.
@@ -178,6 +225,36 @@ void mp_mkgm(unsigned logn, uint32_t *restrict gm,
 void mp_mkigm(unsigned logn, uint32_t *restrict igm,
 	uint32_t ig, uint32_t p, uint32_t p0i);
 
+/* Get the gm[] table (as computed by mp_mkgmigm()) for degree n = 2^logn
+   and prime PRIMES[i]. If the table is in the twiddle cache (see
+   FNDSA_KEYGEN_CACHE), then a pointer into the cache is returned;
+   otherwise, the table is computed into buf[] (n words), and buf is
+   returned. The returned table must not be modified. */
+#define mp_get_gm   fndsa_mp_get_gm
+const uint32_t *mp_get_gm(unsigned logn, size_t i, uint32_t *buf);
+
+/* Like mp_get_gm(), but for the igm[] table. */
+#define mp_get_igm   fndsa_mp_get_igm
+const uint32_t *mp_get_igm(unsigned logn, size_t i, uint32_t *buf);
+
+/* Like mp_get_gm() and mp_get_igm() together; *gm and *igm are set to
+   the tables, computed into gm_buf[] and igm_buf[] if not cached. */
+#define mp_get_gmigm   fndsa_mp_get_gmigm
+void mp_get_gmigm(unsigned logn, size_t i,
+	const uint32_t **gm, const uint32_t **igm,
+	uint32_t *gm_buf, uint32_t *igm_buf);
+
+/* Get the size (in bytes) of the twiddle cache (0 if FNDSA_KEYGEN_CACHE
+   is disabled). */
+#define mp_twiddle_cache_size   fndsa_mp_twiddle_cache_size
+size_t mp_twiddle_cache_size(void);
+
+/* Enable or disable the use of the twiddle cache (enabled by default).
+   This is meant for benchmarks and tests, and must not be called while
+   a key pair generation is running. */
+#define mp_twiddle_cache_enable   fndsa_mp_twiddle_cache_enable
+void mp_twiddle_cache_enable(int enabled);
+
 /* Compute the NTT over a polynomial. The polynomial a[] is modified
    in-place. */
 #define mp_NTT   fndsa_mp_NTT
@@ -311,6 +388,14 @@ void avx2_mp_mkgm(unsigned logn, uint32_t *restrict gm,
 #define avx2_mp_mkigm   fndsa_avx2_mp_mkigm
 void avx2_mp_mkigm(unsigned logn, uint32_t *restrict igm,
 	uint32_t ig, uint32_t p, uint32_t p0i);
+#define avx2_mp_get_gm   fndsa_avx2_mp_get_gm
+const uint32_t *avx2_mp_get_gm(unsigned logn, size_t i, uint32_t *buf);
+#define avx2_mp_get_igm   fndsa_avx2_mp_get_igm
+const uint32_t *avx2_mp_get_igm(unsigned logn, size_t i, uint32_t *buf);
+#define avx2_mp_get_gmigm   fndsa_avx2_mp_get_gmigm
+void avx2_mp_get_gmigm(unsigned logn, size_t i,
+	const uint32_t **gm, const uint32_t **igm,
+	uint32_t *gm_buf, uint32_t *igm_buf);
 #define avx2_mp_NTT   fndsa_avx2_mp_NTT
 void avx2_mp_NTT(unsigned logn,
 	uint32_t *restrict a, const uint32_t *restrict gm,
@@ -321,6 +406,60 @@ void avx2_mp_iNTT(unsigned logn,
 	uint32_t p, uint32_t p0i);
 #endif
 
+#if FNDSA_AVX512
+/* AVX-512F versions of the modular operations, over 16 lanes. Since all
+   values are in [0,p-1] with p < 2^31, conditional subtractions of p
+   can use an unsigned minimum: if x >= p then x - p < x, otherwise
+   x - p wraps around and is greater than x. */
+TARGET_AVX512
+static inline __m512i
+mp_set_x16(__m512i zv, __m512i zp)
+{
+	return _mm512_min_epu32(zv, _mm512_add_epi32(zv, zp));
+}
+
+TARGET_AVX512
+static inline __m512i
+mp_add_x16(__m512i za, __m512i zb, __m512i zp)
+{
+	__m512i zd = _mm512_add_epi32(za, zb);
+	return _mm512_min_epu32(zd, _mm512_sub_epi32(zd, zp));
+}
+
+TARGET_AVX512
+static inline __m512i
+mp_sub_x16(__m512i za, __m512i zb, __m512i zp)
+{
+	__m512i zd = _mm512_sub_epi32(za, zb);
+	return _mm512_min_epu32(zd, _mm512_add_epi32(zd, zp));
+}
+
+TARGET_AVX512
+static inline __m512i
+mp_half_x16(__m512i za, __m512i zp)
+{
+	__mmask16 mo = _mm512_test_epi32_mask(za, _mm512_set1_epi32(1));
+	return _mm512_srli_epi32(_mm512_mask_add_epi32(za, mo, za, zp), 1);
+}
+
+TARGET_AVX512
+static inline __m512i
+mp_mmul_x16(__m512i za, __m512i zb, __m512i zp, __m512i zp0i)
+{
+	/* Even lanes in zd0, odd lanes in zd1; the Montgomery reduction
+	   leaves each result in the high half of its 64-bit slot. */
+	__m512i zd0 = _mm512_mul_epu32(za, zb);
+	__m512i zd1 = _mm512_mul_epu32(
+		_mm512_srli_epi64(za, 32), _mm512_srli_epi64(zb, 32));
+	__m512i ze0 = _mm512_mul_epu32(_mm512_mul_epu32(zd0, zp0i), zp);
+	__m512i ze1 = _mm512_mul_epu32(_mm512_mul_epu32(zd1, zp0i), zp);
+	zd0 = _mm512_srli_epi64(_mm512_add_epi64(zd0, ze0), 32);
+	zd1 = _mm512_add_epi64(zd1, ze1);
+	__m512i zg = _mm512_mask_blend_epi32(0xAAAA, zd0, zd1);
+	return _mm512_min_epu32(zg, _mm512_sub_epi32(zg, zp));
+}
+#endif
+
 /* ==================================================================== */
 /*
  * Custom bignum implementation.
@@ -352,7 +491,9 @@ uint32_t zint_mul_small(uint32_t *m, size_t len, uint32_t x);
      p is prime
      2^30 < p < 2^31
      p0i = -1/p mod 2^32
-     R2 = 2^64 mod p     */
+     R2 = 2^64 mod p
+   If AVX-512F is supported, long integers are reduced with
+   avx512_zint_mod_small_unsigned() (the result is the same). */
 #define zint_mod_small_unsigned   fndsa_zint_mod_small_unsigned
 uint32_t zint_mod_small_unsigned(const uint32_t *d, size_t len, size_t stride,
 	uint32_t p, uint32_t p0i, uint32_t R2);
@@ -398,10 +539,13 @@ void zint_norm_zero(uint32_t *restrict x, size_t len, size_t xstride,
    moduli) and returned in signed conventions; otherwise, output values
    are in [0,m-1] and use unsigned convention.
 
-   tmp[] must have room for xlen words. */
+   tmp[] must have room for xlen words. The integers are rebuilt
+   independently of each other, and are spread over the threads of the
+   pool kp (if not NULL). */
 #define zint_rebuild_CRT   fndsa_zint_rebuild_CRT
 void zint_rebuild_CRT(uint32_t *restrict xx, size_t xlen, size_t n,
-	size_t num_sets, int normalize_signed, uint32_t *restrict tmp);
+	size_t num_sets, int normalize_signed, uint32_t *restrict tmp,
+	kgen_pool *kp);
 
 /* Negate a big integer conditionally: a is replaced with -a if and only
    if ctl = 0xFFFFFFFF. Control value ctl must be 0x00000000 or 0xFFFFFFFF.
@@ -452,9 +596,28 @@ TARGET_AVX2 __m256i avx2_zint_mod_small_unsigned_x8(
 TARGET_AVX2 void avx2_zint_add_mul_small_x8(
 	uint32_t *restrict d, size_t len, size_t dstride,
 	const uint32_t *restrict a, __m256i ys);
+#if FNDSA_AVX512
+/* Like zint_mod_small_unsigned(), using AVX-512F; the words of d are
+   processed 16 at a time, which is faster for long integers (at least
+   a few dozen words). Callers must check has_avx512(). */
+#define avx512_zint_mod_small_unsigned \
+	fndsa_avx512_zint_mod_small_unsigned
+TARGET_AVX512 uint32_t avx512_zint_mod_small_unsigned(
+	const uint32_t *d, size_t len, size_t stride,
+	uint32_t p, uint32_t p0i, uint32_t R2);
+#endif
+/* Reduce num signed integers modulo p: dst[j] receives the same value
+   as zint_mod_small_signed(d + j, len, stride, p, p0i, R2, Rx), for
+   j = 0 to num-1. Integers are processed 8 at a time (16 at a time if
+   the CPU supports AVX-512F). */
+#define avx2_zint_mod_small_signed_row   fndsa_avx2_zint_mod_small_signed_row
+TARGET_AVX2 void avx2_zint_mod_small_signed_row(uint32_t *restrict dst,
+	const uint32_t *restrict d, size_t len, size_t stride, size_t num,
+	uint32_t p, uint32_t p0i, uint32_t R2, uint32_t Rx);
 #define avx2_zint_rebuild_CRT   fndsa_avx2_zint_rebuild_CRT
 void avx2_zint_rebuild_CRT(uint32_t *restrict xx, size_t xlen, size_t n,
-	size_t num_sets, int normalize_signed, uint32_t *restrict tmp);
+	size_t num_sets, int normalize_signed, uint32_t *restrict tmp,
+	kgen_pool *kp);
 
 TARGET_AVX2
 static inline __m256i
@@ -975,12 +1138,14 @@ void poly_sub_scaled(unsigned logn,
 /* Subtract k*f from F. Coefficients of polynomial k are small integers
    (signed values in the -2^31..+2^31 range) scaled by 2^sc. Polynomial f
    MUST be in RNS+NTT over flen+1 words (even though f itself would fit on
-   flen words); polynomial F MUST be in plain representation. */
+   flen words); polynomial F MUST be in plain representation. The work
+   is spread over the threads of the pool kp (if not NULL). */
 #define poly_sub_scaled_ntt   fndsa_poly_sub_scaled_ntt
 void
 poly_sub_scaled_ntt(unsigned logn, uint32_t *restrict F, size_t Flen,
 	const uint32_t *restrict f, size_t flen,
-	const int32_t *restrict k, uint32_t sc, uint32_t *restrict tmp);
+	const int32_t *restrict k, uint32_t sc, uint32_t *restrict tmp,
+	kgen_pool *kp);
 
 /* depth = 1
    logn = logn_top - depth
@@ -1028,7 +1193,8 @@ void avx2_poly_sub_scaled(unsigned logn,
 void
 avx2_poly_sub_scaled_ntt(unsigned logn, uint32_t *restrict F, size_t Flen,
 	const uint32_t *restrict f, size_t flen,
-	const int32_t *restrict k, uint32_t sc, uint32_t *restrict tmp);
+	const int32_t *restrict k, uint32_t sc, uint32_t *restrict tmp,
+	kgen_pool *kp);
 #define avx2_poly_sub_kfg_scaled_depth1   fndsa_avx2_poly_sub_kfg_scaled_depth1
 void avx2_poly_sub_kfg_scaled_depth1(unsigned logn_top,
 	uint32_t *restrict F, uint32_t *restrict G, size_t FGlen,
@@ -1060,10 +1226,13 @@ uint32_t avx2_poly_sqnorm(unsigned logn, const int8_t *f);
    if found, is returned at the start of the tmp[] array, as two
    consecutive int8_t[] values. Returned value is 1 on success, 0 on error.
 
-   tmp[] must have room for 6*n words. */
+   tmp[] must have room for 6*n words. The per-prime computations and
+   CRT reconstructions are spread over the threads of kp (if not NULL);
+   the result does not depend on the number of threads. */
 #define solve_NTRU   fndsa_solve_NTRU
 int solve_NTRU(unsigned logn,
-        const int8_t *restrict f, const int8_t *restrict g, uint32_t *tmp);
+        const int8_t *restrict f, const int8_t *restrict g,
+	uint32_t *tmp, kgen_pool *kp);
 
 /* Check that a given (f,g) has an acceptable orthogonolized norm.
    tmp[] must have room for 2.5*n fxr values */
@@ -1074,7 +1243,8 @@ int check_ortho_norm(unsigned logn,
 #if FNDSA_AVX2
 #define avx2_solve_NTRU   fndsa_avx2_solve_NTRU
 int avx2_solve_NTRU(unsigned logn,
-        const int8_t *restrict f, const int8_t *restrict g, uint32_t *tmp);
+        const int8_t *restrict f, const int8_t *restrict g,
+	uint32_t *tmp, kgen_pool *kp);
 #define avx2_check_ortho_norm   fndsa_avx2_check_ortho_norm
 int avx2_check_ortho_norm(unsigned logn,
 	const int8_t *f, const int8_t *g, fxr *tmp);
@@ -1097,6 +1267,38 @@ void sample_f(unsigned logn, shake256x4_context *pc, int8_t *f);
 void sample_f(unsigned logn, shake_context *pc, int8_t *f);
 #endif
 
+#if FNDSA_AVX2
+/* AVX2 version of sample_f(); output is identical. */
+#define avx2_sample_f   fndsa_avx2_sample_f
+#if FNDSA_SHAKE256X4
+void avx2_sample_f(unsigned logn, shake256x4_context *pc, int8_t *f);
+#else
+void avx2_sample_f(unsigned logn, shake_context *pc, int8_t *f);
+#endif
+#endif
+
+/* ==================================================================== */
+/*
+ * Key pair generation statistics.
+ */
+
+/* Counters for the candidate (f,g) pairs considered by key pair
+   generation: each sampled candidate is either rejected by one of the
+   successive tests, or used for the key pair. */
+typedef struct {
+	unsigned long candidates;
+	unsigned long rej_norm;
+	unsigned long rej_invert;
+	unsigned long rej_ortho;
+	unsigned long rej_solve;
+} keygen_stats;
+
+/* Similar to fndsa_keygen_seeded(), and adds the counts for this key
+   pair generation to *st (for benchmarks). */
+#define keygen_seeded_stats   fndsa_keygen_seeded_stats
+void keygen_seeded_stats(unsigned logn, const void *seed, size_t seed_len,
+	void *sign_key, void *vrfy_key, keygen_stats *st);
+
 /* ==================================================================== */
 
 #endif
@@ -0,0 +1,336 @@
+/*
+ * Background key pair pool.
+ */
+
+#include "kgen_inner.h"
+
+#if FNDSA_KEYGEN_MT
+
+#include <pthread.h>
+
+/*
+ * Ready key pairs are kept in a bounded ring, protected by a mutex.
+ * Each worker reserves a ring slot (counted in 'reserved') before
+ * generating a key pair in its own buffers, so that the number of
+ * completed and in-progress key pairs never exceeds the capacity; the
+ * new key pair is then copied into the ring. Key generation takes
+ * milliseconds, so the mutex is not a contention point.
+ *
+ * Each worker has its own random generator (see sysrng_shake_init()
+ * and shake_ratchet()). Private key material is erased from the worker
+ * buffers and from the ring slots as soon as it has been copied out;
+ * the worker generators and buffers are erased when the pool is
+ * destroyed.
+ */
+
+typedef struct {
+	fndsa_keypool *pool;
+	pthread_t thread;
+	shake_context rng;
+	uint8_t *sign_key;
+	uint8_t *vrfy_key;
+	void *tmp;
+	size_t tmp_len;
+} keypool_worker;
+
+struct fndsa_keypool_ {
+	unsigned logn;
+	size_t sk_len;
+	size_t vk_len;
+	size_t capacity;
+	size_t head;
+	size_t count;
+	size_t reserved;
+	int stopping;
+	uint8_t *ring;
+	keypool_worker *workers;
+	unsigned num_threads;
+	pthread_mutex_t lock;
+	pthread_cond_t cond_space;
+	pthread_cond_t cond_ready;
+};
+
+/* Size of the temporary area of each worker (see fndsa_keygen_temp()). */
+static size_t
+keypool_tmp_len(unsigned logn)
+{
+	return ((size_t)26 << logn) + 31;
+}
+
+/* Generate one key pair into the worker buffers. */
+static void
+worker_keygen(keypool_worker *w)
+{
+	fndsa_keypool *kp = w->pool;
+	uint8_t buf[32];
+	shake_ratchet(&w->rng, buf, sizeof buf);
+	(void)fndsa_keygen_seeded_temp(kp->logn, buf, 32,
+		w->sign_key, w->vrfy_key, w->tmp, w->tmp_len);
+	secure_wipe(buf, sizeof buf);
+	secure_wipe(w->tmp, w->tmp_len);
+}
+
+static void *
+worker_main(void *arg)
+{
+	keypool_worker *w = arg;
+	fndsa_keypool *kp = w->pool;
+	size_t kp_len = kp->sk_len + kp->vk_len;
+	for (;;) {
+		pthread_mutex_lock(&kp->lock);
+		while (kp->count + kp->reserved >= kp->capacity
+			&& !kp->stopping)
+		{
+			pthread_cond_wait(&kp->cond_space, &kp->lock);
+		}
+		if (kp->stopping) {
+			pthread_mutex_unlock(&kp->lock);
+			return NULL;
+		}
+		kp->reserved ++;
+		pthread_mutex_unlock(&kp->lock);
+
+		worker_keygen(w);
+
+		pthread_mutex_lock(&kp->lock);
+		size_t j = kp->head + kp->count;
+		if (j >= kp->capacity) {
+			j -= kp->capacity;
+		}
+		uint8_t *slot = kp->ring + j * kp_len;
+		memcpy(slot, w->sign_key, kp->sk_len);
+		memcpy(slot + kp->sk_len, w->vrfy_key, kp->vk_len);
+		kp->reserved --;
+		kp->count ++;
+		pthread_cond_signal(&kp->cond_ready);
+		pthread_mutex_unlock(&kp->lock);
+		secure_wipe(w->sign_key, kp->sk_len);
+	}
+}
+
+/* Stop the first num workers and release the synchronization objects. */
+static void
+keypool_shutdown(fndsa_keypool *kp, unsigned num)
+{
+	pthread_mutex_lock(&kp->lock);
+	kp->stopping = 1;
+	pthread_cond_broadcast(&kp->cond_space);
+	pthread_mutex_unlock(&kp->lock);
+	for (unsigned i = 0; i < num; i ++) {
+		pthread_join(kp->workers[i].thread, NULL);
+	}
+	pthread_cond_destroy(&kp->cond_ready);
+	pthread_cond_destroy(&kp->cond_space);
+	pthread_mutex_destroy(&kp->lock);
+}
+
+/* Erase the worker generators and buffers. The buffers of the first
+   num workers are erased; the worker array is erased entirely. */
+static void
+keypool_wipe_workers(fndsa_keypool *kp, unsigned num)
+{
+	for (unsigned i = 0; i < num; i ++) {
+		keypool_worker *w = &kp->workers[i];
+		secure_wipe(w->sign_key, kp->sk_len);
+		secure_wipe(w->tmp, w->tmp_len);
+	}
+	secure_wipe(kp->workers, kp->num_threads * sizeof(keypool_worker));
+}
+
+/* see fndsa.h */
+size_t
+fndsa_keypool_size(unsigned logn, size_t capacity, unsigned num_threads)
+{
+	if (logn < 2 || logn > 10) {
+		return 0;
+	}
+	if (capacity < 1 || capacity > 65536) {
+		return 0;
+	}
+	if (num_threads < 1 || num_threads > 256) {
+		return 0;
+	}
+	size_t sk_len = FNDSA_SIGN_KEY_SIZE(logn);
+	size_t vk_len = FNDSA_VRFY_KEY_SIZE(logn);
+	return 63 + ROUND64(sizeof(fndsa_keypool))
+		+ ROUND64(num_threads * sizeof(keypool_worker))
+		+ ROUND64(capacity * (sk_len + vk_len))
+		+ num_threads * (ROUND64(sk_len) + ROUND64(vk_len)
+			+ ROUND64(keypool_tmp_len(logn)));
+}
+
+/* see fndsa.h */
+fndsa_keypool *
+fndsa_keypool_create(unsigned logn, size_t capacity, unsigned num_threads,
+	void *mem, size_t mem_len)
+{
+	size_t len = fndsa_keypool_size(logn, capacity, num_threads);
+	if (len == 0 || mem == NULL || mem_len < len) {
+		return NULL;
+	}
+
+	/* Layout: pool structure, workers, ring, and the per-worker
+	   buffers; each element starts on a 64-byte boundary. */
+	uint8_t *buf = (uint8_t *)(((uintptr_t)mem + 63) & ~(uintptr_t)63);
+	fndsa_keypool *kp = (fndsa_keypool *)buf;
+	buf += ROUND64(sizeof(fndsa_keypool));
+	memset(kp, 0, sizeof *kp);
+	kp->logn = logn;
+	kp->sk_len = FNDSA_SIGN_KEY_SIZE(logn);
+	kp->vk_len = FNDSA_VRFY_KEY_SIZE(logn);
+	kp->capacity = capacity;
+	kp->num_threads = num_threads;
+	kp->workers = (keypool_worker *)buf;
+	buf += ROUND64(num_threads * sizeof(keypool_worker));
+	kp->ring = buf;
+	buf += ROUND64(capacity * (kp->sk_len + kp->vk_len));
+	size_t tmp_len = keypool_tmp_len(logn);
+	for (unsigned i = 0; i < num_threads; i ++) {
+		keypool_worker *w = &kp->workers[i];
+		w->pool = kp;
+		w->sign_key = buf;
+		buf += ROUND64(kp->sk_len);
+		w->vrfy_key = buf;
+		buf += ROUND64(kp->vk_len);
+		w->tmp = buf;
+		w->tmp_len = tmp_len;
+		buf += ROUND64(tmp_len);
+		if (!sysrng_shake_init(&w->rng)) {
+			keypool_wipe_workers(kp, 0);
+			return NULL;
+		}
+	}
+
+	if (pthread_mutex_init(&kp->lock, NULL) != 0) {
+		keypool_wipe_workers(kp, 0);
+		return NULL;
+	}
+	if (pthread_cond_init(&kp->cond_space, NULL) != 0) {
+		pthread_mutex_destroy(&kp->lock);
+		keypool_wipe_workers(kp, 0);
+		return NULL;
+	}
+	if (pthread_cond_init(&kp->cond_ready, NULL) != 0) {
+		pthread_cond_destroy(&kp->cond_space);
+		pthread_mutex_destroy(&kp->lock);
+		keypool_wipe_workers(kp, 0);
+		return NULL;
+	}
+	for (unsigned i = 0; i < num_threads; i ++) {
+		keypool_worker *w = &kp->workers[i];
+		if (pthread_create(&w->thread, NULL, worker_main, w) != 0) {
+			keypool_shutdown(kp, i);
+			secure_wipe(kp->ring,
+				capacity * (kp->sk_len + kp->vk_len));
+			keypool_wipe_workers(kp, i);
+			return NULL;
+		}
+	}
+	return kp;
+}
+
+/* see fndsa.h */
+int
+fndsa_keypool_take(fndsa_keypool *kp,
+	void *sign_key, void *vrfy_key, int wait)
+{
+	size_t kp_len = kp->sk_len + kp->vk_len;
+	pthread_mutex_lock(&kp->lock);
+	while (kp->count == 0) {
+		if (!wait) {
+			pthread_mutex_unlock(&kp->lock);
+			return 0;
+		}
+		pthread_cond_wait(&kp->cond_ready, &kp->lock);
+	}
+	uint8_t *slot = kp->ring + kp->head * kp_len;
+	if (sign_key != NULL) {
+		memcpy(sign_key, slot, kp->sk_len);
+	}
+	if (vrfy_key != NULL) {
+		memcpy(vrfy_key, slot + kp->sk_len, kp->vk_len);
+	}
+	secure_wipe(slot, kp->sk_len);
+	if (++ kp->head == kp->capacity) {
+		kp->head = 0;
+	}
+	kp->count --;
+	pthread_cond_signal(&kp->cond_space);
+	pthread_mutex_unlock(&kp->lock);
+	return 1;
+}
+
+/* see fndsa.h */
+size_t
+fndsa_keypool_available(fndsa_keypool *kp)
+{
+	pthread_mutex_lock(&kp->lock);
+	size_t count = kp->count;
+	pthread_mutex_unlock(&kp->lock);
+	return count;
+}
+
+/* see fndsa.h */
+void
+fndsa_keypool_destroy(fndsa_keypool *kp)
+{
+	keypool_shutdown(kp, kp->num_threads);
+	secure_wipe(kp->ring, kp->capacity * (kp->sk_len + kp->vk_len));
+	keypool_wipe_workers(kp, kp->num_threads);
+}
+
+#else
+
+/* No thread support: the pool cannot be created. */
+
+/* see fndsa.h */
+size_t
+fndsa_keypool_size(unsigned logn, size_t capacity, unsigned num_threads)
+{
+	(void)logn;
+	(void)capacity;
+	(void)num_threads;
+	return 0;
+}
+
+/* see fndsa.h */
+fndsa_keypool *
+fndsa_keypool_create(unsigned logn, size_t capacity, unsigned num_threads,
+	void *mem, size_t mem_len)
+{
+	(void)logn;
+	(void)capacity;
+	(void)num_threads;
+	(void)mem;
+	(void)mem_len;
+	return NULL;
+}
+
+/* see fndsa.h */
+int
+fndsa_keypool_take(fndsa_keypool *kp,
+	void *sign_key, void *vrfy_key, int wait)
+{
+	(void)kp;
+	(void)sign_key;
+	(void)vrfy_key;
+	(void)wait;
+	return 0;
+}
+
+/* see fndsa.h */
+size_t
+fndsa_keypool_available(fndsa_keypool *kp)
+{
+	(void)kp;
+	return 0;
+}
+
+/* see fndsa.h */
+void
+fndsa_keypool_destroy(fndsa_keypool *kp)
+{
+	(void)kp;
+}
+
+#endif
@@ -4,6 +4,10 @@
 
 #include "kgen_inner.h"
 
+#if FNDSA_KEYGEN_CACHE
+#include <pthread.h>
+#endif
+
 /*
  * Bit-reversal index table (over 10 bits).
  */
@@ -387,6 +391,171 @@ avx2_mp_mkigm(unsigned logn, uint32_t *restrict igm,
 }
 #endif
 
+#if FNDSA_KEYGEN_CACHE
+/*
+ * Twiddle cache. For a given prime, the gm[] and igm[] tables for
+ * degree n = 2^logn are the first n entries of the tables for degree
+ * 1024 (see mp_mkgmigm()); thus, a single table pair per prime is kept,
+ * sized for the largest degree at which key pair generation uses that
+ * prime. TWIDDLE_NUM[logn] is the number of primes (starting with
+ * PRIMES[0]) for which the tables are cached at degree 2^logn; this
+ * matches the number of primes used by solve_NTRU() at each depth for
+ * n = 1024, which also covers all smaller degrees. Other requests are
+ * served by computing the tables into the caller's buffer.
+ *
+ * The cache is filled on first use (under pthread_once()) and is
+ * read-only afterwards, so it can be shared by all threads.
+ */
+
+static const uint16_t TWIDDLE_NUM[11] = {
+	308, 308, 155, 78, 40, 21, 11, 6, 3, 2, 1
+};
+#define TWIDDLE_PRIMES   308
+#define TWIDDLE_WORDS    4038
+
+static uint32_t twiddle_gm[TWIDDLE_WORDS];
+static uint32_t twiddle_igm[TWIDDLE_WORDS];
+static uint16_t twiddle_off[TWIDDLE_PRIMES];
+static pthread_once_t twiddle_once = PTHREAD_ONCE_INIT;
+static int twiddle_enabled = 1;
+
+static void
+twiddle_init(void)
+{
+	size_t off = 0;
+	unsigned logn = 10;
+	for (size_t i = 0; i < TWIDDLE_PRIMES; i ++) {
+		while (i >= TWIDDLE_NUM[logn]) {
+			logn --;
+		}
+		twiddle_off[i] = (uint16_t)off;
+		mp_mkgmigm(logn, twiddle_gm + off, twiddle_igm + off,
+			PRIMES[i].g, PRIMES[i].ig, PRIMES[i].p, PRIMES[i].p0i);
+		off += (size_t)1 << logn;
+	}
+}
+
+/* Get the cached table (twiddle_gm or twiddle_igm) for prime i and
+   degree 2^logn, or NULL if not cached. */
+static inline const uint32_t *
+twiddle_lookup(const uint32_t *tab, unsigned logn, size_t i)
+{
+	if (!twiddle_enabled || i >= TWIDDLE_NUM[logn]) {
+		return NULL;
+	}
+	pthread_once(&twiddle_once, twiddle_init);
+	return tab + twiddle_off[i];
+}
+#else
+#define twiddle_lookup(tab, logn, i)   NULL
+#endif
+
+/* see kgen_inner.h */
+const uint32_t *
+mp_get_gm(unsigned logn, size_t i, uint32_t *buf)
+{
+	const uint32_t *gm = twiddle_lookup(twiddle_gm, logn, i);
+	if (gm != NULL) {
+		return gm;
+	}
+	mp_mkgm(logn, buf, PRIMES[i].g, PRIMES[i].p, PRIMES[i].p0i);
+	return buf;
+}
+
+/* see kgen_inner.h */
+const uint32_t *
+mp_get_igm(unsigned logn, size_t i, uint32_t *buf)
+{
+	const uint32_t *igm = twiddle_lookup(twiddle_igm, logn, i);
+	if (igm != NULL) {
+		return igm;
+	}
+	mp_mkigm(logn, buf, PRIMES[i].ig, PRIMES[i].p, PRIMES[i].p0i);
+	return buf;
+}
+
+/* see kgen_inner.h */
+void
+mp_get_gmigm(unsigned logn, size_t i,
+	const uint32_t **gm, const uint32_t **igm,
+	uint32_t *gm_buf, uint32_t *igm_buf)
+{
+	*gm = twiddle_lookup(twiddle_gm, logn, i);
+	if (*gm != NULL) {
+		*igm = twiddle_lookup(twiddle_igm, logn, i);
+		return;
+	}
+	mp_mkgmigm(logn, gm_buf, igm_buf, PRIMES[i].g, PRIMES[i].ig,
+		PRIMES[i].p, PRIMES[i].p0i);
+	*gm = gm_buf;
+	*igm = igm_buf;
+}
+
+#if FNDSA_AVX2
+TARGET_AVX2
+const uint32_t *
+avx2_mp_get_gm(unsigned logn, size_t i, uint32_t *buf)
+{
+	const uint32_t *gm = twiddle_lookup(twiddle_gm, logn, i);
+	if (gm != NULL) {
+		return gm;
+	}
+	avx2_mp_mkgm(logn, buf, PRIMES[i].g, PRIMES[i].p, PRIMES[i].p0i);
+	return buf;
+}
+
+TARGET_AVX2
+const uint32_t *
+avx2_mp_get_igm(unsigned logn, size_t i, uint32_t *buf)
+{
+	const uint32_t *igm = twiddle_lookup(twiddle_igm, logn, i);
+	if (igm != NULL) {
+		return igm;
+	}
+	avx2_mp_mkigm(logn, buf, PRIMES[i].ig, PRIMES[i].p, PRIMES[i].p0i);
+	return buf;
+}
+
+TARGET_AVX2
+void
+avx2_mp_get_gmigm(unsigned logn, size_t i,
+	const uint32_t **gm, const uint32_t **igm,
+	uint32_t *gm_buf, uint32_t *igm_buf)
+{
+	*gm = twiddle_lookup(twiddle_gm, logn, i);
+	if (*gm != NULL) {
+		*igm = twiddle_lookup(twiddle_igm, logn, i);
+		return;
+	}
+	avx2_mp_mkgmigm(logn, gm_buf, igm_buf, PRIMES[i].g, PRIMES[i].ig,
+		PRIMES[i].p, PRIMES[i].p0i);
+	*gm = gm_buf;
+	*igm = igm_buf;
+}
+#endif
+
+/* see kgen_inner.h */
+size_t
+mp_twiddle_cache_size(void)
+{
+#if FNDSA_KEYGEN_CACHE
+	return sizeof twiddle_gm + sizeof twiddle_igm + sizeof twiddle_off;
+#else
+	return 0;
+#endif
+}
+
+/* see kgen_inner.h */
+void
+mp_twiddle_cache_enable(int enabled)
+{
+#if FNDSA_KEYGEN_CACHE
+	twiddle_enabled = enabled;
+#else
+	(void)enabled;
+#endif
+}
+
 #if FNDSA_AVX2
 TARGET_AVX2
 static inline __m256i
@@ -0,0 +1,217 @@
+/*
+ * Thread pool for multi-threaded key pair generation.
+ */
+
+#include "kgen_inner.h"
+
+#if FNDSA_KEYGEN_MT
+
+#include <pthread.h>
+
+/*
+ * The pool lives for the duration of a single key pair generation. Each
+ * call to kgen_run() publishes the task and bumps a generation counter;
+ * each active worker processes its own chunk (with a scratch area on its
+ * own stack), while the calling thread processes the first chunk, then
+ * waits until all active workers have reported completion. The mutex provides
+ * the ordering between the caller's writes and the workers' reads, and
+ * conversely.
+ */
+
+typedef struct {
+	kgen_pool *kp;
+	unsigned index;
+	pthread_t thread;
+} kgen_worker;
+
+struct kgen_pool_ {
+	pthread_mutex_t lock;
+	pthread_cond_t cond_task;
+	pthread_cond_t cond_done;
+	unsigned num_threads;
+	unsigned active;
+	unsigned generation;
+	unsigned pending;
+	int stopping;
+	kgen_task task;
+	void *ctx;
+	size_t num;
+	kgen_worker workers[KGEN_MAX_THREADS - 1];
+};
+
+/* Start of chunk i (out of k) when splitting num indices. */
+static inline size_t
+chunk_start(size_t num, unsigned i, unsigned k)
+{
+	return (num * i) / k;
+}
+
+static void *
+worker_main(void *arg)
+{
+	kgen_worker *w = arg;
+	kgen_pool *kp = w->kp;
+	uint32_t scratch[KGEN_SCRATCH_WORDS];
+	unsigned gen = 0;
+	for (;;) {
+		pthread_mutex_lock(&kp->lock);
+		while (kp->generation == gen && !kp->stopping) {
+			pthread_cond_wait(&kp->cond_task, &kp->lock);
+		}
+		if (kp->stopping) {
+			pthread_mutex_unlock(&kp->lock);
+			return NULL;
+		}
+		gen = kp->generation;
+		kgen_task task = kp->task;
+		void *ctx = kp->ctx;
+		size_t num = kp->num;
+		unsigned active = kp->active;
+		pthread_mutex_unlock(&kp->lock);
+
+		if (w->index >= active) {
+			continue;
+		}
+		size_t start = chunk_start(num, w->index, active);
+		size_t end = chunk_start(num, w->index + 1, active);
+		if (start < end) {
+			task(ctx, start, end, scratch);
+		}
+
+		pthread_mutex_lock(&kp->lock);
+		if (-- kp->pending == 0) {
+			pthread_cond_signal(&kp->cond_done);
+		}
+		pthread_mutex_unlock(&kp->lock);
+	}
+}
+
+/* see kgen_inner.h */
+void
+kgen_run(kgen_pool *kp, size_t num, size_t cost,
+	kgen_task task, void *ctx, uint32_t *scratch)
+{
+	if (num == 0) {
+		return;
+	}
+	size_t max_active = (num * cost) / KGEN_MIN_WORK;
+	if (max_active > num) {
+		max_active = num;
+	}
+	if (kp == NULL || max_active <= 1) {
+		task(ctx, 0, num, scratch);
+		return;
+	}
+	unsigned active = kp->num_threads;
+	if (active > max_active) {
+		active = (unsigned)max_active;
+	}
+	pthread_mutex_lock(&kp->lock);
+	kp->task = task;
+	kp->ctx = ctx;
+	kp->num = num;
+	kp->active = active;
+	kp->pending = active - 1;
+	kp->generation ++;
+	pthread_cond_broadcast(&kp->cond_task);
+	pthread_mutex_unlock(&kp->lock);
+
+	task(ctx, 0, chunk_start(num, 1, active), scratch);
+
+	pthread_mutex_lock(&kp->lock);
+	while (kp->pending != 0) {
+		pthread_cond_wait(&kp->cond_done, &kp->lock);
+	}
+	pthread_mutex_unlock(&kp->lock);
+}
+
+/* Stop the first num workers and release the synchronization objects. */
+static void
+pool_shutdown(kgen_pool *kp, unsigned num)
+{
+	pthread_mutex_lock(&kp->lock);
+	kp->stopping = 1;
+	pthread_cond_broadcast(&kp->cond_task);
+	pthread_mutex_unlock(&kp->lock);
+	for (unsigned i = 0; i < num; i ++) {
+		pthread_join(kp->workers[i].thread, NULL);
+	}
+	pthread_cond_destroy(&kp->cond_done);
+	pthread_cond_destroy(&kp->cond_task);
+	pthread_mutex_destroy(&kp->lock);
+}
+
+/* see kgen_inner.h */
+void
+kgen_pool_call(unsigned num_threads,
+	void (*fn)(kgen_pool *kp, void *ctx), void *ctx)
+{
+	kgen_pool pool;
+
+	if (num_threads > KGEN_MAX_THREADS) {
+		num_threads = KGEN_MAX_THREADS;
+	}
+	if (num_threads <= 1) {
+		fn(NULL, ctx);
+		return;
+	}
+	memset(&pool, 0, sizeof pool);
+	if (pthread_mutex_init(&pool.lock, NULL) != 0) {
+		fn(NULL, ctx);
+		return;
+	}
+	if (pthread_cond_init(&pool.cond_task, NULL) != 0) {
+		pthread_mutex_destroy(&pool.lock);
+		fn(NULL, ctx);
+		return;
+	}
+	if (pthread_cond_init(&pool.cond_done, NULL) != 0) {
+		pthread_cond_destroy(&pool.cond_task);
+		pthread_mutex_destroy(&pool.lock);
+		fn(NULL, ctx);
+		return;
+	}
+
+	/* If some threads cannot be created, we run with the ones we
+	   got; the output does not depend on the number of threads. */
+	unsigned num_workers = 0;
+	while (num_workers < num_threads - 1) {
+		kgen_worker *w = &pool.workers[num_workers];
+		w->kp = &pool;
+		w->index = num_workers + 1;
+		if (pthread_create(&w->thread, NULL, worker_main, w) != 0) {
+			break;
+		}
+		num_workers ++;
+	}
+	pool.num_threads = num_workers + 1;
+	fn(num_workers == 0 ? NULL : &pool, ctx);
+	pool_shutdown(&pool, num_workers);
+}
+
+#else
+
+/* No thread support: tasks run on the calling thread. */
+
+/* see kgen_inner.h */
+void
+kgen_run(kgen_pool *kp, size_t num, size_t cost,
+	kgen_task task, void *ctx, uint32_t *scratch)
+{
+	(void)kp;
+	(void)cost;
+	if (num != 0) {
+		task(ctx, 0, num, scratch);
+	}
+}
+
+/* see kgen_inner.h */
+void
+kgen_pool_call(unsigned num_threads,
+	void (*fn)(kgen_pool *kp, void *ctx), void *ctx)
+{
+	(void)num_threads;
+	fn(NULL, ctx);
+}
+
+#endif
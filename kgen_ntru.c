@@ -29,12 +29,11 @@ make_fg_zero(unsigned logn,
 	size_t n = (size_t)1 << logn;
 	uint32_t *ft = tmp;
 	uint32_t *gt = ft + n;
-	uint32_t *gm = gt + n;
 	uint32_t p = PRIMES[0].p;
 	uint32_t p0i = PRIMES[0].p0i;
 	poly_mp_set_small(logn, ft, f, p);
 	poly_mp_set_small(logn, gt, g, p);
-	mp_mkgm(logn, gm, PRIMES[0].g, p, p0i);
+	const uint32_t *gm = mp_get_gm(logn, 0, gt + n);
 	mp_NTT(logn, ft, gm, p, p0i);
 	mp_NTT(logn, gt, gm, p, p0i);
 }
@@ -49,58 +48,45 @@ avx2_make_fg_zero(unsigned logn,
 	size_t n = (size_t)1 << logn;
 	uint32_t *ft = tmp;
 	uint32_t *gt = ft + n;
-	uint32_t *gm = gt + n;
 	uint32_t p = PRIMES[0].p;
 	uint32_t p0i = PRIMES[0].p0i;
 	avx2_poly_mp_set_small(logn, ft, f, p);
 	avx2_poly_mp_set_small(logn, gt, g, p);
-	avx2_mp_mkgm(logn, gm, PRIMES[0].g, p, p0i);
+	const uint32_t *gm = avx2_mp_get_gm(logn, 0, gt + n);
 	avx2_mp_NTT(logn, ft, gm, p, p0i);
 	avx2_mp_NTT(logn, gt, gm, p, p0i);
 }
 #endif
 
-/* One step of computing (f,g) at a given depth.
-     Input: (f,g) of degree 2^(logn_top-depth)
-     Output: (f',g') of degree 2^(logn_top-(depth+1))
-   Input and output values are at the start of tmp[], in RNS+NTT notation.
-  
-   RAM USAGE: 3*(2^logn_top) (at most)
-   (assumptions: max_bl_small[0] = max_bl_small[1] = 1, max_bl_small[2] = 2) */
+/* Context for make_fg_step() tasks. */
+typedef struct {
+	unsigned logn;
+	size_t slen;
+	uint32_t *fs;
+	uint32_t *gs;
+	uint32_t *fd;
+	uint32_t *gd;
+} fg_step_ctx;
+
+/* make_fg_step() for the primes start to end-1 (all lower than slen):
+   the output words are computed from the source values (RNS+NTT), and
+   the source values are then converted to RNS (non-NTT). tmp[] receives
+   the iNTT support (n words). */
 static void
-make_fg_step(unsigned logn_top, unsigned depth, uint32_t *tmp)
+fg_step_low_task(void *ctx, size_t start, size_t end, uint32_t *tmp)
 {
-	unsigned logn = logn_top - depth;
+	fg_step_ctx *fc = ctx;
+	unsigned logn = fc->logn;
 	size_t n = (size_t)1 << logn;
 	size_t hn = n >> 1;
-	size_t slen = MAX_BL_SMALL[depth];
-	size_t tlen = MAX_BL_SMALL[depth + 1];
-
-	/* Layout:
-	     fd    output f' (hn*tlen)
-	     gd    output g' (hn*tlen)
-	     fs    source (n*slen)
-	     gs    source (n*slen)
-	     t1    NTT support (n)
-	     t2    extra (max(n, slen - n))  */
-	uint32_t *fd = tmp;
-	uint32_t *gd = fd + hn * tlen;
-	uint32_t *fs = gd + hn * tlen;
-	uint32_t *gs = fs + n * slen;
-	uint32_t *t1 = gs + n * slen;
-	uint32_t *t2 = t1 + n;
-	memmove(fs, tmp, 2 * n * slen * sizeof *tmp);
-
-	/* First slen words: we use the input values directly, and apply
-	   inverse NTT as we go, so that we get the sources in RNS (non-NTT). */
-	uint32_t *xf = fs;
-	uint32_t *xg = gs;
-	uint32_t *yf = fd;
-	uint32_t *yg = gd;
-	for (size_t i = 0; i < slen; i ++) {
+	for (size_t i = start; i < end; i ++) {
 		uint32_t p = PRIMES[i].p;
 		uint32_t p0i = PRIMES[i].p0i;
 		uint32_t R2 = PRIMES[i].R2;
+		uint32_t *xf = fc->fs + i * n;
+		uint32_t *xg = fc->gs + i * n;
+		uint32_t *yf = fc->fd + i * hn;
+		uint32_t *yg = fc->gd + i * hn;
 		for (size_t j = 0; j < hn; j ++) {
 			yf[j] = mp_mmul(
 				mp_mmul(xf[2 * j], xf[2 * j + 1], p, p0i),
@@ -109,55 +95,66 @@ make_fg_step(unsigned logn_top, unsigned depth, uint32_t *tmp)
 				mp_mmul(xg[2 * j], xg[2 * j + 1], p, p0i),
 				R2, p, p0i);
 		}
-		mp_mkigm(logn, t1, PRIMES[i].ig, p, p0i);
-		mp_iNTT(logn, xf, t1, p, p0i);
-		mp_iNTT(logn, xg, t1, p, p0i);
-		xf += n;
-		xg += n;
-		yf += hn;
-		yg += hn;
+		const uint32_t *igm = mp_get_igm(logn, i, tmp);
+		mp_iNTT(logn, xf, igm, p, p0i);
+		mp_iNTT(logn, xg, igm, p, p0i);
 	}
+}
 
-	/* Now that fs and gs are in RNS, rebuild their plain integer
-	   coefficients. */
-	zint_rebuild_CRT(fs, slen, n, 2, 1, t1);
-
-	/* Remaining output words. */
-	for (size_t i = slen; i < tlen; i ++) {
+/* make_fg_step() for the primes slen+start to slen+end-1: the output
+   words are computed from the source values (plain). tmp[] receives the
+   NTT support and a temporary polynomial (2*n words). */
+static void
+fg_step_high_task(void *ctx, size_t start, size_t end, uint32_t *tmp)
+{
+	fg_step_ctx *fc = ctx;
+	unsigned logn = fc->logn;
+	size_t n = (size_t)1 << logn;
+	size_t hn = n >> 1;
+	size_t slen = fc->slen;
+	uint32_t *t1 = tmp;
+	uint32_t *t2 = t1 + n;
+	for (size_t i = slen + start; i < slen + end; i ++) {
 		uint32_t p = PRIMES[i].p;
 		uint32_t p0i = PRIMES[i].p0i;
 		uint32_t R2 = PRIMES[i].R2;
 		uint32_t Rx = mp_Rx31(slen, p, p0i, R2);
-		mp_mkgm(logn, t1, PRIMES[i].g, p, p0i);
+		uint32_t *yf = fc->fd + i * hn;
+		uint32_t *yg = fc->gd + i * hn;
+		const uint32_t *gm = mp_get_gm(logn, i, t1);
 		for (size_t j = 0; j < n; j ++) {
 			t2[j] = zint_mod_small_signed(
-				fs + j, slen, n, p, p0i, R2, Rx);
+				fc->fs + j, slen, n, p, p0i, R2, Rx);
 		}
-		mp_NTT(logn, t2, t1, p, p0i);
+		mp_NTT(logn, t2, gm, p, p0i);
 		for (size_t j = 0; j < hn; j ++) {
 			yf[j] = mp_mmul(
 				mp_mmul(t2[2 * j], t2[2 * j + 1], p, p0i),
 				R2, p, p0i);
 		}
-		yf += hn;
 		for (size_t j = 0; j < n; j ++) {
 			t2[j] = zint_mod_small_signed(
-				gs + j, slen, n, p, p0i, R2, Rx);
+				fc->gs + j, slen, n, p, p0i, R2, Rx);
 		}
-		mp_NTT(logn, t2, t1, p, p0i);
+		mp_NTT(logn, t2, gm, p, p0i);
 		for (size_t j = 0; j < hn; j ++) {
 			yg[j] = mp_mmul(
 				mp_mmul(t2[2 * j], t2[2 * j + 1], p, p0i),
 				R2, p, p0i);
 		}
-		yg += hn;
 	}
 }
 
-#if FNDSA_AVX2
-TARGET_AVX2
+/* One step of computing (f,g) at a given depth.
+     Input: (f,g) of degree 2^(logn_top-depth)
+     Output: (f',g') of degree 2^(logn_top-(depth+1))
+   Input and output values are at the start of tmp[], in RNS+NTT notation.
+   The per-prime computations are spread over the threads of kp.
+  
+   RAM USAGE: 3*(2^logn_top) (at most)
+   (assumptions: max_bl_small[0] = max_bl_small[1] = 1, max_bl_small[2] = 2) */
 static void
-avx2_make_fg_step(unsigned logn_top, unsigned depth, uint32_t *tmp)
+make_fg_step(unsigned logn_top, unsigned depth, uint32_t *tmp, kgen_pool *kp)
 {
 	unsigned logn = logn_top - depth;
 	size_t n = (size_t)1 << logn;
@@ -172,24 +169,47 @@ avx2_make_fg_step(unsigned logn_top, unsigned depth, uint32_t *tmp)
 	     gs    source (n*slen)
 	     t1    NTT support (n)
 	     t2    extra (max(n, slen - n))  */
-	uint32_t *fd = tmp;
-	uint32_t *gd = fd + hn * tlen;
-	uint32_t *fs = gd + hn * tlen;
-	uint32_t *gs = fs + n * slen;
-	uint32_t *t1 = gs + n * slen;
-	uint32_t *t2 = t1 + n;
-	memmove(fs, tmp, 2 * n * slen * sizeof *tmp);
+	fg_step_ctx fc;
+	fc.logn = logn;
+	fc.slen = slen;
+	fc.fd = tmp;
+	fc.gd = fc.fd + hn * tlen;
+	fc.fs = fc.gd + hn * tlen;
+	fc.gs = fc.fs + n * slen;
+	uint32_t *t1 = fc.gs + n * slen;
+	memmove(fc.fs, tmp, 2 * n * slen * sizeof *tmp);
 
 	/* First slen words: we use the input values directly, and apply
 	   inverse NTT as we go, so that we get the sources in RNS (non-NTT). */
-	uint32_t *xf = fs;
-	uint32_t *xg = gs;
-	uint32_t *yf = fd;
-	uint32_t *yg = gd;
-	for (size_t i = 0; i < slen; i ++) {
+	kgen_run(kp, slen, (size_t)(logn + 1) << logn,
+		fg_step_low_task, &fc, t1);
+
+	/* Now that fs and gs are in RNS, rebuild their plain integer
+	   coefficients. */
+	zint_rebuild_CRT(fc.fs, slen, n, 2, 1, t1, kp);
+
+	/* Remaining output words. */
+	kgen_run(kp, tlen - slen, (slen + logn) << (logn + 1),
+		fg_step_high_task, &fc, t1);
+}
+
+#if FNDSA_AVX2
+TARGET_AVX2
+static void
+avx2_fg_step_low_task(void *ctx, size_t start, size_t end, uint32_t *tmp)
+{
+	fg_step_ctx *fc = ctx;
+	unsigned logn = fc->logn;
+	size_t n = (size_t)1 << logn;
+	size_t hn = n >> 1;
+	for (size_t i = start; i < end; i ++) {
 		uint32_t p = PRIMES[i].p;
 		uint32_t p0i = PRIMES[i].p0i;
 		uint32_t R2 = PRIMES[i].R2;
+		uint32_t *xf = fc->fs + i * n;
+		uint32_t *xg = fc->gs + i * n;
+		uint32_t *yf = fc->fd + i * hn;
+		uint32_t *yg = fc->gd + i * hn;
 		for (size_t j = 0; j < hn; j ++) {
 			yf[j] = mp_mmul(
 				mp_mmul(xf[2 * j], xf[2 * j + 1], p, p0i),
@@ -198,37 +218,40 @@ avx2_make_fg_step(unsigned logn_top, unsigned depth, uint32_t *tmp)
 				mp_mmul(xg[2 * j], xg[2 * j + 1], p, p0i),
 				R2, p, p0i);
 		}
-		mp_mkigm(logn, t1, PRIMES[i].ig, p, p0i);
-		mp_iNTT(logn, xf, t1, p, p0i);
-		mp_iNTT(logn, xg, t1, p, p0i);
-		xf += n;
-		xg += n;
-		yf += hn;
-		yg += hn;
+		const uint32_t *igm = mp_get_igm(logn, i, tmp);
+		mp_iNTT(logn, xf, igm, p, p0i);
+		mp_iNTT(logn, xg, igm, p, p0i);
 	}
+}
 
-	/* Now that fs and gs are in RNS, rebuild their plain integer
-	   coefficients. */
-	avx2_zint_rebuild_CRT(fs, slen, n, 2, 1, t1);
-
-	/* Remaining output words. */
-	for (size_t i = slen; i < tlen; i ++) {
+TARGET_AVX2
+static void
+avx2_fg_step_high_task(void *ctx, size_t start, size_t end, uint32_t *tmp)
+{
+	fg_step_ctx *fc = ctx;
+	unsigned logn = fc->logn;
+	size_t n = (size_t)1 << logn;
+	size_t hn = n >> 1;
+	size_t slen = fc->slen;
+	uint32_t *fs = fc->fs;
+	uint32_t *gs = fc->gs;
+	uint32_t *t1 = tmp;
+	uint32_t *t2 = t1 + n;
+	for (size_t i = slen + start; i < slen + end; i ++) {
 		uint32_t p = PRIMES[i].p;
 		uint32_t p0i = PRIMES[i].p0i;
 		uint32_t R2 = PRIMES[i].R2;
 		uint32_t Rx = mp_Rx31(slen, p, p0i, R2);
-		avx2_mp_mkgm(logn, t1, PRIMES[i].g, p, p0i);
+		uint32_t *yf = fc->fd + i * hn;
+		uint32_t *yg = fc->gd + i * hn;
+		const uint32_t *gm = avx2_mp_get_gm(logn, i, t1);
 		if (logn >= 3) {
 			__m256i yp = _mm256_set1_epi32(p);
 			__m256i yp0i = _mm256_set1_epi32(p0i);
 			__m256i yR2 = _mm256_set1_epi32(R2);
-			__m256i yRx = _mm256_set1_epi32(Rx);
-			for (size_t j = 0; j < n; j += 8) {
-				__m256i yt = zint_mod_small_signed_x8(
-					fs + j, slen, n, yp, yp0i, yR2, yRx);
-				_mm256_storeu_si256((__m256i *)(t2 + j), yt);
-			}
-			avx2_mp_NTT(logn, t2, t1, p, p0i);
+			avx2_zint_mod_small_signed_row(t2, fs, slen, n, n,
+				p, p0i, R2, Rx);
+			avx2_mp_NTT(logn, t2, gm, p, p0i);
 			for (size_t j = 0; j < hn; j += 4) {
 				__m256i yt = _mm256_loadu_si256(
 					(__m256i *)(t2 + (2 * j)));
@@ -240,13 +263,9 @@ avx2_make_fg_step(unsigned logn_top, unsigned depth, uint32_t *tmp)
 				_mm_storeu_si128((__m128i *)(yf + j),
 					_mm256_castsi256_si128(yt));
 			}
-			yf += hn;
-			for (size_t j = 0; j < n; j += 8) {
-				__m256i yt = zint_mod_small_signed_x8(
-					gs + j, slen, n, yp, yp0i, yR2, yRx);
-				_mm256_storeu_si256((__m256i *)(t2 + j), yt);
-			}
-			avx2_mp_NTT(logn, t2, t1, p, p0i);
+			avx2_zint_mod_small_signed_row(t2, gs, slen, n, n,
+				p, p0i, R2, Rx);
+			avx2_mp_NTT(logn, t2, gm, p, p0i);
 			for (size_t j = 0; j < hn; j += 4) {
 				__m256i yt = _mm256_loadu_si256(
 					(__m256i *)(t2 + (2 * j)));
@@ -258,33 +277,68 @@ avx2_make_fg_step(unsigned logn_top, unsigned depth, uint32_t *tmp)
 				_mm_storeu_si128((__m128i *)(yg + j),
 					_mm256_castsi256_si128(yt));
 			}
-			yg += hn;
 			continue;
 		}
-		for (size_t j = 0; j < n; j ++) {
-			t2[j] = zint_mod_small_signed(
-				fs + j, slen, n, p, p0i, R2, Rx);
-		}
-		avx2_mp_NTT(logn, t2, t1, p, p0i);
+		avx2_zint_mod_small_signed_row(t2, fs, slen, n, n,
+			p, p0i, R2, Rx);
+		avx2_mp_NTT(logn, t2, gm, p, p0i);
 		for (size_t j = 0; j < hn; j ++) {
 			yf[j] = mp_mmul(
 				mp_mmul(t2[2 * j], t2[2 * j + 1], p, p0i),
 				R2, p, p0i);
 		}
-		yf += hn;
-		for (size_t j = 0; j < n; j ++) {
-			t2[j] = zint_mod_small_signed(
-				gs + j, slen, n, p, p0i, R2, Rx);
-		}
-		avx2_mp_NTT(logn, t2, t1, p, p0i);
+		avx2_zint_mod_small_signed_row(t2, gs, slen, n, n,
+			p, p0i, R2, Rx);
+		avx2_mp_NTT(logn, t2, gm, p, p0i);
 		for (size_t j = 0; j < hn; j ++) {
 			yg[j] = mp_mmul(
 				mp_mmul(t2[2 * j], t2[2 * j + 1], p, p0i),
 				R2, p, p0i);
 		}
-		yg += hn;
 	}
 }
+
+TARGET_AVX2
+static void
+avx2_make_fg_step(unsigned logn_top, unsigned depth,
+	uint32_t *tmp, kgen_pool *kp)
+{
+	unsigned logn = logn_top - depth;
+	size_t n = (size_t)1 << logn;
+	size_t hn = n >> 1;
+	size_t slen = MAX_BL_SMALL[depth];
+	size_t tlen = MAX_BL_SMALL[depth + 1];
+
+	/* Layout:
+	     fd    output f' (hn*tlen)
+	     gd    output g' (hn*tlen)
+	     fs    source (n*slen)
+	     gs    source (n*slen)
+	     t1    NTT support (n)
+	     t2    extra (max(n, slen - n))  */
+	fg_step_ctx fc;
+	fc.logn = logn;
+	fc.slen = slen;
+	fc.fd = tmp;
+	fc.gd = fc.fd + hn * tlen;
+	fc.fs = fc.gd + hn * tlen;
+	fc.gs = fc.fs + n * slen;
+	uint32_t *t1 = fc.gs + n * slen;
+	memmove(fc.fs, tmp, 2 * n * slen * sizeof *tmp);
+
+	/* First slen words: we use the input values directly, and apply
+	   inverse NTT as we go, so that we get the sources in RNS (non-NTT). */
+	kgen_run(kp, slen, (size_t)(logn + 1) << logn,
+		avx2_fg_step_low_task, &fc, t1);
+
+	/* Now that fs and gs are in RNS, rebuild their plain integer
+	   coefficients. */
+	avx2_zint_rebuild_CRT(fc.fs, slen, n, 2, 1, t1, kp);
+
+	/* Remaining output words. */
+	kgen_run(kp, tlen - slen, (slen + logn) << (logn + 1),
+		avx2_fg_step_high_task, &fc, t1);
+}
 #endif
 
 /* Compute (f,g) at a specified depth, in RNS+NTT notation.
@@ -298,11 +352,11 @@ avx2_make_fg_step(unsigned logn_top, unsigned depth, uint32_t *tmp)
 static void
 make_fg_intermediate(unsigned logn_top,
 	const int8_t *restrict f, const int8_t *restrict g,
-	unsigned depth, uint32_t *tmp)
+	unsigned depth, uint32_t *tmp, kgen_pool *kp)
 {
 	make_fg_zero(logn_top, f, g, tmp);
 	for (unsigned d = 0; d < depth; d ++) {
-		make_fg_step(logn_top, d, tmp);
+		make_fg_step(logn_top, d, tmp, kp);
 	}
 }
 
@@ -311,11 +365,11 @@ TARGET_AVX2
 static void
 avx2_make_fg_intermediate(unsigned logn_top,
 	const int8_t *restrict f, const int8_t *restrict g,
-	unsigned depth, uint32_t *tmp)
+	unsigned depth, uint32_t *tmp, kgen_pool *kp)
 {
 	avx2_make_fg_zero(logn_top, f, g, tmp);
 	for (unsigned d = 0; d < depth; d ++) {
-		avx2_make_fg_step(logn_top, d, tmp);
+		avx2_make_fg_step(logn_top, d, tmp, kp);
 	}
 }
 #endif
@@ -330,7 +384,7 @@ avx2_make_fg_intermediate(unsigned logn_top,
 static int
 make_fg_deepest(unsigned logn_top,
 	const int8_t *restrict f, const int8_t *restrict g,
-	uint32_t *tmp, size_t sav_off)
+	uint32_t *tmp, size_t sav_off, kgen_pool *kp)
 {
 	make_fg_zero(logn_top, f, g, tmp);
 	int r = 1;
@@ -350,7 +404,7 @@ make_fg_deepest(unsigned logn_top,
 	r = (int)(1 - (b >> 31));
 
 	for (unsigned d = 0; d < logn_top; d ++) {
-		make_fg_step(logn_top, d, tmp);
+		make_fg_step(logn_top, d, tmp, kp);
 
 		/* make_fg_step() computes the (f,g) for depth d+1; we
 		   save that value if d+1 is at least at the save
@@ -371,7 +425,7 @@ TARGET_AVX2
 static int
 avx2_make_fg_deepest(unsigned logn_top,
 	const int8_t *restrict f, const int8_t *restrict g,
-	uint32_t *tmp, size_t sav_off)
+	uint32_t *tmp, size_t sav_off, kgen_pool *kp)
 {
 	avx2_make_fg_zero(logn_top, f, g, tmp);
 	int r = 1;
@@ -391,7 +445,7 @@ avx2_make_fg_deepest(unsigned logn_top,
 	r = (int)(1 - (b >> 31));
 
 	for (unsigned d = 0; d < logn_top; d ++) {
-		avx2_make_fg_step(logn_top, d, tmp);
+		avx2_make_fg_step(logn_top, d, tmp, kp);
 
 		/* make_fg_step() computes the (f,g) for depth d+1; we
 		   save that value if d+1 is at least at the save
@@ -429,12 +483,15 @@ avx2_make_fg_deepest(unsigned logn_top,
    RAM USAGE: max(3*(2^logn_top), 8*max_bl_small[depth]) */
 static int
 solve_NTRU_deepest(unsigned logn_top,
-	const int8_t *restrict f, const int8_t *restrict g, uint32_t *tmp)
+	const int8_t *restrict f, const int8_t *restrict g,
+	uint32_t *tmp, kgen_pool *kp)
 {
 	/* Get (f,g) at the deepest level (i.e. Res(f,X^n+1) and Res(g,X^n+1)).
 	   Obtained (f,g) are in RNS+NTT (since degree n = 1, this is
 	   equivalent to RNS). */
-	if (!make_fg_deepest(logn_top, f, g, tmp, (size_t)6 << logn_top)) {
+	if (!make_fg_deepest(logn_top, f, g, tmp,
+		(size_t)6 << logn_top, kp))
+	{
 		return SOLVE_ERR_GCD;
 	}
 
@@ -453,7 +510,7 @@ solve_NTRU_deepest(unsigned logn_top,
 	memmove(fp, tmp, 2 * len * sizeof *tmp);
 
 	/* Convert back the resultants into plain integers. */
-	zint_rebuild_CRT(fp, len, 1, 2, 0, t1);
+	zint_rebuild_CRT(fp, len, 1, 2, 0, t1, kp);
 
 	/* Apply the binary GCD to get a solution (F,G) such that:
 	     f*G - g*F = 1  */
@@ -474,12 +531,15 @@ solve_NTRU_deepest(unsigned logn_top,
 TARGET_AVX2
 static int
 avx2_solve_NTRU_deepest(unsigned logn_top,
-	const int8_t *restrict f, const int8_t *restrict g, uint32_t *tmp)
+	const int8_t *restrict f, const int8_t *restrict g,
+	uint32_t *tmp, kgen_pool *kp)
 {
 	/* Get (f,g) at the deepest level (i.e. Res(f,X^n+1) and Res(g,X^n+1)).
 	   Obtained (f,g) are in RNS+NTT (since degree n = 1, this is
 	   equivalent to RNS). */
-	if (!avx2_make_fg_deepest(logn_top, f, g, tmp, (size_t)6 << logn_top)) {
+	if (!avx2_make_fg_deepest(logn_top, f, g, tmp,
+		(size_t)6 << logn_top, kp))
+	{
 		return SOLVE_ERR_GCD;
 	}
 
@@ -498,7 +558,7 @@ avx2_solve_NTRU_deepest(unsigned logn_top,
 	memmove(fp, tmp, 2 * len * sizeof *tmp);
 
 	/* Convert back the resultants into plain integers. */
-	avx2_zint_rebuild_CRT(fp, len, 1, 2, 0, t1);
+	avx2_zint_rebuild_CRT(fp, len, 1, 2, 0, t1, kp);
 
 	/* Apply the binary GCD to get a solution (F,G) such that:
 	     f*G - g*F = 1  */
@@ -522,6 +582,149 @@ avx2_solve_NTRU_deepest(unsigned logn_top,
    is faster at large degrees, but not at small degrees. */
 #define MIN_LOGN_FGNTT   4
 
+/* Context for solve_NTRU_intermediate() tasks. */
+typedef struct {
+	unsigned logn;
+	size_t slen;
+	size_t dlen;
+	uint32_t *Ft;
+	uint32_t *Gt;
+	uint32_t *ft;
+	uint32_t *gt;
+	const uint32_t *Fd;
+	const uint32_t *Gd;
+	size_t base;
+	const uint32_t *src;
+	uint32_t *dst;
+} ntru_inter_ctx;
+
+/* Convert (Fd,Gd) (from the deeper level) to RNS modulo the primes
+   start to end-1. Values for prime i go to the last hn slots of the
+   n-word row i of (Ft,Gt). */
+static void
+inter_FGd_to_RNS_task(void *ctx, size_t start, size_t end, uint32_t *tmp)
+{
+	ntru_inter_ctx *ic = ctx;
+	unsigned logn = ic->logn;
+	size_t n = (size_t)1 << logn;
+	size_t hn = n >> 1;
+	size_t dlen = ic->dlen;
+	(void)tmp;
+	for (size_t i = start; i < end; i ++) {
+		uint32_t p = PRIMES[i].p;
+		uint32_t p0i = PRIMES[i].p0i;
+		uint32_t R2 = PRIMES[i].R2;
+		uint32_t Rx = mp_Rx31((unsigned)dlen, p, p0i, R2);
+		uint32_t *xt = ic->Ft + i * n + hn;
+		uint32_t *yt = ic->Gt + i * n + hn;
+		for (size_t j = 0; j < hn; j ++) {
+			xt[j] = zint_mod_small_signed(ic->Fd + j, dlen, hn,
+				p, p0i, R2, Rx);
+			yt[j] = zint_mod_small_signed(ic->Gd + j, dlen, hn,
+				p, p0i, R2, Rx);
+		}
+	}
+}
+
+/* Compute the unreduced (F,G) modulo the primes base+start to
+   base+end-1. For primes below slen, (f,g) is read from its RNS+NTT
+   rows, which are then converted to RNS (non-NTT); for other primes,
+   (f,g) must already be in plain representation. tmp[] receives the
+   NTT tables and (f,g) modulo the current prime (4*n words). */
+static void
+inter_FG_task(void *ctx, size_t start, size_t end, uint32_t *tmp)
+{
+	ntru_inter_ctx *ic = ctx;
+	unsigned logn = ic->logn;
+	size_t n = (size_t)1 << logn;
+	size_t hn = n >> 1;
+	size_t slen = ic->slen;
+	uint32_t *ft = ic->ft;
+	uint32_t *gt = ic->gt;
+	for (size_t i = ic->base + start; i < ic->base + end; i ++) {
+		uint32_t p = PRIMES[i].p;
+		uint32_t p0i = PRIMES[i].p0i;
+		uint32_t R2 = PRIMES[i].R2;
+
+		/* Memory layout:
+		     gm    NTT support (n) (if not cached)
+		     igm   iNTT support (n) (if not cached)
+		     fx    temporary f mod p (NTT) (n)
+		     gx    temporary g mod p (NTT) (n)  */
+		const uint32_t *gm;
+		const uint32_t *igm;
+		uint32_t *fx = tmp + 2 * n;
+		uint32_t *gx = fx + n;
+		mp_get_gmigm(logn, i, &gm, &igm, tmp, tmp + n);
+		if (i < slen) {
+			memcpy(fx, ft + i * n, n * sizeof *fx);
+			memcpy(gx, gt + i * n, n * sizeof *gx);
+			mp_iNTT(logn, ft + i * n, igm, p, p0i);
+			mp_iNTT(logn, gt + i * n, igm, p, p0i);
+		} else {
+			uint32_t Rx = mp_Rx31((unsigned)slen, p, p0i, R2);
+			for (size_t j = 0; j < n; j ++) {
+				fx[j] = zint_mod_small_signed(ft + j, slen, n,
+					p, p0i, R2, Rx);
+				gx[j] = zint_mod_small_signed(gt + j, slen, n,
+					p, p0i, R2, Rx);
+			}
+			mp_NTT(logn, fx, gm, p, p0i);
+			mp_NTT(logn, gx, gm, p, p0i);
+		}
+
+		/* We have (F,G) from deeper level in Ft and Gt, in
+		   RNS. We apply the NTT modulo p. */
+		uint32_t *Fe = ic->Ft + i * n;
+		uint32_t *Ge = ic->Gt + i * n;
+		mp_NTT(logn - 1, Fe + hn, gm, p, p0i);
+		mp_NTT(logn - 1, Ge + hn, gm, p, p0i);
+
+		/* Compute F and G (unreduced) modulo p. */
+		for (size_t j = 0; j < hn; j ++) {
+			uint32_t fa = fx[(j << 1) + 0];
+			uint32_t fb = fx[(j << 1) + 1];
+			uint32_t ga = gx[(j << 1) + 0];
+			uint32_t gb = gx[(j << 1) + 1];
+			uint32_t mFp = mp_mmul(Fe[j + hn], R2, p, p0i);
+			uint32_t mGp = mp_mmul(Ge[j + hn], R2, p, p0i);
+			Fe[(j << 1) + 0] = mp_mmul(gb, mFp, p, p0i);
+			Fe[(j << 1) + 1] = mp_mmul(ga, mFp, p, p0i);
+			Ge[(j << 1) + 0] = mp_mmul(fb, mGp, p, p0i);
+			Ge[(j << 1) + 1] = mp_mmul(fa, mGp, p, p0i);
+		}
+
+		/* We want the new (F,G) in RNS only (no NTT). */
+		mp_iNTT(logn, Fe, igm, p, p0i);
+		mp_iNTT(logn, Ge, igm, p, p0i);
+	}
+}
+
+/* Convert src (plain, slen words per coefficient) to RNS+NTT modulo the
+   primes start to end-1; the values for prime i are written in row i of
+   dst. tmp[] receives the NTT support (n words). */
+static void
+inter_fg_NTT_task(void *ctx, size_t start, size_t end, uint32_t *tmp)
+{
+	ntru_inter_ctx *ic = ctx;
+	unsigned logn = ic->logn;
+	size_t n = (size_t)1 << logn;
+	size_t slen = ic->slen;
+	for (size_t i = start; i < end; i ++) {
+		uint32_t p = PRIMES[i].p;
+		uint32_t p0i = PRIMES[i].p0i;
+		uint32_t R2 = PRIMES[i].R2;
+		uint32_t Rx = mp_Rx31((unsigned)slen, p, p0i, R2);
+		uint32_t *tn = ic->dst + i * n;
+		const uint32_t *gm = mp_get_gm(logn, i, tmp);
+		for (size_t j = 0; j < n; j ++) {
+			tn[j] = zint_mod_small_signed(
+				ic->src + j, slen, n, p, p0i, R2, Rx);
+		}
+		mp_NTT(logn, tn, gm, p, p0i);
+	}
+}
+
 /* Solving the NTRU equation, intermediate level.
    Input is (F,G) from one level deeper (half-degree), in plain
    representation, at the start of tmp[]; output is (F,G) from this
@@ -531,7 +734,7 @@ avx2_solve_NTRU_deepest(unsigned logn_top,
 static int
 solve_NTRU_intermediate(unsigned logn_top,
 	const int8_t *restrict f, const int8_t *restrict g,
-	unsigned depth, uint32_t *restrict tmp)
+	unsigned depth, uint32_t *restrict tmp, kgen_pool *kp)
 {
 	unsigned logn = logn_top - depth;
 	size_t n = (size_t)1 << logn;
@@ -555,7 +758,7 @@ solve_NTRU_intermediate(unsigned logn_top,
 
 	/* Get (f,g) for this level (in RNS+NTT). */
 	if (depth < MIN_SAVE_FG[logn_top]) {
-		make_fg_intermediate(logn_top, f, g, depth, fgt);
+		make_fg_intermediate(logn_top, f, g, depth, fgt, kp);
 	} else {
 		uint32_t *sav_fg = tmp + ((size_t)6 << logn_top);
 		for (unsigned d = MIN_SAVE_FG[logn_top];
@@ -588,101 +791,37 @@ solve_NTRU_intermediate(unsigned logn_top,
 	   in (Ft, Gt). Fd and Gd have degree hn only; we store the
 	   values for each modulus p in the _last_ hn slots of the
 	   n-word line for that modulus. */
-	for (size_t i = 0; i < llen; i ++) {
-		uint32_t p = PRIMES[i].p;
-		uint32_t p0i = PRIMES[i].p0i;
-		uint32_t R2 = PRIMES[i].R2;
-		uint32_t Rx = mp_Rx31((unsigned)dlen, p, p0i, R2);
-		uint32_t *xt = Ft + i * n + hn;
-		uint32_t *yt = Gt + i * n + hn;
-		for (size_t j = 0; j < hn; j ++) {
-			xt[j] = zint_mod_small_signed(Fd + j, dlen, hn,
-				p, p0i, R2, Rx);
-			yt[j] = zint_mod_small_signed(Gd + j, dlen, hn,
-				p, p0i, R2, Rx);
-		}
-	}
+	ntru_inter_ctx ic;
+	ic.logn = logn;
+	ic.slen = slen;
+	ic.dlen = dlen;
+	ic.Ft = Ft;
+	ic.Gt = Gt;
+	ic.ft = ft;
+	ic.gt = gt;
+	ic.Fd = Fd;
+	ic.Gd = Gd;
+	kgen_run(kp, llen, dlen << logn, inter_FGd_to_RNS_task, &ic, t1);
 
 	/* Fd and Gd are no longer needed. */
 	t1 = Fd;
 
 	/* Compute (F,G) (unreduced) modulo sufficiently many small primes.
-	   We also un-NTT (f,g) as we go; when slen primes have been
-	   processed, we obtain (f,g) in RNS, and we apply the CRT to
-	   get (f,g) in plain representation. */
-	for (size_t i = 0; i < llen; i ++) {
-		/* If we have processed exactly slen primes, then (f,g)
-		   are in RNS, and we can rebuild them. */
-		if (i == slen) {
-			zint_rebuild_CRT(ft, slen, n, 2, 1, t1);
-		}
-
-		uint32_t p = PRIMES[i].p;
-		uint32_t p0i = PRIMES[i].p0i;
-		uint32_t R2 = PRIMES[i].R2;
-
-		/* Memory layout: we keep Ft, Gt, ft and gt; we append:
-		     gm    NTT support (n)
-		     igm   iNTT support (n)
-		     fx    temporary f mod p (NTT) (n)
-		     gx    temporary g mod p (NTT) (n)  */
-		uint32_t *gm = t1;
-		uint32_t *igm = gm + n;
-		uint32_t *fx = igm + n;
-		uint32_t *gx = fx + n;
-		mp_mkgmigm(logn, gm, igm, PRIMES[i].g, PRIMES[i].ig, p, p0i);
-		if (i < slen) {
-			memcpy(fx, ft + i * n, n * sizeof *fx);
-			memcpy(gx, gt + i * n, n * sizeof *gx);
-			mp_iNTT(logn, ft + i * n, igm, p, p0i);
-			mp_iNTT(logn, gt + i * n, igm, p, p0i);
-		} else {
-			uint32_t Rx = mp_Rx31((unsigned)slen, p, p0i, R2);
-			for (size_t j = 0; j < n; j ++) {
-				fx[j] = zint_mod_small_signed(ft + j, slen, n,
-					p, p0i, R2, Rx);
-				gx[j] = zint_mod_small_signed(gt + j, slen, n,
-					p, p0i, R2, Rx);
-			}
-			mp_NTT(logn, fx, gm, p, p0i);
-			mp_NTT(logn, gx, gm, p, p0i);
-		}
-
-		/* We have (F,G) from deeper level in Ft and Gt, in
-		   RNS. We apply the NTT modulo p. */
-		uint32_t *Fe = Ft + i * n;
-		uint32_t *Ge = Gt + i * n;
-		mp_NTT(logn - 1, Fe + hn, gm, p, p0i);
-		mp_NTT(logn - 1, Ge + hn, gm, p, p0i);
-
-		/* Compute F and G (unreduced) modulo p. */
-		for (size_t j = 0; j < hn; j ++) {
-			uint32_t fa = fx[(j << 1) + 0];
-			uint32_t fb = fx[(j << 1) + 1];
-			uint32_t ga = gx[(j << 1) + 0];
-			uint32_t gb = gx[(j << 1) + 1];
-			uint32_t mFp = mp_mmul(Fe[j + hn], R2, p, p0i);
-			uint32_t mGp = mp_mmul(Ge[j + hn], R2, p, p0i);
-			Fe[(j << 1) + 0] = mp_mmul(gb, mFp, p, p0i);
-			Fe[(j << 1) + 1] = mp_mmul(ga, mFp, p, p0i);
-			Ge[(j << 1) + 0] = mp_mmul(fb, mGp, p, p0i);
-			Ge[(j << 1) + 1] = mp_mmul(fa, mGp, p, p0i);
-		}
-
-		/* We want the new (F,G) in RNS only (no NTT). */
-		mp_iNTT(logn, Fe, igm, p, p0i);
-		mp_iNTT(logn, Ge, igm, p, p0i);
-	}
-
-	/* Edge case: if slen == llen, then we have not rebuilt (f,g)
-	   into plain representation yet, so we do it now. */
-	if (slen == llen) {
-		zint_rebuild_CRT(ft, slen, n, 2, 1, t1);
-	}
+	   The first slen primes also un-NTT (f,g); we then have (f,g) in
+	   RNS, and we apply the CRT to get (f,g) in plain representation,
+	   which the remaining primes use. Primes are independent of each
+	   other and are spread over the threads of kp. */
+	ic.base = 0;
+	kgen_run(kp, slen, (size_t)(logn + 1) << (logn + 1),
+		inter_FG_task, &ic, t1);
+	zint_rebuild_CRT(ft, slen, n, 2, 1, t1, kp);
+	ic.base = slen;
+	kgen_run(kp, llen - slen, (slen + logn) << (logn + 1),
+		inter_FG_task, &ic, t1);
 
 	/* We now have the unreduced (F,G) in RNS. We rebuild their
 	   plain representation. */
-	zint_rebuild_CRT(Ft, llen, n, 2, 1, t1);
+	zint_rebuild_CRT(Ft, llen, n, 2, 1, t1, kp);
 
 	/* We now reduce these (F,G) with Babai's nearest plane
 	   algorithm. The reduction conceptually goes as follows:
@@ -830,35 +969,14 @@ solve_NTRU_intermediate(unsigned logn_top,
 	if (use_sub_ntt) {
 		uint32_t *gm = t2;
 		uint32_t *tn = gm + n;
-		for (size_t i = 0; i <= slen; i ++) {
-			uint32_t p = PRIMES[i].p;
-			uint32_t p0i = PRIMES[i].p0i;
-			uint32_t R2 = PRIMES[i].R2;
-			uint32_t Rx = mp_Rx31((unsigned)slen, p, p0i, R2);
-			mp_mkgm(logn, gm, PRIMES[i].g, p, p0i);
-			for (size_t j = 0; j < n; j ++) {
-				tn[j] = zint_mod_small_signed(
-					ft + j, slen, n, p, p0i, R2, Rx);
-			}
-			mp_NTT(logn, tn, gm, p, p0i);
-			tn += n;
-		}
-		tn = gm + n;
+		ic.dst = tn;
+		ic.src = ft;
+		kgen_run(kp, slen + 1, (slen + logn) << logn,
+			inter_fg_NTT_task, &ic, gm);
 		memmove(ft, tn, (slen + 1) * n * sizeof *tn);
-		for (size_t i = 0; i <= slen; i ++) {
-			uint32_t p = PRIMES[i].p;
-			uint32_t p0i = PRIMES[i].p0i;
-			uint32_t R2 = PRIMES[i].R2;
-			uint32_t Rx = mp_Rx31((unsigned)slen, p, p0i, R2);
-			mp_mkgm(logn, gm, PRIMES[i].g, p, p0i);
-			for (size_t j = 0; j < n; j ++) {
-				tn[j] = zint_mod_small_signed(
-					gt + j, slen, n, p, p0i, R2, Rx);
-			}
-			mp_NTT(logn, tn, gm, p, p0i);
-			tn += n;
-		}
-		tn = gm + n;
+		ic.src = gt;
+		kgen_run(kp, slen + 1, (slen + logn) << logn,
+			inter_fg_NTT_task, &ic, gm);
 		memmove(gt, tn, (slen + 1) * n * sizeof *tn);
 	}
 
@@ -902,9 +1020,9 @@ solve_NTRU_intermediate(unsigned logn_top,
 				(uint32_t *)k, scale_k, f, g, t2);
 		} else if (use_sub_ntt) {
 			poly_sub_scaled_ntt(logn, Ft, FGlen, ft, slen,
-				k, scale_k, t2);
+				k, scale_k, t2, kp);
 			poly_sub_scaled_ntt(logn, Gt, FGlen, gt, slen,
-				k, scale_k, t2);
+				k, scale_k, t2, kp);
 		} else {
 			poly_sub_scaled(logn, Ft, FGlen, ft, slen, k, scale_k);
 			poly_sub_scaled(logn, Gt, FGlen, gt, slen, k, scale_k);
@@ -951,14 +1069,14 @@ solve_NTRU_intermediate(unsigned logn_top,
 	uint32_t p0i = PRIMES[0].p0i;
 	uint32_t R2 = PRIMES[0].R2;
 	uint32_t Rx = mp_Rx31(slen, p, p0i, R2);
-	mp_mkgm(logn, t4, PRIMES[0].g, p, p0i);
+	const uint32_t *gm = mp_get_gm(logn, 0, t4);
 	if (use_sub_ntt) {
 		t1 = ft;
 		for (size_t i = 0; i < n; i ++) {
 			t2[i] = zint_mod_small_signed(
 				Gt + i, slen, n, p, p0i, R2, Rx);
 		}
-		mp_NTT(logn, t2, t4, p, p0i);
+		mp_NTT(logn, t2, gm, p, p0i);
 	} else {
 		for (size_t i = 0; i < n; i ++) {
 			t1[i] = zint_mod_small_signed(
@@ -966,8 +1084,8 @@ solve_NTRU_intermediate(unsigned logn_top,
 			t2[i] = zint_mod_small_signed(
 				Gt + i, slen, n, p, p0i, R2, Rx);
 		}
-		mp_NTT(logn, t1, t4, p, p0i);
-		mp_NTT(logn, t2, t4, p, p0i);
+		mp_NTT(logn, t1, gm, p, p0i);
+		mp_NTT(logn, t2, gm, p, p0i);
 	}
 	for (size_t i = 0; i < n; i ++) {
 		t3[i] = mp_mmul(t1[i], t2[i], p, p0i);
@@ -978,7 +1096,7 @@ solve_NTRU_intermediate(unsigned logn_top,
 			t2[i] = zint_mod_small_signed(
 				Ft + i, slen, n, p, p0i, R2, Rx);
 		}
-		mp_NTT(logn, t2, t4, p, p0i);
+		mp_NTT(logn, t2, gm, p, p0i);
 	} else {
 		for (size_t i = 0; i < n; i ++) {
 			t1[i] = zint_mod_small_signed(
@@ -986,8 +1104,8 @@ solve_NTRU_intermediate(unsigned logn_top,
 			t2[i] = zint_mod_small_signed(
 				Ft + i, slen, n, p, p0i, R2, Rx);
 		}
-		mp_NTT(logn, t1, t4, p, p0i);
-		mp_NTT(logn, t2, t4, p, p0i);
+		mp_NTT(logn, t1, gm, p, p0i);
+		mp_NTT(logn, t2, gm, p, p0i);
 	}
 	uint32_t rv = mp_mmul(Q, 1, p, p0i);
 	for (size_t i = 0; i < n; i ++) {
@@ -1001,126 +1119,64 @@ solve_NTRU_intermediate(unsigned logn_top,
 }
 
 #if FNDSA_AVX2
+/* Convert (Fd,Gd) (from the deeper level) to RNS modulo the primes
+   start to end-1. Values for prime i go to the last hn slots of the
+   n-word row i of (Ft,Gt). */
 TARGET_AVX2
-static int
-avx2_solve_NTRU_intermediate(unsigned logn_top,
-	const int8_t *restrict f, const int8_t *restrict g,
-	unsigned depth, uint32_t *restrict tmp)
+static void
+avx2_inter_FGd_to_RNS_task(void *ctx, size_t start, size_t end, uint32_t *tmp)
 {
-	unsigned logn = logn_top - depth;
+	ntru_inter_ctx *ic = ctx;
+	unsigned logn = ic->logn;
 	size_t n = (size_t)1 << logn;
 	size_t hn = n >> 1;
-
-	/* slen   size for (f,g) at this level (also output (F,G))
-	   llen   size for unreduced (F,G) at this level
-	   dlen   size for input (F,G) from deeper level
-	   Note: we always have llen >= dlen */
-	size_t slen = MAX_BL_SMALL[depth];
-	size_t llen = MAX_BL_LARGE[depth];
-	size_t dlen = MAX_BL_SMALL[depth + 1];
-
-	/* Fd   F from deeper level (dlen*hn)
-	   Gd   G from deeper level (dlen*hn)
-	   ft   f from this level (slen*n)
-	   gt   g from this level (slen*n) */
-	uint32_t *Fd = tmp;
-	uint32_t *Gd = Fd + dlen * hn;
-	uint32_t *fgt = Gd + dlen * hn;
-
-	/* Get (f,g) for this level (in RNS+NTT). */
-	if (depth < MIN_SAVE_FG[logn_top]) {
-		avx2_make_fg_intermediate(logn_top, f, g, depth, fgt);
-	} else {
-		uint32_t *sav_fg = tmp + ((size_t)6 << logn_top);
-		for (unsigned d = MIN_SAVE_FG[logn_top];
-			d <= depth; d ++)
-		{
-			sav_fg -= MAX_BL_SMALL[d] << (logn_top + 1 - d);
-		}
-		memmove(fgt, sav_fg, 2 * slen * n * sizeof *fgt);
-	}
-
-	/* Move buffers so that we have room for the unreduced (F,G) at
-	   this level.
-	     Ft   F from this level (unreduced) (llen*n)
-	     Gt   G from this level (unreduced) (llen*n)
-	     ft   f from this level (slen*n)
-	     gt   g from this level (slen*n)
-	     Fd   F from deeper level (dlen*hn)
-	     Gd   G from deeper level (dlen*hn)  */
-	uint32_t *Ft = tmp;
-	uint32_t *Gt = Ft + llen * n;
-	uint32_t *ft = Gt + llen * n;
-	uint32_t *gt = ft + slen * n;
-	Fd = gt + slen * n;
-	Gd = Fd + dlen * hn;
-	uint32_t *t1 = Gd + dlen * hn;
-	memmove(ft, fgt, 2 * n * slen * sizeof *ft);
-	memmove(Fd, tmp, 2 * hn * dlen * sizeof *tmp);
-
-	/* Convert Fd and Gd to RNS, with output temporarily stored
-	   in (Ft, Gt). Fd and Gd have degree hn only; we store the
-	   values for each modulus p in the _last_ hn slots of the
-	   n-word line for that modulus. */
-	for (size_t i = 0; i < llen; i ++) {
+	size_t dlen = ic->dlen;
+	(void)tmp;
+	for (size_t i = start; i < end; i ++) {
 		uint32_t p = PRIMES[i].p;
 		uint32_t p0i = PRIMES[i].p0i;
 		uint32_t R2 = PRIMES[i].R2;
 		uint32_t Rx = mp_Rx31((unsigned)dlen, p, p0i, R2);
-		uint32_t *xt = Ft + i * n + hn;
-		uint32_t *yt = Gt + i * n + hn;
-		if (logn >= 4) {
-			__m256i yp = _mm256_set1_epi32(p);
-			__m256i yp0i = _mm256_set1_epi32(p0i);
-			__m256i yR2 = _mm256_set1_epi32(R2);
-			__m256i yRx = _mm256_set1_epi32(Rx);
-			for (size_t j = 0; j < hn; j += 8) {
-				_mm256_storeu_si256((__m256i *)(xt + j),
-					zint_mod_small_signed_x8(Fd + j, dlen,
-						hn, yp, yp0i, yR2, yRx));
-				_mm256_storeu_si256((__m256i *)(yt + j),
-					zint_mod_small_signed_x8(Gd + j, dlen,
-						hn, yp, yp0i, yR2, yRx));
-			}
-		} else {
-			for (size_t j = 0; j < hn; j ++) {
-				xt[j] = zint_mod_small_signed(Fd + j, dlen, hn,
-					p, p0i, R2, Rx);
-				yt[j] = zint_mod_small_signed(Gd + j, dlen, hn,
-					p, p0i, R2, Rx);
-			}
-		}
+		uint32_t *xt = ic->Ft + i * n + hn;
+		uint32_t *yt = ic->Gt + i * n + hn;
+		avx2_zint_mod_small_signed_row(xt, ic->Fd, dlen, hn, hn,
+			p, p0i, R2, Rx);
+		avx2_zint_mod_small_signed_row(yt, ic->Gd, dlen, hn, hn,
+			p, p0i, R2, Rx);
 	}
+}
 
-	/* Fd and Gd are no longer needed. */
-	t1 = Fd;
-
-	/* Compute (F,G) (unreduced) modulo sufficiently many small primes.
-	   We also un-NTT (f,g) as we go; when slen primes have been
-	   processed, we obtain (f,g) in RNS, and we apply the CRT to
-	   get (f,g) in plain representation. */
-	for (size_t i = 0; i < llen; i ++) {
-		/* If we have processed exactly slen primes, then (f,g)
-		   are in RNS, and we can rebuild them. */
-		if (i == slen) {
-			avx2_zint_rebuild_CRT(ft, slen, n, 2, 1, t1);
-		}
-
+/* Compute the unreduced (F,G) modulo the primes base+start to
+   base+end-1. For primes below slen, (f,g) is read from its RNS+NTT
+   rows, which are then converted to RNS (non-NTT); for other primes,
+   (f,g) must already be in plain representation. tmp[] receives the
+   NTT tables and (f,g) modulo the current prime (4*n words). */
+TARGET_AVX2
+static void
+avx2_inter_FG_task(void *ctx, size_t start, size_t end, uint32_t *tmp)
+{
+	ntru_inter_ctx *ic = ctx;
+	unsigned logn = ic->logn;
+	size_t n = (size_t)1 << logn;
+	size_t hn = n >> 1;
+	size_t slen = ic->slen;
+	uint32_t *ft = ic->ft;
+	uint32_t *gt = ic->gt;
+	for (size_t i = ic->base + start; i < ic->base + end; i ++) {
 		uint32_t p = PRIMES[i].p;
 		uint32_t p0i = PRIMES[i].p0i;
 		uint32_t R2 = PRIMES[i].R2;
 
-		/* Memory layout: we keep Ft, Gt, ft and gt; we append:
-		     gm    NTT support (n)
-		     igm   iNTT support (n)
+		/* Memory layout:
+		     gm    NTT support (n) (if not cached)
+		     igm   iNTT support (n) (if not cached)
 		     fx    temporary f mod p (NTT) (n)
 		     gx    temporary g mod p (NTT) (n)  */
-		uint32_t *gm = t1;
-		uint32_t *igm = gm + n;
-		uint32_t *fx = igm + n;
+		const uint32_t *gm;
+		const uint32_t *igm;
+		uint32_t *fx = tmp + 2 * n;
 		uint32_t *gx = fx + n;
-		avx2_mp_mkgmigm(logn, gm, igm,
-			PRIMES[i].g, PRIMES[i].ig, p, p0i);
+		avx2_mp_get_gmigm(logn, i, &gm, &igm, tmp, tmp + n);
 		if (i < slen) {
 			memcpy(fx, ft + i * n, n * sizeof *fx);
 			memcpy(gx, gt + i * n, n * sizeof *gx);
@@ -1128,20 +1184,18 @@ avx2_solve_NTRU_intermediate(unsigned logn_top,
 			avx2_mp_iNTT(logn, gt + i * n, igm, p, p0i);
 		} else {
 			uint32_t Rx = mp_Rx31((unsigned)slen, p, p0i, R2);
-			for (size_t j = 0; j < n; j ++) {
-				fx[j] = zint_mod_small_signed(ft + j, slen, n,
-					p, p0i, R2, Rx);
-				gx[j] = zint_mod_small_signed(gt + j, slen, n,
-					p, p0i, R2, Rx);
-			}
+			avx2_zint_mod_small_signed_row(fx, ft, slen, n, n,
+				p, p0i, R2, Rx);
+			avx2_zint_mod_small_signed_row(gx, gt, slen, n, n,
+				p, p0i, R2, Rx);
 			avx2_mp_NTT(logn, fx, gm, p, p0i);
 			avx2_mp_NTT(logn, gx, gm, p, p0i);
 		}
 
 		/* We have (F,G) from deeper level in Ft and Gt, in
 		   RNS. We apply the NTT modulo p. */
-		uint32_t *Fe = Ft + i * n;
-		uint32_t *Ge = Gt + i * n;
+		uint32_t *Fe = ic->Ft + i * n;
+		uint32_t *Ge = ic->Gt + i * n;
 		avx2_mp_NTT(logn - 1, Fe + hn, gm, p, p0i);
 		avx2_mp_NTT(logn - 1, Ge + hn, gm, p, p0i);
 
@@ -1205,16 +1259,125 @@ avx2_solve_NTRU_intermediate(unsigned logn_top,
 		avx2_mp_iNTT(logn, Fe, igm, p, p0i);
 		avx2_mp_iNTT(logn, Ge, igm, p, p0i);
 	}
+}
 
-	/* Edge case: if slen == llen, then we have not rebuilt (f,g)
-	   into plain representation yet, so we do it now. */
-	if (slen == llen) {
-		avx2_zint_rebuild_CRT(ft, slen, n, 2, 1, t1);
+/* Convert src (plain, slen words per coefficient) to RNS+NTT modulo the
+   primes start to end-1; the values for prime i are written in row i of
+   dst. tmp[] receives the NTT support (n words). */
+TARGET_AVX2
+static void
+avx2_inter_fg_NTT_task(void *ctx, size_t start, size_t end, uint32_t *tmp)
+{
+	ntru_inter_ctx *ic = ctx;
+	unsigned logn = ic->logn;
+	size_t n = (size_t)1 << logn;
+	size_t slen = ic->slen;
+	for (size_t i = start; i < end; i ++) {
+		uint32_t p = PRIMES[i].p;
+		uint32_t p0i = PRIMES[i].p0i;
+		uint32_t R2 = PRIMES[i].R2;
+		uint32_t Rx = mp_Rx31((unsigned)slen, p, p0i, R2);
+		uint32_t *tn = ic->dst + i * n;
+		const uint32_t *gm = avx2_mp_get_gm(logn, i, tmp);
+		avx2_zint_mod_small_signed_row(tn, ic->src, slen, n, n,
+			p, p0i, R2, Rx);
+		avx2_mp_NTT(logn, tn, gm, p, p0i);
 	}
+}
+
+TARGET_AVX2
+static int
+avx2_solve_NTRU_intermediate(unsigned logn_top,
+	const int8_t *restrict f, const int8_t *restrict g,
+	unsigned depth, uint32_t *restrict tmp, kgen_pool *kp)
+{
+	unsigned logn = logn_top - depth;
+	size_t n = (size_t)1 << logn;
+	size_t hn = n >> 1;
+
+	/* slen   size for (f,g) at this level (also output (F,G))
+	   llen   size for unreduced (F,G) at this level
+	   dlen   size for input (F,G) from deeper level
+	   Note: we always have llen >= dlen */
+	size_t slen = MAX_BL_SMALL[depth];
+	size_t llen = MAX_BL_LARGE[depth];
+	size_t dlen = MAX_BL_SMALL[depth + 1];
+
+	/* Fd   F from deeper level (dlen*hn)
+	   Gd   G from deeper level (dlen*hn)
+	   ft   f from this level (slen*n)
+	   gt   g from this level (slen*n) */
+	uint32_t *Fd = tmp;
+	uint32_t *Gd = Fd + dlen * hn;
+	uint32_t *fgt = Gd + dlen * hn;
+
+	/* Get (f,g) for this level (in RNS+NTT). */
+	if (depth < MIN_SAVE_FG[logn_top]) {
+		avx2_make_fg_intermediate(logn_top, f, g, depth, fgt, kp);
+	} else {
+		uint32_t *sav_fg = tmp + ((size_t)6 << logn_top);
+		for (unsigned d = MIN_SAVE_FG[logn_top];
+			d <= depth; d ++)
+		{
+			sav_fg -= MAX_BL_SMALL[d] << (logn_top + 1 - d);
+		}
+		memmove(fgt, sav_fg, 2 * slen * n * sizeof *fgt);
+	}
+
+	/* Move buffers so that we have room for the unreduced (F,G) at
+	   this level.
+	     Ft   F from this level (unreduced) (llen*n)
+	     Gt   G from this level (unreduced) (llen*n)
+	     ft   f from this level (slen*n)
+	     gt   g from this level (slen*n)
+	     Fd   F from deeper level (dlen*hn)
+	     Gd   G from deeper level (dlen*hn)  */
+	uint32_t *Ft = tmp;
+	uint32_t *Gt = Ft + llen * n;
+	uint32_t *ft = Gt + llen * n;
+	uint32_t *gt = ft + slen * n;
+	Fd = gt + slen * n;
+	Gd = Fd + dlen * hn;
+	uint32_t *t1 = Gd + dlen * hn;
+	memmove(ft, fgt, 2 * n * slen * sizeof *ft);
+	memmove(Fd, tmp, 2 * hn * dlen * sizeof *tmp);
+
+	/* Convert Fd and Gd to RNS, with output temporarily stored
+	   in (Ft, Gt). Fd and Gd have degree hn only; we store the
+	   values for each modulus p in the _last_ hn slots of the
+	   n-word line for that modulus. */
+	ntru_inter_ctx ic;
+	ic.logn = logn;
+	ic.slen = slen;
+	ic.dlen = dlen;
+	ic.Ft = Ft;
+	ic.Gt = Gt;
+	ic.ft = ft;
+	ic.gt = gt;
+	ic.Fd = Fd;
+	ic.Gd = Gd;
+	kgen_run(kp, llen, dlen << logn,
+		avx2_inter_FGd_to_RNS_task, &ic, t1);
+
+	/* Fd and Gd are no longer needed. */
+	t1 = Fd;
+
+	/* Compute (F,G) (unreduced) modulo sufficiently many small primes.
+	   The first slen primes also un-NTT (f,g); we then have (f,g) in
+	   RNS, and we apply the CRT to get (f,g) in plain representation,
+	   which the remaining primes use. Primes are independent of each
+	   other and are spread over the threads of kp. */
+	ic.base = 0;
+	kgen_run(kp, slen, (size_t)(logn + 1) << (logn + 1),
+		avx2_inter_FG_task, &ic, t1);
+	avx2_zint_rebuild_CRT(ft, slen, n, 2, 1, t1, kp);
+	ic.base = slen;
+	kgen_run(kp, llen - slen, (slen + logn) << (logn + 1),
+		avx2_inter_FG_task, &ic, t1);
 
 	/* We now have the unreduced (F,G) in RNS. We rebuild their
 	   plain representation. */
-	avx2_zint_rebuild_CRT(Ft, llen, n, 2, 1, t1);
+	avx2_zint_rebuild_CRT(Ft, llen, n, 2, 1, t1, kp);
 
 	/* We now reduce these (F,G) with Babai's nearest plane
 	   algorithm. The reduction conceptually goes as follows:
@@ -1363,35 +1526,14 @@ avx2_solve_NTRU_intermediate(unsigned logn_top,
 	if (use_sub_ntt) {
 		uint32_t *gm = t2;
 		uint32_t *tn = gm + n;
-		for (size_t i = 0; i <= slen; i ++) {
-			uint32_t p = PRIMES[i].p;
-			uint32_t p0i = PRIMES[i].p0i;
-			uint32_t R2 = PRIMES[i].R2;
-			uint32_t Rx = mp_Rx31((unsigned)slen, p, p0i, R2);
-			avx2_mp_mkgm(logn, gm, PRIMES[i].g, p, p0i);
-			for (size_t j = 0; j < n; j ++) {
-				tn[j] = zint_mod_small_signed(
-					ft + j, slen, n, p, p0i, R2, Rx);
-			}
-			avx2_mp_NTT(logn, tn, gm, p, p0i);
-			tn += n;
-		}
-		tn = gm + n;
+		ic.dst = tn;
+		ic.src = ft;
+		kgen_run(kp, slen + 1, (slen + logn) << logn,
+			avx2_inter_fg_NTT_task, &ic, gm);
 		memmove(ft, tn, (slen + 1) * n * sizeof *tn);
-		for (size_t i = 0; i <= slen; i ++) {
-			uint32_t p = PRIMES[i].p;
-			uint32_t p0i = PRIMES[i].p0i;
-			uint32_t R2 = PRIMES[i].R2;
-			uint32_t Rx = mp_Rx31((unsigned)slen, p, p0i, R2);
-			avx2_mp_mkgm(logn, gm, PRIMES[i].g, p, p0i);
-			for (size_t j = 0; j < n; j ++) {
-				tn[j] = zint_mod_small_signed(
-					gt + j, slen, n, p, p0i, R2, Rx);
-			}
-			avx2_mp_NTT(logn, tn, gm, p, p0i);
-			tn += n;
-		}
-		tn = gm + n;
+		ic.src = gt;
+		kgen_run(kp, slen + 1, (slen + logn) << logn,
+			avx2_inter_fg_NTT_task, &ic, gm);
 		memmove(gt, tn, (slen + 1) * n * sizeof *tn);
 	}
 
@@ -1436,9 +1578,9 @@ avx2_solve_NTRU_intermediate(unsigned logn_top,
 				(uint32_t *)k, scale_k, f, g, t2);
 		} else if (use_sub_ntt) {
 			avx2_poly_sub_scaled_ntt(logn,
-				Ft, FGlen, ft, slen, k, scale_k, t2);
+				Ft, FGlen, ft, slen, k, scale_k, t2, kp);
 			avx2_poly_sub_scaled_ntt(logn,
-				Gt, FGlen, gt, slen, k, scale_k, t2);
+				Gt, FGlen, gt, slen, k, scale_k, t2, kp);
 		} else {
 			avx2_poly_sub_scaled(logn,
 				Ft, FGlen, ft, slen, k, scale_k);
@@ -1487,23 +1629,19 @@ avx2_solve_NTRU_intermediate(unsigned logn_top,
 	uint32_t p0i = PRIMES[0].p0i;
 	uint32_t R2 = PRIMES[0].R2;
 	uint32_t Rx = mp_Rx31(slen, p, p0i, R2);
-	avx2_mp_mkgm(logn, t4, PRIMES[0].g, p, p0i);
+	const uint32_t *gm = avx2_mp_get_gm(logn, 0, t4);
 	if (use_sub_ntt) {
 		t1 = ft;
-		for (size_t i = 0; i < n; i ++) {
-			t2[i] = zint_mod_small_signed(
-				Gt + i, slen, n, p, p0i, R2, Rx);
-		}
-		avx2_mp_NTT(logn, t2, t4, p, p0i);
+		avx2_zint_mod_small_signed_row(t2, Gt, slen, n, n,
+			p, p0i, R2, Rx);
+		avx2_mp_NTT(logn, t2, gm, p, p0i);
 	} else {
-		for (size_t i = 0; i < n; i ++) {
-			t1[i] = zint_mod_small_signed(
-				ft + i, slen, n, p, p0i, R2, Rx);
-			t2[i] = zint_mod_small_signed(
-				Gt + i, slen, n, p, p0i, R2, Rx);
-		}
-		avx2_mp_NTT(logn, t1, t4, p, p0i);
-		avx2_mp_NTT(logn, t2, t4, p, p0i);
+		avx2_zint_mod_small_signed_row(t1, ft, slen, n, n,
+			p, p0i, R2, Rx);
+		avx2_zint_mod_small_signed_row(t2, Gt, slen, n, n,
+			p, p0i, R2, Rx);
+		avx2_mp_NTT(logn, t1, gm, p, p0i);
+		avx2_mp_NTT(logn, t2, gm, p, p0i);
 	}
 	if (n >= 8) {
 		__m256i yp = _mm256_set1_epi32(p);
@@ -1521,20 +1659,16 @@ avx2_solve_NTRU_intermediate(unsigned logn_top,
 	}
 	if (use_sub_ntt) {
 		t1 = gt;
-		for (size_t i = 0; i < n; i ++) {
-			t2[i] = zint_mod_small_signed(
-				Ft + i, slen, n, p, p0i, R2, Rx);
-		}
-		avx2_mp_NTT(logn, t2, t4, p, p0i);
+		avx2_zint_mod_small_signed_row(t2, Ft, slen, n, n,
+			p, p0i, R2, Rx);
+		avx2_mp_NTT(logn, t2, gm, p, p0i);
 	} else {
-		for (size_t i = 0; i < n; i ++) {
-			t1[i] = zint_mod_small_signed(
-				gt + i, slen, n, p, p0i, R2, Rx);
-			t2[i] = zint_mod_small_signed(
-				Ft + i, slen, n, p, p0i, R2, Rx);
-		}
-		avx2_mp_NTT(logn, t1, t4, p, p0i);
-		avx2_mp_NTT(logn, t2, t4, p, p0i);
+		avx2_zint_mod_small_signed_row(t1, gt, slen, n, n,
+			p, p0i, R2, Rx);
+		avx2_zint_mod_small_signed_row(t2, Ft, slen, n, n,
+			p, p0i, R2, Rx);
+		avx2_mp_NTT(logn, t1, gm, p, p0i);
+		avx2_mp_NTT(logn, t2, gm, p, p0i);
 	}
 	uint32_t rv = mp_mmul(Q, 1, p, p0i);
 	if (n >= 8) {
@@ -1595,10 +1729,9 @@ solve_NTRU_depth0(unsigned logn,
 	uint32_t *Gd = Fd + hn;
 	uint32_t *ft = Gd + hn;
 	uint32_t *gt = ft + n;
-	uint32_t *gm = gt + n;
 
 	/* Load f and g, and convert to RNS+NTT. */
-	mp_mkgm(logn, gm, PRIMES[0].g, p, p0i);
+	const uint32_t *gm = mp_get_gm(logn, 0, gt + n);
 	poly_mp_set_small(logn, ft, f, p);
 	poly_mp_set_small(logn, gt, g, p);
 	mp_NTT(logn, ft, gm, p, p0i);
@@ -1634,7 +1767,7 @@ solve_NTRU_depth0(unsigned logn,
 	uint32_t *Fp = tmp;
 	uint32_t *Gp = Fp + n;
 	uint32_t *t1 = Gp + n;
-	uint32_t *t2 = t1 + n;  /* alias on gm */
+	uint32_t *t2 = t1 + n;  /* alias on gm (if not cached) */
 	uint32_t *t3 = t2 + n;
 	uint32_t *t4 = t3 + n;
 	memmove(Fp, ft, 2 * n * sizeof *ft);
@@ -1669,9 +1802,9 @@ solve_NTRU_depth0(unsigned logn,
 
 	/* Convert back F*adj(f) + G*adj(g) and f*adj(f) + g*adj(g) to
 	   plain representation, and move f*adj(f) + g*adj(g) to t2. */
-	mp_mkigm(logn, t4, PRIMES[0].ig, p, p0i);
-	mp_iNTT(logn, t1, t4, p, p0i);
-	mp_iNTT(logn, t3, t4, p, p0i);
+	const uint32_t *igm = mp_get_igm(logn, 0, t4);
+	mp_iNTT(logn, t1, igm, p, p0i);
+	mp_iNTT(logn, t3, igm, p, p0i);
 	for (size_t i = 0; i < n; i ++) {
 		/* NOTE: no truncature to 31 bits. */
 		t1[i] = (uint32_t)mp_norm(t1[i], p);
@@ -1729,8 +1862,8 @@ solve_NTRU_depth0(unsigned logn,
 	     t4    free (n)  */
 
 	/* Convert k to RNS+NTT+Montgomery. */
-	mp_mkgm(logn, t4, PRIMES[0].g, p, p0i);
-	mp_NTT(logn, t1, t4, p, p0i);
+	gm = mp_get_gm(logn, 0, t4);
+	mp_NTT(logn, t1, gm, p, p0i);
 	for (size_t i = 0; i < n; i ++) {
 		t1[i] = mp_mmul(t1[i], R2, p, p0i);
 	}
@@ -1742,8 +1875,8 @@ solve_NTRU_depth0(unsigned logn,
 		t2[i] = mp_set(f[i], p);
 		t3[i] = mp_set(g[i], p);
 	}
-	mp_NTT(logn, t2, t4, p, p0i);
-	mp_NTT(logn, t3, t4, p, p0i);
+	mp_NTT(logn, t2, gm, p, p0i);
+	mp_NTT(logn, t3, gm, p, p0i);
 	uint32_t rv = mp_mmul(Q, 1, p, p0i);
 	for (size_t i = 0; i < n; i ++) {
 		Fp[i] = mp_sub(Fp[i], mp_mmul(t1[i], t2[i], p, p0i), p);
@@ -1757,9 +1890,9 @@ solve_NTRU_depth0(unsigned logn,
 	}
 
 	/* Convert back F and G into normal representation. */
-	mp_mkigm(logn, t4, PRIMES[0].ig, p, p0i);
-	mp_iNTT(logn, Fp, t4, p, p0i);
-	mp_iNTT(logn, Gp, t4, p, p0i);
+	igm = mp_get_igm(logn, 0, t4);
+	mp_iNTT(logn, Fp, igm, p, p0i);
+	mp_iNTT(logn, Gp, igm, p, p0i);
 	poly_mp_norm(logn, Fp, p);
 	poly_mp_norm(logn, Gp, p);
 
@@ -1792,10 +1925,9 @@ avx2_solve_NTRU_depth0(unsigned logn,
 	uint32_t *Gd = Fd + hn;
 	uint32_t *ft = Gd + hn;
 	uint32_t *gt = ft + n;
-	uint32_t *gm = gt + n;
 
 	/* Load f and g, and convert to RNS+NTT. */
-	avx2_mp_mkgm(logn, gm, PRIMES[0].g, p, p0i);
+	const uint32_t *gm = avx2_mp_get_gm(logn, 0, gt + n);
 	avx2_poly_mp_set_small(logn, ft, f, p);
 	avx2_poly_mp_set_small(logn, gt, g, p);
 	avx2_mp_NTT(logn, ft, gm, p, p0i);
@@ -1865,7 +1997,7 @@ avx2_solve_NTRU_depth0(unsigned logn,
 	uint32_t *Fp = tmp;
 	uint32_t *Gp = Fp + n;
 	uint32_t *t1 = Gp + n;
-	uint32_t *t2 = t1 + n;  /* alias on gm */
+	uint32_t *t2 = t1 + n;  /* alias on gm (if not cached) */
 	uint32_t *t3 = t2 + n;
 	uint32_t *t4 = t3 + n;
 	memmove(Fp, ft, 2 * n * sizeof *ft);
@@ -1900,9 +2032,9 @@ avx2_solve_NTRU_depth0(unsigned logn,
 
 	/* Convert back F*adj(f) + G*adj(g) and f*adj(f) + g*adj(g) to
 	   plain representation, and move f*adj(f) + g*adj(g) to t2. */
-	avx2_mp_mkigm(logn, t4, PRIMES[0].ig, p, p0i);
-	avx2_mp_iNTT(logn, t1, t4, p, p0i);
-	avx2_mp_iNTT(logn, t3, t4, p, p0i);
+	const uint32_t *igm = avx2_mp_get_igm(logn, 0, t4);
+	avx2_mp_iNTT(logn, t1, igm, p, p0i);
+	avx2_mp_iNTT(logn, t3, igm, p, p0i);
 	for (size_t i = 0; i < n; i ++) {
 		/* NOTE: no truncature to 31 bits. */
 		t1[i] = (uint32_t)mp_norm(t1[i], p);
@@ -1960,8 +2092,8 @@ avx2_solve_NTRU_depth0(unsigned logn,
 	     t4    free (n)  */
 
 	/* Convert k to RNS+NTT+Montgomery. */
-	avx2_mp_mkgm(logn, t4, PRIMES[0].g, p, p0i);
-	avx2_mp_NTT(logn, t1, t4, p, p0i);
+	gm = avx2_mp_get_gm(logn, 0, t4);
+	avx2_mp_NTT(logn, t1, gm, p, p0i);
 	for (size_t i = 0; i < n; i ++) {
 		t1[i] = mp_mmul(t1[i], R2, p, p0i);
 	}
@@ -1973,8 +2105,8 @@ avx2_solve_NTRU_depth0(unsigned logn,
 		t2[i] = mp_set(f[i], p);
 		t3[i] = mp_set(g[i], p);
 	}
-	avx2_mp_NTT(logn, t2, t4, p, p0i);
-	avx2_mp_NTT(logn, t3, t4, p, p0i);
+	avx2_mp_NTT(logn, t2, gm, p, p0i);
+	avx2_mp_NTT(logn, t3, gm, p, p0i);
 	uint32_t rv = mp_mmul(Q, 1, p, p0i);
 	for (size_t i = 0; i < n; i ++) {
 		Fp[i] = mp_sub(Fp[i], mp_mmul(t1[i], t2[i], p, p0i), p);
@@ -1988,9 +2120,9 @@ avx2_solve_NTRU_depth0(unsigned logn,
 	}
 
 	/* Convert back F and G into normal representation. */
-	avx2_mp_mkigm(logn, t4, PRIMES[0].ig, p, p0i);
-	avx2_mp_iNTT(logn, Fp, t4, p, p0i);
-	avx2_mp_iNTT(logn, Gp, t4, p, p0i);
+	igm = avx2_mp_get_igm(logn, 0, t4);
+	avx2_mp_iNTT(logn, Fp, igm, p, p0i);
+	avx2_mp_iNTT(logn, Gp, igm, p, p0i);
 	avx2_poly_mp_norm(logn, Fp, p);
 	avx2_poly_mp_norm(logn, Gp, p);
 
@@ -2001,17 +2133,18 @@ avx2_solve_NTRU_depth0(unsigned logn,
 /* see kgen_inner.h */
 int
 solve_NTRU(unsigned logn,
-	const int8_t *restrict f, const int8_t *restrict g, uint32_t *tmp)
+	const int8_t *restrict f, const int8_t *restrict g,
+	uint32_t *tmp, kgen_pool *kp)
 {
 	size_t n = (size_t)1 << logn;
 
-	int err = solve_NTRU_deepest(logn, f, g, tmp);
+	int err = solve_NTRU_deepest(logn, f, g, tmp, kp);
 	if (err != SOLVE_OK) {
 		return 0;
 	}
 	unsigned depth = logn;
 	while (depth -- > 1) {
-		err = solve_NTRU_intermediate(logn, f, g, depth, tmp);
+		err = solve_NTRU_intermediate(logn, f, g, depth, tmp, kp);
 		if (err != SOLVE_OK) {
 			return 0;
 		}
@@ -2044,17 +2177,18 @@ solve_NTRU(unsigned logn,
 TARGET_AVX2
 int
 avx2_solve_NTRU(unsigned logn,
-	const int8_t *restrict f, const int8_t *restrict g, uint32_t *tmp)
+	const int8_t *restrict f, const int8_t *restrict g,
+	uint32_t *tmp, kgen_pool *kp)
 {
 	size_t n = (size_t)1 << logn;
 
-	int err = avx2_solve_NTRU_deepest(logn, f, g, tmp);
+	int err = avx2_solve_NTRU_deepest(logn, f, g, tmp, kp);
 	if (err != SOLVE_OK) {
 		return 0;
 	}
 	unsigned depth = logn;
 	while (depth -- > 1) {
-		err = avx2_solve_NTRU_intermediate(logn, f, g, depth, tmp);
+		err = avx2_solve_NTRU_intermediate(logn, f, g, depth, tmp, kp);
 		if (err != SOLVE_OK) {
 			return 0;
 		}
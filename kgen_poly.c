@@ -857,97 +857,129 @@ avx2_poly_sub_scaled(unsigned logn,
 }
 #endif
 
-/* see kgen_inner.h */
-void
-poly_sub_scaled_ntt(unsigned logn, uint32_t *restrict F, size_t Flen,
-	const uint32_t *restrict f, size_t flen,
-	const int32_t *restrict k, uint32_t sc, uint32_t *restrict tmp)
-{
-	size_t n = (size_t)1 << logn;
-	size_t tlen = flen + 1;
-	uint32_t *gm = tmp;
-	uint32_t *igm = gm + n;
-	uint32_t *fk = igm + n;
-	uint32_t *t1 = fk + (tlen << logn);
+/* Context for poly_sub_scaled_ntt() tasks. */
+typedef struct {
+	unsigned logn;
+	uint32_t *F;
+	size_t Flen;
+	const uint32_t *f;
+	const int32_t *k;
+	uint32_t *fk;
+	size_t tlen;
 	uint32_t sch, scl;
-	DIVREM31(sch, scl, sc);
+} sub_scaled_ntt_ctx;
 
-	/*
-	 * Compute k*f in fk[], in RNS notation.
-	 * f is assumed to be already in RNS+NTT over flen+1 words.
-	 */
-	for (size_t i = 0; i < tlen; i ++) {
+/* Compute k*f modulo the primes start to end-1, in fk[] (RNS). The
+   NTT of k is computed directly in the output row; tmp[] receives the
+   NTT tables (2*n words). */
+static void
+sub_scaled_ntt_mul_task(void *ctx, size_t start, size_t end, uint32_t *tmp)
+{
+	sub_scaled_ntt_ctx *sc = ctx;
+	unsigned logn = sc->logn;
+	size_t n = (size_t)1 << logn;
+	for (size_t i = start; i < end; i ++) {
 		uint32_t p = PRIMES[i].p;
 		uint32_t p0i = PRIMES[i].p0i;
 		uint32_t R2 = PRIMES[i].R2;
-		mp_mkgmigm(logn, gm, igm, PRIMES[i].g, PRIMES[i].ig, p, p0i);
+		const uint32_t *gm;
+		const uint32_t *igm;
+		mp_get_gmigm(logn, i, &gm, &igm, tmp, tmp + n);
+		const uint32_t *fs = sc->f + (i << logn);
+		uint32_t *ff = sc->fk + (i << logn);
 		for (size_t j = 0; j < n; j ++) {
-			t1[j] = mp_set(k[j], p);
+			ff[j] = mp_set(sc->k[j], p);
 		}
-		mp_NTT(logn, t1, gm, p, p0i);
-
-		const uint32_t *fs = f + (i << logn);
-		uint32_t *ff = fk + (i << logn);
+		mp_NTT(logn, ff, gm, p, p0i);
 		for (size_t j = 0; j < n; j ++) {
 			ff[j] = mp_mmul(
-				mp_mmul(t1[j], fs[j], p, p0i), R2, p, p0i);
+				mp_mmul(ff[j], fs[j], p, p0i), R2, p, p0i);
 		}
 		mp_iNTT(logn, ff, igm, p, p0i);
 	}
+}
+
+/* Subtract k*f (plain), scaled, from coefficients start to end-1 of F. */
+static void
+sub_scaled_ntt_sub_task(void *ctx, size_t start, size_t end, uint32_t *tmp)
+{
+	sub_scaled_ntt_ctx *sc = ctx;
+	size_t n = (size_t)1 << sc->logn;
+	(void)tmp;
+	for (size_t i = start; i < end; i ++) {
+		zint_sub_scaled(sc->F + i, sc->Flen, sc->fk + i, sc->tlen, n,
+			sc->sch, sc->scl);
+	}
+}
+
+/* see kgen_inner.h */
+void
+poly_sub_scaled_ntt(unsigned logn, uint32_t *restrict F, size_t Flen,
+	const uint32_t *restrict f, size_t flen,
+	const int32_t *restrict k, uint32_t sc, uint32_t *restrict tmp,
+	kgen_pool *kp)
+{
+	size_t n = (size_t)1 << logn;
+	sub_scaled_ntt_ctx ctx;
+	ctx.logn = logn;
+	ctx.F = F;
+	ctx.Flen = Flen;
+	ctx.f = f;
+	ctx.k = k;
+	ctx.tlen = flen + 1;
+	ctx.fk = tmp + 2 * n;
+	DIVREM31(ctx.sch, ctx.scl, sc);
+	uint32_t *t1 = ctx.fk + (ctx.tlen << logn);
+
+	/*
+	 * Compute k*f in fk[], in RNS notation.
+	 * f is assumed to be already in RNS+NTT over flen+1 words.
+	 */
+	kgen_run(kp, ctx.tlen, (size_t)(logn + 1) << (logn + 1),
+		sub_scaled_ntt_mul_task, &ctx, tmp);
 
 	/*
 	 * Rebuild k*f.
 	 */
-	zint_rebuild_CRT(fk, tlen, n, 1, 1, t1);
+	zint_rebuild_CRT(ctx.fk, ctx.tlen, n, 1, 1, t1, kp);
 
 	/*
 	 * Subtract k*f, scaled, from F.
 	 */
-	for (size_t i = 0; i < n; i ++) {
-		zint_sub_scaled(F + i, Flen, fk + i, tlen, n, sch, scl);
-	}
+	kgen_run(kp, n, Flen, sub_scaled_ntt_sub_task, &ctx, NULL);
 }
 
 #if FNDSA_AVX2
 TARGET_AVX2
-void
-avx2_poly_sub_scaled_ntt(unsigned logn, uint32_t *restrict F, size_t Flen,
-	const uint32_t *restrict f, size_t flen,
-	const int32_t *restrict k, uint32_t sc, uint32_t *restrict tmp)
+static void
+avx2_sub_scaled_ntt_mul_task(void *ctx,
+	size_t start, size_t end, uint32_t *tmp)
 {
+	sub_scaled_ntt_ctx *sc = ctx;
+	unsigned logn = sc->logn;
 	size_t n = (size_t)1 << logn;
-	size_t tlen = flen + 1;
-	uint32_t *gm = tmp;
-	uint32_t *igm = gm + n;
-	uint32_t *fk = igm + n;
-	uint32_t *t1 = fk + (tlen << logn);
-	uint32_t sch, scl;
-	DIVREM31(sch, scl, sc);
-
-	/*
-	 * Compute k*f in fk[], in RNS notation.
-	 * f is assumed to be already in RNS+NTT over flen+1 words.
-	 */
-	for (size_t i = 0; i < tlen; i ++) {
+	for (size_t i = start; i < end; i ++) {
 		uint32_t p = PRIMES[i].p;
 		uint32_t p0i = PRIMES[i].p0i;
 		uint32_t R2 = PRIMES[i].R2;
-		avx2_mp_mkgmigm(logn, gm, igm,
-			PRIMES[i].g, PRIMES[i].ig, p, p0i);
+		const uint32_t *gm;
+		const uint32_t *igm;
+		avx2_mp_get_gmigm(logn, i, &gm, &igm, tmp, tmp + n);
+		const uint32_t *fs = sc->f + (i << logn);
+		uint32_t *ff = sc->fk + (i << logn);
 		__m256i yp = _mm256_set1_epi32(p);
 		for (size_t j = 0; j < n; j += 8) {
-			__m256i yk = _mm256_loadu_si256((__m256i *)(k + j));
-			_mm256_storeu_si256((__m256i *)(t1 + j),
+			__m256i yk = _mm256_loadu_si256(
+				(const __m256i *)(sc->k + j));
+			_mm256_storeu_si256((__m256i *)(ff + j),
 				mp_set_x8(yk, yp));
 		}
-		avx2_mp_NTT(logn, t1, gm, p, p0i);
+		avx2_mp_NTT(logn, ff, gm, p, p0i);
 
-		const uint32_t *fs = f + (i << logn);
-		uint32_t *ff = fk + (i << logn);
 		__m256i yp0i = _mm256_set1_epi32(p0i);
 		__m256i yR2 = _mm256_set1_epi32(R2);
 		for (size_t j = 0; j < n; j += 8) {
-			__m256i y1 = _mm256_loadu_si256((__m256i *)(t1 + j));
+			__m256i y1 = _mm256_loadu_si256((__m256i *)(ff + j));
 			__m256i y2 = _mm256_loadu_si256((__m256i *)(fs + j));
 			_mm256_storeu_si256((__m256i *)(ff + j),
 				mp_mmul_x8(
@@ -956,18 +988,93 @@ avx2_poly_sub_scaled_ntt(unsigned logn, uint32_t *restrict F, size_t Flen,
 		}
 		avx2_mp_iNTT(logn, ff, igm, p, p0i);
 	}
+}
+
+#if FNDSA_AVX512
+/* Like avx2_sub_scaled_ntt_mul_task(), with 16-lane pointwise operations
+   (n >= 16). */
+TARGET_AVX512
+static void
+avx512_sub_scaled_ntt_mul_task(void *ctx,
+	size_t start, size_t end, uint32_t *tmp)
+{
+	sub_scaled_ntt_ctx *sc = ctx;
+	unsigned logn = sc->logn;
+	size_t n = (size_t)1 << logn;
+	for (size_t i = start; i < end; i ++) {
+		uint32_t p = PRIMES[i].p;
+		uint32_t p0i = PRIMES[i].p0i;
+		uint32_t R2 = PRIMES[i].R2;
+		const uint32_t *gm;
+		const uint32_t *igm;
+		avx2_mp_get_gmigm(logn, i, &gm, &igm, tmp, tmp + n);
+		const uint32_t *fs = sc->f + (i << logn);
+		uint32_t *ff = sc->fk + (i << logn);
+		__m512i zp = _mm512_set1_epi32(p);
+		for (size_t j = 0; j < n; j += 16) {
+			__m512i zk = _mm512_loadu_si512(
+				(const void *)(sc->k + j));
+			_mm512_storeu_si512((void *)(ff + j),
+				mp_set_x16(zk, zp));
+		}
+		avx2_mp_NTT(logn, ff, gm, p, p0i);
+
+		__m512i zp0i = _mm512_set1_epi32(p0i);
+		__m512i zR2 = _mm512_set1_epi32(R2);
+		for (size_t j = 0; j < n; j += 16) {
+			__m512i z1 = _mm512_loadu_si512((const void *)(ff + j));
+			__m512i z2 = _mm512_loadu_si512((const void *)(fs + j));
+			_mm512_storeu_si512((void *)(ff + j),
+				mp_mmul_x16(
+					mp_mmul_x16(z1, z2, zp, zp0i),
+					zR2, zp, zp0i));
+		}
+		avx2_mp_iNTT(logn, ff, igm, p, p0i);
+	}
+}
+#endif
+
+TARGET_AVX2
+void
+avx2_poly_sub_scaled_ntt(unsigned logn, uint32_t *restrict F, size_t Flen,
+	const uint32_t *restrict f, size_t flen,
+	const int32_t *restrict k, uint32_t sc, uint32_t *restrict tmp,
+	kgen_pool *kp)
+{
+	size_t n = (size_t)1 << logn;
+	sub_scaled_ntt_ctx ctx;
+	ctx.logn = logn;
+	ctx.F = F;
+	ctx.Flen = Flen;
+	ctx.f = f;
+	ctx.k = k;
+	ctx.tlen = flen + 1;
+	ctx.fk = tmp + 2 * n;
+	DIVREM31(ctx.sch, ctx.scl, sc);
+	uint32_t *t1 = ctx.fk + (ctx.tlen << logn);
+
+	/*
+	 * Compute k*f in fk[], in RNS notation.
+	 * f is assumed to be already in RNS+NTT over flen+1 words.
+	 */
+	kgen_task mul_task = avx2_sub_scaled_ntt_mul_task;
+#if FNDSA_AVX512
+	if (logn >= 4 && has_avx512()) {
+		mul_task = avx512_sub_scaled_ntt_mul_task;
+	}
+#endif
+	kgen_run(kp, ctx.tlen, (size_t)(logn + 1) << (logn + 1),
+		mul_task, &ctx, tmp);
 
 	/*
 	 * Rebuild k*f.
 	 */
-	avx2_zint_rebuild_CRT(fk, tlen, n, 1, 1, t1);
+	avx2_zint_rebuild_CRT(ctx.fk, ctx.tlen, n, 1, 1, t1, kp);
 
 	/*
 	 * Subtract k*f, scaled, from F.
 	 */
-	for (size_t i = 0; i < n; i ++) {
-		zint_sub_scaled(F + i, Flen, fk + i, tlen, n, sch, scl);
-	}
+	kgen_run(kp, n, Flen, sub_scaled_ntt_sub_task, &ctx, NULL);
 }
 #endif
 
@@ -982,8 +1089,8 @@ poly_sub_kfg_scaled_depth1(unsigned logn_top,
 	unsigned logn = logn_top - 1;
 	size_t n = (size_t)1 << logn;
 	size_t hn = n >> 1;
-	uint32_t *gm = tmp;
-	uint32_t *t1 = gm + n;
+	uint32_t *gm_buf = tmp;
+	uint32_t *t1 = gm_buf + n;
 	uint32_t *t2 = t1 + n;
 
 	/*
@@ -1047,7 +1154,7 @@ poly_sub_kfg_scaled_depth1(unsigned logn_top,
 		uint32_t p0i = PRIMES[i].p0i;
 		uint32_t R2 = PRIMES[i].R2;
 		uint32_t R3 = mp_mmul(R2, R2, p, p0i);
-		mp_mkgm(logn, gm, PRIMES[i].g, p, p0i);
+		const uint32_t *gm = mp_get_gm(logn, i, gm_buf);
 
 		/*
 		 * k <- (2^sc)*k (and into NTT).
@@ -1153,9 +1260,9 @@ poly_sub_kfg_scaled_depth1(unsigned logn_top,
 		/*
 		 * Convert back F and G to RNS.
 		 */
-		mp_mkigm(logn, t1, PRIMES[i].ig, p, p0i);
-		mp_iNTT(logn, Fu, t1, p, p0i);
-		mp_iNTT(logn, Gu, t1, p, p0i);
+		const uint32_t *igm = mp_get_igm(logn, i, t1);
+		mp_iNTT(logn, Fu, igm, p, p0i);
+		mp_iNTT(logn, Gu, igm, p, p0i);
 
 		/*
 		 * We replaced k (plain 32-bit) with (2^sc)*k (NTT). We must
@@ -1163,7 +1270,7 @@ poly_sub_kfg_scaled_depth1(unsigned logn_top,
 		 * iteration.
 		 */
 		if ((i + 1) < FGlen) {
-			mp_iNTT(logn, k, t1, p, p0i);
+			mp_iNTT(logn, k, igm, p, p0i);
 			scv = (uint32_t)1 << (-sc & 31);
 			for (uint32_t m = sc >> 5; m > 0; m --) {
 				scv = mp_mmul(scv, 1, p, p0i);
@@ -1237,8 +1344,8 @@ avx2_poly_sub_kfg_scaled_depth1(unsigned logn_top,
 	unsigned logn = logn_top - 1;
 	size_t n = (size_t)1 << logn;
 	size_t hn = n >> 1;
-	uint32_t *gm = tmp;
-	uint32_t *t1 = gm + n;
+	uint32_t *gm_buf = tmp;
+	uint32_t *t1 = gm_buf + n;
 	uint32_t *t2 = t1 + n;
 
 	/*
@@ -1376,7 +1483,7 @@ avx2_poly_sub_kfg_scaled_depth1(unsigned logn_top,
 		uint32_t p0i = PRIMES[i].p0i;
 		uint32_t R2 = PRIMES[i].R2;
 		uint32_t R3 = mp_mmul(R2, R2, p, p0i);
-		avx2_mp_mkgm(logn, gm, PRIMES[i].g, p, p0i);
+		const uint32_t *gm = avx2_mp_get_gm(logn, i, gm_buf);
 
 		/*
 		 * k <- (2^sc)*k (and into NTT).
@@ -1482,9 +1589,9 @@ avx2_poly_sub_kfg_scaled_depth1(unsigned logn_top,
 		/*
 		 * Convert back F and G to RNS.
 		 */
-		avx2_mp_mkigm(logn, t1, PRIMES[i].ig, p, p0i);
-		avx2_mp_iNTT(logn, Fu, t1, p, p0i);
-		avx2_mp_iNTT(logn, Gu, t1, p, p0i);
+		const uint32_t *igm = avx2_mp_get_igm(logn, i, t1);
+		avx2_mp_iNTT(logn, Fu, igm, p, p0i);
+		avx2_mp_iNTT(logn, Gu, igm, p, p0i);
 
 		/*
 		 * We replaced k (plain 32-bit) with (2^sc)*k (NTT). We must
@@ -1492,7 +1599,7 @@ avx2_poly_sub_kfg_scaled_depth1(unsigned logn_top,
 		 * iteration.
 		 */
 		if ((i + 1) < FGlen) {
-			mp_iNTT(logn, k, t1, p, p0i);
+			mp_iNTT(logn, k, igm, p, p0i);
 			scv = (uint32_t)1 << (-sc & 31);
 			for (uint32_t m = sc >> 5; m > 0; m --) {
 				scv = mp_mmul(scv, 1, p, p0i);
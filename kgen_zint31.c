@@ -28,6 +28,12 @@ zint_mod_small_unsigned(const uint32_t *d, size_t len, size_t stride,
 	 *  - multiply x by 2^31
 	 *  - add new word
 	 */
+#if FNDSA_AVX512
+	if (len >= 16 && has_avx512()) {
+		return avx512_zint_mod_small_unsigned(
+			d, len, stride, p, p0i, R2);
+	}
+#endif
 	uint32_t x = 0;
 	uint32_t z = mp_half(R2, p);
 	d += len * stride;
@@ -63,6 +69,168 @@ avx2_zint_mod_small_unsigned_x8(const uint32_t *d, size_t len, size_t stride,
 }
 #endif
 
+#if FNDSA_AVX512
+/* see kgen_inner.h */
+TARGET_AVX512
+uint32_t
+avx512_zint_mod_small_unsigned(const uint32_t *d, size_t len, size_t stride,
+	uint32_t p, uint32_t p0i, uint32_t R2)
+{
+	/*
+	 * Lane t accumulates words t, t+16, t+32..., with Horner's rule
+	 * on 2^(31*16) instead of 2^31. The lanes are then multiplied
+	 * by 2^(31*t) and added together.
+	 */
+	if (len == 0) {
+		return 0;
+	}
+	__m512i zp = _mm512_set1_epi32(p);
+	__m512i zp0i = _mm512_set1_epi32(p0i);
+
+	/* zk[i] = 2^(31*2^i)*R mod p (Montgomery representation of
+	   the block weights). */
+	uint32_t zk[5];
+	zk[0] = mp_half(R2, p);
+	for (int i = 1; i < 5; i ++) {
+		zk[i] = mp_mmul(zk[i - 1], zk[i - 1], p, p0i);
+	}
+
+	/* Lane weights 2^(31*t)*R mod p, built by doubling the number
+	   of set lanes at each step. */
+	__m512i zw = _mm512_set1_epi32(mp_R(p));
+	__m512i zlane = _mm512_setr_epi32(
+		0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+	for (int i = 0; i < 4; i ++) {
+		int h = 1 << i;
+		__m512i zs = _mm512_permutexvar_epi32(
+			_mm512_sub_epi32(zlane, _mm512_set1_epi32(h)), zw);
+		zs = mp_mmul_x16(zs, _mm512_set1_epi32(zk[i]), zp, zp0i);
+		zw = _mm512_mask_mov_epi32(zw,
+			(__mmask16)((0xFFFF << h) & 0xFFFF), zs);
+	}
+
+	/* Word offsets of the 16 lanes; the top block may be partial. */
+	__m512i zoff = _mm512_mullo_epi32(zlane,
+		_mm512_set1_epi32((int32_t)stride));
+	size_t nb = (len + 15) >> 4;
+	size_t rem = len - ((nb - 1) << 4);
+	const uint32_t *e = d + ((nb - 1) << 4) * stride;
+	__mmask16 mt = (__mmask16)(((uint32_t)1 << rem) - 1);
+	__m512i zx;
+	if (stride == 1) {
+		zx = _mm512_maskz_loadu_epi32(mt, e);
+	} else {
+		zx = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(),
+			mt, zoff, e, 4);
+	}
+	zx = _mm512_min_epu32(zx, _mm512_sub_epi32(zx, zp));
+	__m512i z16 = _mm512_set1_epi32(zk[4]);
+	for (size_t i = nb - 1; i > 0; i --) {
+		e -= stride << 4;
+		__m512i zv;
+		if (stride == 1) {
+			zv = _mm512_loadu_si512((const void *)e);
+		} else {
+			zv = _mm512_i32gather_epi32(zoff, e, 4);
+		}
+		zv = _mm512_min_epu32(zv, _mm512_sub_epi32(zv, zp));
+		zx = mp_mmul_x16(zx, z16, zp, zp0i);
+		zx = mp_add_x16(zx, zv, zp);
+	}
+
+	/* Apply the lane weights and add all lanes together. */
+	zx = mp_mmul_x16(zx, zw, zp, zp0i);
+	zx = mp_add_x16(zx, _mm512_shuffle_i32x4(zx, zx, 0x4E), zp);
+	zx = mp_add_x16(zx, _mm512_shuffle_i32x4(zx, zx, 0xB1), zp);
+	zx = mp_add_x16(zx, _mm512_shuffle_epi32(zx, 0x4E), zp);
+	zx = mp_add_x16(zx, _mm512_shuffle_epi32(zx, 0xB1), zp);
+	return (uint32_t)_mm_cvtsi128_si32(_mm512_castsi512_si128(zx));
+}
+
+/* Like avx2_zint_mod_small_unsigned_x8(), over 16 integers. */
+TARGET_AVX512
+static __m512i
+avx512_zint_mod_small_unsigned_x16(const uint32_t *d, size_t len,
+	size_t stride, __m512i zp, __m512i zp0i, __m512i zR2)
+{
+	__m512i zx = _mm512_setzero_si512();
+	__m512i zz = mp_half_x16(zR2, zp);
+	d += len * stride;
+	for (size_t i = len; i > 0; i --) {
+		d -= stride;
+		__m512i zw = _mm512_loadu_si512((const void *)d);
+		zw = _mm512_min_epu32(zw, _mm512_sub_epi32(zw, zp));
+		zx = mp_mmul_x16(zx, zz, zp, zp0i);
+		zx = mp_add_x16(zx, zw, zp);
+	}
+	return zx;
+}
+
+/* Like avx2_zint_mod_small_signed_row(), using AVX-512F. */
+TARGET_AVX512
+static void
+avx512_zint_mod_small_signed_row(uint32_t *restrict dst,
+	const uint32_t *restrict d, size_t len, size_t stride, size_t num,
+	uint32_t p, uint32_t p0i, uint32_t R2, uint32_t Rx)
+{
+	size_t j = 0;
+	if (len > 0) {
+		__m512i zp = _mm512_set1_epi32(p);
+		__m512i zp0i = _mm512_set1_epi32(p0i);
+		__m512i zR2 = _mm512_set1_epi32(R2);
+		__m512i zRx = _mm512_set1_epi32(Rx);
+		__m512i zsb = _mm512_set1_epi32(0x40000000);
+		for (; (j + 15) < num; j += 16) {
+			__m512i zx = avx512_zint_mod_small_unsigned_x16(
+				d + j, len, stride, zp, zp0i, zR2);
+			__m512i zl = _mm512_loadu_si512(
+				(const void *)(d + j + (len - 1) * stride));
+			__mmask16 mn = _mm512_test_epi32_mask(zl, zsb);
+			zx = mp_sub_x16(zx, _mm512_maskz_mov_epi32(mn, zRx), zp);
+			_mm512_storeu_si512((void *)(dst + j), zx);
+		}
+	}
+	for (; j < num; j ++) {
+		dst[j] = zint_mod_small_signed(d + j, len, stride,
+			p, p0i, R2, Rx);
+	}
+}
+#endif
+
+#if FNDSA_AVX2
+/* see kgen_inner.h */
+TARGET_AVX2
+void
+avx2_zint_mod_small_signed_row(uint32_t *restrict dst,
+	const uint32_t *restrict d, size_t len, size_t stride, size_t num,
+	uint32_t p, uint32_t p0i, uint32_t R2, uint32_t Rx)
+{
+#if FNDSA_AVX512
+	if (num >= 16 && has_avx512()) {
+		avx512_zint_mod_small_signed_row(dst, d, len, stride, num,
+			p, p0i, R2, Rx);
+		return;
+	}
+#endif
+	size_t j = 0;
+	if (num >= 8) {
+		__m256i yp = _mm256_set1_epi32(p);
+		__m256i yp0i = _mm256_set1_epi32(p0i);
+		__m256i yR2 = _mm256_set1_epi32(R2);
+		__m256i yRx = _mm256_set1_epi32(Rx);
+		for (; (j + 7) < num; j += 8) {
+			_mm256_storeu_si256((__m256i *)(dst + j),
+				zint_mod_small_signed_x8(d + j, len, stride,
+					yp, yp0i, yR2, yRx));
+		}
+	}
+	for (; j < num; j ++) {
+		dst[j] = zint_mod_small_signed(d + j, len, stride,
+			p, p0i, R2, Rx);
+	}
+}
+#endif
+
 /* see kgen_inner.h */
 void
 zint_add_mul_small(uint32_t *restrict x, size_t len, size_t xstride,
@@ -117,6 +285,42 @@ avx2_zint_add_mul_small_x8(uint32_t *restrict d, size_t len, size_t dstride,
 }
 #endif
 
+#if FNDSA_AVX512
+/* Like avx2_zint_add_mul_small_x8(), over 16 integers. */
+TARGET_AVX512
+static void
+avx512_zint_add_mul_small_x16(uint32_t *restrict d, size_t len,
+	size_t dstride, const uint32_t *restrict a, __m512i zs)
+{
+	__m512i cc0 = _mm512_setzero_si512();
+	__m512i cc1 = _mm512_setzero_si512();
+	__m512i zs0 = zs;
+	__m512i zs1 = _mm512_srli_epi64(zs, 32);
+	__m512i zw32 = _mm512_set1_epi64(0xFFFFFFFF);
+	__m512i zm31 = _mm512_set1_epi32(0x7FFFFFFF);
+	for (size_t i = 0; i < len; i ++) {
+		__m512i za = _mm512_set1_epi64(a[i]);
+		__m512i z0 = _mm512_mul_epu32(za, zs0);
+		__m512i z1 = _mm512_mul_epu32(za, zs1);
+		__m512i zd = _mm512_loadu_si512((const void *)d);
+		__m512i zd0 = _mm512_and_si512(zd, zw32);
+		__m512i zd1 = _mm512_srli_epi64(zd, 32);
+		z0 = _mm512_add_epi64(z0, _mm512_add_epi64(zd0, cc0));
+		z1 = _mm512_add_epi64(z1, _mm512_add_epi64(zd1, cc1));
+		cc0 = _mm512_srli_epi64(z0, 31);
+		cc1 = _mm512_srli_epi64(z1, 31);
+		zd = _mm512_mask_blend_epi32(0xAAAA,
+			z0, _mm512_slli_epi64(z1, 32));
+		_mm512_storeu_si512((void *)d, _mm512_and_si512(zd, zm31));
+		d += dstride;
+	}
+
+	_mm512_storeu_si512((void *)d,
+		_mm512_and_si512(_mm512_mask_blend_epi32(0xAAAA,
+			cc0, _mm512_slli_epi64(cc1, 32)), zm31));
+}
+#endif
+
 /* see kgen_inner.h */
 void
 zint_norm_zero(uint32_t *restrict x, size_t len, size_t xstride,
@@ -239,11 +443,46 @@ zint_norm_zero_x8(uint32_t *restrict x, size_t len, size_t xstride,
 }
 #endif
 
-/* see kgen_inner.h */
-void
-zint_rebuild_CRT(uint32_t *restrict xx, size_t xlen, size_t n,
-	size_t num_sets, int normalize_signed, uint32_t *restrict tmp)
+/* Context for zint_rebuild_CRT() tasks. The integers are numbered
+   across all sets (integer c is integer c % n of set c / n); each task
+   index covers gran consecutive integers. */
+typedef struct {
+	uint32_t *xx;
+	size_t xlen;
+	size_t n;
+	size_t num_sets;
+	int normalize_signed;
+	size_t gran;
+} rebuild_CRT_ctx;
+
+/* Get the range of integers j0 to j1-1 of set k which are part of the
+   integers c0 to c1-1 (numbered across all sets). */
+static inline void
+rebuild_CRT_range(size_t n, size_t k, size_t c0, size_t c1,
+	size_t *j0, size_t *j1)
 {
+	size_t u = k * n;
+	size_t v = u + n;
+	if (c1 <= u || c0 >= v) {
+		*j0 = 0;
+		*j1 = 0;
+		return;
+	}
+	*j0 = (c0 > u ? c0 : u) - u;
+	*j1 = (c1 < v ? c1 : v) - u;
+}
+
+static void
+rebuild_CRT_task(void *ctx, size_t start, size_t end, uint32_t *tmp)
+{
+	rebuild_CRT_ctx *rc = ctx;
+	uint32_t *xx = rc->xx;
+	size_t xlen = rc->xlen;
+	size_t n = rc->n;
+	size_t num_sets = rc->num_sets;
+	size_t c0 = start * rc->gran;
+	size_t c1 = end * rc->gran;
+
 	size_t uu = 0;
 	tmp[0] = PRIMES[0].p;
 	for (size_t i = 1; i < xlen; i ++) {
@@ -263,7 +502,9 @@ zint_rebuild_CRT(uint32_t *restrict xx, size_t xlen, size_t n,
 		uu += n;
 		size_t kk = 0;
 		for (size_t k = 0; k < num_sets; k ++) {
-			for (size_t j = 0; j < n; j ++) {
+			size_t j0, j1;
+			rebuild_CRT_range(n, k, c0, c1, &j0, &j1);
+			for (size_t j = j0; j < j1; j ++) {
 				/*
 				 * xp = the integer x modulo the prime p for
 				 *      this iteration
@@ -293,10 +534,12 @@ zint_rebuild_CRT(uint32_t *restrict xx, size_t xlen, size_t n,
 	/*
 	 * Normalize the reconstructed values around 0.
 	 */
-	if (normalize_signed) {
+	if (rc->normalize_signed) {
 		size_t kk = 0;
 		for (size_t k = 0; k < num_sets; k ++) {
-			for (size_t j = 0; j < n; j ++) {
+			size_t j0, j1;
+			rebuild_CRT_range(n, k, c0, c1, &j0, &j1);
+			for (size_t j = j0; j < j1; j ++) {
 				zint_norm_zero(xx + kk + j, xlen, n, tmp);
 			}
 			kk += n * xlen;
@@ -304,12 +547,38 @@ zint_rebuild_CRT(uint32_t *restrict xx, size_t xlen, size_t n,
 	}
 }
 
+/* see kgen_inner.h */
+void
+zint_rebuild_CRT(uint32_t *restrict xx, size_t xlen, size_t n,
+	size_t num_sets, int normalize_signed, uint32_t *restrict tmp,
+	kgen_pool *kp)
+{
+	/* Each integer is rebuilt independently of the others; only the
+	   product of the primes (in tmp[]) is shared, and each task
+	   recomputes it. */
+	rebuild_CRT_ctx rc;
+	rc.xx = xx;
+	rc.xlen = xlen;
+	rc.n = n;
+	rc.num_sets = num_sets;
+	rc.normalize_signed = normalize_signed;
+	rc.gran = 1;
+	kgen_run(kp, n * num_sets, xlen * xlen, rebuild_CRT_task, &rc, tmp);
+}
+
 #if FNDSA_AVX2
 TARGET_AVX2
-void
-avx2_zint_rebuild_CRT(uint32_t *restrict xx, size_t xlen, size_t n,
-	size_t num_sets, int normalize_signed, uint32_t *restrict tmp)
+static void
+avx2_rebuild_CRT_task(void *ctx, size_t start, size_t end, uint32_t *tmp)
 {
+	rebuild_CRT_ctx *rc = ctx;
+	uint32_t *xx = rc->xx;
+	size_t xlen = rc->xlen;
+	size_t n = rc->n;
+	size_t num_sets = rc->num_sets;
+	size_t c0 = start * rc->gran;
+	size_t c1 = end * rc->gran;
+
 	size_t uu = 0;
 	tmp[0] = PRIMES[0].p;
 	for (size_t i = 1; i < xlen; i ++) {
@@ -333,8 +602,10 @@ avx2_zint_rebuild_CRT(uint32_t *restrict xx, size_t xlen, size_t n,
 		uu += n;
 		size_t kk = 0;
 		for (size_t k = 0; k < num_sets; k ++) {
-			size_t j = 0;
-			for (; (j + 7) < n; j += 8) {
+			size_t j0, j1;
+			rebuild_CRT_range(n, k, c0, c1, &j0, &j1);
+			size_t j = j0;
+			for (; (j + 7) < j1; j += 8) {
 				__m256i y1 = _mm256_loadu_si256(
 					(__m256i *)(xx + kk + uu + j));
 				__m256i y2 = avx2_zint_mod_small_unsigned_x8(
@@ -344,7 +615,7 @@ avx2_zint_rebuild_CRT(uint32_t *restrict xx, size_t xlen, size_t n,
 				avx2_zint_add_mul_small_x8(
 					xx + kk + j, i, n, tmp, yr);
 			}
-			for (; j < n; j ++) {
+			for (; j < j1; j ++) {
 				/*
 				 * xp = the integer x modulo the prime p for
 				 *      this iteration
@@ -374,14 +645,88 @@ avx2_zint_rebuild_CRT(uint32_t *restrict xx, size_t xlen, size_t n,
 	/*
 	 * Normalize the reconstructed values around 0.
 	 */
-	if (normalize_signed) {
+	if (rc->normalize_signed) {
+		size_t kk = 0;
+		for (size_t k = 0; k < num_sets; k ++) {
+			size_t j0, j1;
+			rebuild_CRT_range(n, k, c0, c1, &j0, &j1);
+			size_t j = j0;
+			for (; (j + 7) < j1; j += 8) {
+				zint_norm_zero_x8(xx + kk + j, xlen, n, tmp);
+			}
+			for (; j < j1; j ++) {
+				zint_norm_zero(xx + kk + j, xlen, n, tmp);
+			}
+			kk += n * xlen;
+		}
+	}
+}
+
+#if FNDSA_AVX512
+/* Like avx2_rebuild_CRT_task(), with the integers processed in groups
+   of 16 (the task granularity is 16). */
+TARGET_AVX512
+static void
+avx512_rebuild_CRT_task(void *ctx, size_t start, size_t end, uint32_t *tmp)
+{
+	rebuild_CRT_ctx *rc = ctx;
+	uint32_t *xx = rc->xx;
+	size_t xlen = rc->xlen;
+	size_t n = rc->n;
+	size_t num_sets = rc->num_sets;
+	size_t c0 = start * rc->gran;
+	size_t c1 = end * rc->gran;
+
+	size_t uu = 0;
+	tmp[0] = PRIMES[0].p;
+	for (size_t i = 1; i < xlen; i ++) {
+		uint32_t p = PRIMES[i].p;
+		uint32_t p0i = PRIMES[i].p0i;
+		uint32_t R2 = PRIMES[i].R2;
+		uint32_t s = PRIMES[i].s;
+		__m512i zp = _mm512_set1_epi32(p);
+		__m512i zp0i = _mm512_set1_epi32(p0i);
+		__m512i zR2 = _mm512_set1_epi32(R2);
+		__m512i zs = _mm512_set1_epi32(s);
+		uu += n;
 		size_t kk = 0;
 		for (size_t k = 0; k < num_sets; k ++) {
-			size_t j = 0;
-			for (; (j + 7) < n; j += 8) {
+			size_t j0, j1;
+			rebuild_CRT_range(n, k, c0, c1, &j0, &j1);
+			size_t j = j0;
+			for (; (j + 15) < j1; j += 16) {
+				__m512i z1 = _mm512_loadu_si512(
+					(const void *)(xx + kk + uu + j));
+				__m512i z2 = avx512_zint_mod_small_unsigned_x16(
+					xx + kk + j, i, n, zp, zp0i, zR2);
+				__m512i zr = mp_mmul_x16(zs,
+					mp_sub_x16(z1, z2, zp), zp, zp0i);
+				avx512_zint_add_mul_small_x16(
+					xx + kk + j, i, n, tmp, zr);
+			}
+			for (; j < j1; j ++) {
+				uint32_t xp = xx[kk + j + uu];
+				uint32_t xq = zint_mod_small_unsigned(
+					xx + kk + j, i, n, p, p0i, R2);
+				uint32_t xr = mp_mmul(
+					s, mp_sub(xp, xq, p), p, p0i);
+				zint_add_mul_small(xx + kk + j, i, n, tmp, xr);
+			}
+			kk += n * xlen;
+		}
+		tmp[i] = zint_mul_small(tmp, i, p);
+	}
+
+	if (rc->normalize_signed) {
+		size_t kk = 0;
+		for (size_t k = 0; k < num_sets; k ++) {
+			size_t j0, j1;
+			rebuild_CRT_range(n, k, c0, c1, &j0, &j1);
+			size_t j = j0;
+			for (; (j + 7) < j1; j += 8) {
 				zint_norm_zero_x8(xx + kk + j, xlen, n, tmp);
 			}
-			for (; j < n; j ++) {
+			for (; j < j1; j ++) {
 				zint_norm_zero(xx + kk + j, xlen, n, tmp);
 			}
 			kk += n * xlen;
@@ -390,6 +735,35 @@ avx2_zint_rebuild_CRT(uint32_t *restrict xx, size_t xlen, size_t n,
 }
 #endif
 
+TARGET_AVX2
+void
+avx2_zint_rebuild_CRT(uint32_t *restrict xx, size_t xlen, size_t n,
+	size_t num_sets, int normalize_signed, uint32_t *restrict tmp,
+	kgen_pool *kp)
+{
+	/* Tasks work on groups of 8 integers (16 with AVX-512, when the
+	   degree allows it), so that the split does not prevent
+	   vectorization. */
+	rebuild_CRT_ctx rc;
+	rc.xx = xx;
+	rc.xlen = xlen;
+	rc.n = n;
+	rc.num_sets = num_sets;
+	rc.normalize_signed = normalize_signed;
+#if FNDSA_AVX512
+	if (n >= 16 && has_avx512()) {
+		rc.gran = 16;
+		kgen_run(kp, (n * num_sets) >> 4, 16 * xlen * xlen,
+			avx512_rebuild_CRT_task, &rc, tmp);
+		return;
+	}
+#endif
+	rc.gran = n >= 8 ? 8 : 1;
+	kgen_run(kp, (n * num_sets) / rc.gran, rc.gran * xlen * xlen,
+		avx2_rebuild_CRT_task, &rc, tmp);
+}
+#endif
+
 /* see kgen_inner.h */
 void
 zint_negate(uint32_t *a, size_t len, uint32_t ctl)
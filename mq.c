@@ -10,6 +10,9 @@
 /* -1/q mod 2^32 */
 #define Q1I   4143984639
 
+/* 2^32 mod q (i.e. 1 in Montgomery representation) */
+#define R1         10952
+
 /* 2^64 mod q */
 #define R2          5664
 
@@ -133,6 +136,19 @@ mq_div(uint32_t x, uint32_t y)
 	return mq_mmul(x, iy);
 }
 
+/* Return 0xFFFFFFFF if x != 0 mod q, 0 otherwise (x in internal
+   representation). */
+static inline uint32_t
+mq_nonzero_mask(uint32_t x)
+{
+#if FNDSA_ASM_CORTEXM4
+	/* In a relaxed representation, both x = 0 and x = q are zero. */
+	return -(((x - Q) & -x) >> 31);
+#else
+	return -((x - Q) >> 31);
+#endif
+}
+
 #if FNDSA_AVX2
 
 TARGET_AVX2
@@ -242,6 +258,108 @@ mq_div_x16(__m256i x, __m256i y)
 
 #endif
 
+#if FNDSA_AVX512
+/* AVX-512BW versions of the helpers above, with 32 lanes. */
+
+TARGET_AVX512BW
+static inline __m512i
+mq_add_x32(__m512i x, __m512i y)
+{
+	__m512i qq = _mm512_set1_epi16(Q);
+	__m512i a = _mm512_sub_epi16(qq, _mm512_add_epi16(x, y));
+	__m512i b = _mm512_add_epi16(a,
+		_mm512_and_si512(qq, _mm512_srai_epi16(a, 15)));
+	return _mm512_sub_epi16(qq, b);
+}
+
+TARGET_AVX512BW
+static inline __m512i
+mq_sub_x32(__m512i x, __m512i y)
+{
+	__m512i qq = _mm512_set1_epi16(Q);
+	__m512i a = _mm512_sub_epi16(y, x);
+	__m512i b = _mm512_add_epi16(a,
+		_mm512_and_si512(qq, _mm512_srai_epi16(a, 15)));
+	return _mm512_sub_epi16(qq, b);
+}
+
+TARGET_AVX512BW
+static inline __m512i
+mq_half_x32(__m512i x)
+{
+	__mmask32 m = _mm512_test_epi16_mask(x, _mm512_set1_epi16(1));
+	x = _mm512_mask_add_epi16(x, m, x, _mm512_set1_epi16(Q));
+	return _mm512_srli_epi16(x, 1);
+}
+
+TARGET_AVX512BW
+static inline __m512i
+mq_mred_x32(__m512i lo, __m512i hi)
+{
+	__m512i qx32 = _mm512_set1_epi16(Q);
+	__m512i q1ilox32 = _mm512_set1_epi16(Q1Ilo);
+	__m512i q1ihix32 = _mm512_set1_epi16(Q1Ihi);
+
+	/* Same computations as mq_mred_x16(). */
+	__m512i x = _mm512_add_epi16(
+		_mm512_add_epi16(
+			_mm512_mulhi_epu16(lo, q1ilox32),
+			_mm512_mullo_epi16(lo, q1ihix32)),
+		_mm512_mullo_epi16(hi, q1ilox32));
+	x = _mm512_mulhi_epu16(x, qx32);
+	return _mm512_add_epi16(x, _mm512_set1_epi16(1));
+}
+
+TARGET_AVX512BW
+static inline __m512i
+mq_mmul_x32(__m512i x, __m512i y)
+{
+	return mq_mred_x32(_mm512_mullo_epi16(x, y), _mm512_mulhi_epu16(x, y));
+}
+
+TARGET_AVX512BW
+static __m512i
+mq_div_x32(__m512i x, __m512i y)
+{
+	/* Convert y to Montgomery representation. */
+	y = mq_mmul_x32(y, _mm512_set1_epi16(R2));
+
+	/* 1/y = y^(q-2), with the same addition chain as mq_div(). */
+	__m512i y2 = mq_mmul_x32(y, y);
+	__m512i y3 = mq_mmul_x32(y2, y);
+	__m512i y5 = mq_mmul_x32(y3, y2);
+	__m512i y10 = mq_mmul_x32(y5, y5);
+	__m512i y20 = mq_mmul_x32(y10, y10);
+	__m512i y40 = mq_mmul_x32(y20, y20);
+	__m512i y80 = mq_mmul_x32(y40, y40);
+	__m512i y160 = mq_mmul_x32(y80, y80);
+	__m512i y163 = mq_mmul_x32(y160, y3);
+	__m512i y323 = mq_mmul_x32(y163, y160);
+	__m512i y646 = mq_mmul_x32(y323, y323);
+	__m512i y1292 = mq_mmul_x32(y646, y646);
+	__m512i y1455 = mq_mmul_x32(y1292, y163);
+	__m512i y2910 = mq_mmul_x32(y1455, y1455);
+	__m512i y5820 = mq_mmul_x32(y2910, y2910);
+	__m512i y6143 = mq_mmul_x32(y5820, y323);
+	__m512i y12286 = mq_mmul_x32(y6143, y6143);
+	__m512i iy = mq_mmul_x32(y12286, y);
+	return mq_mmul_x32(x, iy);
+}
+
+/* Broadcast each of the first 32 >> s 16-bit words of x into 2^s
+   consecutive lanes (1 <= s <= 4). */
+TARGET_AVX512BW
+static inline __m512i
+mq_spread_x32(__m512i x, int s)
+{
+	__m512i idx = _mm512_srl_epi16(_mm512_set_epi16(
+		31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16,
+		15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0),
+		_mm_cvtsi32_si128(s));
+	return _mm512_permutexvar_epi16(idx, x);
+}
+#endif
+
 #if !FNDSA_ASM_CORTEXM4
 /* see inner.h */
 void
@@ -327,6 +445,28 @@ avx2_mqpoly_signed_to_int(unsigned logn, uint16_t *d)
 }
 #endif
 
+#if FNDSA_AVX512
+TARGET_AVX512BW
+void
+avx512_mqpoly_signed_to_int(unsigned logn, uint16_t *d)
+{
+	if (logn < 6) {
+		avx2_mqpoly_signed_to_int(logn, d);
+		return;
+	}
+	__m512i *dp = (__m512i *)d;
+	__m512i qq = _mm512_set1_epi16(Q);
+	for (size_t i = 0; i < (1u << (logn - 5)); i ++) {
+		__m512i z = _mm512_loadu_si512(dp + i);
+		z = _mm512_sub_epi16(_mm512_setzero_si512(), z);
+		z = _mm512_add_epi16(z,
+			_mm512_and_si512(qq, _mm512_srai_epi16(z, 15)));
+		z = _mm512_sub_epi16(qq, z);
+		_mm512_storeu_si512(dp + i, z);
+	}
+}
+#endif
+
 /* see inner.h */
 int
 mqpoly_int_to_small(unsigned logn, const uint16_t *d, int8_t *f)
@@ -431,6 +571,27 @@ avx2_mqpoly_ext_to_int(unsigned logn, uint16_t *d)
 }
 #endif
 
+#if FNDSA_AVX512
+TARGET_AVX512BW
+void
+avx512_mqpoly_ext_to_int(unsigned logn, uint16_t *d)
+{
+	if (logn < 6) {
+		avx2_mqpoly_ext_to_int(logn, d);
+		return;
+	}
+	__m512i *dp = (__m512i *)d;
+	__m512i qq = _mm512_set1_epi16(Q);
+	for (size_t i = 0; i < (1u << (logn - 5)); i ++) {
+		__m512i z = _mm512_loadu_si512(dp + i);
+		__mmask32 m = _mm512_cmpeq_epi16_mask(z,
+			_mm512_setzero_si512());
+		z = _mm512_mask_add_epi16(z, m, z, qq);
+		_mm512_storeu_si512(dp + i, z);
+	}
+}
+#endif
+
 #if !FNDSA_ASM_CORTEXM4
 /* see inner.h */
 void
@@ -470,6 +631,26 @@ avx2_mqpoly_int_to_ext(unsigned logn, uint16_t *d)
 }
 #endif
 
+#if FNDSA_AVX512
+TARGET_AVX512BW
+void
+avx512_mqpoly_int_to_ext(unsigned logn, uint16_t *d)
+{
+	if (logn < 6) {
+		avx2_mqpoly_int_to_ext(logn, d);
+		return;
+	}
+	__m512i *dp = (__m512i *)d;
+	__m512i qq = _mm512_set1_epi16(Q);
+	for (size_t i = 0; i < (1u << (logn - 5)); i ++) {
+		__m512i z = _mm512_loadu_si512(dp + i);
+		__mmask32 m = _mm512_cmpeq_epi16_mask(z, qq);
+		z = _mm512_mask_sub_epi16(z, m, z, qq);
+		_mm512_storeu_si512(dp + i, z);
+	}
+}
+#endif
+
 #if !FNDSA_ASM_CORTEXM4
 /* see inner.h */
 void
@@ -654,6 +835,138 @@ avx2_mqpoly_int_to_ntt(unsigned logn, uint16_t *d)
 }
 #endif
 
+#if FNDSA_AVX512
+/* Last five NTT layers for two consecutive 32-coefficient blocks, whose
+   twiddle factors start at indices k and k + 1. The first block is in
+   the low 256-bit halves of *a0 (coefficients 0 to 15) and *a1
+   (coefficients 16 to 31), the second block in the high halves; within
+   each half, the computations are the same as in avx2_NTT32(). Twiddle
+   factors of both blocks are consecutive in mq_GM[], so that they are
+   obtained with a single load and a word permutation. */
+TARGET_AVX512BW
+static inline void
+avx512_NTT32x2(__m512i *a0, __m512i *a1, size_t k)
+{
+	__m512i za0, za1, zt1, zt2, zt3, zt4, zg, zsk, zplo, zphi;
+
+	za0 = *a0;
+	za1 = *a1;
+
+	/* Selection of the 128-bit lanes 0 (resp. 1) of each 256-bit
+	   half of both inputs (same as _mm256_permute2x128_si256() with
+	   0x20 and 0x31, respectively). */
+	zplo = _mm512_setr_epi64(0, 1, 8, 9, 4, 5, 12, 13);
+	zphi = _mm512_setr_epi64(2, 3, 10, 11, 6, 7, 14, 15);
+
+	/* t = 32, m = 1 */
+	zg = _mm512_inserti64x4(_mm512_set1_epi16(mq_GM[k]),
+		_mm256_set1_epi16(mq_GM[k + 1]), 1);
+	zt1 = za0;
+	zt2 = mq_mmul_x32(za1, zg);
+	za0 = mq_add_x32(zt1, zt2);
+	za1 = mq_sub_x32(zt1, zt2);
+
+	/* t = 16, m = 2 */
+	zt1 = _mm512_permutex2var_epi64(za0, zplo, za1);
+	zt2 = _mm512_permutex2var_epi64(za0, zphi, za1);
+	zg = mq_spread_x32(_mm512_castsi128_si512(
+		_mm_loadl_epi64((const __m128i *)(mq_GM + (k << 1)))), 3);
+	zt2 = mq_mmul_x32(zt2, zg);
+	za0 = mq_add_x32(zt1, zt2);
+	za1 = mq_sub_x32(zt1, zt2);
+
+	/* t = 8, m = 4 */
+	zt1 = _mm512_unpacklo_epi64(za0, za1);
+	zt2 = _mm512_unpackhi_epi64(za0, za1);
+	zg = mq_spread_x32(_mm512_castsi128_si512(
+		_mm_loadu_si128((const __m128i *)(mq_GM + (k << 2)))), 2);
+	zt2 = mq_mmul_x32(zt2, zg);
+	za0 = mq_add_x32(zt1, zt2);
+	za1 = mq_sub_x32(zt1, zt2);
+
+	/* t = 4, m = 8 */
+	zt3 = _mm512_shuffle_epi32(za0, (_MM_PERM_ENUM)0xD8);
+	zt4 = _mm512_shuffle_epi32(za1, (_MM_PERM_ENUM)0xD8);
+	zt1 = _mm512_unpacklo_epi32(zt3, zt4);
+	zt2 = _mm512_unpackhi_epi32(zt3, zt4);
+	zg = mq_spread_x32(_mm512_castsi256_si512(
+		_mm256_loadu_si256((const __m256i *)(mq_GM + (k << 3)))), 1);
+	zt2 = mq_mmul_x32(zt2, zg);
+	za0 = mq_add_x32(zt1, zt2);
+	za1 = mq_sub_x32(zt1, zt2);
+
+	/* t = 2, m = 16 */
+	zsk = _mm512_broadcast_i32x4(_mm_setr_epi8(
+		0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15));
+	zt3 = _mm512_shuffle_epi8(za0, zsk);
+	zt4 = _mm512_shuffle_epi8(za1, zsk);
+	zt1 = _mm512_unpacklo_epi16(zt3, zt4);
+	zt2 = _mm512_unpackhi_epi16(zt3, zt4);
+	zg = _mm512_loadu_si512((const void *)(mq_GM + (k << 4)));
+	zt2 = mq_mmul_x32(zt2, zg);
+	za0 = mq_add_x32(zt1, zt2);
+	za1 = mq_sub_x32(zt1, zt2);
+
+	zt1 = _mm512_unpacklo_epi16(za0, za1);
+	zt2 = _mm512_unpackhi_epi16(za0, za1);
+	za0 = _mm512_permutex2var_epi64(zt1, zplo, zt2);
+	za1 = _mm512_permutex2var_epi64(zt1, zphi, zt2);
+
+	*a0 = za0;
+	*a1 = za1;
+}
+
+TARGET_AVX512BW
+void
+avx512_mqpoly_int_to_ntt(unsigned logn, uint16_t *d)
+{
+	if (logn < 6) {
+		avx2_mqpoly_int_to_ntt(logn, d);
+		return;
+	}
+	__m512i *dp = (__m512i *)d;
+	size_t n = (size_t)1 << logn;
+	size_t t = n >> 5;
+	for (unsigned lm = 0; lm < (logn - 5); lm ++) {
+		size_t m = (size_t)1 << lm;
+		size_t ht = t >> 1;
+		size_t j0 = 0;
+		for (size_t i = 0; i < m; i ++) {
+			__m512i zs = _mm512_set1_epi16(mq_GM[i + m]);
+			for (size_t j = 0; j < ht; j ++) {
+				size_t j1 = j0 + j;
+				size_t j2 = j1 + ht;
+				__m512i z1, z2;
+				z1 = _mm512_loadu_si512(dp + j1);
+				z2 = _mm512_loadu_si512(dp + j2);
+				z2 = mq_mmul_x32(z2, zs);
+				_mm512_storeu_si512(dp + j1, mq_add_x32(z1, z2));
+				_mm512_storeu_si512(dp + j2, mq_sub_x32(z1, z2));
+			}
+			j0 += t;
+		}
+		t = ht;
+	}
+
+	/* Each 512-bit word contains one 32-coefficient block; two
+	   consecutive blocks are processed together. */
+	size_t m = n >> 5;
+	__m512i zsel0 = _mm512_setr_epi64(0, 1, 2, 3, 8, 9, 10, 11);
+	__m512i zsel1 = _mm512_setr_epi64(4, 5, 6, 7, 12, 13, 14, 15);
+	for (size_t i = 0; i < m; i += 2) {
+		__m512i zb0 = _mm512_loadu_si512(dp + i);
+		__m512i zb1 = _mm512_loadu_si512(dp + i + 1);
+		__m512i za0 = _mm512_permutex2var_epi64(zb0, zsel0, zb1);
+		__m512i za1 = _mm512_permutex2var_epi64(zb0, zsel1, zb1);
+		avx512_NTT32x2(&za0, &za1, i + m);
+		_mm512_storeu_si512(dp + i,
+			_mm512_permutex2var_epi64(za0, zsel0, za1));
+		_mm512_storeu_si512(dp + i + 1,
+			_mm512_permutex2var_epi64(za0, zsel1, za1));
+	}
+}
+#endif
+
 #if !FNDSA_ASM_CORTEXM4
 /* see inner.h */
 void
@@ -838,6 +1151,118 @@ avx2_mqpoly_ntt_to_int(unsigned logn, uint16_t *d)
 }
 #endif
 
+#if FNDSA_AVX512
+/* Inverse of avx512_NTT32x2() (first five layers of the inverse NTT,
+   for two consecutive 32-coefficient blocks), with the same layout;
+   the computations mirror avx2_iNTT32(). */
+TARGET_AVX512BW
+static inline void
+avx512_iNTT32x2(__m512i *a0, __m512i *a1, size_t k)
+{
+	__m512i za0, za1, zt1, zt2, zt3, zt4, zig, zsk, zplo, zphi;
+
+	za0 = *a0;
+	za1 = *a1;
+	zplo = _mm512_setr_epi64(0, 1, 8, 9, 4, 5, 12, 13);
+	zphi = _mm512_setr_epi64(2, 3, 10, 11, 6, 7, 14, 15);
+
+	zt1 = _mm512_permutex2var_epi64(za0, zplo, za1);
+	zt2 = _mm512_permutex2var_epi64(za0, zphi, za1);
+	zsk = _mm512_broadcast_i32x4(_mm_setr_epi8(
+		0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15));
+	zt3 = _mm512_shuffle_epi8(zt1, zsk);
+	zt4 = _mm512_shuffle_epi8(zt2, zsk);
+	zt1 = _mm512_unpacklo_epi64(zt3, zt4);
+	zt2 = _mm512_unpackhi_epi64(zt3, zt4);
+	zig = _mm512_loadu_si512((const void *)(mq_iGM + (k << 4)));
+	za0 = mq_half_x32(mq_add_x32(zt1, zt2));
+	za1 = mq_mmul_x32(mq_sub_x32(zt1, zt2), zig);
+
+	zt1 = _mm512_mask_blend_epi16(0xAAAAAAAA,
+		za0, _mm512_slli_epi32(za1, 16));
+	zt2 = _mm512_mask_blend_epi16(0xAAAAAAAA,
+		_mm512_srli_epi32(za0, 16), za1);
+	zig = mq_spread_x32(_mm512_castsi256_si512(
+		_mm256_loadu_si256((const __m256i *)(mq_iGM + (k << 3)))), 1);
+	za0 = mq_half_x32(mq_add_x32(zt1, zt2));
+	za1 = mq_mmul_x32(mq_sub_x32(zt1, zt2), zig);
+
+	zt1 = _mm512_mask_blend_epi16(0xCCCCCCCC,
+		za0, _mm512_slli_epi64(za1, 32));
+	zt2 = _mm512_mask_blend_epi16(0xCCCCCCCC,
+		_mm512_srli_epi64(za0, 32), za1);
+	zig = mq_spread_x32(_mm512_castsi128_si512(
+		_mm_loadu_si128((const __m128i *)(mq_iGM + (k << 2)))), 2);
+	za0 = mq_half_x32(mq_add_x32(zt1, zt2));
+	za1 = mq_mmul_x32(mq_sub_x32(zt1, zt2), zig);
+
+	zt1 = _mm512_unpacklo_epi64(za0, za1);
+	zt2 = _mm512_unpackhi_epi64(za0, za1);
+	zig = mq_spread_x32(_mm512_castsi128_si512(
+		_mm_loadl_epi64((const __m128i *)(mq_iGM + (k << 1)))), 3);
+	za0 = mq_half_x32(mq_add_x32(zt1, zt2));
+	za1 = mq_mmul_x32(mq_sub_x32(zt1, zt2), zig);
+
+	zt1 = _mm512_permutex2var_epi64(za0, zplo, za1);
+	zt2 = _mm512_permutex2var_epi64(za0, zphi, za1);
+	zig = _mm512_inserti64x4(_mm512_set1_epi16(mq_iGM[k]),
+		_mm256_set1_epi16(mq_iGM[k + 1]), 1);
+	za0 = mq_half_x32(mq_add_x32(zt1, zt2));
+	za1 = mq_mmul_x32(mq_sub_x32(zt1, zt2), zig);
+
+	*a0 = za0;
+	*a1 = za1;
+}
+
+TARGET_AVX512BW
+void
+avx512_mqpoly_ntt_to_int(unsigned logn, uint16_t *d)
+{
+	if (logn < 6) {
+		avx2_mqpoly_ntt_to_int(logn, d);
+		return;
+	}
+	__m512i *dp = (__m512i *)d;
+	size_t n = (size_t)1 << logn;
+	size_t m = n >> 5;
+	__m512i zsel0 = _mm512_setr_epi64(0, 1, 2, 3, 8, 9, 10, 11);
+	__m512i zsel1 = _mm512_setr_epi64(4, 5, 6, 7, 12, 13, 14, 15);
+	for (size_t i = 0; i < m; i += 2) {
+		__m512i zb0 = _mm512_loadu_si512(dp + i);
+		__m512i zb1 = _mm512_loadu_si512(dp + i + 1);
+		__m512i za0 = _mm512_permutex2var_epi64(zb0, zsel0, zb1);
+		__m512i za1 = _mm512_permutex2var_epi64(zb0, zsel1, zb1);
+		avx512_iNTT32x2(&za0, &za1, i + m);
+		_mm512_storeu_si512(dp + i,
+			_mm512_permutex2var_epi64(za0, zsel0, za1));
+		_mm512_storeu_si512(dp + i + 1,
+			_mm512_permutex2var_epi64(za0, zsel1, za1));
+	}
+	size_t t = 1;
+	for (unsigned lm = 5; lm < logn; lm ++) {
+		size_t hm = (size_t)1 << (logn - 1 - lm);
+		size_t dt = t << 1;
+		size_t j0 = 0;
+		for (size_t i = 0; i < hm; i ++) {
+			__m512i zs = _mm512_set1_epi16(mq_iGM[i + hm]);
+			for (size_t j = 0; j < t; j ++) {
+				size_t j1 = j0 + j;
+				size_t j2 = j1 + t;
+				__m512i z1, z2;
+				z1 = _mm512_loadu_si512(dp + j1);
+				z2 = _mm512_loadu_si512(dp + j2);
+				_mm512_storeu_si512(dp + j1,
+					mq_half_x32(mq_add_x32(z1, z2)));
+				_mm512_storeu_si512(dp + j2,
+					mq_mmul_x32(zs, mq_sub_x32(z1, z2)));
+			}
+			j0 += dt;
+		}
+		t = dt;
+	}
+}
+#endif
+
 #if !FNDSA_ASM_CORTEXM4
 /* see inner.h */
 void
@@ -874,23 +1299,67 @@ avx2_mqpoly_mul_ntt(unsigned logn, uint16_t *a, const uint16_t *b)
 }
 #endif
 
+#if FNDSA_AVX512
+TARGET_AVX512BW
+void
+avx512_mqpoly_mul_ntt(unsigned logn, uint16_t *a, const uint16_t *b)
+{
+	if (logn < 6) {
+		avx2_mqpoly_mul_ntt(logn, a, b);
+		return;
+	}
+	__m512i *ap = (__m512i *)a;
+	const __m512i *bp = (const __m512i *)b;
+	__m512i zR2 = _mm512_set1_epi16(R2);
+	for (size_t i = 0; i < (1u << (logn - 5)); i ++) {
+		__m512i za = _mm512_loadu_si512(ap + i);
+		__m512i zb = _mm512_loadu_si512(bp + i);
+		za = mq_mmul_x32(mq_mmul_x32(za, zb), zR2);
+		_mm512_storeu_si512(ap + i, za);
+	}
+}
+#endif
+
 /* see inner.h */
 int
 mqpoly_div_ntt(unsigned logn, uint16_t *a, const uint16_t *b)
 {
+	/* We use Montgomery's trick so that only one inversion is
+	   computed. Let P_i = b_0*b_1*...*b_i; then 1/b_i = P_{i-1}/P_i.
+	   In a first pass, we replace each a_i with a_i*P_{i-1}. We then
+	   invert P_{n-1}, and in a second pass (backwards), we multiply
+	   each a_i by 1/P_i, obtaining 1/P_{i-1} = b_i/P_i for the next
+	   step.
+
+	   All products use Montgomery multiplication; with p starting
+	   at R = 2^32 mod q, the first pass keeps p = P_i/R^i and sets
+	   a_i to a_i*P_{i-1}/R^i. The second pass then keeps j = R*R^i/P_i,
+	   so that mq_mmul(a_i, j) = a_i/b_i.
+
+	   Zero coefficients of b would make the whole product zero; they
+	   are replaced with R (i.e. 1 in Montgomery representation), and
+	   the corresponding output coefficients are set to zero. */
 	size_t n = (size_t)1 << logn;
 	uint32_t r = 0xFFFFFFFF;
+	uint32_t p = R1;
 	for (size_t i = 0; i < n; i ++) {
 		uint32_t x = b[i];
-#if FNDSA_ASM_CORTEXM4
-		/* In a relaxed representation, we want to detect both
-		   x = 0 and x = q. */
-		r &= -x;
-#endif
-		r &= x - Q;
-		a[i] = (uint16_t)mq_div(a[i], x);
+		uint32_t m = mq_nonzero_mask(x);
+		r &= m;
+		x = R1 ^ (m & (x ^ R1));
+		a[i] = (uint16_t)mq_mmul(a[i], p);
+		p = mq_mmul(p, x);
 	}
-	return (r >> 16) != 0;
+	uint32_t j = mq_div(R1, p);
+	for (size_t i = n; i -- > 0;) {
+		uint32_t x = b[i];
+		uint32_t m = mq_nonzero_mask(x);
+		x = R1 ^ (m & (x ^ R1));
+		uint32_t y = mq_mmul(a[i], j);
+		a[i] = (uint16_t)(Q ^ (m & (y ^ Q)));
+		j = mq_mmul(j, x);
+	}
+	return (int)(r & 1);
 }
 
 #if FNDSA_AVX2
@@ -898,30 +1367,77 @@ TARGET_AVX2
 int
 avx2_mqpoly_div_ntt(unsigned logn, uint16_t *a, const uint16_t *b)
 {
-	if (logn >= 4) {
-		__m256i *ap = (__m256i *)a;
-		const __m256i *bp = (const __m256i *)b;
-		__m256i qq = _mm256_set1_epi16(Q);
-		__m256i ov = _mm256_set1_epi16(-1);
-		for (size_t i = 0; i < (1u << (logn - 4)); i ++) {
-			__m256i ya = _mm256_loadu_si256(ap + i);
-			__m256i yb = _mm256_loadu_si256(bp + i);
-			ya = mq_div_x16(ya, yb);
-			_mm256_storeu_si256(ap + i, ya);
-			ov = _mm256_and_si256(ov, _mm256_sub_epi16(yb, qq));
-		}
-		uint32_t r = (uint32_t)_mm256_movemask_epi8(ov);
-		return (r & 0xAAAAAAAA) == 0xAAAAAAAA;
-	} else {
-		size_t n = (size_t)1 << logn;
-		uint32_t r = 0xFFFFFFFF;
-		for (size_t i = 0; i < n; i ++) {
-			uint32_t x = b[i];
-			r &= x - Q;
-			a[i] = (uint16_t)mq_div(a[i], x);
-		}
-		return (r >> 16) != 0;
+	if (logn < 4) {
+		return mqpoly_div_ntt(logn, a, b);
+	}
+
+	/* Same method as mqpoly_div_ntt(), with 16 independent products
+	   (one per lane) and a single vectorized inversion. */
+	__m256i *ap = (__m256i *)a;
+	const __m256i *bp = (const __m256i *)b;
+	size_t nv = (size_t)1 << (logn - 4);
+	__m256i qq = _mm256_set1_epi16(Q);
+	__m256i r1 = _mm256_set1_epi16(R1);
+	__m256i yr = _mm256_setzero_si256();
+	__m256i yp = r1;
+	for (size_t i = 0; i < nv; i ++) {
+		__m256i yb = _mm256_loadu_si256(bp + i);
+		__m256i ym = _mm256_cmpeq_epi16(yb, qq);
+		yr = _mm256_or_si256(yr, ym);
+		yb = _mm256_blendv_epi8(yb, r1, ym);
+		__m256i ya = _mm256_loadu_si256(ap + i);
+		_mm256_storeu_si256(ap + i, mq_mmul_x16(ya, yp));
+		yp = mq_mmul_x16(yp, yb);
+	}
+	__m256i yj = mq_div_x16(r1, yp);
+	for (size_t i = nv; i -- > 0;) {
+		__m256i yb = _mm256_loadu_si256(bp + i);
+		__m256i ym = _mm256_cmpeq_epi16(yb, qq);
+		yb = _mm256_blendv_epi8(yb, r1, ym);
+		__m256i ya = mq_mmul_x16(_mm256_loadu_si256(ap + i), yj);
+		_mm256_storeu_si256(ap + i, _mm256_blendv_epi8(ya, qq, ym));
+		yj = mq_mmul_x16(yj, yb);
+	}
+	return _mm256_testz_si256(yr, yr);
+}
+#endif
+
+#if FNDSA_AVX512
+TARGET_AVX512BW
+int
+avx512_mqpoly_div_ntt(unsigned logn, uint16_t *a, const uint16_t *b)
+{
+	if (logn < 6) {
+		return avx2_mqpoly_div_ntt(logn, a, b);
+	}
+
+	/* Same method as mqpoly_div_ntt(), with 32 lanes. */
+	__m512i *ap = (__m512i *)a;
+	const __m512i *bp = (const __m512i *)b;
+	size_t nv = (size_t)1 << (logn - 5);
+	__m512i qq = _mm512_set1_epi16(Q);
+	__m512i r1 = _mm512_set1_epi16(R1);
+	__mmask32 bad = 0;
+	__m512i zp = r1;
+	for (size_t i = 0; i < nv; i ++) {
+		__m512i zb = _mm512_loadu_si512(bp + i);
+		__mmask32 zm = _mm512_cmpeq_epu16_mask(zb, qq);
+		bad |= zm;
+		zb = _mm512_mask_blend_epi16(zm, zb, r1);
+		__m512i za = _mm512_loadu_si512(ap + i);
+		_mm512_storeu_si512(ap + i, mq_mmul_x32(za, zp));
+		zp = mq_mmul_x32(zp, zb);
+	}
+	__m512i zj = mq_div_x32(r1, zp);
+	for (size_t i = nv; i -- > 0;) {
+		__m512i zb = _mm512_loadu_si512(bp + i);
+		__mmask32 zm = _mm512_cmpeq_epu16_mask(zb, qq);
+		zb = _mm512_mask_blend_epi16(zm, zb, r1);
+		__m512i za = mq_mmul_x32(_mm512_loadu_si512(ap + i), zj);
+		_mm512_storeu_si512(ap + i, _mm512_mask_blend_epi16(zm, za, qq));
+		zj = mq_mmul_x32(zj, zb);
 	}
+	return bad == 0;
 }
 #endif
 
@@ -972,6 +1488,25 @@ avx2_mqpoly_sub(unsigned logn, uint16_t *a, const uint16_t *b)
 }
 #endif
 
+#if FNDSA_AVX512
+TARGET_AVX512BW
+void
+avx512_mqpoly_sub(unsigned logn, uint16_t *a, const uint16_t *b)
+{
+	if (logn < 6) {
+		avx2_mqpoly_sub(logn, a, b);
+		return;
+	}
+	__m512i *ap = (__m512i *)a;
+	const __m512i *bp = (const __m512i *)b;
+	for (size_t i = 0; i < (1u << (logn - 5)); i ++) {
+		__m512i za = _mm512_loadu_si512(ap + i);
+		__m512i zb = _mm512_loadu_si512(bp + i);
+		_mm512_storeu_si512(ap + i, mq_sub_x32(za, zb));
+	}
+}
+#endif
+
 /* see inner.h */
 int
 mqpoly_is_invertible(unsigned logn, const int8_t *f, uint16_t *tmp)
@@ -1167,6 +1702,40 @@ avx2_mqpoly_sqnorm_ext(unsigned logn, const uint16_t *a)
 }
 #endif
 
+#if FNDSA_AVX512
+TARGET_AVX512BW
+uint32_t
+avx512_mqpoly_sqnorm_ext(unsigned logn, const uint16_t *a)
+{
+	if (logn < 6) {
+		return avx2_mqpoly_sqnorm_ext(logn, a);
+	}
+	const __m512i *ap = (const __m512i *)a;
+	__m512i zs = _mm512_setzero_si512();
+	__m512i qq = _mm512_set1_epi16(Q);
+	__m512i hq = _mm512_set1_epi16((Q - 1) >> 1);
+	for (size_t i = 0; i < (1u << (logn - 5)); i ++) {
+		__m512i z = _mm512_loadu_si512(ap + i);
+
+		/* Normalize to [-q/2,+q/2], then add the squares, by
+		   pairs. Each 32-bit slot receives at most 32 pairs
+		   (for n = 1024), i.e. at most 64*6144^2 < 2^32: the
+		   slots cannot overflow. */
+		__mmask32 m = _mm512_cmpgt_epi16_mask(z, hq);
+		z = _mm512_mask_sub_epi16(z, m, z, qq);
+		zs = _mm512_add_epi32(zs, _mm512_madd_epi16(z, z));
+	}
+
+	/* Add the slots over 64 bits, and saturate to 2^32-1 if the sum
+	   is 2^31 or more. */
+	__m512i zt = _mm512_add_epi64(
+		_mm512_cvtepu32_epi64(_mm512_castsi512_si256(zs)),
+		_mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(zs, 1)));
+	uint64_t r = (uint64_t)_mm512_reduce_add_epi64(zt);
+	return r < ((uint64_t)1 << 31) ? (uint32_t)r : 0xFFFFFFFF;
+}
+#endif
+
 #if !FNDSA_ASM_CORTEXM4
 /* see inner.h */
 uint32_t
@@ -1218,6 +1787,24 @@ avx2_mqpoly_sqnorm_signed(unsigned logn, const uint16_t *a)
 }
 #endif
 
+#if FNDSA_AVX512
+TARGET_AVX512BW
+uint32_t
+avx512_mqpoly_sqnorm_signed(unsigned logn, const uint16_t *a)
+{
+	if (logn < 6) {
+		return avx2_mqpoly_sqnorm_signed(logn, a);
+	}
+	const __m512i *ap = (const __m512i *)a;
+	__m512i zs = _mm512_setzero_si512();
+	for (size_t i = 0; i < (1u << (logn - 5)); i ++) {
+		__m512i z = _mm512_loadu_si512(ap + i);
+		zs = _mm512_add_epi32(zs, _mm512_madd_epi16(z, z));
+	}
+	return (uint32_t)_mm512_reduce_add_epi32(zs);
+}
+#endif
+
 /* see inner.h */
 int
 mqpoly_sqnorm_is_acceptable(unsigned logn, uint32_t norm)
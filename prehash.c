@@ -0,0 +1,622 @@
+/*
+ * Pre-hash functions (SHA-2, SHA-3, SHAKE) for the pre-hashed signature
+ * and verification modes.
+ */
+
+#include "inner.h"
+
+/* Supported hash functions; the context kind is the index in this table
+   plus one (a zero kind marks a context that was not initialized with a
+   supported identifier). The SHAKE output lengths are 256 bits for
+   SHAKE128 and 512 bits for SHAKE256. */
+static const struct {
+	const char *id;
+	unsigned out_len;
+} prehash_funcs[] = {
+	{ FNDSA_HASH_ID_SHA256,     32 },
+	{ FNDSA_HASH_ID_SHA384,     48 },
+	{ FNDSA_HASH_ID_SHA512,     64 },
+	{ FNDSA_HASH_ID_SHA512_256, 32 },
+	{ FNDSA_HASH_ID_SHA3_256,   32 },
+	{ FNDSA_HASH_ID_SHA3_384,   48 },
+	{ FNDSA_HASH_ID_SHA3_512,   64 },
+	{ FNDSA_HASH_ID_SHAKE128,   32 },
+	{ FNDSA_HASH_ID_SHAKE256,   64 }
+};
+
+#define PH_SHA256       1
+#define PH_SHA384       2
+#define PH_SHA512       3
+#define PH_SHA512_256   4
+#define PH_SHA3_256     5
+#define PH_SHA3_384     6
+#define PH_SHA3_512     7
+#define PH_SHAKE128     8
+#define PH_SHAKE256     9
+
+/*
+ * For SHA-2 functions, buf[] holds the pending partial block, and count
+ * is the total input length (in bytes). For SHA-3 and SHAKE, the
+ * Keccak context does its own buffering.
+ */
+typedef struct {
+	union {
+		uint32_t h32[8];
+		uint64_t h64[8];
+		shake_context sc;
+	} u;
+	uint8_t buf[128];
+	uint64_t count;
+	unsigned kind;
+} prehash_state;
+
+/* The public context type must be large enough. */
+typedef char prehash_size_check[
+	(sizeof(fndsa_prehash_context) >= sizeof(prehash_state))
+	? 1 : -1];
+
+static inline uint32_t
+dec32be(const uint8_t *d)
+{
+	return ((uint32_t)d[0] << 24)
+		| ((uint32_t)d[1] << 16)
+		| ((uint32_t)d[2] << 8)
+		| (uint32_t)d[3];
+}
+
+static inline void
+enc32be(uint8_t *d, uint32_t x)
+{
+	d[0] = (uint8_t)(x >> 24);
+	d[1] = (uint8_t)(x >> 16);
+	d[2] = (uint8_t)(x >> 8);
+	d[3] = (uint8_t)x;
+}
+
+static inline uint64_t
+dec64be(const uint8_t *d)
+{
+	return ((uint64_t)dec32be(d) << 32) | (uint64_t)dec32be(d + 4);
+}
+
+static inline void
+enc64be(uint8_t *d, uint64_t x)
+{
+	enc32be(d, (uint32_t)(x >> 32));
+	enc32be(d + 4, (uint32_t)x);
+}
+
+/* ==================================================================== */
+/*
+ * SHA-256.
+ */
+
+static const uint32_t IV224_256[8] = {
+	0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+	0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+};
+
+ALIGN32
+static const uint32_t K256[64] = {
+	0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
+	0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+	0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+	0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+	0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC,
+	0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+	0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7,
+	0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+	0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
+	0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+	0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3,
+	0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+	0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5,
+	0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+	0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
+	0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+};
+
+#define ROTR32(x, n)   (((x) >> (n)) | ((x) << (32 - (n))))
+
+/* Process num 64-byte blocks. */
+static void
+sha256_blocks(uint32_t *h, const uint8_t *data, size_t num)
+{
+	while (num -- > 0) {
+		uint32_t w[64];
+		for (int i = 0; i < 16; i ++) {
+			w[i] = dec32be(data + 4 * i);
+		}
+		for (int i = 16; i < 64; i ++) {
+			uint32_t x0 = w[i - 15];
+			uint32_t x1 = w[i - 2];
+			w[i] = w[i - 16] + w[i - 7]
+				+ (ROTR32(x0, 7) ^ ROTR32(x0, 18) ^ (x0 >> 3))
+				+ (ROTR32(x1, 17) ^ ROTR32(x1, 19)
+				^ (x1 >> 10));
+		}
+		uint32_t a = h[0], b = h[1], c = h[2], d = h[3];
+		uint32_t e = h[4], f = h[5], g = h[6], k = h[7];
+		for (int i = 0; i < 64; i ++) {
+			uint32_t t1 = k + (ROTR32(e, 6) ^ ROTR32(e, 11)
+				^ ROTR32(e, 25)) + (g ^ (e & (f ^ g)))
+				+ K256[i] + w[i];
+			uint32_t t2 = (ROTR32(a, 2) ^ ROTR32(a, 13)
+				^ ROTR32(a, 22)) + ((a & b) | (c & (a | b)));
+			k = g;
+			g = f;
+			f = e;
+			e = d + t1;
+			d = c;
+			c = b;
+			b = a;
+			a = t1 + t2;
+		}
+		h[0] += a;
+		h[1] += b;
+		h[2] += c;
+		h[3] += d;
+		h[4] += e;
+		h[5] += f;
+		h[6] += g;
+		h[7] += k;
+		data += 64;
+	}
+}
+
+#if FNDSA_AVX2
+/* Same as sha256_blocks(), with the SHA extensions. The state is kept in
+   two registers, in the (A,B,E,F) and (C,D,G,H) layout expected by the
+   sha256rnds2 opcode; each SHA_NI_RND4 invocation performs four rounds,
+   and SHA_NI_SCHED computes the next four message words. */
+TARGET_SHANI
+static void
+shani_sha256_blocks(uint32_t *h, const uint8_t *data, size_t num)
+{
+	const __m128i bswap = _mm_set_epi64x(
+		0x0C0D0E0F08090A0B, 0x0405060700010203);
+	__m128i t = _mm_loadu_si128((const __m128i *)h);
+	__m128i s1 = _mm_loadu_si128((const __m128i *)(h + 4));
+	t = _mm_shuffle_epi32(t, 0xB1);
+	s1 = _mm_shuffle_epi32(s1, 0x1B);
+	__m128i s0 = _mm_alignr_epi8(t, s1, 8);
+	s1 = _mm_blend_epi16(s1, t, 0xF0);
+
+#define SHA_NI_RND4(m, j)   do { \
+		__m128i y = _mm_add_epi32(m, \
+			_mm_load_si128((const __m128i *)(K256 + (j)))); \
+		s1 = _mm_sha256rnds2_epu32(s1, s0, y); \
+		s0 = _mm_sha256rnds2_epu32(s0, s1, \
+			_mm_shuffle_epi32(y, 0x0E)); \
+	} while (0)
+#define SHA_NI_SCHED(m0, m1, m2, m3)   do { \
+		m0 = _mm_sha256msg2_epu32(_mm_add_epi32( \
+			_mm_sha256msg1_epu32(m0, m1), \
+			_mm_alignr_epi8(m3, m2, 4)), m3); \
+	} while (0)
+
+	while (num -- > 0) {
+		__m128i s0_save = s0;
+		__m128i s1_save = s1;
+		__m128i m0 = _mm_shuffle_epi8(
+			_mm_loadu_si128((const __m128i *)data), bswap);
+		__m128i m1 = _mm_shuffle_epi8(
+			_mm_loadu_si128((const __m128i *)(data + 16)), bswap);
+		__m128i m2 = _mm_shuffle_epi8(
+			_mm_loadu_si128((const __m128i *)(data + 32)), bswap);
+		__m128i m3 = _mm_shuffle_epi8(
+			_mm_loadu_si128((const __m128i *)(data + 48)), bswap);
+		SHA_NI_RND4(m0, 0);
+		SHA_NI_RND4(m1, 4);
+		SHA_NI_RND4(m2, 8);
+		SHA_NI_RND4(m3, 12);
+		for (int j = 16; j < 64; j += 16) {
+			SHA_NI_SCHED(m0, m1, m2, m3);
+			SHA_NI_RND4(m0, j);
+			SHA_NI_SCHED(m1, m2, m3, m0);
+			SHA_NI_RND4(m1, j + 4);
+			SHA_NI_SCHED(m2, m3, m0, m1);
+			SHA_NI_RND4(m2, j + 8);
+			SHA_NI_SCHED(m3, m0, m1, m2);
+			SHA_NI_RND4(m3, j + 12);
+		}
+		s0 = _mm_add_epi32(s0, s0_save);
+		s1 = _mm_add_epi32(s1, s1_save);
+		data += 64;
+	}
+
+#undef SHA_NI_RND4
+#undef SHA_NI_SCHED
+
+	t = _mm_shuffle_epi32(s0, 0x1B);
+	s1 = _mm_shuffle_epi32(s1, 0xB1);
+	s0 = _mm_blend_epi16(t, s1, 0xF0);
+	s1 = _mm_alignr_epi8(s1, t, 8);
+	_mm_storeu_si128((__m128i *)h, s0);
+	_mm_storeu_si128((__m128i *)(h + 4), s1);
+}
+#endif
+
+/* ==================================================================== */
+/*
+ * SHA-384, SHA-512 and SHA-512/256.
+ */
+
+static const uint64_t IV384[8] = {
+	0xCBBB9D5DC1059ED8, 0x629A292A367CD507,
+	0x9159015A3070DD17, 0x152FECD8F70E5939,
+	0x67332667FFC00B31, 0x8EB44A8768581511,
+	0xDB0C2E0D64F98FA7, 0x47B5481DBEFA4FA4
+};
+
+static const uint64_t IV512[8] = {
+	0x6A09E667F3BCC908, 0xBB67AE8584CAA73B,
+	0x3C6EF372FE94F82B, 0xA54FF53A5F1D36F1,
+	0x510E527FADE682D1, 0x9B05688C2B3E6C1F,
+	0x1F83D9ABFB41BD6B, 0x5BE0CD19137E2179
+};
+
+static const uint64_t IV512_256[8] = {
+	0x22312194FC2BF72C, 0x9F555FA3C84C64C2,
+	0x2393B86B6F53B151, 0x963877195940EABD,
+	0x96283EE2A88EFFE3, 0xBE5E1E2553863992,
+	0x2B0199FC2C85B8AA, 0x0EB72DDC81C52CA2
+};
+
+static const uint64_t K512[80] = {
+	0x428A2F98D728AE22, 0x7137449123EF65CD,
+	0xB5C0FBCFEC4D3B2F, 0xE9B5DBA58189DBBC,
+	0x3956C25BF348B538, 0x59F111F1B605D019,
+	0x923F82A4AF194F9B, 0xAB1C5ED5DA6D8118,
+	0xD807AA98A3030242, 0x12835B0145706FBE,
+	0x243185BE4EE4B28C, 0x550C7DC3D5FFB4E2,
+	0x72BE5D74F27B896F, 0x80DEB1FE3B1696B1,
+	0x9BDC06A725C71235, 0xC19BF174CF692694,
+	0xE49B69C19EF14AD2, 0xEFBE4786384F25E3,
+	0x0FC19DC68B8CD5B5, 0x240CA1CC77AC9C65,
+	0x2DE92C6F592B0275, 0x4A7484AA6EA6E483,
+	0x5CB0A9DCBD41FBD4, 0x76F988DA831153B5,
+	0x983E5152EE66DFAB, 0xA831C66D2DB43210,
+	0xB00327C898FB213F, 0xBF597FC7BEEF0EE4,
+	0xC6E00BF33DA88FC2, 0xD5A79147930AA725,
+	0x06CA6351E003826F, 0x142929670A0E6E70,
+	0x27B70A8546D22FFC, 0x2E1B21385C26C926,
+	0x4D2C6DFC5AC42AED, 0x53380D139D95B3DF,
+	0x650A73548BAF63DE, 0x766A0ABB3C77B2A8,
+	0x81C2C92E47EDAEE6, 0x92722C851482353B,
+	0xA2BFE8A14CF10364, 0xA81A664BBC423001,
+	0xC24B8B70D0F89791, 0xC76C51A30654BE30,
+	0xD192E819D6EF5218, 0xD69906245565A910,
+	0xF40E35855771202A, 0x106AA07032BBD1B8,
+	0x19A4C116B8D2D0C8, 0x1E376C085141AB53,
+	0x2748774CDF8EEB99, 0x34B0BCB5E19B48A8,
+	0x391C0CB3C5C95A63, 0x4ED8AA4AE3418ACB,
+	0x5B9CCA4F7763E373, 0x682E6FF3D6B2B8A3,
+	0x748F82EE5DEFB2FC, 0x78A5636F43172F60,
+	0x84C87814A1F0AB72, 0x8CC702081A6439EC,
+	0x90BEFFFA23631E28, 0xA4506CEBDE82BDE9,
+	0xBEF9A3F7B2C67915, 0xC67178F2E372532B,
+	0xCA273ECEEA26619C, 0xD186B8C721C0C207,
+	0xEADA7DD6CDE0EB1E, 0xF57D4F7FEE6ED178,
+	0x06F067AA72176FBA, 0x0A637DC5A2C898A6,
+	0x113F9804BEF90DAE, 0x1B710B35131C471B,
+	0x28DB77F523047D84, 0x32CAAB7B40C72493,
+	0x3C9EBE0A15C9BEBC, 0x431D67C49C100D4C,
+	0x4CC5D4BECB3E42B6, 0x597F299CFC657E2A,
+	0x5FCB6FAB3AD6FAEC, 0x6C44198C4A475817
+};
+
+#define ROTR64(x, n)   (((x) >> (n)) | ((x) << (64 - (n))))
+
+/* Process num 128-byte blocks. */
+static void
+sha512_blocks(uint64_t *h, const uint8_t *data, size_t num)
+{
+	while (num -- > 0) {
+		uint64_t w[80];
+		for (int i = 0; i < 16; i ++) {
+			w[i] = dec64be(data + 8 * i);
+		}
+		for (int i = 16; i < 80; i ++) {
+			uint64_t x0 = w[i - 15];
+			uint64_t x1 = w[i - 2];
+			w[i] = w[i - 16] + w[i - 7]
+				+ (ROTR64(x0, 1) ^ ROTR64(x0, 8) ^ (x0 >> 7))
+				+ (ROTR64(x1, 19) ^ ROTR64(x1, 61) ^ (x1 >> 6));
+		}
+		uint64_t a = h[0], b = h[1], c = h[2], d = h[3];
+		uint64_t e = h[4], f = h[5], g = h[6], k = h[7];
+		for (int i = 0; i < 80; i ++) {
+			uint64_t t1 = k + (ROTR64(e, 14) ^ ROTR64(e, 18)
+				^ ROTR64(e, 41)) + (g ^ (e & (f ^ g)))
+				+ K512[i] + w[i];
+			uint64_t t2 = (ROTR64(a, 28) ^ ROTR64(a, 34)
+				^ ROTR64(a, 39)) + ((a & b) | (c & (a | b)));
+			k = g;
+			g = f;
+			f = e;
+			e = d + t1;
+			d = c;
+			c = b;
+			b = a;
+			a = t1 + t2;
+		}
+		h[0] += a;
+		h[1] += b;
+		h[2] += c;
+		h[3] += d;
+		h[4] += e;
+		h[5] += f;
+		h[6] += g;
+		h[7] += k;
+		data += 128;
+	}
+}
+
+/* ==================================================================== */
+
+/* Process num full blocks for a SHA-2 function. */
+static void
+sha2_blocks(prehash_state *ps, const uint8_t *data, size_t num)
+{
+	if (ps->kind == PH_SHA256) {
+#if FNDSA_AVX2
+		if (has_shani()) {
+			shani_sha256_blocks(ps->u.h32, data, num);
+			return;
+		}
+#endif
+		sha256_blocks(ps->u.h32, data, num);
+	} else {
+		sha512_blocks(ps->u.h64, data, num);
+	}
+}
+
+/* Set the context to the initial state for its hash function. */
+static void
+prehash_reset(prehash_state *ps)
+{
+	ps->count = 0;
+	switch (ps->kind) {
+	case PH_SHA256:
+		memcpy(ps->u.h32, IV224_256, sizeof IV224_256);
+		break;
+	case PH_SHA384:
+		memcpy(ps->u.h64, IV384, sizeof IV384);
+		break;
+	case PH_SHA512:
+		memcpy(ps->u.h64, IV512, sizeof IV512);
+		break;
+	case PH_SHA512_256:
+		memcpy(ps->u.h64, IV512_256, sizeof IV512_256);
+		break;
+	case PH_SHA3_256:
+		sha3_init(&ps->u.sc, 256);
+		break;
+	case PH_SHA3_384:
+		sha3_init(&ps->u.sc, 384);
+		break;
+	case PH_SHA3_512:
+		sha3_init(&ps->u.sc, 512);
+		break;
+	case PH_SHAKE128:
+		shake_init(&ps->u.sc, 128);
+		break;
+	case PH_SHAKE256:
+		shake_init(&ps->u.sc, 256);
+		break;
+	}
+}
+
+/* see fndsa.h */
+int
+fndsa_prehash_init(fndsa_prehash_context *pc, const char *id)
+{
+	prehash_state *ps = (prehash_state *)(void *)pc;
+	ps->kind = 0;
+
+	/* All supported identifiers are 11-byte OIDs (06 09 ...). */
+	if (id == NULL || id[0] != 0x06 || id[1] != 0x09) {
+		return 0;
+	}
+	for (size_t i = 0;
+		i < (sizeof prehash_funcs) / (sizeof prehash_funcs[0]); i ++)
+	{
+		if (memcmp(id, prehash_funcs[i].id, 11) == 0) {
+			ps->kind = (unsigned)i + 1;
+			prehash_reset(ps);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* see fndsa.h */
+void
+fndsa_prehash_update(fndsa_prehash_context *pc,
+	const void *data, size_t len)
+{
+	prehash_state *ps = (prehash_state *)(void *)pc;
+	const uint8_t *buf = (const uint8_t *)data;
+	size_t blen;
+	switch (ps->kind) {
+	case PH_SHA256:
+		blen = 64;
+		break;
+	case PH_SHA384:
+	case PH_SHA512:
+	case PH_SHA512_256:
+		blen = 128;
+		break;
+	case 0:
+		return;
+	default:
+		shake_inject(&ps->u.sc, data, len);
+		return;
+	}
+
+	/* Complete the pending block, if any, then process the full blocks
+	   directly from the source, and keep the remaining bytes. */
+	size_t ptr = (size_t)ps->count & (blen - 1);
+	ps->count += (uint64_t)len;
+	if (ptr != 0) {
+		size_t clen = blen - ptr;
+		if (clen > len) {
+			clen = len;
+		}
+		memcpy(ps->buf + ptr, buf, clen);
+		buf += clen;
+		len -= clen;
+		if (ptr + clen < blen) {
+			return;
+		}
+		sha2_blocks(ps, ps->buf, 1);
+	}
+	size_t num = len / blen;
+	if (num > 0) {
+		sha2_blocks(ps, buf, num);
+		buf += num * blen;
+		len -= num * blen;
+	}
+	memcpy(ps->buf, buf, len);
+}
+
+/* see fndsa.h */
+size_t
+fndsa_prehash_final(fndsa_prehash_context *pc, void *out)
+{
+	prehash_state *ps = (prehash_state *)(void *)pc;
+	if (ps->kind == 0) {
+		return 0;
+	}
+	size_t out_len = prehash_funcs[ps->kind - 1].out_len;
+	uint8_t *dst = (uint8_t *)out;
+	switch (ps->kind) {
+	case PH_SHA256: {
+		/* Padding: 0x80, zeros, and the 64-bit length in bits. */
+		size_t ptr = (size_t)ps->count & 63;
+		ps->buf[ptr ++] = 0x80;
+		if (ptr > 56) {
+			memset(ps->buf + ptr, 0, 64 - ptr);
+			sha2_blocks(ps, ps->buf, 1);
+			ptr = 0;
+		}
+		memset(ps->buf + ptr, 0, 56 - ptr);
+		enc64be(ps->buf + 56, ps->count << 3);
+		sha2_blocks(ps, ps->buf, 1);
+		for (int i = 0; i < 8; i ++) {
+			enc32be(dst + 4 * i, ps->u.h32[i]);
+		}
+		break;
+	}
+	case PH_SHA384:
+	case PH_SHA512:
+	case PH_SHA512_256: {
+		/* Padding: 0x80, zeros, and the 128-bit length in bits. */
+		uint8_t tmp[64];
+		size_t ptr = (size_t)ps->count & 127;
+		ps->buf[ptr ++] = 0x80;
+		if (ptr > 112) {
+			memset(ps->buf + ptr, 0, 128 - ptr);
+			sha2_blocks(ps, ps->buf, 1);
+			ptr = 0;
+		}
+		memset(ps->buf + ptr, 0, 112 - ptr);
+		enc64be(ps->buf + 112, ps->count >> 61);
+		enc64be(ps->buf + 120, ps->count << 3);
+		sha2_blocks(ps, ps->buf, 1);
+		for (int i = 0; i < 8; i ++) {
+			enc64be(tmp + 8 * i, ps->u.h64[i]);
+		}
+		memcpy(dst, tmp, out_len);
+		break;
+	}
+	case PH_SHAKE128:
+	case PH_SHAKE256:
+		shake_flip(&ps->u.sc);
+		shake_extract(&ps->u.sc, dst, out_len);
+		break;
+	default:
+		sha3_close(&ps->u.sc, dst);
+		break;
+	}
+	prehash_reset(ps);
+	return out_len;
+}
+
+/* Finalize a pre-hash context into hv[] (64 bytes); the hash identifier
+   is written into *id. Returned value is the hash length, or 0 if the
+   context was not initialized with a supported identifier. */
+static size_t
+prehash_get(fndsa_prehash_context *pc, uint8_t *hv, const char **id)
+{
+	size_t hv_len = fndsa_prehash_final(pc, hv);
+	if (hv_len != 0) {
+		*id = prehash_funcs[((prehash_state *)(void *)pc)->kind - 1].id;
+	}
+	return hv_len;
+}
+
+/* see fndsa.h */
+size_t
+fndsa_sign_prehash(const void *sign_key, size_t sign_key_len,
+	const void *ctx, size_t ctx_len, fndsa_prehash_context *pc,
+	void *sig, size_t max_sig_len)
+{
+	uint8_t hv[64];
+	const char *id;
+	size_t hv_len = prehash_get(pc, hv, &id);
+	if (hv_len == 0) {
+		return 0;
+	}
+	return fndsa_sign(sign_key, sign_key_len, ctx, ctx_len,
+		id, hv, hv_len, sig, max_sig_len);
+}
+
+/* see fndsa.h */
+size_t
+fndsa_sign_weak_prehash(const void *sign_key, size_t sign_key_len,
+	const void *ctx, size_t ctx_len, fndsa_prehash_context *pc,
+	void *sig, size_t max_sig_len)
+{
+	uint8_t hv[64];
+	const char *id;
+	size_t hv_len = prehash_get(pc, hv, &id);
+	if (hv_len == 0) {
+		return 0;
+	}
+	return fndsa_sign_weak(sign_key, sign_key_len, ctx, ctx_len,
+		id, hv, hv_len, sig, max_sig_len);
+}
+
+/* see fndsa.h */
+int
+fndsa_verify_prehash(const void *sig, size_t sig_len,
+	const void *vrfy_key, size_t vrfy_key_len,
+	const void *ctx, size_t ctx_len, fndsa_prehash_context *pc)
+{
+	uint8_t hv[64];
+	const char *id;
+	size_t hv_len = prehash_get(pc, hv, &id);
+	if (hv_len == 0) {
+		return 0;
+	}
+	return fndsa_verify(sig, sig_len, vrfy_key, vrfy_key_len,
+		ctx, ctx_len, id, hv, hv_len);
+}
+
+/* see fndsa.h */
+int
+fndsa_verify_weak_prehash(const void *sig, size_t sig_len,
+	const void *vrfy_key, size_t vrfy_key_len,
+	const void *ctx, size_t ctx_len, fndsa_prehash_context *pc)
+{
+	uint8_t hv[64];
+	const char *id;
+	size_t hv_len = prehash_get(pc, hv, &id);
+	if (hv_len == 0) {
+		return 0;
+	}
+	return fndsa_verify_weak(sig, sig_len, vrfy_key, vrfy_key_len,
+		ctx, ctx_len, id, hv, hv_len);
+}
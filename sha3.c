@@ -691,6 +691,235 @@ process_block_x4(uint64_t *A)
 }
 #endif
 
+#if FNDSA_AVX512
+/* Eight SHAKE256 instances in parallel, with AVX-512F; this is the
+   same code as process_block_x4(), except that the eight states are
+   interleaved (word i of state j is A[8*i + j]). AVX-512F also has
+   rotation and three-input logical opcodes. */
+TARGET_AVX512
+static void
+process_block_x8(uint64_t *A)
+{
+	__m512i ya[25];
+
+	for (int i = 0; i < 25; i ++) {
+		ya[i] = _mm512_loadu_si512((const __m512i *)A + i);
+	}
+
+	/*
+	 * Compute the 24 rounds. This loop is partially unrolled (each
+	 * iteration computes two rounds).
+	 */
+	for (int j = 0; j < 24; j += 2) {
+		__m512i yt0, yt1, yt2, yt3, yt4;
+
+#define yy_rotl(yv, nn)    _mm512_rol_epi64(yv, nn)
+#define yy_xor(a, b)       _mm512_xor_si512(a, b)
+#define yy_xor3(a, b, c)   _mm512_ternarylogic_epi64(a, b, c, 0x96)
+#define yy_chi(a, b, c)    _mm512_ternarylogic_epi64(a, b, c, 0xD2)
+
+#define yCOMB1(yd, i0, i1, i2, i3, i4, i5, i6, i7, i8, i9)   do { \
+		__m512i ytt0, ytt1, ytt2, ytt3; \
+		ytt0 = yy_xor3(ya[i0], ya[i1], ya[i2]); \
+		ytt1 = yy_xor3(ya[i3], ya[i4], ytt0); \
+		ytt1 = yy_rotl(ytt1, 1); \
+		ytt2 = yy_xor3(ya[i5], ya[i6], ya[i7]); \
+		ytt3 = yy_xor3(ya[i8], ya[i9], ytt2); \
+		yd = yy_xor(ytt1, ytt3); \
+	} while (0)
+
+#define yCOMB2(i0, i1, i2, i3, i4, op0, op1, op2, op3, op4)   do { \
+		__m512i yc0, yc1, yc2, yc3, yc4; \
+		yc0 = yy_chi(ya[i0], ya[i1], ya[i2]); \
+		yc1 = yy_chi(ya[i1], ya[i2], ya[i3]); \
+		yc2 = yy_chi(ya[i2], ya[i3], ya[i4]); \
+		yc3 = yy_chi(ya[i3], ya[i4], ya[i0]); \
+		yc4 = yy_chi(ya[i4], ya[i0], ya[i1]); \
+		ya[i0] = yc0; \
+		ya[i1] = yc1; \
+		ya[i2] = yc2; \
+		ya[i3] = yc3; \
+		ya[i4] = yc4; \
+	} while (0)
+
+		/* Round j */
+
+		yCOMB1(yt0, 1, 6, 11, 16, 21, 4, 9, 14, 19, 24);
+		yCOMB1(yt1, 2, 7, 12, 17, 22, 0, 5, 10, 15, 20);
+		yCOMB1(yt2, 3, 8, 13, 18, 23, 1, 6, 11, 16, 21);
+		yCOMB1(yt3, 4, 9, 14, 19, 24, 2, 7, 12, 17, 22);
+		yCOMB1(yt4, 0, 5, 10, 15, 20, 3, 8, 13, 18, 23);
+
+		ya[ 0] = yy_xor(ya[ 0], yt0);
+		ya[ 5] = yy_xor(ya[ 5], yt0);
+		ya[10] = yy_xor(ya[10], yt0);
+		ya[15] = yy_xor(ya[15], yt0);
+		ya[20] = yy_xor(ya[20], yt0);
+		ya[ 1] = yy_xor(ya[ 1], yt1);
+		ya[ 6] = yy_xor(ya[ 6], yt1);
+		ya[11] = yy_xor(ya[11], yt1);
+		ya[16] = yy_xor(ya[16], yt1);
+		ya[21] = yy_xor(ya[21], yt1);
+		ya[ 2] = yy_xor(ya[ 2], yt2);
+		ya[ 7] = yy_xor(ya[ 7], yt2);
+		ya[12] = yy_xor(ya[12], yt2);
+		ya[17] = yy_xor(ya[17], yt2);
+		ya[22] = yy_xor(ya[22], yt2);
+		ya[ 3] = yy_xor(ya[ 3], yt3);
+		ya[ 8] = yy_xor(ya[ 8], yt3);
+		ya[13] = yy_xor(ya[13], yt3);
+		ya[18] = yy_xor(ya[18], yt3);
+		ya[23] = yy_xor(ya[23], yt3);
+		ya[ 4] = yy_xor(ya[ 4], yt4);
+		ya[ 9] = yy_xor(ya[ 9], yt4);
+		ya[14] = yy_xor(ya[14], yt4);
+		ya[19] = yy_xor(ya[19], yt4);
+		ya[24] = yy_xor(ya[24], yt4);
+		ya[ 5] = yy_rotl(ya[ 5], 36);
+		ya[10] = yy_rotl(ya[10],  3);
+		ya[15] = yy_rotl(ya[15], 41);
+		ya[20] = yy_rotl(ya[20], 18);
+		ya[ 1] = yy_rotl(ya[ 1],  1);
+		ya[ 6] = yy_rotl(ya[ 6], 44);
+		ya[11] = yy_rotl(ya[11], 10);
+		ya[16] = yy_rotl(ya[16], 45);
+		ya[21] = yy_rotl(ya[21],  2);
+		ya[ 2] = yy_rotl(ya[ 2], 62);
+		ya[ 7] = yy_rotl(ya[ 7],  6);
+		ya[12] = yy_rotl(ya[12], 43);
+		ya[17] = yy_rotl(ya[17], 15);
+		ya[22] = yy_rotl(ya[22], 61);
+		ya[ 3] = yy_rotl(ya[ 3], 28);
+		ya[ 8] = yy_rotl(ya[ 8], 55);
+		ya[13] = yy_rotl(ya[13], 25);
+		ya[18] = yy_rotl(ya[18], 21);
+		ya[23] = yy_rotl(ya[23], 56);
+		ya[ 4] = yy_rotl(ya[ 4], 27);
+		ya[ 9] = yy_rotl(ya[ 9], 20);
+		ya[14] = yy_rotl(ya[14], 39);
+		ya[19] = yy_rotl(ya[19],  8);
+		ya[24] = yy_rotl(ya[24], 14);
+
+		yCOMB2(0, 6, 12, 18, 24, or, ornotL, and, or, and);
+		yCOMB2(3, 9, 10, 16, 22, or, and, ornotR, or, and);
+		yCOMB2(1, 7, 13, 19, 20, or, andnotR, and, or, and);
+		yCOMB2(4, 5, 11, 17, 23, and, ornotR, or, and, or);
+		yCOMB2(2, 8, 14, 15, 21, and, or, and, or, andnotR);
+
+		ya[0] = yy_xor(ya[0], _mm512_set1_epi64((int64_t)RC[j + 0]));
+
+		/* Round j + 1 */
+
+		yCOMB1(yt0, 6, 9, 7, 5, 8, 24, 22, 20, 23, 21);
+		yCOMB1(yt1, 12, 10, 13, 11, 14, 0, 3, 1, 4, 2);
+		yCOMB1(yt2, 18, 16, 19, 17, 15, 6, 9, 7, 5, 8);
+		yCOMB1(yt3, 24, 22, 20, 23, 21, 12, 10, 13, 11, 14);
+		yCOMB1(yt4, 0, 3, 1, 4, 2, 18, 16, 19, 17, 15);
+
+		ya[ 0] = yy_xor(ya[ 0], yt0);
+		ya[ 3] = yy_xor(ya[ 3], yt0);
+		ya[ 1] = yy_xor(ya[ 1], yt0);
+		ya[ 4] = yy_xor(ya[ 4], yt0);
+		ya[ 2] = yy_xor(ya[ 2], yt0);
+		ya[ 6] = yy_xor(ya[ 6], yt1);
+		ya[ 9] = yy_xor(ya[ 9], yt1);
+		ya[ 7] = yy_xor(ya[ 7], yt1);
+		ya[ 5] = yy_xor(ya[ 5], yt1);
+		ya[ 8] = yy_xor(ya[ 8], yt1);
+		ya[12] = yy_xor(ya[12], yt2);
+		ya[10] = yy_xor(ya[10], yt2);
+		ya[13] = yy_xor(ya[13], yt2);
+		ya[11] = yy_xor(ya[11], yt2);
+		ya[14] = yy_xor(ya[14], yt2);
+		ya[18] = yy_xor(ya[18], yt3);
+		ya[16] = yy_xor(ya[16], yt3);
+		ya[19] = yy_xor(ya[19], yt3);
+		ya[17] = yy_xor(ya[17], yt3);
+		ya[15] = yy_xor(ya[15], yt3);
+		ya[24] = yy_xor(ya[24], yt4);
+		ya[22] = yy_xor(ya[22], yt4);
+		ya[20] = yy_xor(ya[20], yt4);
+		ya[23] = yy_xor(ya[23], yt4);
+		ya[21] = yy_xor(ya[21], yt4);
+		ya[ 3] = yy_rotl(ya[ 3], 36);
+		ya[ 1] = yy_rotl(ya[ 1],  3);
+		ya[ 4] = yy_rotl(ya[ 4], 41);
+		ya[ 2] = yy_rotl(ya[ 2], 18);
+		ya[ 6] = yy_rotl(ya[ 6],  1);
+		ya[ 9] = yy_rotl(ya[ 9], 44);
+		ya[ 7] = yy_rotl(ya[ 7], 10);
+		ya[ 5] = yy_rotl(ya[ 5], 45);
+		ya[ 8] = yy_rotl(ya[ 8],  2);
+		ya[12] = yy_rotl(ya[12], 62);
+		ya[10] = yy_rotl(ya[10],  6);
+		ya[13] = yy_rotl(ya[13], 43);
+		ya[11] = yy_rotl(ya[11], 15);
+		ya[14] = yy_rotl(ya[14], 61);
+		ya[18] = yy_rotl(ya[18], 28);
+		ya[16] = yy_rotl(ya[16], 55);
+		ya[19] = yy_rotl(ya[19], 25);
+		ya[17] = yy_rotl(ya[17], 21);
+		ya[15] = yy_rotl(ya[15], 56);
+		ya[24] = yy_rotl(ya[24], 27);
+		ya[22] = yy_rotl(ya[22], 20);
+		ya[20] = yy_rotl(ya[20], 39);
+		ya[23] = yy_rotl(ya[23],  8);
+		ya[21] = yy_rotl(ya[21], 14);
+
+		yCOMB2(0, 9, 13, 17, 21, or, ornotL, and, or, and);
+		yCOMB2(18, 22, 1, 5, 14, or, and, ornotR, or, and);
+		yCOMB2(6, 10, 19, 23, 2, or, andnotR, and, or, and);
+		yCOMB2(24, 3, 7, 11, 15, and, ornotR, or, and, or);
+		yCOMB2(12, 16, 20, 4, 8, and, or, and, or, andnotR);
+
+		ya[0] = yy_xor(ya[0], _mm512_set1_epi64((int64_t)RC[j + 1]));
+
+		/* Apply combined permutation for next round */
+
+		__m512i yt = ya[ 5];
+		ya[ 5] = ya[18];
+		ya[18] = ya[11];
+		ya[11] = ya[10];
+		ya[10] = ya[ 6];
+		ya[ 6] = ya[22];
+		ya[22] = ya[20];
+		ya[20] = ya[12];
+		ya[12] = ya[19];
+		ya[19] = ya[15];
+		ya[15] = ya[24];
+		ya[24] = ya[ 8];
+		ya[ 8] = yt;
+		yt = ya[ 1];
+		ya[ 1] = ya[ 9];
+		ya[ 9] = ya[14];
+		ya[14] = ya[ 2];
+		ya[ 2] = ya[13];
+		ya[13] = ya[23];
+		ya[23] = ya[ 4];
+		ya[ 4] = ya[21];
+		ya[21] = ya[16];
+		ya[16] = ya[ 3];
+                ya[ 3] = ya[17];
+                ya[17] = ya[ 7];
+                ya[ 7] = yt;
+
+#undef yy_rotl
+#undef yy_xor
+#undef yy_xor3
+#undef yy_chi
+#undef yCOMB1
+#undef yCOMB2
+	}
+
+	/*
+	 * Write back state words.
+	 */
+	for (int i = 0; i < 25; i ++) {
+		_mm512_storeu_si512((__m512i *)A + i, ya[i]);
+	}
+}
+#endif
+
 #if FNDSA_SSE2
 /* This is a variant of the AVX2 process_block_x4() function, but with
    only SSE2 opcodes, it runs only two blocks in parallel. It still uses
@@ -1309,7 +1538,6 @@ shake_extract(shake_context *sc, void *out, size_t len)
 	sc->dptr = (unsigned)dptr;
 }
 
-#if FNDSA_SHAKE256X4
 /* Little-endian 64-bit decoding. */
 static inline uint64_t
 dec64le(const void *src)
@@ -1340,6 +1568,7 @@ enc64le(void *dst, uint64_t x)
 	buf[7] = (uint8_t)(x >> 56);
 }
 
+#if FNDSA_SHAKE256X4
 /* see inner.h */
 void
 shake256x4_init(shake256x4_context *sc, const void *seed, size_t seed_len)
@@ -1503,6 +1732,355 @@ shake256x4_refill(shake256x4_context *sc)
 }
 #endif
 
+/*
+ * Multi-buffer SHAKE256. The nl states (nl = 4 or 8) are interleaved:
+ * word i of state j is A[nl*i + j]. In input mode, each state has its
+ * own input pointer (dptr[j]); a full block (dptr[j] == rate) is
+ * processed lazily, when more input must be injected in that state, or
+ * when flipping. All states are then permuted together; the states which
+ * are not full are saved and restored around the permutation. In output
+ * mode, all states share the same output pointer (dptr[0]).
+ */
+
+typedef struct {
+	uint64_t A[100];
+	unsigned dptr[4];
+	unsigned tier;
+} shake256_x4_state;
+
+typedef struct {
+	uint64_t A[200];
+	unsigned dptr[8];
+	unsigned tier;
+} shake256_x8_state;
+
+/* The public context types must be large enough. */
+typedef char shake256_x4_size_check[
+	(sizeof(fndsa_shake256_x4_context) >= sizeof(shake256_x4_state))
+	? 1 : -1];
+typedef char shake256_x8_size_check[
+	(sizeof(fndsa_shake256_x8_context) >= sizeof(shake256_x8_state))
+	? 1 : -1];
+
+#define MB_RATE   136
+
+/* Apply the permutation on the four states in A, which are interleaved
+   with a stride of 4. */
+static void
+mb_permute_x4(uint64_t *A, unsigned tier)
+{
+	(void)tier;
+#if FNDSA_AVX2
+	if (tier >= SIMD_TIER_AVX2) {
+		process_block_x4(A);
+		return;
+	}
+#endif
+#if FNDSA_SSE2 || FNDSA_NEON_SHA3
+	process_block_x2(A);
+	process_block_x2(A + 2);
+#else
+	uint64_t B[25];
+	for (int j = 0; j < 4; j ++) {
+		for (int i = 0; i < 25; i ++) {
+			B[i] = A[(i << 2) + j];
+		}
+		process_block(B, MB_RATE >> 3);
+		for (int i = 0; i < 25; i ++) {
+			A[(i << 2) + j] = B[i];
+		}
+	}
+#endif
+}
+
+/* Apply the permutation on the states of A (nl states) whose index
+   is set in mask. All states are permuted; those which are not in the
+   mask are restored afterwards. */
+static void
+mb_permute(uint64_t *A, unsigned nl, unsigned mask, unsigned tier)
+{
+	if (mask != (1u << nl) - 1) {
+		uint64_t save[200];
+		memcpy(save, A, nl * 25 * sizeof(uint64_t));
+		mb_permute(A, nl, (1u << nl) - 1, tier);
+		for (unsigned j = 0; j < nl; j ++) {
+			if (((mask >> j) & 1) == 0) {
+				for (unsigned i = 0; i < 25; i ++) {
+					A[nl * i + j] = save[nl * i + j];
+				}
+			}
+		}
+		return;
+	}
+
+	if (nl == 4) {
+		mb_permute_x4(A, tier);
+		return;
+	}
+#if FNDSA_AVX512
+	if (tier >= SIMD_TIER_AVX512) {
+		process_block_x8(A);
+		return;
+	}
+#endif
+	/* Eight states: process each half with the four-state code. */
+	uint64_t B[100];
+	for (int h = 0; h < 8; h += 4) {
+		for (int i = 0; i < 25; i ++) {
+			memcpy(&B[i << 2], &A[(i << 3) + h], 4 * sizeof(uint64_t));
+		}
+		mb_permute_x4(B, tier);
+		for (int i = 0; i < 25; i ++) {
+			memcpy(&A[(i << 3) + h], &B[i << 2], 4 * sizeof(uint64_t));
+		}
+	}
+}
+
+static void
+mb_init(uint64_t *A, unsigned *dptr, unsigned nl)
+{
+	memset(A, 0, nl * 25 * sizeof(uint64_t));
+	for (unsigned j = 0; j < nl; j ++) {
+		dptr[j] = 0;
+	}
+}
+
+static void
+mb_inject(uint64_t *A, unsigned *dptr, unsigned nl, unsigned tier,
+	const void *const *in, const size_t *len)
+{
+	const uint8_t *buf[8];
+	size_t rem[8];
+	for (unsigned j = 0; j < nl; j ++) {
+		buf[j] = (const uint8_t *)in[j];
+		rem[j] = len[j];
+	}
+	for (;;) {
+		unsigned mask = 0;
+		int more = 0;
+		for (unsigned j = 0; j < nl; j ++) {
+			unsigned d = dptr[j];
+			size_t clen = MB_RATE - d;
+			if (clen > rem[j]) {
+				clen = rem[j];
+			}
+			const uint8_t *src = buf[j];
+			if (clen > 0) {
+				buf[j] += clen;
+				rem[j] -= clen;
+			}
+			while (clen > 0) {
+				uint64_t *w = &A[nl * (d >> 3) + j];
+				if ((d & 7) == 0 && clen >= 8) {
+					*w ^= (uint64_t)src[0]
+						| ((uint64_t)src[1] << 8)
+						| ((uint64_t)src[2] << 16)
+						| ((uint64_t)src[3] << 24)
+						| ((uint64_t)src[4] << 32)
+						| ((uint64_t)src[5] << 40)
+						| ((uint64_t)src[6] << 48)
+						| ((uint64_t)src[7] << 56);
+					src += 8;
+					d += 8;
+					clen -= 8;
+				} else {
+					*w ^= (uint64_t)*src ++ << ((d & 7) << 3);
+					d ++;
+					clen --;
+				}
+			}
+			dptr[j] = d;
+			if (d == MB_RATE) {
+				mask |= 1u << j;
+				if (rem[j] > 0) {
+					more = 1;
+				}
+			}
+		}
+		if (!more) {
+			return;
+		}
+
+		/* At least one state has more input; all such states are
+		   full. All full states are processed. */
+		mb_permute(A, nl, mask, tier);
+		for (unsigned j = 0; j < nl; j ++) {
+			if (((mask >> j) & 1) != 0) {
+				dptr[j] = 0;
+			}
+		}
+	}
+}
+
+static void
+mb_flip(uint64_t *A, unsigned *dptr, unsigned nl, unsigned tier)
+{
+	unsigned mask = 0;
+	for (unsigned j = 0; j < nl; j ++) {
+		if (dptr[j] == MB_RATE) {
+			mask |= 1u << j;
+		}
+	}
+	if (mask != 0) {
+		mb_permute(A, nl, mask, tier);
+	}
+	for (unsigned j = 0; j < nl; j ++) {
+		unsigned d = ((mask >> j) & 1) != 0 ? 0 : dptr[j];
+		A[nl * (d >> 3) + j] ^= (uint64_t)0x1F << ((d & 7) << 3);
+		A[nl * ((MB_RATE - 1) >> 3) + j] ^= (uint64_t)0x80 << 56;
+	}
+	dptr[0] = MB_RATE;
+}
+
+static void
+mb_extract(uint64_t *A, unsigned *dptr, unsigned nl, unsigned tier,
+	void *const *out, size_t len)
+{
+	uint8_t *buf[8];
+	for (unsigned j = 0; j < nl; j ++) {
+		buf[j] = (uint8_t *)out[j];
+	}
+	unsigned d = dptr[0];
+	while (len > 0) {
+		if (d == MB_RATE) {
+			mb_permute(A, nl, (1u << nl) - 1, tier);
+			d = 0;
+		}
+		size_t clen = MB_RATE - d;
+		if (clen > len) {
+			clen = len;
+		}
+		for (unsigned j = 0; j < nl; j ++) {
+			uint8_t *dst = buf[j];
+			unsigned e = d;
+			for (size_t u = 0; u < clen;) {
+				uint64_t w = A[nl * (e >> 3) + j];
+				if ((e & 7) == 0 && (clen - u) >= 8) {
+					dst[u + 0] = (uint8_t)w;
+					dst[u + 1] = (uint8_t)(w >> 8);
+					dst[u + 2] = (uint8_t)(w >> 16);
+					dst[u + 3] = (uint8_t)(w >> 24);
+					dst[u + 4] = (uint8_t)(w >> 32);
+					dst[u + 5] = (uint8_t)(w >> 40);
+					dst[u + 6] = (uint8_t)(w >> 48);
+					dst[u + 7] = (uint8_t)(w >> 56);
+					u += 8;
+					e += 8;
+				} else {
+					dst[u ++] = (uint8_t)(w >> ((e & 7) << 3));
+					e ++;
+				}
+			}
+			buf[j] += clen;
+		}
+		d += (unsigned)clen;
+		len -= clen;
+	}
+	dptr[0] = d;
+}
+
+/* Get the SIMD tier to use for the multi-buffer code. */
+static unsigned
+mb_tier(void)
+{
+#if FNDSA_AVX512
+	if (has_avx512()) {
+		return SIMD_TIER_AVX512;
+	}
+#endif
+#if FNDSA_AVX2
+	if (has_avx2()) {
+		return SIMD_TIER_AVX2;
+	}
+#endif
+	return SIMD_TIER_BASE;
+}
+
+/* see fndsa.h */
+void
+fndsa_shake256_x4_init(fndsa_shake256_x4_context *sc)
+{
+	shake256_x4_state *st = (shake256_x4_state *)(void *)sc;
+	mb_init(st->A, st->dptr, 4);
+	st->tier = mb_tier();
+}
+
+/* see fndsa.h */
+void
+fndsa_shake256_x4_inject(fndsa_shake256_x4_context *sc,
+	const void *const *in, const size_t *len)
+{
+	shake256_x4_state *st = (shake256_x4_state *)(void *)sc;
+	mb_inject(st->A, st->dptr, 4, st->tier, in, len);
+}
+
+/* see fndsa.h */
+void
+fndsa_shake256_x4_flip(fndsa_shake256_x4_context *sc)
+{
+	shake256_x4_state *st = (shake256_x4_state *)(void *)sc;
+	mb_flip(st->A, st->dptr, 4, st->tier);
+}
+
+/* see fndsa.h */
+void
+fndsa_shake256_x4_extract(fndsa_shake256_x4_context *sc,
+	void *const *out, size_t len)
+{
+	shake256_x4_state *st = (shake256_x4_state *)(void *)sc;
+	mb_extract(st->A, st->dptr, 4, st->tier, out, len);
+}
+
+/* see fndsa.h */
+void
+fndsa_shake256_x8_init(fndsa_shake256_x8_context *sc)
+{
+	shake256_x8_state *st = (shake256_x8_state *)(void *)sc;
+	mb_init(st->A, st->dptr, 8);
+	st->tier = mb_tier();
+}
+
+/* see fndsa.h */
+void
+fndsa_shake256_x8_inject(fndsa_shake256_x8_context *sc,
+	const void *const *in, const size_t *len)
+{
+	shake256_x8_state *st = (shake256_x8_state *)(void *)sc;
+	mb_inject(st->A, st->dptr, 8, st->tier, in, len);
+}
+
+/* see fndsa.h */
+void
+fndsa_shake256_x8_flip(fndsa_shake256_x8_context *sc)
+{
+	shake256_x8_state *st = (shake256_x8_state *)(void *)sc;
+	mb_flip(st->A, st->dptr, 8, st->tier);
+}
+
+/* see fndsa.h */
+void
+fndsa_shake256_x8_extract(fndsa_shake256_x8_context *sc,
+	void *const *out, size_t len)
+{
+	shake256_x8_state *st = (shake256_x8_state *)(void *)sc;
+	mb_extract(st->A, st->dptr, 8, st->tier, out, len);
+}
+
+/* see inner.h */
+void
+shake256_x4_set(fndsa_shake256_x4_context *sc, const shake_context *src)
+{
+	shake256_x4_state *st = (shake256_x4_state *)(void *)sc;
+	for (int i = 0; i < 25; i ++) {
+		st->A[(i << 2) + 0] = src[0].A[i];
+		st->A[(i << 2) + 1] = src[1].A[i];
+		st->A[(i << 2) + 2] = src[2].A[i];
+		st->A[(i << 2) + 3] = src[3].A[i];
+	}
+	st->dptr[0] = src[0].dptr;
+	st->tier = mb_tier();
+}
+
 /* SHA-3 is mostly the same as SHAKE, except for the padding, and the
    fact that the output size is fixed. */
 
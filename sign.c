@@ -4,34 +4,17 @@
 
 #include "sign_inner.h"
 
-/* Verified properties at this point:
-      degree is acceptable
-      encoded signing key has the proper size
-      signature buffer is large enough to receive the result
-      tmp is large enough (but not necessarily aligned)  */
-static size_t
-sign_step1(unsigned logn, const uint8_t *sign_key,
-	const uint8_t *ctx, size_t ctx_len,
-	const char *id, const uint8_t *hv, size_t hv_len,
-	const uint8_t *seed, size_t seed_len,
-	uint8_t *sig, void *tmp)
+/* Decode the signing key (header byte and length have already been
+   verified) into f, g and F, recompute G, and compute the SHAKE256 hash
+   of the verifying key into hashed_key[] (64 bytes). tmp must have room
+   for 4*n bytes, and be at least 2-byte aligned. Returned value is 1 on
+   success, 0 if the key is invalid. */
+static int
+decode_sign_key(unsigned logn, const uint8_t *sign_key,
+	int8_t *f, int8_t *g, int8_t *F, int8_t *G,
+	uint8_t *hashed_key, void *tmp)
 {
 	size_t n = (size_t)1 << logn;
-
-	/* Align tmp to a 32-byte boundary. */
-	tmp = (void *)(((uintptr_t)tmp + 31) & ~(uintptr_t)31);
-
-	/* We decode f, g and F into a temporary area, and use them
-	   to recompute G. Only G will be provided in decoded format
-	   to sign_core(); f, g and F can be redecoded cheaply from
-	   the encoded key when needed. */
-	int8_t *f = (int8_t *)tmp + 4 * n;
-	int8_t *g = f + n;
-	int8_t *F = g + n;
-	int8_t *G = (int8_t *)tmp + ((size_t)58 << logn);
-
-	/* Decode the private key. Header byte and length have already
-	   been verified. */
 	unsigned nbits;
 	switch (logn) {
 	case 2: case 3: case 4: case 5:
@@ -97,25 +80,94 @@ sign_step1(unsigned logn, const uint8_t *sign_key,
 	vrfy_key[0] = 0x00 + logn;
 	mqpoly_encode(logn, t0, vrfy_key + 1);
 
-	/* We can use t0 for the SHAKE256 context. The tmp buffer currently
-	   starts with t1 (2*n bytes), which contains the encoded public
-	   key (no more than 2*n bytes), leaging 56*n bytes until the
-	   storage place for G (at tmp + 58*n). With n >= 4, this is at
-	   least 224 bytes; the SHAKE context uses 208 bytes. Moreover,
-	   tmp + 2*n is at least 8-byte aligned. */
+	/* The encoded verifying key (no more than 2*n bytes) is in t1.
+	   The SHAKE context (208 bytes) would not fit in the remaining
+	   2*n bytes of tmp for small degrees, so we keep it on the stack. */
+	shake_context sc;
+	shake_init(&sc, 256);
+	shake_inject(&sc, vrfy_key, FNDSA_VRFY_KEY_SIZE(logn));
+	shake_flip(&sc);
+	shake_extract(&sc, hashed_key, 64);
+	return 1;
+}
+
+/* Verified properties at this point:
+      degree is acceptable
+      encoded signing key has the proper size
+      signature buffer is large enough to receive all the results
+      tmp is large enough (but not necessarily aligned)
+   The num messages are signed with the same key; the key-dependent
+   computations are done only once. Signature i is written at offset
+   i*FNDSA_SIGNATURE_SIZE(logn) in sigs[]. Returned value is the number
+   of generated signatures (num on success). */
+static size_t
+sign_step1(unsigned logn, const uint8_t *sign_key,
+	const fndsa_sign_msg *msgs, size_t num,
+	const uint8_t *seed, size_t seed_len,
+	uint8_t *sigs, void *tmp, size_t tmp_len)
+{
+	size_t n = (size_t)1 << logn;
+	size_t sig_len = FNDSA_SIGNATURE_SIZE(logn);
+
+	/* Align tmp to a 32-byte boundary. */
+	tmp = (void *)(((uintptr_t)tmp + 31) & ~(uintptr_t)31);
+
 	uint8_t hashed_key[64];
-	shake_context *sc = (shake_context *)t0;
-	shake_init(sc, 256);
-	shake_inject(sc, vrfy_key, FNDSA_VRFY_KEY_SIZE(logn));
-	shake_flip(sc);
-	shake_extract(sc, hashed_key, sizeof hashed_key);
+	if (tmp_len >= (((size_t)110 << logn) + 31)) {
+		/* Large temporary area: we expand the key right after
+		   the 58*n bytes used by sign_core_expanded():
+		      B and Gram matrix (6*n fpr slots)
+		      f, g, F and G (4*n bytes)
+		   so that the basis and Gram matrix are computed only
+		   once, regardless of the number of restarts and of
+		   messages. */
+		fpr *bg = (fpr *)((uint8_t *)tmp + ((size_t)58 << logn));
+		int8_t *fgFG = (int8_t *)(bg + 6 * n);
+		if (!decode_sign_key(logn, sign_key, fgFG, fgFG + n,
+			fgFG + 2 * n, fgFG + 3 * n, hashed_key, tmp))
+		{
+			return 0;
+		}
+		sign_expand_basis(logn, fgFG, bg);
+		for (size_t i = 0; i < num; i ++) {
+			const fndsa_sign_msg *m = &msgs[i];
+			if (sign_core_expanded(logn, fgFG, bg, hashed_key,
+				m->ctx, m->ctx_len, m->id, m->hv, m->hv_len,
+				seed, seed_len, NULL, sigs + i * sig_len,
+				tmp) == 0)
+			{
+				return i;
+			}
+		}
+		return num;
+	}
+
+	/* We decode f, g and F into a temporary area, and use them
+	   to recompute G. Only G will be provided in decoded format
+	   to sign_core(); f, g and F can be redecoded cheaply from
+	   the encoded key when needed. */
+	int8_t *f = (int8_t *)tmp + 4 * n;
+	int8_t *g = f + n;
+	int8_t *F = g + n;
+	int8_t *G = (int8_t *)tmp + ((size_t)58 << logn);
+	if (!decode_sign_key(logn, sign_key, f, g, F, G, hashed_key, tmp)) {
+		return 0;
+	}
 
 	/* We now have G, and we checked that f, g and F can be decoded
 	   successfully (no out-of-range element). Hashed public key is in
-	   hashed_key[]. We can proceed to the main signing loop. */
-	return sign_core(logn, sign_key + 1, G, hashed_key,
-		ctx, ctx_len, id, hv, hv_len,
-		seed, seed_len, sig, tmp);
+	   hashed_key[]. We can proceed to the main signing loop; sign_core()
+	   does not modify G, which can thus be used for all messages. */
+	for (size_t i = 0; i < num; i ++) {
+		const fndsa_sign_msg *m = &msgs[i];
+		if (sign_core(logn, sign_key + 1, G, hashed_key,
+			m->ctx, m->ctx_len, m->id, m->hv, m->hv_len,
+			seed, seed_len, sigs + i * sig_len, tmp) == 0)
+		{
+			return i;
+		}
+	}
+	return num;
 
 	/* TODO: maybe explicitly overwrite the whole temporary area with
 	   zeros? Arguably this is mostly wasted time if the area is
@@ -126,18 +178,21 @@ sign_step1(unsigned logn, const uint8_t *sign_key,
 
 /* Custom wrappers to allocate the temporary buffers on the stack. Several
    wrappers are defined so that stack allocation is not always worst-case. */
+#if FNDSA_SIGN_LARGE_TMP
+#define SIGN_TMP_SIZE(sz)   ((sz) * 110 + 31)
+#else
+#define SIGN_TMP_SIZE(sz)   ((sz) * 59 + 31)
+#endif
 #define SIGN_WRAP(sz)   \
 	static size_t sign_ ## sz(unsigned logn, \
 		const uint8_t *sign_key, \
-		const uint8_t *ctx, size_t ctx_len, \
-		const char *id, const uint8_t *hv, size_t hv_len, \
+		const fndsa_sign_msg *msgs, size_t num, \
 		const uint8_t *seed, size_t seed_len, \
-		uint8_t *sig) \
+		uint8_t *sigs) \
 	{ \
-		uint8_t tmp[(sz) * 59 + 31]; \
-		return sign_step1(logn, \
-			sign_key, ctx, ctx_len, id, hv, hv_len, \
-			seed, seed_len, sig, tmp); \
+		uint8_t tmp[SIGN_TMP_SIZE(sz)]; \
+		return sign_step1(logn, sign_key, msgs, num, \
+			seed, seed_len, sigs, tmp, sizeof tmp); \
 	}
 
 SIGN_WRAP(32)
@@ -147,14 +202,11 @@ SIGN_WRAP(256)
 SIGN_WRAP(512)
 SIGN_WRAP(1024)
 
-static size_t
-sign_wrapper(int weak,
-	const uint8_t *sign_key, size_t sign_key_len,
-	const uint8_t *ctx, size_t ctx_len,
-	const char *id, const uint8_t *hv, size_t hv_len,
-	const uint8_t *seed, size_t seed_len,
-	uint8_t *sig, size_t max_sig_len,
-	void *tmp, size_t tmp_len)
+/* Get the degree from the signing key header, and check that the key
+   size is correct. Returned value is logn, or 0 if the key is not
+   acceptable. */
+static unsigned
+sign_key_logn(int weak, const uint8_t *sign_key, size_t sign_key_len)
 {
 	/* Signing key defines the degree to use. */
 	if (sign_key_len == 0) {
@@ -177,52 +229,102 @@ sign_wrapper(int weak,
 	if (sign_key_len != FNDSA_SIGN_KEY_SIZE(logn)) {
 		return 0;
 	}
-	if (sig == NULL) {
-		return FNDSA_SIGNATURE_SIZE(logn);
-	}
-	if (max_sig_len < FNDSA_SIGNATURE_SIZE(logn)) {
-		return 0;
-	}
+	return logn;
+}
 
-	/* We have checked that the degree is acceptable, the signing key
-	   size is correct, and the signature will fit in the output buffer. */
+/* Sign num messages (degree and output buffer size have been checked);
+   the temporary area is allocated on the stack if tmp is NULL. Returned
+   value is the number of generated signatures. */
+static size_t
+sign_dispatch(unsigned logn, const uint8_t *sign_key,
+	const fndsa_sign_msg *msgs, size_t num,
+	const uint8_t *seed, size_t seed_len,
+	uint8_t *sigs, void *tmp, size_t tmp_len)
+{
 	if (tmp == NULL) {
 		switch (logn) {
 		case 6:
-			return sign_64(logn,
-				sign_key, ctx, ctx_len, id, hv, hv_len,
-				seed, seed_len, sig);
+			return sign_64(logn, sign_key, msgs, num,
+				seed, seed_len, sigs);
 		case 7:
-			return sign_128(logn,
-				sign_key, ctx, ctx_len, id, hv, hv_len,
-				seed, seed_len, sig);
+			return sign_128(logn, sign_key, msgs, num,
+				seed, seed_len, sigs);
 		case 8:
-			return sign_256(logn,
-				sign_key, ctx, ctx_len, id, hv, hv_len,
-				seed, seed_len, sig);
+			return sign_256(logn, sign_key, msgs, num,
+				seed, seed_len, sigs);
 		case 9:
-			return sign_512(logn,
-				sign_key, ctx, ctx_len, id, hv, hv_len,
-				seed, seed_len, sig);
+			return sign_512(logn, sign_key, msgs, num,
+				seed, seed_len, sigs);
 		case 10:
-			return sign_1024(logn,
-				sign_key, ctx, ctx_len, id, hv, hv_len,
-				seed, seed_len, sig);
+			return sign_1024(logn, sign_key, msgs, num,
+				seed, seed_len, sigs);
 		default:
-			return sign_32(logn,
-				sign_key, ctx, ctx_len, id, hv, hv_len,
-				seed, seed_len, sig);
+			return sign_32(logn, sign_key, msgs, num,
+				seed, seed_len, sigs);
 		}
 	} else {
 		if (tmp_len < (((size_t)59 << logn) + 31)) {
 			return 0;
 		}
-		return sign_step1(logn,
-			sign_key, ctx, ctx_len, id, hv, hv_len,
-			seed, seed_len, sig, tmp);
+		return sign_step1(logn, sign_key, msgs, num,
+			seed, seed_len, sigs, tmp, tmp_len);
 	}
 }
 
+static size_t
+sign_wrapper(int weak,
+	const uint8_t *sign_key, size_t sign_key_len,
+	const uint8_t *ctx, size_t ctx_len,
+	const char *id, const uint8_t *hv, size_t hv_len,
+	const uint8_t *seed, size_t seed_len,
+	uint8_t *sig, size_t max_sig_len,
+	void *tmp, size_t tmp_len)
+{
+	unsigned logn = sign_key_logn(weak, sign_key, sign_key_len);
+	if (logn == 0) {
+		return 0;
+	}
+	if (sig == NULL) {
+		return FNDSA_SIGNATURE_SIZE(logn);
+	}
+	if (max_sig_len < FNDSA_SIGNATURE_SIZE(logn)) {
+		return 0;
+	}
+
+	/* We have checked that the degree is acceptable, the signing key
+	   size is correct, and the signature will fit in the output buffer. */
+	fndsa_sign_msg msg;
+	msg.ctx = ctx;
+	msg.ctx_len = ctx_len;
+	msg.id = id;
+	msg.hv = hv;
+	msg.hv_len = hv_len;
+	if (sign_dispatch(logn, sign_key, &msg, 1,
+		seed, seed_len, sig, tmp, tmp_len) == 0)
+	{
+		return 0;
+	}
+	return FNDSA_SIGNATURE_SIZE(logn);
+}
+
+static size_t
+sign_batch_wrapper(int weak,
+	const uint8_t *sign_key, size_t sign_key_len,
+	const fndsa_sign_msg *msgs, size_t num,
+	uint8_t *sigs, size_t max_sigs_len,
+	void *tmp, size_t tmp_len)
+{
+	unsigned logn = sign_key_logn(weak, sign_key, sign_key_len);
+	if (logn == 0 || num == 0 || sigs == NULL) {
+		return 0;
+	}
+	if (max_sigs_len / FNDSA_SIGNATURE_SIZE(logn) < num) {
+		return 0;
+	}
+	return sign_dispatch(logn, sign_key, msgs, num,
+		NULL, 0, sigs, tmp, tmp_len);
+}
+
 /* see fndsa.h */
 size_t
 fndsa_sign(const void *sign_key, size_t sign_key_len,
@@ -326,3 +428,353 @@ fndsa_sign_weak_seeded_temp(const void *sign_key, size_t sign_key_len,
 		ctx, ctx_len, id, hv, hv_len,
 		seed, seed_len, sig, max_sig_len, tmp, tmp_len);
 }
+
+/* see fndsa.h */
+size_t
+fndsa_sign_batch(const void *sign_key, size_t sign_key_len,
+	const fndsa_sign_msg *msgs, size_t num,
+	void *sigs, size_t max_sigs_len)
+{
+	return sign_batch_wrapper(0, sign_key, sign_key_len,
+		msgs, num, sigs, max_sigs_len, NULL, 0);
+}
+
+/* see fndsa.h */
+size_t
+fndsa_sign_batch_temp(const void *sign_key, size_t sign_key_len,
+	const fndsa_sign_msg *msgs, size_t num,
+	void *sigs, size_t max_sigs_len,
+	void *tmp, size_t tmp_len)
+{
+	return sign_batch_wrapper(0, sign_key, sign_key_len,
+		msgs, num, sigs, max_sigs_len, tmp, tmp_len);
+}
+
+/* see fndsa.h */
+size_t
+fndsa_sign_weak_batch(const void *sign_key, size_t sign_key_len,
+	const fndsa_sign_msg *msgs, size_t num,
+	void *sigs, size_t max_sigs_len)
+{
+	return sign_batch_wrapper(1, sign_key, sign_key_len,
+		msgs, num, sigs, max_sigs_len, NULL, 0);
+}
+
+/* see fndsa.h */
+size_t
+fndsa_sign_weak_batch_temp(const void *sign_key, size_t sign_key_len,
+	const fndsa_sign_msg *msgs, size_t num,
+	void *sigs, size_t max_sigs_len,
+	void *tmp, size_t tmp_len)
+{
+	return sign_batch_wrapper(1, sign_key, sign_key_len,
+		msgs, num, sigs, max_sigs_len, tmp, tmp_len);
+}
+
+/*
+ * Expanded signing keys. The expanded key is stored in the caller-provided
+ * buffer, starting at the first 32-byte aligned address:
+ *    hashed verifying key (64 bytes)
+ *    header byte (0x50 + logn), then padding up to offset 96
+ *    B and Gram matrix, in FFT representation (6*n fpr slots)
+ *    f, g, F and G, decoded (4*n bytes)
+ * Since the alignment depends on the buffer address, the expanded key
+ * cannot be moved in memory.
+ */
+
+/* see fndsa.h */
+int
+fndsa_sign_key_expand(const void *sign_key, size_t sign_key_len,
+	void *esk, size_t esk_len)
+{
+	const uint8_t *sk = sign_key;
+	if (sign_key_len == 0) {
+		return 0;
+	}
+	unsigned head = sk[0];
+	if ((head & 0xF0) != 0x50) {
+		return 0;
+	}
+	unsigned logn = head & 0x0F;
+	if (logn < 2 || logn > 10) {
+		return 0;
+	}
+	if (sign_key_len != FNDSA_SIGN_KEY_SIZE(logn)) {
+		return 0;
+	}
+	if (esk_len < FNDSA_SIGN_KEY_EXPANDED_SIZE(logn)) {
+		return 0;
+	}
+	size_t n = (size_t)1 << logn;
+	uint8_t *buf = (uint8_t *)(((uintptr_t)esk + 31) & ~(uintptr_t)31);
+	fpr *bg = (fpr *)(buf + 96);
+	int8_t *fgFG = (int8_t *)(bg + 6 * n);
+
+	/* The header byte is set only on success, so that a failed
+	   expansion cannot be used for signing. We use the area for
+	   B as temporary storage for rebuilding G. */
+	buf[64] = 0;
+	if (!decode_sign_key(logn, sk, fgFG, fgFG + n, fgFG + 2 * n,
+		fgFG + 3 * n, buf, bg))
+	{
+		return 0;
+	}
+	sign_expand_basis(logn, fgFG, bg);
+	buf[64] = 0x50 + logn;
+	return 1;
+}
+
+/* Verified properties at this point:
+      degree is acceptable
+      expanded key buffer is large enough
+      signature buffer is large enough to receive the result
+      tmp is large enough (but not necessarily aligned)  */
+static size_t
+sign_expanded_step1(unsigned logn, const uint8_t *buf,
+	const uint8_t *ctx, size_t ctx_len,
+	const char *id, const uint8_t *hv, size_t hv_len,
+	const uint8_t *seed, size_t seed_len, fndsa_randpool *rp,
+	uint8_t *sig, void *tmp)
+{
+	size_t n = (size_t)1 << logn;
+	tmp = (void *)(((uintptr_t)tmp + 31) & ~(uintptr_t)31);
+	const fpr *bg = (const fpr *)(buf + 96);
+	const int8_t *fgFG = (const int8_t *)(bg + 6 * n);
+	return sign_core_expanded(logn, fgFG, bg, buf,
+		ctx, ctx_len, id, hv, hv_len,
+		seed, seed_len, rp, sig, tmp);
+}
+
+/* Stack wrappers for signing with an expanded key; the temporary area is
+   smaller than for the plain signing functions since G is already in
+   the expanded key. */
+#define SIGN_EXPANDED_WRAP(sz)   \
+	static size_t sign_expanded_ ## sz(unsigned logn, \
+		const uint8_t *buf, \
+		const uint8_t *ctx, size_t ctx_len, \
+		const char *id, const uint8_t *hv, size_t hv_len, \
+		const uint8_t *seed, size_t seed_len, fndsa_randpool *rp, \
+		uint8_t *sig) \
+	{ \
+		uint8_t tmp[(sz) * 58 + 31]; \
+		return sign_expanded_step1(logn, \
+			buf, ctx, ctx_len, id, hv, hv_len, \
+			seed, seed_len, rp, sig, tmp); \
+	}
+
+SIGN_EXPANDED_WRAP(32)
+SIGN_EXPANDED_WRAP(64)
+SIGN_EXPANDED_WRAP(128)
+SIGN_EXPANDED_WRAP(256)
+SIGN_EXPANDED_WRAP(512)
+SIGN_EXPANDED_WRAP(1024)
+
+static size_t
+sign_expanded_wrapper(int weak,
+	const uint8_t *esk, size_t esk_len,
+	const uint8_t *ctx, size_t ctx_len,
+	const char *id, const uint8_t *hv, size_t hv_len,
+	const uint8_t *seed, size_t seed_len, fndsa_randpool *rp,
+	uint8_t *sig, size_t max_sig_len,
+	void *tmp, size_t tmp_len)
+{
+	/* The smallest expanded key buffer is enough to reach the
+	   header byte. */
+	if (esk_len < FNDSA_SIGN_KEY_EXPANDED_SIZE(2)) {
+		return 0;
+	}
+	const uint8_t *buf = (const uint8_t *)
+		(((uintptr_t)esk + 31) & ~(uintptr_t)31);
+	unsigned head = buf[64];
+	if ((head & 0xF0) != 0x50) {
+		return 0;
+	}
+	unsigned logn = head & 0x0F;
+	if (weak) {
+		if (logn < 2 || logn > 8) {
+			return 0;
+		}
+	} else {
+		if (logn < 9 || logn > 10) {
+			return 0;
+		}
+	}
+	if (esk_len < FNDSA_SIGN_KEY_EXPANDED_SIZE(logn)) {
+		return 0;
+	}
+	if (rp != NULL && randpool_logn(rp) != logn) {
+		return 0;
+	}
+	if (sig == NULL) {
+		return FNDSA_SIGNATURE_SIZE(logn);
+	}
+	if (max_sig_len < FNDSA_SIGNATURE_SIZE(logn)) {
+		return 0;
+	}
+
+	if (tmp == NULL) {
+		switch (logn) {
+		case 6:
+			return sign_expanded_64(logn,
+				buf, ctx, ctx_len, id, hv, hv_len,
+				seed, seed_len, rp, sig);
+		case 7:
+			return sign_expanded_128(logn,
+				buf, ctx, ctx_len, id, hv, hv_len,
+				seed, seed_len, rp, sig);
+		case 8:
+			return sign_expanded_256(logn,
+				buf, ctx, ctx_len, id, hv, hv_len,
+				seed, seed_len, rp, sig);
+		case 9:
+			return sign_expanded_512(logn,
+				buf, ctx, ctx_len, id, hv, hv_len,
+				seed, seed_len, rp, sig);
+		case 10:
+			return sign_expanded_1024(logn,
+				buf, ctx, ctx_len, id, hv, hv_len,
+				seed, seed_len, rp, sig);
+		default:
+			return sign_expanded_32(logn,
+				buf, ctx, ctx_len, id, hv, hv_len,
+				seed, seed_len, rp, sig);
+		}
+	} else {
+		if (tmp_len < (((size_t)58 << logn) + 31)) {
+			return 0;
+		}
+		return sign_expanded_step1(logn,
+			buf, ctx, ctx_len, id, hv, hv_len,
+			seed, seed_len, rp, sig, tmp);
+	}
+}
+
+/* see fndsa.h */
+size_t
+fndsa_sign_expanded(const void *esk, size_t esk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len,
+	void *sig, size_t max_sig_len)
+{
+	return sign_expanded_wrapper(0, esk, esk_len,
+		ctx, ctx_len, id, hv, hv_len,
+		NULL, 0, NULL, sig, max_sig_len, NULL, 0);
+}
+
+/* see fndsa.h */
+size_t
+fndsa_sign_expanded_temp(const void *esk, size_t esk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len,
+	void *sig, size_t max_sig_len,
+	void *tmp, size_t tmp_len)
+{
+	return sign_expanded_wrapper(0, esk, esk_len,
+		ctx, ctx_len, id, hv, hv_len,
+		NULL, 0, NULL, sig, max_sig_len, tmp, tmp_len);
+}
+
+/* see fndsa.h */
+size_t
+fndsa_sign_expanded_seeded(const void *esk, size_t esk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len,
+	const void *seed, size_t seed_len,
+	void *sig, size_t max_sig_len)
+{
+	return sign_expanded_wrapper(0, esk, esk_len,
+		ctx, ctx_len, id, hv, hv_len,
+		seed, seed_len, NULL, sig, max_sig_len, NULL, 0);
+}
+
+/* see fndsa.h */
+size_t
+fndsa_sign_expanded_seeded_temp(const void *esk, size_t esk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len,
+	const void *seed, size_t seed_len,
+	void *sig, size_t max_sig_len,
+	void *tmp, size_t tmp_len)
+{
+	return sign_expanded_wrapper(0, esk, esk_len,
+		ctx, ctx_len, id, hv, hv_len,
+		seed, seed_len, NULL, sig, max_sig_len, tmp, tmp_len);
+}
+
+/* see fndsa.h */
+size_t
+fndsa_sign_weak_expanded(const void *esk, size_t esk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len,
+	void *sig, size_t max_sig_len)
+{
+	return sign_expanded_wrapper(1, esk, esk_len,
+		ctx, ctx_len, id, hv, hv_len,
+		NULL, 0, NULL, sig, max_sig_len, NULL, 0);
+}
+
+/* see fndsa.h */
+size_t
+fndsa_sign_weak_expanded_temp(const void *esk, size_t esk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len,
+	void *sig, size_t max_sig_len,
+	void *tmp, size_t tmp_len)
+{
+	return sign_expanded_wrapper(1, esk, esk_len,
+		ctx, ctx_len, id, hv, hv_len,
+		NULL, 0, NULL, sig, max_sig_len, tmp, tmp_len);
+}
+
+/* see fndsa.h */
+size_t
+fndsa_sign_weak_expanded_seeded(const void *esk, size_t esk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len,
+	const void *seed, size_t seed_len,
+	void *sig, size_t max_sig_len)
+{
+	return sign_expanded_wrapper(1, esk, esk_len,
+		ctx, ctx_len, id, hv, hv_len,
+		seed, seed_len, NULL, sig, max_sig_len, NULL, 0);
+}
+
+/* see fndsa.h */
+size_t
+fndsa_sign_weak_expanded_seeded_temp(const void *esk, size_t esk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len,
+	const void *seed, size_t seed_len,
+	void *sig, size_t max_sig_len,
+	void *tmp, size_t tmp_len)
+{
+	return sign_expanded_wrapper(1, esk, esk_len,
+		ctx, ctx_len, id, hv, hv_len,
+		seed, seed_len, NULL, sig, max_sig_len, tmp, tmp_len);
+}
+
+/* see fndsa.h */
+size_t
+fndsa_sign_expanded_pooled(fndsa_randpool *rp,
+	const void *esk, size_t esk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len,
+	void *sig, size_t max_sig_len)
+{
+	return sign_expanded_wrapper(0, esk, esk_len,
+		ctx, ctx_len, id, hv, hv_len,
+		NULL, 0, rp, sig, max_sig_len, NULL, 0);
+}
+
+/* see fndsa.h */
+size_t
+fndsa_sign_weak_expanded_pooled(fndsa_randpool *rp,
+	const void *esk, size_t esk_len,
+	const void *ctx, size_t ctx_len,
+	const char *id, const void *hv, size_t hv_len,
+	void *sig, size_t max_sig_len)
+{
+	return sign_expanded_wrapper(1, esk, esk_len,
+		ctx, ctx_len, id, hv, hv_len,
+		NULL, 0, rp, sig, max_sig_len, NULL, 0);
+}
@@ -4,29 +4,468 @@
 
 #include "sign_inner.h"
 
+/* When AVX2 support is compiled in, the polynomial functions are
+   called through FPOLY(), which selects the version that matches the
+   SIMD tier held in the simd_tier variable (a local variable or
+   parameter). All versions compute the same values. */
+#if FNDSA_AVX512_FPOLY
+#define FPOLY(name)   (simd_tier >= SIMD_TIER_AVX512 ? avx512_fpoly_ ## name \
+	: simd_tier >= SIMD_TIER_AVX2 ? avx2_fpoly_ ## name : fpoly_ ## name)
+#elif FNDSA_AVX2_FPOLY
+#define FPOLY(name)   (simd_tier >= SIMD_TIER_AVX2 \
+	? avx2_fpoly_ ## name : fpoly_ ## name)
+#else
+#define FPOLY(name)   fpoly_ ## name
+#endif
+
+/* Get the best SIMD tier supported by the current CPU for the signing
+   computations (SIMD_TIER_BASE if no runtime-selected code is compiled
+   in). */
+static unsigned
+get_simd_tier(void)
+{
+#if FNDSA_AVX512_FPOLY
+	if (has_avx512()) {
+		return SIMD_TIER_AVX512;
+	}
+#endif
+#if FNDSA_AVX2_FPOLY
+	if (has_avx2()) {
+		return SIMD_TIER_AVX2;
+	}
+#endif
+	return SIMD_TIER_BASE;
+}
+
+/* Fast Fourier sampling with the ffsamp_fft() variant for the provided
+   SIMD tier. */
+static void
+ffsamp_fft_tier(unsigned simd_tier, sampler_state *ss, fpr *tmp)
+{
+#if FNDSA_AVX512_FPOLY
+	if (simd_tier >= SIMD_TIER_AVX512) {
+		avx512_ffsamp_fft(ss, tmp);
+		return;
+	}
+#endif
+#if FNDSA_AVX2_FPOLY
+	if (simd_tier >= SIMD_TIER_AVX2) {
+		avx2_ffsamp_fft(ss, tmp);
+		return;
+	}
+#endif
+	(void)simd_tier;
+	ffsamp_fft(ss, tmp);
+}
+
 /* Given f, g, F and G, return the basis [[g, -f], [G, -F]] in FFT
    format (b00, b01, b10 and b11, in that order, are written in the
    destination). */
 static void
-basis_to_FFT(unsigned logn,
+basis_to_FFT(unsigned logn, unsigned simd_tier,
 	const int8_t *f, const int8_t *g, const int8_t *F, const int8_t *G,
 	fpr *dst)
 {
+	(void)simd_tier;
 	size_t n = (size_t)1 << logn;
 	fpr *b00 = dst;
 	fpr *b01 = b00 + n;
 	fpr *b10 = b01 + n;
 	fpr *b11 = b10 + n;
-	fpoly_set_small(logn, b01, f);
-	fpoly_set_small(logn, b00, g);
-	fpoly_set_small(logn, b11, F);
-	fpoly_set_small(logn, b10, G);
-	fpoly_FFT(logn, b01);
-	fpoly_FFT(logn, b00);
-	fpoly_FFT(logn, b11);
-	fpoly_FFT(logn, b10);
-	fpoly_neg(logn, b01);
-	fpoly_neg(logn, b11);
+	FPOLY(set_small)(logn, b01, f);
+	FPOLY(set_small)(logn, b00, g);
+	FPOLY(set_small)(logn, b11, F);
+	FPOLY(set_small)(logn, b10, G);
+	FPOLY(FFT)(logn, b01);
+	FPOLY(FFT)(logn, b00);
+	FPOLY(FFT)(logn, b11);
+	FPOLY(FFT)(logn, b10);
+	FPOLY(neg)(logn, b01);
+	FPOLY(neg)(logn, b11);
+}
+
+/* see sign_inner.h */
+TARGET_SSE2 TARGET_NEON
+void
+sign_expand_basis(unsigned logn, const int8_t *fgFG, fpr *dst)
+{
+#if FNDSA_SSE2
+	unsigned round_mode = _MM_GET_ROUNDING_MODE();
+	_MM_SET_ROUNDING_MODE(_MM_ROUND_NEAREST);
+#endif
+	unsigned simd_tier = get_simd_tier();
+
+	size_t n = (size_t)1 << logn;
+	size_t hn = n >> 1;
+	const int8_t *f = fgFG;
+	const int8_t *g = f + n;
+	const int8_t *F = g + n;
+	const int8_t *G = F + n;
+
+	/* fpoly_gram_fft() overwrites b00, b01 and b10, so we first
+	   compute the basis in the upper 4*n slots, then move the Gram
+	   matrix to its final place (g00 and g11 go through the lower
+	   slots, which are free at this point), and finally compute
+	   the basis again in the lower 4*n slots. */
+	fpr *b00 = dst + 2 * n;
+	fpr *b01 = b00 + n;
+	fpr *b10 = b01 + n;
+	fpr *b11 = b10 + n;
+	basis_to_FFT(logn, simd_tier, f, g, F, G, b00);
+	FPOLY(gram_fft)(logn, b00, b01, b10, b11);
+	fpr *g01 = dst + 4 * n;
+	fpr *g00 = g01 + n;
+	fpr *g11 = g00 + hn;
+	memcpy(dst, b00, hn * sizeof(fpr));
+	memcpy(dst + hn, b10, hn * sizeof(fpr));
+	memcpy(g01, b01, n * sizeof(fpr));
+	memcpy(g00, dst, hn * sizeof(fpr));
+	memcpy(g11, dst + hn, hn * sizeof(fpr));
+	basis_to_FFT(logn, simd_tier, f, g, F, G, dst);
+
+#if FNDSA_SSE2
+	_MM_SET_ROUNDING_MODE(round_mode);
+#endif
+}
+
+/* Generate the nonce (40 bytes) and the sub-seed (56 bytes) for
+   iteration number counter, into rndbuf[]. tmp is used for the SHAKE
+   context (at least 208 bytes, 8-byte aligned). Returned value is 1 on
+   success, 0 if the system RNG failed. */
+static int
+sign_gen_rnd(uint32_t counter, int orig_falcon,
+	const uint8_t *seed, size_t seed_len, uint8_t *rndbuf, void *tmp)
+{
+	/* In the original Falcon, the nonce was not regenerated in case
+	   of restart, but regenerating it makes the algorithm security
+	   easier to analyze and prove.
+
+	   When working with an explicit seed: normally, we hash
+	   together the seed and a loop counter. For test purposes,
+	   if we are using the original Falcon behaviour, this is
+	   the first iteration, and the seed length is exactly 96
+	   bytes, then we use the seed directly. */
+	uint8_t *rndp;
+	size_t rndlen;
+	if (counter == 0 || !orig_falcon) {
+		rndp = rndbuf;
+		rndlen = 40 + 56;
+	} else {
+		rndp = rndbuf + 40;
+		rndlen = 56;
+	}
+	if (seed == NULL) {
+		return sysrng(rndp, rndlen);
+	} else if (orig_falcon && counter == 0 && seed_len == rndlen) {
+		memcpy(rndp, seed, rndlen);
+	} else {
+		shake_context *sc = (shake_context *)tmp;
+		shake_init(sc, 256);
+		shake_inject(sc, seed, seed_len);
+		uint8_t cbuf[4];
+		cbuf[0] = (uint8_t)counter;
+		cbuf[1] = (uint8_t)(counter >> 8);
+		cbuf[2] = (uint8_t)(counter >> 16);
+		cbuf[3] = (uint8_t)(counter >> 24);
+		shake_inject(sc, cbuf, 4);
+		shake_flip(sc);
+		shake_extract(sc, rndp, rndlen);
+	}
+	return 1;
+}
+
+/* Given the sampled vector [t0,t1] (in FFT representation, at the
+   start of tmp), compute the signature value, check its norm, and
+   encode it. On the FPU paths, the lattice basis B (b00, b01, b10 and
+   b11, in FFT representation) must have been written in tmp right
+   after t1; on other paths, f, g, F and G are used instead. The
+   decoded f and g must not overlap with tmp[] up to 24*n bytes.
+   Returned value is the signature length on success, or 0 if the
+   candidate signature was rejected (the caller should then loop). */
+TARGET_SSE2 TARGET_NEON
+static size_t
+sign_finish(unsigned logn, unsigned simd_tier,
+	const int8_t *f, const int8_t *g, const int8_t *F, const int8_t *G,
+	const uint16_t *hm, const uint8_t *nonce, uint8_t *sig, fpr *tmp)
+{
+	(void)simd_tier;
+	size_t n = (size_t)1 << logn;
+	fpr *t0 = tmp;
+	fpr *t1 = t0 + n;
+
+	/*
+	 * At this point, [t0,t1] are the FFT representation of
+	 * the sampled vector; in normal (non-FFT) representation,
+	 * [t0,t1] is integral. We want to apply the lattice basis
+	 * Compute the lattice basis B = [[g, -f], [G, -F]] to that
+	 * vector, and subtract the result from [hm,0] to get the
+	 * signature value. These computations can be done either
+	 * in the FFT domain, or in with integers; and integer
+	 * computations can be done modulo q = 12289 since the
+	 * signature verification also works modulo q. Using
+	 * integers is faster than staying in FFT representation
+	 * when floating-point operations are emulated.
+	 */
+#if !(FNDSA_SSE2 || FNDSA_NEON || FNDSA_RV64D)
+
+	/* Convert [t0, t1] to integers modulo q. */
+	fpoly_iFFT(logn, t0);
+	fpoly_iFFT(logn, t1);
+	uint16_t *ut0 = (uint16_t *)(t1 + n);
+	uint16_t *ut1 = ut0 + n;
+	uint16_t *ut2 = ut1 + n;
+	uint16_t *ut3 = ut2 + n;
+#if FNDSA_SSE2
+	/* We inline an fpr_rint() implementation, using SSE2
+	   intrinsics (_mm_cvtpd_epi32() for rounding to neareast
+	   with roundTiesToEven). */
+	for (size_t i = 0; i < n; i += 2) {
+		__m128d xt = _mm_loadu_pd((const double *)t0 + i);
+		__m128i zt = _mm_cvtpd_epi32(xt);
+		ut0[i + 0] = (uint16_t)_mm_cvtsi128_si32(zt);
+		ut0[i + 1] = (uint16_t)_mm_cvtsi128_si32(
+			_mm_bsrli_si128(zt, 4));
+	}
+	for (size_t i = 0; i < n; i += 2) {
+		__m128d xt = _mm_loadu_pd((const double *)t1 + i);
+		__m128i zt = _mm_cvtpd_epi32(xt);
+		ut1[i + 0] = (uint16_t)_mm_cvtsi128_si32(zt);
+		ut1[i + 1] = (uint16_t)_mm_cvtsi128_si32(
+			_mm_bsrli_si128(zt, 4));
+	}
+#elif FNDSA_NEON
+	/* We inline an fpr_rint() implementation, using NEON
+	   intrinsics (vcvtnq_s64_f64() for rounding to neareast
+	   with roundTiesToEven). */
+	for (size_t i = 0; i < n; i += 2) {
+		float64x2_t xt = vld1q_f64((const float64_t *)t0 + i);
+		int64x2_t zt = vcvtnq_s64_f64(xt);
+		ut0[i + 0] = (uint16_t)vgetq_lane_s64(zt, 0);
+		ut0[i + 1] = (uint16_t)vgetq_lane_s64(zt, 1);
+	}
+	for (size_t i = 0; i < n; i += 2) {
+		float64x2_t xt = vld1q_f64((const float64_t *)t1 + i);
+		int64x2_t zt = vcvtnq_s64_f64(xt);
+		ut1[i + 0] = (uint16_t)vgetq_lane_s64(zt, 0);
+		ut1[i + 1] = (uint16_t)vgetq_lane_s64(zt, 1);
+	}
+#elif FNDSA_RV64D
+	const f64 *tt0 = (const f64 *)t0;
+	const f64 *tt1 = (const f64 *)t1;
+	for (size_t i = 0; i < n; i ++) {
+		ut0[i] = (uint64_t)f64_rint(tt0[i]);
+	}
+	for (size_t i = 0; i < n; i ++) {
+		ut1[i] = (uint64_t)f64_rint(tt1[i]);
+	}
+#else
+	for (size_t i = 0; i < n; i ++) {
+		ut0[i] = (uint16_t)fpr_rint(t0[i]);
+		ut1[i] = (uint16_t)fpr_rint(t1[i]);
+	}
+#endif
+	mqpoly_signed_to_int(logn, ut0);
+	mqpoly_signed_to_int(logn, ut1);
+
+	/* Convert [t0,t1] to NTT. */
+	mqpoly_int_to_ntt(logn, ut0);
+	mqpoly_int_to_ntt(logn, ut1);
+
+	/* s1 = hm - (g*t0 + G*t1).
+	   We compute s1 into ut3; we do not need to keep s1,
+	   only its squared norm. */
+	mqpoly_small_to_int(logn, g, ut2);
+	mqpoly_small_to_int(logn, G, ut3);
+	mqpoly_int_to_ntt(logn, ut2);
+	mqpoly_int_to_ntt(logn, ut3);
+	mqpoly_mul_ntt(logn, ut2, ut0);
+	mqpoly_mul_ntt(logn, ut3, ut1);
+	mqpoly_add(logn, ut2, ut3);
+	mqpoly_ntt_to_int(logn, ut2);
+	memcpy(ut3, hm, n * sizeof(uint16_t));
+	mqpoly_ext_to_int(logn, ut3);
+	mqpoly_sub(logn, ut3, ut2);
+	uint32_t sqn1 = mqpoly_sqnorm_int(logn, ut3);
+
+	/* s2 = -(-f*t0 - F*t1) = f*t0 + F*t1
+	   We compute s2 into ut3. */
+	mqpoly_small_to_int(logn, f, ut2);
+	mqpoly_small_to_int(logn, F, ut3);
+	mqpoly_int_to_ntt(logn, ut2);
+	mqpoly_int_to_ntt(logn, ut3);
+	mqpoly_mul_ntt(logn, ut2, ut0);
+	mqpoly_mul_ntt(logn, ut3, ut1);
+	mqpoly_add(logn, ut3, ut2);
+	mqpoly_ntt_to_int(logn, ut3);
+	uint32_t sqn2 = mqpoly_sqnorm_int_to_signed(logn, ut3);
+
+	/* If either squared norm saturated, or the sum (i.e.
+	   the total squared norm of [s1,s2]) is too high, then
+	   we loop. */
+	uint32_t sqn = sqn1 + sqn2;
+	sqn1 |= sqn2;
+	sqn |= (uint32_t)(*(int32_t *)&sqn1 >> 31);
+	if (!mqpoly_sqnorm_is_acceptable(logn, sqn)) {
+		return 0;
+	}
+	int16_t *s2 = (int16_t *)ut3;
+
+#else
+	/*
+	 * We stay here in the floating-point domain for the
+	 * application of the basis. This happens to be faster
+	 * on our test platforms with a hardware FPU.
+	 */
+
+	/* Get the lattice point corresponding to the sampled
+	   vector. This means computing:
+	      [v0,v1] = [t0,t1] * [[g, -f], [G, -F]]
+	   hence:
+	      v0 = t0*g + t1*G
+	      v1 = -t0*f - t1*F
+	   The basis (in FFT representation) has been written by the
+	   caller right after t1; it is consumed. */
+	(void)f;
+	(void)g;
+	(void)F;
+	(void)G;
+	fpr *b00 = t1 + n;
+	fpr *b01 = b00 + n;
+	fpr *b10 = b01 + n;
+	fpr *b11 = b10 + n;
+	FPOLY(mul_fft)(logn, b01, t0);
+	FPOLY(mul_fft)(logn, t0, b00);
+	FPOLY(mul_fft)(logn, b10, t1);
+	FPOLY(add)(logn, t0, b10);
+	FPOLY(mul_fft)(logn, t1, b11);
+	FPOLY(add)(logn, t1, b01);
+	FPOLY(iFFT)(logn, t0);
+	FPOLY(iFFT)(logn, t1);
+
+	/* We compute s1, then s2 into buffer s2 (s1 is not
+	   retained). We accumulate their squared norm in sqn,
+	   with an "overflow" flag in ng. */
+	uint32_t sqn = 0;
+	uint32_t ng = 0;
+	int16_t *s2 = (int16_t *)b00;
+#if FNDSA_SSE2
+	/* We inline an fpr_rint() implementation, using SSE2
+	   intrinsics (_mm_cvtpd_epi32() for rounding to neareast
+	   with roundTiesToEven). */
+	for (size_t i = 0; i < n; i += 2) {
+		__m128d xt = _mm_loadu_pd((const double *)t0 + i);
+		__m128i zt = _mm_cvtpd_epi32(xt);
+		uint16_t zu0 = hm[i + 0]
+			- (uint16_t)_mm_cvtsi128_si32(zt);
+		uint16_t zu1 = hm[i + 1]
+			- (uint16_t)_mm_cvtsi128_si32(
+				_mm_bsrli_si128(zt, 4));
+		int32_t z0 = (int32_t)*(int16_t *)&zu0;
+		int32_t z1 = (int32_t)*(int16_t *)&zu1;
+		sqn += (uint32_t)(z0 * z0);
+		ng |= sqn;
+		sqn += (uint32_t)(z1 * z1);
+		ng |= sqn;
+	}
+	for (size_t i = 0; i < n; i += 2) {
+		__m128d xt = _mm_loadu_pd((const double *)t1 + i);
+		__m128i zt = _mm_cvtpd_epi32(xt);
+		uint16_t zu0 = -(uint16_t)_mm_cvtsi128_si32(zt);
+		uint16_t zu1 = -(uint16_t)_mm_cvtsi128_si32(
+			_mm_bsrli_si128(zt, 4));
+		int32_t z0 = (int32_t)*(int16_t *)&zu0;
+		int32_t z1 = (int32_t)*(int16_t *)&zu1;
+		sqn += (uint32_t)(z0 * z0);
+		ng |= sqn;
+		sqn += (uint32_t)(z1 * z1);
+		ng |= sqn;
+		s2[i + 0] = (int16_t)z0;
+		s2[i + 1] = (int16_t)z1;
+	}
+#elif FNDSA_NEON
+	/* We inline an fpr_rint() implementation, using NEON
+	   intrinsics (vcvtnq_s64_f64() for rounding to neareast
+	   with roundTiesToEven). */
+	for (size_t i = 0; i < n; i += 2) {
+		float64x2_t xt = vld1q_f64((const float64_t *)t0 + i);
+		int64x2_t zt = vcvtnq_s64_f64(xt);
+		uint16_t zu0 = hm[i + 0]
+			- (uint16_t)vgetq_lane_s64(zt, 0);
+		uint16_t zu1 = hm[i + 1]
+			- (uint16_t)vgetq_lane_s64(zt, 1);
+		int32_t z0 = (int32_t)*(int16_t *)&zu0;
+		int32_t z1 = (int32_t)*(int16_t *)&zu1;
+		sqn += (uint32_t)(z0 * z0);
+		ng |= sqn;
+		sqn += (uint32_t)(z1 * z1);
+		ng |= sqn;
+	}
+	for (size_t i = 0; i < n; i += 2) {
+		float64x2_t xt = vld1q_f64((const float64_t *)t1 + i);
+		int64x2_t zt = vcvtnq_s64_f64(xt);
+		uint16_t zu0 = -(uint16_t)vgetq_lane_s64(zt, 0);
+		uint16_t zu1 = -(uint16_t)vgetq_lane_s64(zt, 1);
+		int32_t z0 = (int32_t)*(int16_t *)&zu0;
+		int32_t z1 = (int32_t)*(int16_t *)&zu1;
+		sqn += (uint32_t)(z0 * z0);
+		ng |= sqn;
+		sqn += (uint32_t)(z1 * z1);
+		ng |= sqn;
+		s2[i + 0] = (int16_t)z0;
+		s2[i + 1] = (int16_t)z1;
+	}
+#elif FNDSA_RV64D
+	const f64 *tt0 = (const f64 *)t0;
+	const f64 *tt1 = (const f64 *)t1;
+	for (size_t i = 0; i < n; i ++) {
+		uint16_t zu = hm[i] - (uint16_t)f64_rint(tt0[i]);
+		int32_t z = *(int16_t *)&zu;
+		sqn += (uint32_t)(z * z);
+		ng |= sqn;
+	}
+	for (size_t i = 0; i < n; i ++) {
+		uint16_t zu = -(uint16_t)f64_rint(tt1[i]);
+		int32_t z = *(int16_t *)&zu;
+		sqn += (uint32_t)(z * z);
+		ng |= sqn;
+		s2[i] = (int16_t)z;
+	}
+#else
+	for (size_t i = 0; i < n; i ++) {
+		uint16_t zu = hm[i] - (uint16_t)fpr_rint(t0[i]);
+		int32_t z = *(int16_t *)&zu;
+		sqn += (uint32_t)(z * z);
+		ng |= sqn;
+	}
+	for (size_t i = 0; i < n; i ++) {
+		uint16_t zu = -(uint16_t)fpr_rint(t1[i]);
+		int32_t z = *(int16_t *)&zu;
+		sqn += (uint32_t)(z * z);
+		ng |= sqn;
+		s2[i] = (int16_t)z;
+	}
+#endif
+
+	/* If the squared norm exceeds 2^31-1, then at some point
+	   the high bit of ng was set, which we use to saturate
+	   the squared norm to 2^32-1. If the squared norm is
+	   unacceptable, then we loop. */
+	sqn |= (uint32_t)(*(int32_t *)&ng >> 31);
+	if (!mqpoly_sqnorm_is_acceptable(logn, sqn)) {
+		return 0;
+	}
+#endif
+
+	/* We have a candidate signature; we must encode it. This
+	   may fail, if the signature cannot be encoded in the
+	   target size. */
+	size_t sig_len = FNDSA_SIGNATURE_SIZE(logn);
+	if (!comp_encode(logn, s2, sig + 41, sig_len - 41)) {
+		return 0;
+	}
+	sig[0] = 0x30 + logn;
+	memcpy(sig + 1, nonce, 40);
+	return sig_len;
 }
 
 /* see sign_inner.h */
@@ -54,6 +493,7 @@ sign_core(unsigned logn,
 	   which is not IEEE-754 compliant, but we do not care because
 	   we never get any denormal value anywhere in signature
 	   generation). */
+	unsigned simd_tier = get_simd_tier();
 
 	size_t n = (size_t)1 << logn;
 	size_t hn = n >> 1;
@@ -94,47 +534,14 @@ sign_core(unsigned logn,
 	   use F. */
 
 	for (uint32_t counter = 0;; counter ++) {
-		/* Generate the nonce and the sub-seed. In the original
-		   Falcon, the nonce was not regenerated in case of
-		   restart, but regenerating it makes the algorithm security
-		   easier to analyze and prove.
-
-		   When working with an explicit seed: normally, we hash
-		   together the seed and a loop counter. For test purposes,
-		   if we are using the original Falcon behaviour, this is
-		   the first iteration, and the seed length is exactly 96
-		   bytes, then we use the seed directly. */
-		uint8_t *rndp;
-		size_t rndlen;
-		if (counter == 0 || !orig_falcon) {
-			rndp = rndbuf;
-			rndlen = sizeof rndbuf;
-		} else {
-			rndp = rndbuf + 40;
-			rndlen = (sizeof rndbuf) - 40;
-		}
-		if (seed == NULL) {
-			if (!sysrng(rndp, rndlen)) {
-				goto sign_exit;
-			}
-		} else if (orig_falcon && counter == 0 && seed_len == rndlen) {
-			memcpy(rndp, seed, rndlen);
-		} else {
-			/* We can use the tmp buffer for the SHAKE context.
-			   It even works at n = 4 (logn = 2) because there
-			   are 58*4 = 232 bytes free in tmp[] at this point,
-			   and we need only 208. */
-			shake_context *sc = (shake_context *)tmp;
-			shake_init(sc, 256);
-			shake_inject(sc, seed, seed_len);
-			uint8_t cbuf[4];
-			cbuf[0] = (uint8_t)counter;
-			cbuf[1] = (uint8_t)(counter >> 8);
-			cbuf[2] = (uint8_t)(counter >> 16);
-			cbuf[3] = (uint8_t)(counter >> 24);
-			shake_inject(sc, cbuf, 4);
-			shake_flip(sc);
-			shake_extract(sc, rndp, rndlen);
+		/* Generate the nonce and the sub-seed. We can use the tmp
+		   buffer for the SHAKE context. It even works at n = 4
+		   (logn = 2) because there are 58*4 = 232 bytes free in
+		   tmp[] at this point, and we need only 208. */
+		if (!sign_gen_rnd(counter, orig_falcon,
+			seed, seed_len, rndbuf, tmp))
+		{
+			goto sign_exit;
 		}
 
 		/* Hash the message into a polynomial. */
@@ -168,14 +575,14 @@ sign_core(unsigned logn,
 		(void)trim_i8_decode(logn, sign_key_fgF + flen, g, nbits);
 		fpr *t0 = (fpr *)tmp;
 		fpr *t1 = t0 + n;
-		basis_to_FFT(logn, f, g, F, G, t1 + n);
+		basis_to_FFT(logn, simd_tier, f, g, F, G, t1 + n);
 		fpr *b00 = t1 + n;
 		fpr *b01 = b00 + n;
 		fpr *b10 = b01 + n;
 		fpr *b11 = b10 + n;
 		fpr *t2 = b11 + n;
 		memcpy(t2, b01, n * sizeof(fpr));
-		fpoly_gram_fft(logn, b00, b01, b10, b11);
+		FPOLY(gram_fft)(logn, b00, b01, b10, b11);
 
 		/* We now move things a bit to get the following (taking
 		   into account that g00 and g11 are self-adjoint, hence
@@ -199,7 +606,7 @@ sign_core(unsigned logn,
 		   lattice basis to obtain the real target vector (after
 		   normalization with regard to the modulus q).
 		   b11 is unchanged, but b01 is in t2. */
-		fpoly_apply_basis(logn, t0, t1, t2, b11, hm);
+		FPOLY(apply_basis)(logn, t0, t1, t2, b11, hm);
 
 		/* Current layout:
 		      t0  (n)
@@ -210,290 +617,114 @@ sign_core(unsigned logn,
 		   We now do the Fast Fourier sampling, which uses
 		   up to 3*n slots beyond t1 (hence 7*n total usage
 		   in tmp[]). */
-		ffsamp_fft(&ss, tmp);
-
-		/*
-		 * At this point, [t0,t1] are the FFT representation of
-		 * the sampled vector; in normal (non-FFT) representation,
-		 * [t0,t1] is integral. We want to apply the lattice basis
-		 * Compute the lattice basis B = [[g, -f], [G, -F]] to that
-		 * vector, and subtract the result from [hm,0] to get the
-		 * signature value. These computations can be done either
-		 * in the FFT domain, or in with integers; and integer
-		 * computations can be done modulo q = 12289 since the
-		 * signature verification also works modulo q. Using
-		 * integers is faster than staying in FFT representation
-		 * when floating-point operations are emulated.
-		 */
-#if !(FNDSA_SSE2 || FNDSA_NEON || FNDSA_RV64D)
-
-		/* Convert [t0, t1] to integers modulo q. */
-		fpoly_iFFT(logn, t0);
-		fpoly_iFFT(logn, t1);
-		uint16_t *ut0 = (uint16_t *)(t1 + n);
-		uint16_t *ut1 = ut0 + n;
-		uint16_t *ut2 = ut1 + n;
-		uint16_t *ut3 = ut2 + n;
-#if FNDSA_SSE2
-		/* We inline an fpr_rint() implementation, using SSE2
-		   intrinsics (_mm_cvtpd_epi32() for rounding to neareast
-		   with roundTiesToEven). */
-		for (size_t i = 0; i < n; i += 2) {
-			__m128d xt = _mm_loadu_pd((const double *)t0 + i);
-			__m128i zt = _mm_cvtpd_epi32(xt);
-			ut0[i + 0] = (uint16_t)_mm_cvtsi128_si32(zt);
-			ut0[i + 1] = (uint16_t)_mm_cvtsi128_si32(
-				_mm_bsrli_si128(zt, 4));
-		}
-		for (size_t i = 0; i < n; i += 2) {
-			__m128d xt = _mm_loadu_pd((const double *)t1 + i);
-			__m128i zt = _mm_cvtpd_epi32(xt);
-			ut1[i + 0] = (uint16_t)_mm_cvtsi128_si32(zt);
-			ut1[i + 1] = (uint16_t)_mm_cvtsi128_si32(
-				_mm_bsrli_si128(zt, 4));
-		}
-#elif FNDSA_NEON
-		/* We inline an fpr_rint() implementation, using NEON
-		   intrinsics (vcvtnq_s64_f64() for rounding to neareast
-		   with roundTiesToEven). */
-		for (size_t i = 0; i < n; i += 2) {
-			float64x2_t xt = vld1q_f64((const float64_t *)t0 + i);
-			int64x2_t zt = vcvtnq_s64_f64(xt);
-			ut0[i + 0] = (uint16_t)vgetq_lane_s64(zt, 0);
-			ut0[i + 1] = (uint16_t)vgetq_lane_s64(zt, 1);
-		}
-		for (size_t i = 0; i < n; i += 2) {
-			float64x2_t xt = vld1q_f64((const float64_t *)t1 + i);
-			int64x2_t zt = vcvtnq_s64_f64(xt);
-			ut1[i + 0] = (uint16_t)vgetq_lane_s64(zt, 0);
-			ut1[i + 1] = (uint16_t)vgetq_lane_s64(zt, 1);
-		}
-#elif FNDSA_RV64D
-		const f64 *tt0 = (const f64 *)t0;
-		const f64 *tt1 = (const f64 *)t1;
-		for (size_t i = 0; i < n; i ++) {
-			ut0[i] = (uint64_t)f64_rint(tt0[i]);
-		}
-		for (size_t i = 0; i < n; i ++) {
-			ut1[i] = (uint64_t)f64_rint(tt1[i]);
-		}
-#else
-		for (size_t i = 0; i < n; i ++) {
-			ut0[i] = (uint16_t)fpr_rint(t0[i]);
-			ut1[i] = (uint16_t)fpr_rint(t1[i]);
-		}
-#endif
-		mqpoly_signed_to_int(logn, ut0);
-		mqpoly_signed_to_int(logn, ut1);
-
-		/* Convert [t0,t1] to NTT. */
-		mqpoly_int_to_ntt(logn, ut0);
-		mqpoly_int_to_ntt(logn, ut1);
+		ffsamp_fft_tier(simd_tier, &ss, tmp);
 
-		/* Decode (f,g) from the signing key. */
-		f = (int8_t *)(ut3 + n);
+		/* Decode f and g again (after the area used by the
+		   basis), and, on the FPU paths, recompute the basis
+		   right after t1. */
+		f = (int8_t *)tmp + 48 * n;
 		g = f + n;
 		(void)trim_i8_decode(logn, sign_key_fgF, f, nbits);
 		(void)trim_i8_decode(logn, sign_key_fgF + flen, g, nbits);
-
-		/* s1 = hm - (g*t0 + G*t1).
-		   We compute s1 into ut3; we do not need to keep s1,
-		   only its squared norm. */
-		mqpoly_small_to_int(logn, g, ut2);
-		mqpoly_small_to_int(logn, G, ut3);
-		mqpoly_int_to_ntt(logn, ut2);
-		mqpoly_int_to_ntt(logn, ut3);
-		mqpoly_mul_ntt(logn, ut2, ut0);
-		mqpoly_mul_ntt(logn, ut3, ut1);
-		mqpoly_add(logn, ut2, ut3);
-		mqpoly_ntt_to_int(logn, ut2);
-		memcpy(ut3, hm, n * sizeof(uint16_t));
-		mqpoly_ext_to_int(logn, ut3);
-		mqpoly_sub(logn, ut3, ut2);
-		uint32_t sqn1 = mqpoly_sqnorm_int(logn, ut3);
-
-		/* s2 = -(-f*t0 - F*t1) = f*t0 + F*t1
-		   We compute s2 into ut3. */
-		mqpoly_small_to_int(logn, f, ut2);
-		mqpoly_small_to_int(logn, F, ut3);
-		mqpoly_int_to_ntt(logn, ut2);
-		mqpoly_int_to_ntt(logn, ut3);
-		mqpoly_mul_ntt(logn, ut2, ut0);
-		mqpoly_mul_ntt(logn, ut3, ut1);
-		mqpoly_add(logn, ut3, ut2);
-		mqpoly_ntt_to_int(logn, ut3);
-		uint32_t sqn2 = mqpoly_sqnorm_int_to_signed(logn, ut3);
-
-		/* If either squared norm saturated, or the sum (i.e.
-		   the total squared norm of [s1,s2]) is too high, then
-		   we loop. */
-		uint32_t sqn = sqn1 + sqn2;
-		sqn1 |= sqn2;
-		sqn |= (uint32_t)(*(int32_t *)&sqn1 >> 31);
-		if (!mqpoly_sqnorm_is_acceptable(logn, sqn)) {
-			continue;
+#if FNDSA_SSE2 || FNDSA_NEON || FNDSA_RV64D
+		basis_to_FFT(logn, simd_tier, f, g, F, G, t1 + n);
+#endif
+		size_t sig_len = sign_finish(logn, simd_tier, f, g, F, G,
+			hm, nonce, sig, tmp);
+		if (sig_len != 0) {
+			ret = sig_len;
+			goto sign_exit;
 		}
-		int16_t *s2 = (int16_t *)ut3;
+	}
 
-#else
-		/*
-		 * We stay here in the floating-point domain for the
-		 * application of the basis. This happens to be faster
-		 * on our test platforms with a hardware FPU.
-		 */
-
-		/* Get the lattice point corresponding to the sampled
-		   vector. This means computing:
-		      [v0,v1] = [t0,t1] * [[g, -f], [G, -F]]
-		   hence:
-		      v0 = t0*g + t1*G
-		      v1 = -t0*f - t1*F  */
-		fpr *w0 = t1 + n;
-		fpr *w1 = w0 + n;
-		f = (int8_t *)(w1 + n);
-		g = f + n;
-		(void)trim_i8_decode(logn, sign_key_fgF, f, nbits);
-		(void)trim_i8_decode(logn, sign_key_fgF + flen, g, nbits);
-		fpoly_set_small(logn, w0, g);
-		fpoly_set_small(logn, w1, f);
-		fpoly_FFT(logn, w0);
-		fpoly_FFT(logn, w1);
-		fpoly_mul_fft(logn, w1, t0);
-		fpoly_mul_fft(logn, t0, w0);
-		fpoly_set_small(logn, w0, G);
-		fpoly_FFT(logn, w0);
-		fpoly_mul_fft(logn, w0, t1);
-		fpoly_add(logn, t0, w0);
-		fpoly_set_small(logn, w0, F);
-		fpoly_FFT(logn, w0);
-		fpoly_mul_fft(logn, t1, w0);
-		fpoly_add(logn, t1, w1);
-		fpoly_neg(logn, t1);
-		fpoly_iFFT(logn, t0);
-		fpoly_iFFT(logn, t1);
-
-		/* We compute s1, then s2 into buffer s2 (s1 is not
-		   retained). We accumulate their squared norm in sqn,
-		   with an "overflow" flag in ng. */
-		uint32_t sqn = 0;
-		uint32_t ng = 0;
-		int16_t *s2 = (int16_t *)w0;
+sign_exit:
 #if FNDSA_SSE2
-		/* We inline an fpr_rint() implementation, using SSE2
-		   intrinsics (_mm_cvtpd_epi32() for rounding to neareast
-		   with roundTiesToEven). */
-		for (size_t i = 0; i < n; i += 2) {
-			__m128d xt = _mm_loadu_pd((const double *)t0 + i);
-			__m128i zt = _mm_cvtpd_epi32(xt);
-			uint16_t zu0 = hm[i + 0]
-				- (uint16_t)_mm_cvtsi128_si32(zt);
-			uint16_t zu1 = hm[i + 1]
-				- (uint16_t)_mm_cvtsi128_si32(
-					_mm_bsrli_si128(zt, 4));
-			int32_t z0 = (int32_t)*(int16_t *)&zu0;
-			int32_t z1 = (int32_t)*(int16_t *)&zu1;
-			sqn += (uint32_t)(z0 * z0);
-			ng |= sqn;
-			sqn += (uint32_t)(z1 * z1);
-			ng |= sqn;
-		}
-		for (size_t i = 0; i < n; i += 2) {
-			__m128d xt = _mm_loadu_pd((const double *)t1 + i);
-			__m128i zt = _mm_cvtpd_epi32(xt);
-			uint16_t zu0 = -(uint16_t)_mm_cvtsi128_si32(zt);
-			uint16_t zu1 = -(uint16_t)_mm_cvtsi128_si32(
-				_mm_bsrli_si128(zt, 4));
-			int32_t z0 = (int32_t)*(int16_t *)&zu0;
-			int32_t z1 = (int32_t)*(int16_t *)&zu1;
-			sqn += (uint32_t)(z0 * z0);
-			ng |= sqn;
-			sqn += (uint32_t)(z1 * z1);
-			ng |= sqn;
-			s2[i + 0] = (int16_t)z0;
-			s2[i + 1] = (int16_t)z1;
-		}
-#elif FNDSA_NEON
-		/* We inline an fpr_rint() implementation, using NEON
-		   intrinsics (vcvtnq_s64_f64() for rounding to neareast
-		   with roundTiesToEven). */
-		for (size_t i = 0; i < n; i += 2) {
-			float64x2_t xt = vld1q_f64((const float64_t *)t0 + i);
-			int64x2_t zt = vcvtnq_s64_f64(xt);
-			uint16_t zu0 = hm[i + 0]
-				- (uint16_t)vgetq_lane_s64(zt, 0);
-			uint16_t zu1 = hm[i + 1]
-				- (uint16_t)vgetq_lane_s64(zt, 1);
-			int32_t z0 = (int32_t)*(int16_t *)&zu0;
-			int32_t z1 = (int32_t)*(int16_t *)&zu1;
-			sqn += (uint32_t)(z0 * z0);
-			ng |= sqn;
-			sqn += (uint32_t)(z1 * z1);
-			ng |= sqn;
-		}
-		for (size_t i = 0; i < n; i += 2) {
-			float64x2_t xt = vld1q_f64((const float64_t *)t1 + i);
-			int64x2_t zt = vcvtnq_s64_f64(xt);
-			uint16_t zu0 = -(uint16_t)vgetq_lane_s64(zt, 0);
-			uint16_t zu1 = -(uint16_t)vgetq_lane_s64(zt, 1);
-			int32_t z0 = (int32_t)*(int16_t *)&zu0;
-			int32_t z1 = (int32_t)*(int16_t *)&zu1;
-			sqn += (uint32_t)(z0 * z0);
-			ng |= sqn;
-			sqn += (uint32_t)(z1 * z1);
-			ng |= sqn;
-			s2[i + 0] = (int16_t)z0;
-			s2[i + 1] = (int16_t)z1;
-		}
-#elif FNDSA_RV64D
-		const f64 *tt0 = (const f64 *)t0;
-		const f64 *tt1 = (const f64 *)t1;
-		for (size_t i = 0; i < n; i ++) {
-			uint16_t zu = hm[i] - (uint16_t)f64_rint(tt0[i]);
-			int32_t z = *(int16_t *)&zu;
-			sqn += (uint32_t)(z * z);
-			ng |= sqn;
-		}
-		for (size_t i = 0; i < n; i ++) {
-			uint16_t zu = -(uint16_t)f64_rint(tt1[i]);
-			int32_t z = *(int16_t *)&zu;
-			sqn += (uint32_t)(z * z);
-			ng |= sqn;
-			s2[i] = (int16_t)z;
+	_MM_SET_ROUNDING_MODE(round_mode);
+#endif
+	return ret;
+}
+
+/* see sign_inner.h */
+TARGET_SSE2 TARGET_NEON
+size_t
+sign_core_expanded(unsigned logn, const int8_t *fgFG, const fpr *bg,
+	const uint8_t *hashed_vk, const uint8_t *ctx, size_t ctx_len,
+	const char *id, const uint8_t *hv, size_t hv_len,
+	const uint8_t *seed, size_t seed_len, fndsa_randpool *rp,
+	uint8_t *sig, void *tmp)
+{
+	size_t ret = 0;
+
+#if FNDSA_SSE2
+	unsigned round_mode = _MM_GET_ROUNDING_MODE();
+	_MM_SET_ROUNDING_MODE(_MM_ROUND_NEAREST);
+#endif
+	unsigned simd_tier = get_simd_tier();
+
+	size_t n = (size_t)1 << logn;
+	const int8_t *f = fgFG;
+	const int8_t *g = f + n;
+	const int8_t *F = g + n;
+	const int8_t *G = F + n;
+	const fpr *b01 = bg + n;
+	const fpr *b11 = bg + 3 * n;
+	const fpr *gram = bg + 4 * n;
+	int orig_falcon = (*(const uint8_t *)id == 0xFF && id[1] == 0);
+	uint8_t rndbuf[40 + 56];
+	uint8_t *nonce = rndbuf;
+	uint8_t *subseed = rndbuf + 40;
+
+	for (uint32_t counter = 0;; counter ++) {
+		/* With a randomness pool, each attempt uses a new entry
+		   (nonce and pre-expanded sampler stream), which is handed
+		   back right after sampling. */
+		const uint8_t *pre = NULL;
+		size_t slot = 0;
+		if (rp != NULL) {
+			pre = randpool_take(rp, nonce, &slot);
 		}
-#else
-		for (size_t i = 0; i < n; i ++) {
-			uint16_t zu = hm[i] - (uint16_t)fpr_rint(t0[i]);
-			int32_t z = *(int16_t *)&zu;
-			sqn += (uint32_t)(z * z);
-			ng |= sqn;
+		if (pre == NULL && !sign_gen_rnd(counter, orig_falcon,
+			seed, seed_len, rndbuf, tmp))
+		{
+			goto sign_exit;
 		}
-		for (size_t i = 0; i < n; i ++) {
-			uint16_t zu = -(uint16_t)fpr_rint(t1[i]);
-			int32_t z = *(int16_t *)&zu;
-			sqn += (uint32_t)(z * z);
-			ng |= sqn;
-			s2[i] = (int16_t)z;
+		uint16_t *hm = (uint16_t *)((uint8_t *)tmp + 56 * n);
+		hash_to_point(logn, nonce, hashed_vk,
+			ctx, ctx_len, id, hv, hv_len, hm);
+		sampler_state ss;
+		if (pre != NULL) {
+			sampler_init_pre(&ss, logn, pre);
+		} else {
+			sampler_init(&ss, logn, subseed, 56);
 		}
-#endif
 
-		/* If the squared norm exceeds 2^31-1, then at some point
-		   the high bit of ng was set, which we use to saturate
-		   the squared norm to 2^32-1. If the squared norm is
-		   unacceptable, then we loop. */
-		sqn |= (uint32_t)(*(int32_t *)&ng >> 31);
-		if (!mqpoly_sqnorm_is_acceptable(logn, sqn)) {
-			continue;
+		/* Same layout as in sign_core(), but the basis and the
+		   Gram matrix are simply copied from the expanded key:
+		      t0  (n)
+		      t1  (n)
+		      g01 (n)
+		      g00 (hn)
+		      g11 (hn)
+		   fpoly_apply_basis() consumes b01 and b11, hence we
+		   work on copies (b01 in t1, b11 in the free space). */
+		fpr *t0 = (fpr *)tmp;
+		fpr *t1 = t0 + n;
+		fpr *t4 = t1 + 3 * n;
+		memcpy(t1, b01, n * sizeof(fpr));
+		memcpy(t4, b11, n * sizeof(fpr));
+		FPOLY(apply_basis)(logn, t0, t1, t1, t4, hm);
+		memcpy(t1 + n, gram, 2 * n * sizeof(fpr));
+		ffsamp_fft_tier(simd_tier, &ss, tmp);
+		if (pre != NULL) {
+			randpool_release(rp, slot);
 		}
-#endif
 
-		/* We have a candidate signature; we must encode it. This
-		   may fail, if the signature cannot be encoded in the
-		   target size. */
-		size_t sig_len = FNDSA_SIGNATURE_SIZE(logn);
-		if (comp_encode(logn, s2, sig + 41, sig_len - 41)) {
-			/* Success! */
-			sig[0] = 0x30 + logn;
-			memcpy(sig + 1, nonce, 40);
+#if FNDSA_SSE2 || FNDSA_NEON || FNDSA_RV64D
+		memcpy(t1 + n, bg, 4 * n * sizeof(fpr));
+#endif
+		size_t sig_len = sign_finish(logn, simd_tier, f, g, F, G,
+			hm, nonce, sig, tmp);
+		if (sig_len != 0) {
 			ret = sig_len;
 			goto sign_exit;
 		}
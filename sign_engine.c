@@ -0,0 +1,368 @@
+/*
+ * Multi-threaded signing engine.
+ */
+
+#include "sign_inner.h"
+
+#if FNDSA_SIGN_ENGINE
+
+#include <pthread.h>
+
+/*
+ * Jobs are exchanged through a bounded multi-producer multi-consumer
+ * queue (D. Vyukov's design): each slot has a sequence number which
+ * tells whether it is free for the producer at a given position, or
+ * filled for the consumer at that position. Producers and consumers
+ * reserve positions with a compare-and-swap on the enqueue and dequeue
+ * counters, which are kept on separate cache lines.
+ *
+ * Workers that find the queue empty sleep on a condition variable.
+ * The number of sleeping workers is maintained so that producers need
+ * to take the mutex only when some worker is actually sleeping; the
+ * fences on both sides ensure that either the producer sees the
+ * sleeper, or the sleeper sees the new job.
+ */
+
+typedef struct {
+	size_t seq;
+	fndsa_sign_job *job;
+} engine_slot;
+
+typedef struct {
+	fndsa_sign_engine *engine;
+	pthread_t thread;
+	shake_context rng;
+	void *tmp;
+	size_t tmp_len;
+} engine_worker;
+
+struct fndsa_sign_engine_ {
+	size_t enq_pos;
+	uint8_t pad1[64 - sizeof(size_t)];
+	size_t deq_pos;
+	uint8_t pad2[64 - sizeof(size_t)];
+	unsigned sleepers;
+	int stopping;
+	size_t mask;
+	engine_slot *slots;
+	engine_worker *workers;
+	unsigned num_threads;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+};
+
+/* Size of the temporary area of each worker. The areas are not on the
+   stack, but they follow the same FNDSA_SIGN_LARGE_TMP setting as the
+   stack-allocated areas (with the default 59*n+31 bytes, key-dependent
+   values are recomputed on restarts). */
+static size_t
+engine_tmp_len(unsigned logn)
+{
+#if FNDSA_SIGN_LARGE_TMP
+	return ((size_t)110 << logn) + 31;
+#else
+	return ((size_t)59 << logn) + 31;
+#endif
+}
+
+/* Add a job to the queue; returned value is 0 if the queue is full. */
+static int
+queue_push(fndsa_sign_engine *e, fndsa_sign_job *job)
+{
+	size_t pos = __atomic_load_n(&e->enq_pos, __ATOMIC_RELAXED);
+	for (;;) {
+		engine_slot *s = &e->slots[pos & e->mask];
+		size_t seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+		intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+		if (dif == 0) {
+			if (__atomic_compare_exchange_n(&e->enq_pos,
+				&pos, pos + 1, 1,
+				__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			{
+				s->job = job;
+				__atomic_store_n(&s->seq, pos + 1,
+					__ATOMIC_RELEASE);
+				return 1;
+			}
+		} else if (dif < 0) {
+			return 0;
+		} else {
+			pos = __atomic_load_n(&e->enq_pos, __ATOMIC_RELAXED);
+		}
+	}
+}
+
+/* Get the next job from the queue; returned value is NULL if the
+   queue is empty. */
+static fndsa_sign_job *
+queue_pop(fndsa_sign_engine *e)
+{
+	size_t pos = __atomic_load_n(&e->deq_pos, __ATOMIC_RELAXED);
+	for (;;) {
+		engine_slot *s = &e->slots[pos & e->mask];
+		size_t seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+		intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+		if (dif == 0) {
+			if (__atomic_compare_exchange_n(&e->deq_pos,
+				&pos, pos + 1, 1,
+				__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			{
+				fndsa_sign_job *job = s->job;
+				__atomic_store_n(&s->seq, pos + e->mask + 1,
+					__ATOMIC_RELEASE);
+				return job;
+			}
+		} else if (dif < 0) {
+			return NULL;
+		} else {
+			pos = __atomic_load_n(&e->deq_pos, __ATOMIC_RELAXED);
+		}
+	}
+}
+
+/* Process one job. The generator is ratcheted when the per-signature
+   seed is extracted, so that a later leak of the worker state does not
+   reveal the seeds of past signatures. */
+static void
+worker_run_job(engine_worker *w, fndsa_sign_job *job)
+{
+	uint8_t buf[48];
+	shake_ratchet(&w->rng, buf, sizeof buf);
+	job->sig_len = fndsa_sign_seeded_temp(
+		job->sign_key, job->sign_key_len,
+		job->ctx, job->ctx_len, job->id, job->hv, job->hv_len,
+		buf, 48, job->sig, job->max_sig_len, w->tmp, w->tmp_len);
+	secure_wipe(buf, sizeof buf);
+	if (job->callback != NULL) {
+		job->callback(job);
+	}
+	__atomic_store_n(&job->done, 1, __ATOMIC_RELEASE);
+}
+
+static void *
+worker_main(void *arg)
+{
+	engine_worker *w = arg;
+	fndsa_sign_engine *e = w->engine;
+	for (;;) {
+		fndsa_sign_job *job = queue_pop(e);
+		if (job == NULL) {
+			int stop = 0;
+			pthread_mutex_lock(&e->lock);
+			for (;;) {
+				__atomic_add_fetch(&e->sleepers, 1,
+					__ATOMIC_SEQ_CST);
+				__atomic_thread_fence(__ATOMIC_SEQ_CST);
+				stop = e->stopping;
+				job = queue_pop(e);
+				if (job == NULL && !stop) {
+					pthread_cond_wait(&e->cond, &e->lock);
+				}
+				__atomic_sub_fetch(&e->sleepers, 1,
+					__ATOMIC_SEQ_CST);
+				if (job != NULL || stop) {
+					break;
+				}
+			}
+			pthread_mutex_unlock(&e->lock);
+			if (job == NULL) {
+				/* Engine is stopping and the queue is
+				   empty. */
+				return NULL;
+			}
+		}
+		worker_run_job(w, job);
+	}
+}
+
+/* Stop the first num workers and release the synchronization objects. */
+static void
+engine_shutdown(fndsa_sign_engine *e, unsigned num)
+{
+	pthread_mutex_lock(&e->lock);
+	e->stopping = 1;
+	pthread_cond_broadcast(&e->cond);
+	pthread_mutex_unlock(&e->lock);
+	for (unsigned i = 0; i < num; i ++) {
+		pthread_join(e->workers[i].thread, NULL);
+	}
+	pthread_cond_destroy(&e->cond);
+	pthread_mutex_destroy(&e->lock);
+}
+
+/* Erase the random generators of the workers. */
+static void
+engine_wipe_workers(fndsa_sign_engine *e)
+{
+	secure_wipe(e->workers, e->num_threads * sizeof(engine_worker));
+}
+
+/* see fndsa.h */
+size_t
+fndsa_sign_engine_size(unsigned logn,
+	unsigned num_threads, size_t queue_len)
+{
+	if (logn < 9 || logn > 10) {
+		return 0;
+	}
+	if (num_threads < 1 || num_threads > 256) {
+		return 0;
+	}
+	if (queue_len < 2 || queue_len > 65536
+		|| (queue_len & (queue_len - 1)) != 0)
+	{
+		return 0;
+	}
+	return 63 + ROUND64(sizeof(fndsa_sign_engine))
+		+ ROUND64(num_threads * sizeof(engine_worker))
+		+ ROUND64(queue_len * sizeof(engine_slot))
+		+ num_threads * ROUND64(engine_tmp_len(logn));
+}
+
+/* see fndsa.h */
+fndsa_sign_engine *
+fndsa_sign_engine_start(unsigned logn,
+	unsigned num_threads, size_t queue_len, void *mem, size_t mem_len)
+{
+	size_t len = fndsa_sign_engine_size(logn, num_threads, queue_len);
+	if (len == 0 || mem == NULL || mem_len < len) {
+		return NULL;
+	}
+
+	/* Layout: engine structure, workers, queue slots, and the
+	   temporary areas; each element starts on a 64-byte boundary. */
+	uint8_t *buf = (uint8_t *)(((uintptr_t)mem + 63) & ~(uintptr_t)63);
+	fndsa_sign_engine *e = (fndsa_sign_engine *)buf;
+	buf += ROUND64(sizeof(fndsa_sign_engine));
+	memset(e, 0, sizeof *e);
+	e->workers = (engine_worker *)buf;
+	buf += ROUND64(num_threads * sizeof(engine_worker));
+	e->slots = (engine_slot *)buf;
+	buf += ROUND64(queue_len * sizeof(engine_slot));
+	e->mask = queue_len - 1;
+	e->num_threads = num_threads;
+	for (size_t i = 0; i < queue_len; i ++) {
+		e->slots[i].seq = i;
+		e->slots[i].job = NULL;
+	}
+	size_t tmp_len = engine_tmp_len(logn);
+	for (unsigned i = 0; i < num_threads; i ++) {
+		engine_worker *w = &e->workers[i];
+		w->engine = e;
+		w->tmp = buf;
+		w->tmp_len = tmp_len;
+		buf += ROUND64(tmp_len);
+		if (!sysrng_shake_init(&w->rng)) {
+			engine_wipe_workers(e);
+			return NULL;
+		}
+	}
+
+	if (pthread_mutex_init(&e->lock, NULL) != 0) {
+		engine_wipe_workers(e);
+		return NULL;
+	}
+	if (pthread_cond_init(&e->cond, NULL) != 0) {
+		pthread_mutex_destroy(&e->lock);
+		engine_wipe_workers(e);
+		return NULL;
+	}
+	for (unsigned i = 0; i < num_threads; i ++) {
+		engine_worker *w = &e->workers[i];
+		if (pthread_create(&w->thread, NULL, worker_main, w) != 0) {
+			engine_shutdown(e, i);
+			engine_wipe_workers(e);
+			return NULL;
+		}
+	}
+	return e;
+}
+
+/* see fndsa.h */
+int
+fndsa_sign_engine_submit(fndsa_sign_engine *e, fndsa_sign_job *job)
+{
+	job->sig_len = 0;
+	__atomic_store_n(&job->done, 0, __ATOMIC_RELAXED);
+	if (!queue_push(e, job)) {
+		return 0;
+	}
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&e->sleepers, __ATOMIC_RELAXED) != 0) {
+		pthread_mutex_lock(&e->lock);
+		pthread_cond_signal(&e->cond);
+		pthread_mutex_unlock(&e->lock);
+	}
+	return 1;
+}
+
+/* see fndsa.h */
+int
+fndsa_sign_job_done(const fndsa_sign_job *job)
+{
+	return __atomic_load_n(&job->done, __ATOMIC_ACQUIRE);
+}
+
+/* see fndsa.h */
+void
+fndsa_sign_engine_stop(fndsa_sign_engine *e)
+{
+	engine_shutdown(e, e->num_threads);
+	for (unsigned i = 0; i < e->num_threads; i ++) {
+		secure_wipe(e->workers[i].tmp, e->workers[i].tmp_len);
+	}
+	engine_wipe_workers(e);
+}
+
+#else
+
+/* No thread support: the engine cannot be started. */
+
+/* see fndsa.h */
+size_t
+fndsa_sign_engine_size(unsigned logn,
+	unsigned num_threads, size_t queue_len)
+{
+	(void)logn;
+	(void)num_threads;
+	(void)queue_len;
+	return 0;
+}
+
+/* see fndsa.h */
+fndsa_sign_engine *
+fndsa_sign_engine_start(unsigned logn,
+	unsigned num_threads, size_t queue_len, void *mem, size_t mem_len)
+{
+	(void)logn;
+	(void)num_threads;
+	(void)queue_len;
+	(void)mem;
+	(void)mem_len;
+	return NULL;
+}
+
+/* see fndsa.h */
+int
+fndsa_sign_engine_submit(fndsa_sign_engine *e, fndsa_sign_job *job)
+{
+	(void)e;
+	(void)job;
+	return 0;
+}
+
+/* see fndsa.h */
+int
+fndsa_sign_job_done(const fndsa_sign_job *job)
+{
+	return job->done;
+}
+
+/* see fndsa.h */
+void
+fndsa_sign_engine_stop(fndsa_sign_engine *e)
+{
+	(void)e;
+}
+
+#endif
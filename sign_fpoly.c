@@ -1268,6 +1268,312 @@ fpoly_FFT(unsigned logn, fpr *f)
 #endif
 }
 
+#if FNDSA_AVX2_FPOLY
+/* see sign_inner.h */
+TARGET_AVX2
+void
+avx2_fpoly_FFT(unsigned logn, fpr *f)
+{
+	if (logn < 4) {
+		fpoly_FFT(logn, f);
+		return;
+	}
+
+	size_t n = (size_t)1 << logn;
+	size_t hn = n >> 1;
+	size_t t = hn;
+	double *ff = (double *)f;
+
+	/* Same computations as in fpoly_FFT(), four at a time. The last
+	   two iterations (t = 4 and t = 2) are separated, so that t >= 8
+	   and ht >= 4 in all iterations of the loop. */
+	for (unsigned lm = 1; lm < (logn - 2); lm ++) {
+		size_t m = (size_t)1 << lm;
+		size_t hm = m >> 1;
+		size_t ht = t >> 1;
+		size_t j0 = 0;
+		for (size_t i = 0; i < hm; i ++) {
+			__m256d s_re = _mm256_broadcast_sd(
+				(const double *)GM + ((m + i) << 1));
+			__m256d s_im = _mm256_broadcast_sd(
+				(const double *)GM + ((m + i) << 1) + 1);
+			for (size_t j = 0; j < ht; j += 4) {
+				size_t j1 = j0 + j;
+				size_t j2 = j1 + ht;
+				__m256d x_re = _mm256_loadu_pd(ff + j1);
+				__m256d x_im = _mm256_loadu_pd(ff + j1 + hn);
+				__m256d y_re = _mm256_loadu_pd(ff + j2);
+				__m256d y_im = _mm256_loadu_pd(ff + j2 + hn);
+				__m256d z_re = _mm256_sub_pd(
+					_mm256_mul_pd(y_re, s_re),
+					_mm256_mul_pd(y_im, s_im));
+				__m256d z_im = _mm256_add_pd(
+					_mm256_mul_pd(y_re, s_im),
+					_mm256_mul_pd(y_im, s_re));
+				_mm256_storeu_pd(ff + j1,
+					_mm256_add_pd(x_re, z_re));
+				_mm256_storeu_pd(ff + j1 + hn,
+					_mm256_add_pd(x_im, z_im));
+				_mm256_storeu_pd(ff + j2,
+					_mm256_sub_pd(x_re, z_re));
+				_mm256_storeu_pd(ff + j2 + hn,
+					_mm256_sub_pd(x_im, z_im));
+			}
+			j0 += t;
+		}
+		t = ht;
+	}
+
+	/* Next-to-last iteration: m = n/4, hm = n/8, t = 4, ht = 2.
+	   We process two chunks (with two distinct s) at a time. */
+	size_t m = n >> 2;
+	size_t hm = m >> 1;
+	for (size_t i = 0; i < hm; i += 2) {
+		size_t j1 = i << 2;
+		/* s <- re(s0):im(s0):re(s1):im(s1) */
+		__m256d s = _mm256_loadu_pd((const double *)GM + ((m + i) << 1));
+		__m256d s_re = _mm256_unpacklo_pd(s, s);
+		__m256d s_im = _mm256_unpackhi_pd(s, s);
+		/* a <- x0:x1:y0:y1
+		   b <- x2:x3:y2:y3 */
+		__m256d a_re = _mm256_loadu_pd(ff + j1);
+		__m256d b_re = _mm256_loadu_pd(ff + j1 + 4);
+		__m256d a_im = _mm256_loadu_pd(ff + j1 + hn);
+		__m256d b_im = _mm256_loadu_pd(ff + j1 + hn + 4);
+		__m256d x_re = _mm256_permute2f128_pd(a_re, b_re, 0x20);
+		__m256d y_re = _mm256_permute2f128_pd(a_re, b_re, 0x31);
+		__m256d x_im = _mm256_permute2f128_pd(a_im, b_im, 0x20);
+		__m256d y_im = _mm256_permute2f128_pd(a_im, b_im, 0x31);
+		__m256d z_re = _mm256_sub_pd(
+			_mm256_mul_pd(y_re, s_re),
+			_mm256_mul_pd(y_im, s_im));
+		__m256d z_im = _mm256_add_pd(
+			_mm256_mul_pd(y_re, s_im),
+			_mm256_mul_pd(y_im, s_re));
+		y_re = _mm256_sub_pd(x_re, z_re);
+		y_im = _mm256_sub_pd(x_im, z_im);
+		x_re = _mm256_add_pd(x_re, z_re);
+		x_im = _mm256_add_pd(x_im, z_im);
+		_mm256_storeu_pd(ff + j1,
+			_mm256_permute2f128_pd(x_re, y_re, 0x20));
+		_mm256_storeu_pd(ff + j1 + 4,
+			_mm256_permute2f128_pd(x_re, y_re, 0x31));
+		_mm256_storeu_pd(ff + j1 + hn,
+			_mm256_permute2f128_pd(x_im, y_im, 0x20));
+		_mm256_storeu_pd(ff + j1 + hn + 4,
+			_mm256_permute2f128_pd(x_im, y_im, 0x31));
+	}
+
+	/* Last iteration: m = n/2, hm = n/4, t = 2, ht = 1. We process
+	   four chunks at a time; unpacking puts them in the order
+	   0:2:1:3 in the registers, and the twiddle factors are
+	   unpacked in the same way. */
+	for (size_t i = 0; i < hn; i += 8) {
+		__m256d s0 = _mm256_loadu_pd((const double *)GM + n + i);
+		__m256d s1 = _mm256_loadu_pd((const double *)GM + n + i + 4);
+		__m256d s_re = _mm256_unpacklo_pd(s0, s1);
+		__m256d s_im = _mm256_unpackhi_pd(s0, s1);
+		__m256d a_re = _mm256_loadu_pd(ff + i);
+		__m256d b_re = _mm256_loadu_pd(ff + i + 4);
+		__m256d a_im = _mm256_loadu_pd(ff + i + hn);
+		__m256d b_im = _mm256_loadu_pd(ff + i + hn + 4);
+		__m256d x_re = _mm256_unpacklo_pd(a_re, b_re);
+		__m256d y_re = _mm256_unpackhi_pd(a_re, b_re);
+		__m256d x_im = _mm256_unpacklo_pd(a_im, b_im);
+		__m256d y_im = _mm256_unpackhi_pd(a_im, b_im);
+		__m256d z_re = _mm256_sub_pd(
+			_mm256_mul_pd(y_re, s_re),
+			_mm256_mul_pd(y_im, s_im));
+		__m256d z_im = _mm256_add_pd(
+			_mm256_mul_pd(y_re, s_im),
+			_mm256_mul_pd(y_im, s_re));
+		y_re = _mm256_sub_pd(x_re, z_re);
+		y_im = _mm256_sub_pd(x_im, z_im);
+		x_re = _mm256_add_pd(x_re, z_re);
+		x_im = _mm256_add_pd(x_im, z_im);
+		_mm256_storeu_pd(ff + i, _mm256_unpacklo_pd(x_re, y_re));
+		_mm256_storeu_pd(ff + i + 4, _mm256_unpackhi_pd(x_re, y_re));
+		_mm256_storeu_pd(ff + i + hn, _mm256_unpacklo_pd(x_im, y_im));
+		_mm256_storeu_pd(ff + i + hn + 4,
+			_mm256_unpackhi_pd(x_im, y_im));
+	}
+}
+#endif
+
+#if FNDSA_AVX512_FPOLY
+/* see sign_inner.h */
+TARGET_AVX512
+void
+avx512_fpoly_FFT(unsigned logn, fpr *f)
+{
+	if (logn < 5) {
+		avx2_fpoly_FFT(logn, f);
+		return;
+	}
+
+	size_t n = (size_t)1 << logn;
+	size_t hn = n >> 1;
+	size_t t = hn;
+	double *ff = (double *)f;
+
+	/* Same computations as in fpoly_FFT(), eight at a time. The last
+	   three iterations (t = 8, 4 and 2) are separated, so that t >= 16
+	   and ht >= 8 in all iterations of the loop. */
+	for (unsigned lm = 1; lm < (logn - 3); lm ++) {
+		size_t m = (size_t)1 << lm;
+		size_t hm = m >> 1;
+		size_t ht = t >> 1;
+		size_t j0 = 0;
+		for (size_t i = 0; i < hm; i ++) {
+			__m512d s_re = _mm512_set1_pd(
+				((const double *)GM)[(m + i) << 1]);
+			__m512d s_im = _mm512_set1_pd(
+				((const double *)GM)[((m + i) << 1) + 1]);
+			for (size_t j = 0; j < ht; j += 8) {
+				size_t j1 = j0 + j;
+				size_t j2 = j1 + ht;
+				__m512d x_re = _mm512_loadu_pd(ff + j1);
+				__m512d x_im = _mm512_loadu_pd(ff + j1 + hn);
+				__m512d y_re = _mm512_loadu_pd(ff + j2);
+				__m512d y_im = _mm512_loadu_pd(ff + j2 + hn);
+				__m512d z_re = _mm512_sub_pd(
+					_mm512_mul_pd(y_re, s_re),
+					_mm512_mul_pd(y_im, s_im));
+				__m512d z_im = _mm512_add_pd(
+					_mm512_mul_pd(y_re, s_im),
+					_mm512_mul_pd(y_im, s_re));
+				_mm512_storeu_pd(ff + j1,
+					_mm512_add_pd(x_re, z_re));
+				_mm512_storeu_pd(ff + j1 + hn,
+					_mm512_add_pd(x_im, z_im));
+				_mm512_storeu_pd(ff + j2,
+					_mm512_sub_pd(x_re, z_re));
+				_mm512_storeu_pd(ff + j2 + hn,
+					_mm512_sub_pd(x_im, z_im));
+			}
+			j0 += t;
+		}
+		t = ht;
+	}
+
+	/* Iteration with t = 8, ht = 4 (m = n/8). We process two chunks
+	   (with two distinct s) at a time; the x and y halves are
+	   gathered with 256-bit lane shuffles. */
+	__m512i idx_re = _mm512_setr_epi64(0, 0, 0, 0, 2, 2, 2, 2);
+	__m512i idx_im = _mm512_setr_epi64(1, 1, 1, 1, 3, 3, 3, 3);
+	size_t m = n >> 3;
+	for (size_t i = 0; i < (m >> 1); i += 2) {
+		size_t j1 = i << 3;
+		__m512d s = _mm512_castpd256_pd512(_mm256_loadu_pd(
+			(const double *)GM + ((m + i) << 1)));
+		__m512d s_re = _mm512_permutexvar_pd(idx_re, s);
+		__m512d s_im = _mm512_permutexvar_pd(idx_im, s);
+		__m512d a_re = _mm512_loadu_pd(ff + j1);
+		__m512d b_re = _mm512_loadu_pd(ff + j1 + 8);
+		__m512d a_im = _mm512_loadu_pd(ff + j1 + hn);
+		__m512d b_im = _mm512_loadu_pd(ff + j1 + hn + 8);
+		__m512d x_re = _mm512_shuffle_f64x2(a_re, b_re, 0x44);
+		__m512d y_re = _mm512_shuffle_f64x2(a_re, b_re, 0xEE);
+		__m512d x_im = _mm512_shuffle_f64x2(a_im, b_im, 0x44);
+		__m512d y_im = _mm512_shuffle_f64x2(a_im, b_im, 0xEE);
+		__m512d z_re = _mm512_sub_pd(
+			_mm512_mul_pd(y_re, s_re),
+			_mm512_mul_pd(y_im, s_im));
+		__m512d z_im = _mm512_add_pd(
+			_mm512_mul_pd(y_re, s_im),
+			_mm512_mul_pd(y_im, s_re));
+		y_re = _mm512_sub_pd(x_re, z_re);
+		y_im = _mm512_sub_pd(x_im, z_im);
+		x_re = _mm512_add_pd(x_re, z_re);
+		x_im = _mm512_add_pd(x_im, z_im);
+		_mm512_storeu_pd(ff + j1,
+			_mm512_shuffle_f64x2(x_re, y_re, 0x44));
+		_mm512_storeu_pd(ff + j1 + 8,
+			_mm512_shuffle_f64x2(x_re, y_re, 0xEE));
+		_mm512_storeu_pd(ff + j1 + hn,
+			_mm512_shuffle_f64x2(x_im, y_im, 0x44));
+		_mm512_storeu_pd(ff + j1 + hn + 8,
+			_mm512_shuffle_f64x2(x_im, y_im, 0xEE));
+	}
+
+	/* Iteration with t = 4, ht = 2 (m = n/4). We process four chunks
+	   at a time; the x and y halves are gathered with 128-bit lane
+	   shuffles (lanes 0:2 of each source for x, 1:3 for y). */
+	m = n >> 2;
+	for (size_t i = 0; i < (m >> 1); i += 4) {
+		size_t j1 = i << 2;
+		__m512d s = _mm512_loadu_pd((const double *)GM + ((m + i) << 1));
+		__m512d s_re = _mm512_unpacklo_pd(s, s);
+		__m512d s_im = _mm512_unpackhi_pd(s, s);
+		__m512d a_re = _mm512_loadu_pd(ff + j1);
+		__m512d b_re = _mm512_loadu_pd(ff + j1 + 8);
+		__m512d a_im = _mm512_loadu_pd(ff + j1 + hn);
+		__m512d b_im = _mm512_loadu_pd(ff + j1 + hn + 8);
+		__m512d x_re = _mm512_shuffle_f64x2(a_re, b_re, 0x88);
+		__m512d y_re = _mm512_shuffle_f64x2(a_re, b_re, 0xDD);
+		__m512d x_im = _mm512_shuffle_f64x2(a_im, b_im, 0x88);
+		__m512d y_im = _mm512_shuffle_f64x2(a_im, b_im, 0xDD);
+		__m512d z_re = _mm512_sub_pd(
+			_mm512_mul_pd(y_re, s_re),
+			_mm512_mul_pd(y_im, s_im));
+		__m512d z_im = _mm512_add_pd(
+			_mm512_mul_pd(y_re, s_im),
+			_mm512_mul_pd(y_im, s_re));
+		y_re = _mm512_sub_pd(x_re, z_re);
+		y_im = _mm512_sub_pd(x_im, z_im);
+		x_re = _mm512_add_pd(x_re, z_re);
+		x_im = _mm512_add_pd(x_im, z_im);
+		/* x0:x1:x2:x3 and y0:y1:y2:y3 (128-bit lanes) are
+		   written back as x0:y0:x1:y1 and x2:y2:x3:y3. */
+		__m512d c0 = _mm512_shuffle_f64x2(x_re, y_re, 0x44);
+		__m512d c1 = _mm512_shuffle_f64x2(x_re, y_re, 0xEE);
+		__m512d c2 = _mm512_shuffle_f64x2(x_im, y_im, 0x44);
+		__m512d c3 = _mm512_shuffle_f64x2(x_im, y_im, 0xEE);
+		_mm512_storeu_pd(ff + j1, _mm512_shuffle_f64x2(c0, c0, 0xD8));
+		_mm512_storeu_pd(ff + j1 + 8,
+			_mm512_shuffle_f64x2(c1, c1, 0xD8));
+		_mm512_storeu_pd(ff + j1 + hn,
+			_mm512_shuffle_f64x2(c2, c2, 0xD8));
+		_mm512_storeu_pd(ff + j1 + hn + 8,
+			_mm512_shuffle_f64x2(c3, c3, 0xD8));
+	}
+
+	/* Last iteration: t = 2, ht = 1 (m = n/2). We process eight
+	   chunks at a time; unpacking puts them in the order
+	   0:4:1:5:2:6:3:7 in the registers, and the twiddle factors are
+	   unpacked in the same way. */
+	for (size_t i = 0; i < hn; i += 16) {
+		__m512d s0 = _mm512_loadu_pd((const double *)GM + n + i);
+		__m512d s1 = _mm512_loadu_pd((const double *)GM + n + i + 8);
+		__m512d s_re = _mm512_unpacklo_pd(s0, s1);
+		__m512d s_im = _mm512_unpackhi_pd(s0, s1);
+		__m512d a_re = _mm512_loadu_pd(ff + i);
+		__m512d b_re = _mm512_loadu_pd(ff + i + 8);
+		__m512d a_im = _mm512_loadu_pd(ff + i + hn);
+		__m512d b_im = _mm512_loadu_pd(ff + i + hn + 8);
+		__m512d x_re = _mm512_unpacklo_pd(a_re, b_re);
+		__m512d y_re = _mm512_unpackhi_pd(a_re, b_re);
+		__m512d x_im = _mm512_unpacklo_pd(a_im, b_im);
+		__m512d y_im = _mm512_unpackhi_pd(a_im, b_im);
+		__m512d z_re = _mm512_sub_pd(
+			_mm512_mul_pd(y_re, s_re),
+			_mm512_mul_pd(y_im, s_im));
+		__m512d z_im = _mm512_add_pd(
+			_mm512_mul_pd(y_re, s_im),
+			_mm512_mul_pd(y_im, s_re));
+		y_re = _mm512_sub_pd(x_re, z_re);
+		y_im = _mm512_sub_pd(x_im, z_im);
+		x_re = _mm512_add_pd(x_re, z_re);
+		x_im = _mm512_add_pd(x_im, z_im);
+		_mm512_storeu_pd(ff + i, _mm512_unpacklo_pd(x_re, y_re));
+		_mm512_storeu_pd(ff + i + 8, _mm512_unpackhi_pd(x_re, y_re));
+		_mm512_storeu_pd(ff + i + hn, _mm512_unpacklo_pd(x_im, y_im));
+		_mm512_storeu_pd(ff + i + hn + 8,
+			_mm512_unpackhi_pd(x_im, y_im));
+	}
+}
+#endif
+
 /* see sign_inner.h */
 TARGET_SSE2 TARGET_NEON
 void
@@ -1562,6 +1868,321 @@ fpoly_iFFT(unsigned logn, fpr *f)
 #endif
 }
 
+#if FNDSA_AVX2_FPOLY
+/* see sign_inner.h */
+TARGET_AVX2
+void
+avx2_fpoly_iFFT(unsigned logn, fpr *f)
+{
+	if (logn < 4) {
+		fpoly_iFFT(logn, f);
+		return;
+	}
+
+	size_t n = (size_t)1 << logn;
+	size_t hn = n >> 1;
+	double *ff = (double *)f;
+
+	/* Same computations as in fpoly_iFFT(), four at a time. The
+	   first two iterations (t = 1 and t = 2) are separated, so that
+	   t >= 4 in all iterations of the loop. */
+
+	/* First iteration: t = 1, four chunks at a time (register
+	   order is 0:2:1:3, see avx2_fpoly_FFT()). */
+	for (size_t i = 0; i < hn; i += 8) {
+		__m256d s0 = _mm256_loadu_pd((const double *)GM + n + i);
+		__m256d s1 = _mm256_loadu_pd((const double *)GM + n + i + 4);
+		__m256d s_re = _mm256_unpacklo_pd(s0, s1);
+		__m256d s_im = _mm256_unpackhi_pd(s0, s1);
+		__m256d a_re = _mm256_loadu_pd(ff + i);
+		__m256d b_re = _mm256_loadu_pd(ff + i + 4);
+		__m256d a_im = _mm256_loadu_pd(ff + i + hn);
+		__m256d b_im = _mm256_loadu_pd(ff + i + hn + 4);
+		__m256d x_re = _mm256_unpacklo_pd(a_re, b_re);
+		__m256d y_re = _mm256_unpackhi_pd(a_re, b_re);
+		__m256d x_im = _mm256_unpacklo_pd(a_im, b_im);
+		__m256d y_im = _mm256_unpackhi_pd(a_im, b_im);
+		__m256d u_re = _mm256_sub_pd(x_re, y_re);
+		__m256d u_im = _mm256_sub_pd(x_im, y_im);
+		x_re = _mm256_add_pd(x_re, y_re);
+		x_im = _mm256_add_pd(x_im, y_im);
+		/* Multiply with conj(s). */
+		y_re = _mm256_add_pd(
+			_mm256_mul_pd(u_re, s_re),
+			_mm256_mul_pd(u_im, s_im));
+		y_im = _mm256_sub_pd(
+			_mm256_mul_pd(u_im, s_re),
+			_mm256_mul_pd(u_re, s_im));
+		_mm256_storeu_pd(ff + i, _mm256_unpacklo_pd(x_re, y_re));
+		_mm256_storeu_pd(ff + i + 4, _mm256_unpackhi_pd(x_re, y_re));
+		_mm256_storeu_pd(ff + i + hn, _mm256_unpacklo_pd(x_im, y_im));
+		_mm256_storeu_pd(ff + i + hn + 4,
+			_mm256_unpackhi_pd(x_im, y_im));
+	}
+
+	/* Second iteration: t = 2, two chunks at a time. */
+	{
+		size_t hm = n >> 2;
+		for (size_t i = 0; i < (hm >> 1); i += 2) {
+			size_t j1 = i << 2;
+			__m256d s = _mm256_loadu_pd(
+				(const double *)GM + ((hm + i) << 1));
+			__m256d s_re = _mm256_unpacklo_pd(s, s);
+			__m256d s_im = _mm256_unpackhi_pd(s, s);
+			__m256d a_re = _mm256_loadu_pd(ff + j1);
+			__m256d b_re = _mm256_loadu_pd(ff + j1 + 4);
+			__m256d a_im = _mm256_loadu_pd(ff + j1 + hn);
+			__m256d b_im = _mm256_loadu_pd(ff + j1 + hn + 4);
+			__m256d x_re = _mm256_permute2f128_pd(
+				a_re, b_re, 0x20);
+			__m256d y_re = _mm256_permute2f128_pd(
+				a_re, b_re, 0x31);
+			__m256d x_im = _mm256_permute2f128_pd(
+				a_im, b_im, 0x20);
+			__m256d y_im = _mm256_permute2f128_pd(
+				a_im, b_im, 0x31);
+			__m256d u_re = _mm256_sub_pd(x_re, y_re);
+			__m256d u_im = _mm256_sub_pd(x_im, y_im);
+			x_re = _mm256_add_pd(x_re, y_re);
+			x_im = _mm256_add_pd(x_im, y_im);
+			y_re = _mm256_add_pd(
+				_mm256_mul_pd(u_re, s_re),
+				_mm256_mul_pd(u_im, s_im));
+			y_im = _mm256_sub_pd(
+				_mm256_mul_pd(u_im, s_re),
+				_mm256_mul_pd(u_re, s_im));
+			_mm256_storeu_pd(ff + j1,
+				_mm256_permute2f128_pd(x_re, y_re, 0x20));
+			_mm256_storeu_pd(ff + j1 + 4,
+				_mm256_permute2f128_pd(x_re, y_re, 0x31));
+			_mm256_storeu_pd(ff + j1 + hn,
+				_mm256_permute2f128_pd(x_im, y_im, 0x20));
+			_mm256_storeu_pd(ff + j1 + hn + 4,
+				_mm256_permute2f128_pd(x_im, y_im, 0x31));
+		}
+	}
+
+	size_t t = 4;
+	for (unsigned lm = 3; lm < logn; lm ++) {
+		size_t hm = (size_t)1 << (logn - lm);
+		size_t dt = t << 1;
+		size_t j0 = 0;
+		for (size_t i = 0; i < (hm >> 1); i ++) {
+			__m256d s_re = _mm256_broadcast_sd(
+				(const double *)GM + ((hm + i) << 1));
+			__m256d s_im = _mm256_broadcast_sd(
+				(const double *)GM + ((hm + i) << 1) + 1);
+			for (size_t j = 0; j < t; j += 4) {
+				size_t j1 = j0 + j;
+				size_t j2 = j1 + t;
+				__m256d x_re = _mm256_loadu_pd(ff + j1);
+				__m256d x_im = _mm256_loadu_pd(ff + j1 + hn);
+				__m256d y_re = _mm256_loadu_pd(ff + j2);
+				__m256d y_im = _mm256_loadu_pd(ff + j2 + hn);
+				_mm256_storeu_pd(ff + j1,
+					_mm256_add_pd(x_re, y_re));
+				_mm256_storeu_pd(ff + j1 + hn,
+					_mm256_add_pd(x_im, y_im));
+				__m256d u_re = _mm256_sub_pd(x_re, y_re);
+				__m256d u_im = _mm256_sub_pd(x_im, y_im);
+				__m256d z_re = _mm256_add_pd(
+					_mm256_mul_pd(u_re, s_re),
+					_mm256_mul_pd(u_im, s_im));
+				__m256d z_im = _mm256_sub_pd(
+					_mm256_mul_pd(u_im, s_re),
+					_mm256_mul_pd(u_re, s_im));
+				_mm256_storeu_pd(ff + j2, z_re);
+				_mm256_storeu_pd(ff + j2 + hn, z_im);
+			}
+			j0 += dt;
+		}
+		t = dt;
+	}
+
+	/* Divide by n/2 (exact, since this is a power of 2). */
+	__m256d e = _mm256_set1_pd(1.0 / (double)hn);
+	for (size_t i = 0; i < n; i += 4) {
+		_mm256_storeu_pd(ff + i,
+			_mm256_mul_pd(_mm256_loadu_pd(ff + i), e));
+	}
+}
+#endif
+
+#if FNDSA_AVX512_FPOLY
+/* see sign_inner.h */
+TARGET_AVX512
+void
+avx512_fpoly_iFFT(unsigned logn, fpr *f)
+{
+	if (logn < 5) {
+		avx2_fpoly_iFFT(logn, f);
+		return;
+	}
+
+	size_t n = (size_t)1 << logn;
+	size_t hn = n >> 1;
+	double *ff = (double *)f;
+
+	/* Same computations as in fpoly_iFFT(), eight at a time. The
+	   first three iterations (t = 1, 2 and 4) are separated, so that
+	   t >= 8 in all iterations of the loop. The data movements are
+	   the same as in avx512_fpoly_FFT(). */
+
+	/* First iteration: t = 1, eight chunks at a time. */
+	for (size_t i = 0; i < hn; i += 16) {
+		__m512d s0 = _mm512_loadu_pd((const double *)GM + n + i);
+		__m512d s1 = _mm512_loadu_pd((const double *)GM + n + i + 8);
+		__m512d s_re = _mm512_unpacklo_pd(s0, s1);
+		__m512d s_im = _mm512_unpackhi_pd(s0, s1);
+		__m512d a_re = _mm512_loadu_pd(ff + i);
+		__m512d b_re = _mm512_loadu_pd(ff + i + 8);
+		__m512d a_im = _mm512_loadu_pd(ff + i + hn);
+		__m512d b_im = _mm512_loadu_pd(ff + i + hn + 8);
+		__m512d x_re = _mm512_unpacklo_pd(a_re, b_re);
+		__m512d y_re = _mm512_unpackhi_pd(a_re, b_re);
+		__m512d x_im = _mm512_unpacklo_pd(a_im, b_im);
+		__m512d y_im = _mm512_unpackhi_pd(a_im, b_im);
+		__m512d u_re = _mm512_sub_pd(x_re, y_re);
+		__m512d u_im = _mm512_sub_pd(x_im, y_im);
+		x_re = _mm512_add_pd(x_re, y_re);
+		x_im = _mm512_add_pd(x_im, y_im);
+		/* Multiply with conj(s). */
+		y_re = _mm512_add_pd(
+			_mm512_mul_pd(u_re, s_re),
+			_mm512_mul_pd(u_im, s_im));
+		y_im = _mm512_sub_pd(
+			_mm512_mul_pd(u_im, s_re),
+			_mm512_mul_pd(u_re, s_im));
+		_mm512_storeu_pd(ff + i, _mm512_unpacklo_pd(x_re, y_re));
+		_mm512_storeu_pd(ff + i + 8, _mm512_unpackhi_pd(x_re, y_re));
+		_mm512_storeu_pd(ff + i + hn, _mm512_unpacklo_pd(x_im, y_im));
+		_mm512_storeu_pd(ff + i + hn + 8,
+			_mm512_unpackhi_pd(x_im, y_im));
+	}
+
+	/* Second iteration: t = 2, four chunks at a time. */
+	size_t hm = n >> 2;
+	for (size_t i = 0; i < (hm >> 1); i += 4) {
+		size_t j1 = i << 2;
+		__m512d s = _mm512_loadu_pd(
+			(const double *)GM + ((hm + i) << 1));
+		__m512d s_re = _mm512_unpacklo_pd(s, s);
+		__m512d s_im = _mm512_unpackhi_pd(s, s);
+		__m512d a_re = _mm512_loadu_pd(ff + j1);
+		__m512d b_re = _mm512_loadu_pd(ff + j1 + 8);
+		__m512d a_im = _mm512_loadu_pd(ff + j1 + hn);
+		__m512d b_im = _mm512_loadu_pd(ff + j1 + hn + 8);
+		__m512d x_re = _mm512_shuffle_f64x2(a_re, b_re, 0x88);
+		__m512d y_re = _mm512_shuffle_f64x2(a_re, b_re, 0xDD);
+		__m512d x_im = _mm512_shuffle_f64x2(a_im, b_im, 0x88);
+		__m512d y_im = _mm512_shuffle_f64x2(a_im, b_im, 0xDD);
+		__m512d u_re = _mm512_sub_pd(x_re, y_re);
+		__m512d u_im = _mm512_sub_pd(x_im, y_im);
+		x_re = _mm512_add_pd(x_re, y_re);
+		x_im = _mm512_add_pd(x_im, y_im);
+		y_re = _mm512_add_pd(
+			_mm512_mul_pd(u_re, s_re),
+			_mm512_mul_pd(u_im, s_im));
+		y_im = _mm512_sub_pd(
+			_mm512_mul_pd(u_im, s_re),
+			_mm512_mul_pd(u_re, s_im));
+		__m512d c0 = _mm512_shuffle_f64x2(x_re, y_re, 0x44);
+		__m512d c1 = _mm512_shuffle_f64x2(x_re, y_re, 0xEE);
+		__m512d c2 = _mm512_shuffle_f64x2(x_im, y_im, 0x44);
+		__m512d c3 = _mm512_shuffle_f64x2(x_im, y_im, 0xEE);
+		_mm512_storeu_pd(ff + j1, _mm512_shuffle_f64x2(c0, c0, 0xD8));
+		_mm512_storeu_pd(ff + j1 + 8,
+			_mm512_shuffle_f64x2(c1, c1, 0xD8));
+		_mm512_storeu_pd(ff + j1 + hn,
+			_mm512_shuffle_f64x2(c2, c2, 0xD8));
+		_mm512_storeu_pd(ff + j1 + hn + 8,
+			_mm512_shuffle_f64x2(c3, c3, 0xD8));
+	}
+
+	/* Third iteration: t = 4, two chunks at a time. */
+	__m512i idx_re = _mm512_setr_epi64(0, 0, 0, 0, 2, 2, 2, 2);
+	__m512i idx_im = _mm512_setr_epi64(1, 1, 1, 1, 3, 3, 3, 3);
+	hm = n >> 3;
+	for (size_t i = 0; i < (hm >> 1); i += 2) {
+		size_t j1 = i << 3;
+		__m512d s = _mm512_castpd256_pd512(_mm256_loadu_pd(
+			(const double *)GM + ((hm + i) << 1)));
+		__m512d s_re = _mm512_permutexvar_pd(idx_re, s);
+		__m512d s_im = _mm512_permutexvar_pd(idx_im, s);
+		__m512d a_re = _mm512_loadu_pd(ff + j1);
+		__m512d b_re = _mm512_loadu_pd(ff + j1 + 8);
+		__m512d a_im = _mm512_loadu_pd(ff + j1 + hn);
+		__m512d b_im = _mm512_loadu_pd(ff + j1 + hn + 8);
+		__m512d x_re = _mm512_shuffle_f64x2(a_re, b_re, 0x44);
+		__m512d y_re = _mm512_shuffle_f64x2(a_re, b_re, 0xEE);
+		__m512d x_im = _mm512_shuffle_f64x2(a_im, b_im, 0x44);
+		__m512d y_im = _mm512_shuffle_f64x2(a_im, b_im, 0xEE);
+		__m512d u_re = _mm512_sub_pd(x_re, y_re);
+		__m512d u_im = _mm512_sub_pd(x_im, y_im);
+		x_re = _mm512_add_pd(x_re, y_re);
+		x_im = _mm512_add_pd(x_im, y_im);
+		y_re = _mm512_add_pd(
+			_mm512_mul_pd(u_re, s_re),
+			_mm512_mul_pd(u_im, s_im));
+		y_im = _mm512_sub_pd(
+			_mm512_mul_pd(u_im, s_re),
+			_mm512_mul_pd(u_re, s_im));
+		_mm512_storeu_pd(ff + j1,
+			_mm512_shuffle_f64x2(x_re, y_re, 0x44));
+		_mm512_storeu_pd(ff + j1 + 8,
+			_mm512_shuffle_f64x2(x_re, y_re, 0xEE));
+		_mm512_storeu_pd(ff + j1 + hn,
+			_mm512_shuffle_f64x2(x_im, y_im, 0x44));
+		_mm512_storeu_pd(ff + j1 + hn + 8,
+			_mm512_shuffle_f64x2(x_im, y_im, 0xEE));
+	}
+
+	size_t t = 8;
+	for (unsigned lm = 4; lm < logn; lm ++) {
+		hm = (size_t)1 << (logn - lm);
+		size_t dt = t << 1;
+		size_t j0 = 0;
+		for (size_t i = 0; i < (hm >> 1); i ++) {
+			__m512d s_re = _mm512_set1_pd(
+				((const double *)GM)[(hm + i) << 1]);
+			__m512d s_im = _mm512_set1_pd(
+				((const double *)GM)[((hm + i) << 1) + 1]);
+			for (size_t j = 0; j < t; j += 8) {
+				size_t j1 = j0 + j;
+				size_t j2 = j1 + t;
+				__m512d x_re = _mm512_loadu_pd(ff + j1);
+				__m512d x_im = _mm512_loadu_pd(ff + j1 + hn);
+				__m512d y_re = _mm512_loadu_pd(ff + j2);
+				__m512d y_im = _mm512_loadu_pd(ff + j2 + hn);
+				_mm512_storeu_pd(ff + j1,
+					_mm512_add_pd(x_re, y_re));
+				_mm512_storeu_pd(ff + j1 + hn,
+					_mm512_add_pd(x_im, y_im));
+				__m512d u_re = _mm512_sub_pd(x_re, y_re);
+				__m512d u_im = _mm512_sub_pd(x_im, y_im);
+				__m512d z_re = _mm512_add_pd(
+					_mm512_mul_pd(u_re, s_re),
+					_mm512_mul_pd(u_im, s_im));
+				__m512d z_im = _mm512_sub_pd(
+					_mm512_mul_pd(u_im, s_re),
+					_mm512_mul_pd(u_re, s_im));
+				_mm512_storeu_pd(ff + j2, z_re);
+				_mm512_storeu_pd(ff + j2 + hn, z_im);
+			}
+			j0 += dt;
+		}
+		t = dt;
+	}
+
+	/* Divide by n/2 (exact, since this is a power of 2). */
+	__m512d e = _mm512_set1_pd(1.0 / (double)hn);
+	for (size_t i = 0; i < n; i += 8) {
+		_mm512_storeu_pd(ff + i,
+			_mm512_mul_pd(_mm512_loadu_pd(ff + i), e));
+	}
+}
+#endif
+
 /* see sign_inner.h */
 TARGET_SSE2 TARGET_NEON
 void
@@ -1619,6 +2240,49 @@ fpoly_set_small(unsigned logn, fpr *d, const int8_t *f)
 #endif
 }
 
+#if FNDSA_AVX2_FPOLY
+/* see sign_inner.h */
+TARGET_AVX2
+void
+avx2_fpoly_set_small(unsigned logn, fpr *d, const int8_t *f)
+{
+	if (logn < 3) {
+		fpoly_set_small(logn, d, f);
+		return;
+	}
+	size_t n = (size_t)1 << logn;
+	double *dd = (double *)d;
+	for (size_t i = 0; i < n; i += 8) {
+		__m128i x = _mm_cvtepi8_epi32(
+			_mm_loadl_epi64((const __m128i *)(f + i)));
+		__m128i y = _mm_cvtepi8_epi32(_mm_bsrli_si128(
+			_mm_loadl_epi64((const __m128i *)(f + i)), 4));
+		_mm256_storeu_pd(dd + i, _mm256_cvtepi32_pd(x));
+		_mm256_storeu_pd(dd + i + 4, _mm256_cvtepi32_pd(y));
+	}
+}
+#endif
+
+#if FNDSA_AVX512_FPOLY
+/* see sign_inner.h */
+TARGET_AVX512
+void
+avx512_fpoly_set_small(unsigned logn, fpr *d, const int8_t *f)
+{
+	if (logn < 3) {
+		avx2_fpoly_set_small(logn, d, f);
+		return;
+	}
+	size_t n = (size_t)1 << logn;
+	double *dd = (double *)d;
+	for (size_t i = 0; i < n; i += 8) {
+		__m256i x = _mm256_cvtepi8_epi32(
+			_mm_loadl_epi64((const __m128i *)(f + i)));
+		_mm512_storeu_pd(dd + i, _mm512_cvtepi32_pd(x));
+	}
+}
+#endif
+
 /* see sign_inner.h */
 TARGET_SSE2 TARGET_NEON
 void
@@ -1662,6 +2326,44 @@ fpoly_add(unsigned logn, fpr *a, const fpr *b)
 #endif
 }
 
+#if FNDSA_AVX2_FPOLY
+/* see sign_inner.h */
+TARGET_AVX2
+void
+avx2_fpoly_add(unsigned logn, fpr *a, const fpr *b)
+{
+	if (logn < 2) {
+		fpoly_add(logn, a, b);
+		return;
+	}
+	size_t n = (size_t)1 << logn;
+	for (size_t i = 0; i < n; i += 4) {
+		__m256d xa = _mm256_loadu_pd((const double *)a + i);
+		__m256d xb = _mm256_loadu_pd((const double *)b + i);
+		_mm256_storeu_pd((double *)a + i, _mm256_add_pd(xa, xb));
+	}
+}
+#endif
+
+#if FNDSA_AVX512_FPOLY
+/* see sign_inner.h */
+TARGET_AVX512
+void
+avx512_fpoly_add(unsigned logn, fpr *a, const fpr *b)
+{
+	if (logn < 3) {
+		avx2_fpoly_add(logn, a, b);
+		return;
+	}
+	size_t n = (size_t)1 << logn;
+	for (size_t i = 0; i < n; i += 8) {
+		__m512d xa = _mm512_loadu_pd((const double *)a + i);
+		__m512d xb = _mm512_loadu_pd((const double *)b + i);
+		_mm512_storeu_pd((double *)a + i, _mm512_add_pd(xa, xb));
+	}
+}
+#endif
+
 /* see sign_inner.h */
 TARGET_SSE2 TARGET_NEON
 void
@@ -1705,6 +2407,44 @@ fpoly_sub(unsigned logn, fpr *a, const fpr *b)
 #endif
 }
 
+#if FNDSA_AVX2_FPOLY
+/* see sign_inner.h */
+TARGET_AVX2
+void
+avx2_fpoly_sub(unsigned logn, fpr *a, const fpr *b)
+{
+	if (logn < 2) {
+		fpoly_sub(logn, a, b);
+		return;
+	}
+	size_t n = (size_t)1 << logn;
+	for (size_t i = 0; i < n; i += 4) {
+		__m256d xa = _mm256_loadu_pd((const double *)a + i);
+		__m256d xb = _mm256_loadu_pd((const double *)b + i);
+		_mm256_storeu_pd((double *)a + i, _mm256_sub_pd(xa, xb));
+	}
+}
+#endif
+
+#if FNDSA_AVX512_FPOLY
+/* see sign_inner.h */
+TARGET_AVX512
+void
+avx512_fpoly_sub(unsigned logn, fpr *a, const fpr *b)
+{
+	if (logn < 3) {
+		avx2_fpoly_sub(logn, a, b);
+		return;
+	}
+	size_t n = (size_t)1 << logn;
+	for (size_t i = 0; i < n; i += 8) {
+		__m512d xa = _mm512_loadu_pd((const double *)a + i);
+		__m512d xb = _mm512_loadu_pd((const double *)b + i);
+		_mm512_storeu_pd((double *)a + i, _mm512_sub_pd(xa, xb));
+	}
+}
+#endif
+
 /* see sign_inner.h */
 TARGET_SSE2 TARGET_NEON
 void
@@ -1744,6 +2484,44 @@ fpoly_neg(unsigned logn, fpr *a)
 #endif
 }
 
+#if FNDSA_AVX2_FPOLY
+/* see sign_inner.h */
+TARGET_AVX2
+void
+avx2_fpoly_neg(unsigned logn, fpr *a)
+{
+	if (logn < 2) {
+		fpoly_neg(logn, a);
+		return;
+	}
+	size_t n = (size_t)1 << logn;
+	__m256d xz = _mm256_setzero_pd();
+	for (size_t i = 0; i < n; i += 4) {
+		__m256d xa = _mm256_loadu_pd((const double *)a + i);
+		_mm256_storeu_pd((double *)a + i, _mm256_sub_pd(xz, xa));
+	}
+}
+#endif
+
+#if FNDSA_AVX512_FPOLY
+/* see sign_inner.h */
+TARGET_AVX512
+void
+avx512_fpoly_neg(unsigned logn, fpr *a)
+{
+	if (logn < 3) {
+		avx2_fpoly_neg(logn, a);
+		return;
+	}
+	size_t n = (size_t)1 << logn;
+	__m512d xz = _mm512_setzero_pd();
+	for (size_t i = 0; i < n; i += 8) {
+		__m512d xa = _mm512_loadu_pd((const double *)a + i);
+		_mm512_storeu_pd((double *)a + i, _mm512_sub_pd(xz, xa));
+	}
+}
+#endif
+
 /* see sign_inner.h */
 TARGET_SSE2 TARGET_NEON
 void
@@ -1832,6 +2610,62 @@ fpoly_mul_fft(unsigned logn, fpr *a, const fpr *b)
 #endif
 }
 
+#if FNDSA_AVX2_FPOLY
+/* see sign_inner.h */
+TARGET_AVX2
+void
+avx2_fpoly_mul_fft(unsigned logn, fpr *a, const fpr *b)
+{
+	if (logn < 3) {
+		fpoly_mul_fft(logn, a, b);
+		return;
+	}
+	size_t hn = (size_t)1 << (logn - 1);
+	for (size_t i = 0; i < hn; i += 4) {
+		__m256d xar = _mm256_loadu_pd((const double *)a + i);
+		__m256d xai = _mm256_loadu_pd((const double *)a + i + hn);
+		__m256d xbr = _mm256_loadu_pd((const double *)b + i);
+		__m256d xbi = _mm256_loadu_pd((const double *)b + i + hn);
+		__m256d xcr = _mm256_sub_pd(
+			_mm256_mul_pd(xar, xbr),
+			_mm256_mul_pd(xai, xbi));
+		__m256d xci = _mm256_add_pd(
+			_mm256_mul_pd(xar, xbi),
+			_mm256_mul_pd(xai, xbr));
+		_mm256_storeu_pd((double *)a + i, xcr);
+		_mm256_storeu_pd((double *)a + i + hn, xci);
+	}
+}
+#endif
+
+#if FNDSA_AVX512_FPOLY
+/* see sign_inner.h */
+TARGET_AVX512
+void
+avx512_fpoly_mul_fft(unsigned logn, fpr *a, const fpr *b)
+{
+	if (logn < 4) {
+		avx2_fpoly_mul_fft(logn, a, b);
+		return;
+	}
+	size_t hn = (size_t)1 << (logn - 1);
+	for (size_t i = 0; i < hn; i += 8) {
+		__m512d xar = _mm512_loadu_pd((const double *)a + i);
+		__m512d xai = _mm512_loadu_pd((const double *)a + i + hn);
+		__m512d xbr = _mm512_loadu_pd((const double *)b + i);
+		__m512d xbi = _mm512_loadu_pd((const double *)b + i + hn);
+		__m512d xcr = _mm512_sub_pd(
+			_mm512_mul_pd(xar, xbr),
+			_mm512_mul_pd(xai, xbi));
+		__m512d xci = _mm512_add_pd(
+			_mm512_mul_pd(xar, xbi),
+			_mm512_mul_pd(xai, xbr));
+		_mm512_storeu_pd((double *)a + i, xcr);
+		_mm512_storeu_pd((double *)a + i + hn, xci);
+	}
+}
+#endif
+
 /* unused
 TARGET_SSE2 TARGET_NEON
 void
@@ -2027,6 +2861,44 @@ fpoly_mulconst(unsigned logn, fpr *a, fpr x)
 #endif
 }
 
+#if FNDSA_AVX2_FPOLY
+/* see sign_inner.h */
+TARGET_AVX2
+void
+avx2_fpoly_mulconst(unsigned logn, fpr *a, fpr x)
+{
+	if (logn < 2) {
+		fpoly_mulconst(logn, a, x);
+		return;
+	}
+	size_t n = (size_t)1 << logn;
+	__m256d xx = _mm256_broadcast_sd((const double *)&x);
+	for (size_t i = 0; i < n; i += 4) {
+		__m256d xa = _mm256_loadu_pd((const double *)a + i);
+		_mm256_storeu_pd((double *)a + i, _mm256_mul_pd(xa, xx));
+	}
+}
+#endif
+
+#if FNDSA_AVX512_FPOLY
+/* see sign_inner.h */
+TARGET_AVX512
+void
+avx512_fpoly_mulconst(unsigned logn, fpr *a, fpr x)
+{
+	if (logn < 3) {
+		avx2_fpoly_mulconst(logn, a, x);
+		return;
+	}
+	size_t n = (size_t)1 << logn;
+	__m512d xx = _mm512_set1_pd(*(const double *)&x);
+	for (size_t i = 0; i < n; i += 8) {
+		__m512d xa = _mm512_loadu_pd((const double *)a + i);
+		_mm512_storeu_pd((double *)a + i, _mm512_mul_pd(xa, xx));
+	}
+}
+#endif
+
 /* see sign_inner.h */
 TARGET_SSE2 TARGET_NEON
 void
@@ -2150,6 +3022,77 @@ fpoly_LDL_fft(unsigned logn, const fpr *g00, fpr *g01, fpr *g11)
 #endif
 }
 
+#if FNDSA_AVX2_FPOLY
+/* see sign_inner.h */
+TARGET_AVX2
+void
+avx2_fpoly_LDL_fft(unsigned logn, const fpr *g00, fpr *g01, fpr *g11)
+{
+	if (logn < 3) {
+		fpoly_LDL_fft(logn, g00, g01, g11);
+		return;
+	}
+	size_t hn = (size_t)1 << (logn - 1);
+	__m256d one = _mm256_set1_pd(1.0);
+	__m256d nz = _mm256_set1_pd(-0.0);
+	const double *p00 = (const double *)g00;
+	double *p01 = (double *)g01;
+	double *p11 = (double *)g11;
+	for (size_t i = 0; i < hn; i += 4) {
+		__m256d g00_re = _mm256_loadu_pd(p00 + i);
+		__m256d g01_re = _mm256_loadu_pd(p01 + i);
+		__m256d g01_im = _mm256_loadu_pd(p01 + i + hn);
+		__m256d g11_re = _mm256_loadu_pd(p11 + i);
+		__m256d inv_g00_re = _mm256_div_pd(one, g00_re);
+		__m256d mu_re = _mm256_mul_pd(g01_re, inv_g00_re);
+		__m256d mu_im = _mm256_mul_pd(g01_im, inv_g00_re);
+		__m256d zo_re = _mm256_add_pd(
+			_mm256_mul_pd(mu_re, g01_re),
+			_mm256_mul_pd(mu_im, g01_im));
+		_mm256_storeu_pd(p11 + i, _mm256_sub_pd(g11_re, zo_re));
+		_mm256_storeu_pd(p01 + i, mu_re);
+		_mm256_storeu_pd(p01 + i + hn, _mm256_xor_pd(nz, mu_im));
+	}
+}
+#endif
+
+#if FNDSA_AVX512_FPOLY
+/* see sign_inner.h */
+TARGET_AVX512
+void
+avx512_fpoly_LDL_fft(unsigned logn, const fpr *g00, fpr *g01, fpr *g11)
+{
+	if (logn < 4) {
+		avx2_fpoly_LDL_fft(logn, g00, g01, g11);
+		return;
+	}
+	size_t hn = (size_t)1 << (logn - 1);
+	__m512d one = _mm512_set1_pd(1.0);
+	__m512i nz = _mm512_castpd_si512(_mm512_set1_pd(-0.0));
+	const double *p00 = (const double *)g00;
+	double *p01 = (double *)g01;
+	double *p11 = (double *)g11;
+	for (size_t i = 0; i < hn; i += 8) {
+		__m512d g00_re = _mm512_loadu_pd(p00 + i);
+		__m512d g01_re = _mm512_loadu_pd(p01 + i);
+		__m512d g01_im = _mm512_loadu_pd(p01 + i + hn);
+		__m512d g11_re = _mm512_loadu_pd(p11 + i);
+		__m512d inv_g00_re = _mm512_div_pd(one, g00_re);
+		__m512d mu_re = _mm512_mul_pd(g01_re, inv_g00_re);
+		__m512d mu_im = _mm512_mul_pd(g01_im, inv_g00_re);
+		__m512d zo_re = _mm512_add_pd(
+			_mm512_mul_pd(mu_re, g01_re),
+			_mm512_mul_pd(mu_im, g01_im));
+		_mm512_storeu_pd(p11 + i, _mm512_sub_pd(g11_re, zo_re));
+		_mm512_storeu_pd(p01 + i, mu_re);
+		/* AVX-512F has no floating-point XOR; the sign bit is
+		   flipped with the integer version. */
+		_mm512_storeu_pd(p01 + i + hn, _mm512_castsi512_pd(
+			_mm512_xor_si512(nz, _mm512_castpd_si512(mu_im))));
+	}
+}
+#endif
+
 /* see sign_inner.h */
 TARGET_SSE2 TARGET_NEON
 void
@@ -2273,6 +3216,131 @@ fpoly_split_fft(unsigned logn, fpr *f0, fpr *f1, const fpr *f)
 #endif
 }
 
+#if FNDSA_AVX2_FPOLY
+/* see sign_inner.h */
+TARGET_AVX2
+void
+avx2_fpoly_split_fft(unsigned logn, fpr *f0, fpr *f1, const fpr *f)
+{
+	if (logn < 4) {
+		fpoly_split_fft(logn, f0, f1, f);
+		return;
+	}
+	size_t hn = (size_t)1 << (logn - 1);
+	size_t qn = hn >> 1;
+	const double *ff = (const double *)f;
+	double *ff0 = (double *)f0;
+	double *ff1 = (double *)f1;
+	__m256d h = _mm256_set1_pd(0.5);
+
+	/* We process four output coefficients at a time. Unpacking puts
+	   them in the order 0:2:1:3 in the registers (the twiddle
+	   factors are unpacked in the same way); we restore the natural
+	   order with a cross-lane permutation before writing. */
+	for (size_t i = 0; i < qn; i += 4) {
+		__m256d a_re = _mm256_loadu_pd(ff + (i << 1));
+		__m256d b_re = _mm256_loadu_pd(ff + (i << 1) + 4);
+		__m256d a_im = _mm256_loadu_pd(ff + (i << 1) + hn);
+		__m256d b_im = _mm256_loadu_pd(ff + (i << 1) + hn + 4);
+		__m256d x_re = _mm256_unpacklo_pd(a_re, b_re);
+		__m256d y_re = _mm256_unpackhi_pd(a_re, b_re);
+		__m256d x_im = _mm256_unpacklo_pd(a_im, b_im);
+		__m256d y_im = _mm256_unpackhi_pd(a_im, b_im);
+		__m256d s0 = _mm256_loadu_pd(
+			(const double *)GM + ((i + hn) << 1));
+		__m256d s1 = _mm256_loadu_pd(
+			(const double *)GM + ((i + hn) << 1) + 4);
+		__m256d s_re = _mm256_unpacklo_pd(s0, s1);
+		__m256d s_im = _mm256_unpackhi_pd(s0, s1);
+
+		__m256d u_re = _mm256_add_pd(x_re, y_re);
+		__m256d u_im = _mm256_add_pd(x_im, y_im);
+		__m256d v_re = _mm256_sub_pd(x_re, y_re);
+		__m256d v_im = _mm256_sub_pd(x_im, y_im);
+		/* We compute w = v*conj(s) */
+		__m256d w_re = _mm256_add_pd(
+			_mm256_mul_pd(v_re, s_re),
+			_mm256_mul_pd(v_im, s_im));
+		__m256d w_im = _mm256_sub_pd(
+			_mm256_mul_pd(v_im, s_re),
+			_mm256_mul_pd(v_re, s_im));
+		u_re = _mm256_mul_pd(u_re, h);
+		u_im = _mm256_mul_pd(u_im, h);
+		w_re = _mm256_mul_pd(w_re, h);
+		w_im = _mm256_mul_pd(w_im, h);
+		_mm256_storeu_pd(ff0 + i, _mm256_permute4x64_pd(u_re, 0xD8));
+		_mm256_storeu_pd(ff0 + i + qn,
+			_mm256_permute4x64_pd(u_im, 0xD8));
+		_mm256_storeu_pd(ff1 + i, _mm256_permute4x64_pd(w_re, 0xD8));
+		_mm256_storeu_pd(ff1 + i + qn,
+			_mm256_permute4x64_pd(w_im, 0xD8));
+	}
+}
+#endif
+
+#if FNDSA_AVX512_FPOLY
+/* see sign_inner.h */
+TARGET_AVX512
+void
+avx512_fpoly_split_fft(unsigned logn, fpr *f0, fpr *f1, const fpr *f)
+{
+	if (logn < 5) {
+		avx2_fpoly_split_fft(logn, f0, f1, f);
+		return;
+	}
+	size_t hn = (size_t)1 << (logn - 1);
+	size_t qn = hn >> 1;
+	const double *ff = (const double *)f;
+	double *ff0 = (double *)f0;
+	double *ff1 = (double *)f1;
+	__m512d h = _mm512_set1_pd(0.5);
+	__m512i idx = _mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7);
+
+	/* We process eight output coefficients at a time. Unpacking puts
+	   them in the order 0:4:1:5:2:6:3:7 in the registers (the twiddle
+	   factors are unpacked in the same way); we restore the natural
+	   order with a permutation before writing. */
+	for (size_t i = 0; i < qn; i += 8) {
+		__m512d a_re = _mm512_loadu_pd(ff + (i << 1));
+		__m512d b_re = _mm512_loadu_pd(ff + (i << 1) + 8);
+		__m512d a_im = _mm512_loadu_pd(ff + (i << 1) + hn);
+		__m512d b_im = _mm512_loadu_pd(ff + (i << 1) + hn + 8);
+		__m512d x_re = _mm512_unpacklo_pd(a_re, b_re);
+		__m512d y_re = _mm512_unpackhi_pd(a_re, b_re);
+		__m512d x_im = _mm512_unpacklo_pd(a_im, b_im);
+		__m512d y_im = _mm512_unpackhi_pd(a_im, b_im);
+		__m512d s0 = _mm512_loadu_pd(
+			(const double *)GM + ((i + hn) << 1));
+		__m512d s1 = _mm512_loadu_pd(
+			(const double *)GM + ((i + hn) << 1) + 8);
+		__m512d s_re = _mm512_unpacklo_pd(s0, s1);
+		__m512d s_im = _mm512_unpackhi_pd(s0, s1);
+
+		__m512d u_re = _mm512_add_pd(x_re, y_re);
+		__m512d u_im = _mm512_add_pd(x_im, y_im);
+		__m512d v_re = _mm512_sub_pd(x_re, y_re);
+		__m512d v_im = _mm512_sub_pd(x_im, y_im);
+		/* We compute w = v*conj(s) */
+		__m512d w_re = _mm512_add_pd(
+			_mm512_mul_pd(v_re, s_re),
+			_mm512_mul_pd(v_im, s_im));
+		__m512d w_im = _mm512_sub_pd(
+			_mm512_mul_pd(v_im, s_re),
+			_mm512_mul_pd(v_re, s_im));
+		u_re = _mm512_mul_pd(u_re, h);
+		u_im = _mm512_mul_pd(u_im, h);
+		w_re = _mm512_mul_pd(w_re, h);
+		w_im = _mm512_mul_pd(w_im, h);
+		_mm512_storeu_pd(ff0 + i, _mm512_permutexvar_pd(idx, u_re));
+		_mm512_storeu_pd(ff0 + i + qn,
+			_mm512_permutexvar_pd(idx, u_im));
+		_mm512_storeu_pd(ff1 + i, _mm512_permutexvar_pd(idx, w_re));
+		_mm512_storeu_pd(ff1 + i + qn,
+			_mm512_permutexvar_pd(idx, w_im));
+	}
+}
+#endif
+
 /* see sign_inner.h */
 TARGET_SSE2 TARGET_NEON
 void
@@ -2363,6 +3431,100 @@ fpoly_split_selfadj_fft(unsigned logn, fpr *f0, fpr *f1, const fpr *f)
 #endif
 }
 
+#if FNDSA_AVX2_FPOLY
+/* see sign_inner.h */
+TARGET_AVX2
+void
+avx2_fpoly_split_selfadj_fft(unsigned logn, fpr *f0, fpr *f1, const fpr *f)
+{
+	if (logn < 4) {
+		fpoly_split_selfadj_fft(logn, f0, f1, f);
+		return;
+	}
+	size_t hn = (size_t)1 << (logn - 1);
+	size_t qn = hn >> 1;
+	const double *ff = (const double *)f;
+	double *ff0 = (double *)f0;
+	double *ff1 = (double *)f1;
+	__m256d h = _mm256_set1_pd(0.5);
+
+	/* Same register ordering as in avx2_fpoly_split_fft(). */
+	for (size_t i = 0; i < qn; i += 4) {
+		__m256d a_re = _mm256_loadu_pd(ff + (i << 1));
+		__m256d b_re = _mm256_loadu_pd(ff + (i << 1) + 4);
+		__m256d x_re = _mm256_unpacklo_pd(a_re, b_re);
+		__m256d y_re = _mm256_unpackhi_pd(a_re, b_re);
+		__m256d s0 = _mm256_loadu_pd(
+			(const double *)GM + ((i + hn) << 1));
+		__m256d s1 = _mm256_loadu_pd(
+			(const double *)GM + ((i + hn) << 1) + 4);
+		__m256d s_re = _mm256_unpacklo_pd(s0, s1);
+		__m256d s_im = _mm256_unpackhi_pd(s0, s1);
+
+		/* w = v*conj(s), with v real; the imaginary part is
+		   computed as (-v)*im(s). */
+		__m256d u = _mm256_mul_pd(h, _mm256_add_pd(x_re, y_re));
+		__m256d v = _mm256_mul_pd(h, _mm256_sub_pd(x_re, y_re));
+		__m256d nv = _mm256_mul_pd(h, _mm256_sub_pd(y_re, x_re));
+		__m256d w_re = _mm256_mul_pd(v, s_re);
+		__m256d w_im = _mm256_mul_pd(nv, s_im);
+		_mm256_storeu_pd(ff0 + i, _mm256_permute4x64_pd(u, 0xD8));
+		_mm256_storeu_pd(ff0 + i + qn, _mm256_setzero_pd());
+		_mm256_storeu_pd(ff1 + i, _mm256_permute4x64_pd(w_re, 0xD8));
+		_mm256_storeu_pd(ff1 + i + qn,
+			_mm256_permute4x64_pd(w_im, 0xD8));
+	}
+}
+#endif
+
+#if FNDSA_AVX512_FPOLY
+/* see sign_inner.h */
+TARGET_AVX512
+void
+avx512_fpoly_split_selfadj_fft(unsigned logn,
+	fpr *f0, fpr *f1, const fpr *f)
+{
+	if (logn < 5) {
+		avx2_fpoly_split_selfadj_fft(logn, f0, f1, f);
+		return;
+	}
+	size_t hn = (size_t)1 << (logn - 1);
+	size_t qn = hn >> 1;
+	const double *ff = (const double *)f;
+	double *ff0 = (double *)f0;
+	double *ff1 = (double *)f1;
+	__m512d h = _mm512_set1_pd(0.5);
+	__m512i idx = _mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7);
+
+	/* Same register ordering as in avx512_fpoly_split_fft(). */
+	for (size_t i = 0; i < qn; i += 8) {
+		__m512d a_re = _mm512_loadu_pd(ff + (i << 1));
+		__m512d b_re = _mm512_loadu_pd(ff + (i << 1) + 8);
+		__m512d x_re = _mm512_unpacklo_pd(a_re, b_re);
+		__m512d y_re = _mm512_unpackhi_pd(a_re, b_re);
+		__m512d s0 = _mm512_loadu_pd(
+			(const double *)GM + ((i + hn) << 1));
+		__m512d s1 = _mm512_loadu_pd(
+			(const double *)GM + ((i + hn) << 1) + 8);
+		__m512d s_re = _mm512_unpacklo_pd(s0, s1);
+		__m512d s_im = _mm512_unpackhi_pd(s0, s1);
+
+		/* w = v*conj(s), with v real; the imaginary part is
+		   computed as (-v)*im(s). */
+		__m512d u = _mm512_mul_pd(h, _mm512_add_pd(x_re, y_re));
+		__m512d v = _mm512_mul_pd(h, _mm512_sub_pd(x_re, y_re));
+		__m512d nv = _mm512_mul_pd(h, _mm512_sub_pd(y_re, x_re));
+		__m512d w_re = _mm512_mul_pd(v, s_re);
+		__m512d w_im = _mm512_mul_pd(nv, s_im);
+		_mm512_storeu_pd(ff0 + i, _mm512_permutexvar_pd(idx, u));
+		_mm512_storeu_pd(ff0 + i + qn, _mm512_setzero_pd());
+		_mm512_storeu_pd(ff1 + i, _mm512_permutexvar_pd(idx, w_re));
+		_mm512_storeu_pd(ff1 + i + qn,
+			_mm512_permutexvar_pd(idx, w_im));
+	}
+}
+#endif
+
 /* see sign_inner.h */
 TARGET_SSE2 TARGET_NEON
 void
@@ -2464,6 +3626,124 @@ fpoly_merge_fft(unsigned logn, fpr *f, const fpr *f0, const fpr *f1)
 #endif
 }
 
+#if FNDSA_AVX2_FPOLY
+/* see sign_inner.h */
+TARGET_AVX2
+void
+avx2_fpoly_merge_fft(unsigned logn, fpr *f, const fpr *f0, const fpr *f1)
+{
+	if (logn < 4) {
+		fpoly_merge_fft(logn, f, f0, f1);
+		return;
+	}
+	size_t hn = (size_t)1 << (logn - 1);
+	size_t qn = hn >> 1;
+	const double *ff0 = (const double *)f0;
+	const double *ff1 = (const double *)f1;
+	double *ff = (double *)f;
+
+	/* Inputs are permuted into the order 0:2:1:3 so that the
+	   outputs are interleaved back into the natural order by the
+	   in-lane unpacking. */
+	for (size_t i = 0; i < qn; i += 4) {
+		__m256d a_re = _mm256_permute4x64_pd(
+			_mm256_loadu_pd(ff0 + i), 0xD8);
+		__m256d a_im = _mm256_permute4x64_pd(
+			_mm256_loadu_pd(ff0 + i + qn), 0xD8);
+		__m256d b_re = _mm256_permute4x64_pd(
+			_mm256_loadu_pd(ff1 + i), 0xD8);
+		__m256d b_im = _mm256_permute4x64_pd(
+			_mm256_loadu_pd(ff1 + i + qn), 0xD8);
+		__m256d s0 = _mm256_loadu_pd(
+			(const double *)GM + ((i + hn) << 1));
+		__m256d s1 = _mm256_loadu_pd(
+			(const double *)GM + ((i + hn) << 1) + 4);
+		__m256d s_re = _mm256_unpacklo_pd(s0, s1);
+		__m256d s_im = _mm256_unpackhi_pd(s0, s1);
+
+		/* c <- b*s */
+		__m256d c_re = _mm256_sub_pd(
+			_mm256_mul_pd(s_re, b_re),
+			_mm256_mul_pd(s_im, b_im));
+		__m256d c_im = _mm256_add_pd(
+			_mm256_mul_pd(s_re, b_im),
+			_mm256_mul_pd(s_im, b_re));
+		__m256d x_re = _mm256_add_pd(a_re, c_re);
+		__m256d x_im = _mm256_add_pd(a_im, c_im);
+		__m256d y_re = _mm256_sub_pd(a_re, c_re);
+		__m256d y_im = _mm256_sub_pd(a_im, c_im);
+		_mm256_storeu_pd(ff + (i << 1),
+			_mm256_unpacklo_pd(x_re, y_re));
+		_mm256_storeu_pd(ff + (i << 1) + 4,
+			_mm256_unpackhi_pd(x_re, y_re));
+		_mm256_storeu_pd(ff + (i << 1) + hn,
+			_mm256_unpacklo_pd(x_im, y_im));
+		_mm256_storeu_pd(ff + (i << 1) + hn + 4,
+			_mm256_unpackhi_pd(x_im, y_im));
+	}
+}
+#endif
+
+#if FNDSA_AVX512_FPOLY
+/* see sign_inner.h */
+TARGET_AVX512
+void
+avx512_fpoly_merge_fft(unsigned logn,
+	fpr *f, const fpr *f0, const fpr *f1)
+{
+	if (logn < 5) {
+		avx2_fpoly_merge_fft(logn, f, f0, f1);
+		return;
+	}
+	size_t hn = (size_t)1 << (logn - 1);
+	size_t qn = hn >> 1;
+	const double *ff0 = (const double *)f0;
+	const double *ff1 = (const double *)f1;
+	double *ff = (double *)f;
+	__m512i idx = _mm512_setr_epi64(0, 4, 1, 5, 2, 6, 3, 7);
+
+	/* Inputs are permuted into the order 0:4:1:5:2:6:3:7 so that the
+	   outputs are interleaved back into the natural order by the
+	   in-lane unpacking. */
+	for (size_t i = 0; i < qn; i += 8) {
+		__m512d a_re = _mm512_permutexvar_pd(idx,
+			_mm512_loadu_pd(ff0 + i));
+		__m512d a_im = _mm512_permutexvar_pd(idx,
+			_mm512_loadu_pd(ff0 + i + qn));
+		__m512d b_re = _mm512_permutexvar_pd(idx,
+			_mm512_loadu_pd(ff1 + i));
+		__m512d b_im = _mm512_permutexvar_pd(idx,
+			_mm512_loadu_pd(ff1 + i + qn));
+		__m512d s0 = _mm512_loadu_pd(
+			(const double *)GM + ((i + hn) << 1));
+		__m512d s1 = _mm512_loadu_pd(
+			(const double *)GM + ((i + hn) << 1) + 8);
+		__m512d s_re = _mm512_unpacklo_pd(s0, s1);
+		__m512d s_im = _mm512_unpackhi_pd(s0, s1);
+
+		/* c <- b*s */
+		__m512d c_re = _mm512_sub_pd(
+			_mm512_mul_pd(s_re, b_re),
+			_mm512_mul_pd(s_im, b_im));
+		__m512d c_im = _mm512_add_pd(
+			_mm512_mul_pd(s_re, b_im),
+			_mm512_mul_pd(s_im, b_re));
+		__m512d x_re = _mm512_add_pd(a_re, c_re);
+		__m512d x_im = _mm512_add_pd(a_im, c_im);
+		__m512d y_re = _mm512_sub_pd(a_re, c_re);
+		__m512d y_im = _mm512_sub_pd(a_im, c_im);
+		_mm512_storeu_pd(ff + (i << 1),
+			_mm512_unpacklo_pd(x_re, y_re));
+		_mm512_storeu_pd(ff + (i << 1) + 8,
+			_mm512_unpackhi_pd(x_re, y_re));
+		_mm512_storeu_pd(ff + (i << 1) + hn,
+			_mm512_unpacklo_pd(x_im, y_im));
+		_mm512_storeu_pd(ff + (i << 1) + hn + 8,
+			_mm512_unpackhi_pd(x_im, y_im));
+	}
+}
+#endif
+
 /* see sign_inner.h */
 TARGET_SSE2 TARGET_NEON
 void
@@ -2653,6 +3933,142 @@ fpoly_gram_fft(unsigned logn, fpr *b00, fpr *b01, fpr *b10, const fpr *b11)
 #endif
 }
 
+#if FNDSA_AVX2_FPOLY
+/* see sign_inner.h */
+TARGET_AVX2
+void
+avx2_fpoly_gram_fft(unsigned logn,
+	fpr *b00, fpr *b01, fpr *b10, const fpr *b11)
+{
+	if (logn < 3) {
+		fpoly_gram_fft(logn, b00, b01, b10, b11);
+		return;
+	}
+	size_t hn = (size_t)1 << (logn - 1);
+	double *p00 = (double *)b00;
+	double *p01 = (double *)b01;
+	double *p10 = (double *)b10;
+	const double *p11 = (const double *)b11;
+	for (size_t i = 0; i < hn; i += 4) {
+		__m256d b00_re = _mm256_loadu_pd(p00 + i);
+		__m256d b00_im = _mm256_loadu_pd(p00 + i + hn);
+		__m256d b01_re = _mm256_loadu_pd(p01 + i);
+		__m256d b01_im = _mm256_loadu_pd(p01 + i + hn);
+		__m256d b10_re = _mm256_loadu_pd(p10 + i);
+		__m256d b10_im = _mm256_loadu_pd(p10 + i + hn);
+		__m256d b11_re = _mm256_loadu_pd(p11 + i);
+		__m256d b11_im = _mm256_loadu_pd(p11 + i + hn);
+
+		/* g00 = b00*adj(b00) + b01*adj(b01) */
+		__m256d g00_re = _mm256_add_pd(
+			_mm256_add_pd(
+				_mm256_mul_pd(b00_re, b00_re),
+				_mm256_mul_pd(b00_im, b00_im)),
+			_mm256_add_pd(
+				_mm256_mul_pd(b01_re, b01_re),
+				_mm256_mul_pd(b01_im, b01_im)));
+		/* g01 = b00*adj(b10) + b01*adj(b11) */
+		__m256d u_re = _mm256_add_pd(
+			_mm256_mul_pd(b00_re, b10_re),
+			_mm256_mul_pd(b00_im, b10_im));
+		__m256d u_im = _mm256_sub_pd(
+			_mm256_mul_pd(b00_im, b10_re),
+			_mm256_mul_pd(b00_re, b10_im));
+		__m256d v_re = _mm256_add_pd(
+			_mm256_mul_pd(b01_re, b11_re),
+			_mm256_mul_pd(b01_im, b11_im));
+		__m256d v_im = _mm256_sub_pd(
+			_mm256_mul_pd(b01_im, b11_re),
+			_mm256_mul_pd(b01_re, b11_im));
+		__m256d g01_re = _mm256_add_pd(u_re, v_re);
+		__m256d g01_im = _mm256_add_pd(u_im, v_im);
+		/* g11 = b10*adj(b10) + b11*adj(b11) */
+		__m256d g11_re = _mm256_add_pd(
+			_mm256_add_pd(
+				_mm256_mul_pd(b10_re, b10_re),
+				_mm256_mul_pd(b10_im, b10_im)),
+			_mm256_add_pd(
+				_mm256_mul_pd(b11_re, b11_re),
+				_mm256_mul_pd(b11_im, b11_im)));
+
+		_mm256_storeu_pd(p00 + i, g00_re);
+		_mm256_storeu_pd(p00 + i + hn, _mm256_setzero_pd());
+		_mm256_storeu_pd(p01 + i, g01_re);
+		_mm256_storeu_pd(p01 + i + hn, g01_im);
+		_mm256_storeu_pd(p10 + i, g11_re);
+		_mm256_storeu_pd(p10 + i + hn, _mm256_setzero_pd());
+	}
+}
+#endif
+
+#if FNDSA_AVX512_FPOLY
+/* see sign_inner.h */
+TARGET_AVX512
+void
+avx512_fpoly_gram_fft(unsigned logn,
+	fpr *b00, fpr *b01, fpr *b10, const fpr *b11)
+{
+	if (logn < 4) {
+		avx2_fpoly_gram_fft(logn, b00, b01, b10, b11);
+		return;
+	}
+	size_t hn = (size_t)1 << (logn - 1);
+	double *p00 = (double *)b00;
+	double *p01 = (double *)b01;
+	double *p10 = (double *)b10;
+	const double *p11 = (const double *)b11;
+	for (size_t i = 0; i < hn; i += 8) {
+		__m512d b00_re = _mm512_loadu_pd(p00 + i);
+		__m512d b00_im = _mm512_loadu_pd(p00 + i + hn);
+		__m512d b01_re = _mm512_loadu_pd(p01 + i);
+		__m512d b01_im = _mm512_loadu_pd(p01 + i + hn);
+		__m512d b10_re = _mm512_loadu_pd(p10 + i);
+		__m512d b10_im = _mm512_loadu_pd(p10 + i + hn);
+		__m512d b11_re = _mm512_loadu_pd(p11 + i);
+		__m512d b11_im = _mm512_loadu_pd(p11 + i + hn);
+
+		/* g00 = b00*adj(b00) + b01*adj(b01) */
+		__m512d g00_re = _mm512_add_pd(
+			_mm512_add_pd(
+				_mm512_mul_pd(b00_re, b00_re),
+				_mm512_mul_pd(b00_im, b00_im)),
+			_mm512_add_pd(
+				_mm512_mul_pd(b01_re, b01_re),
+				_mm512_mul_pd(b01_im, b01_im)));
+		/* g01 = b00*adj(b10) + b01*adj(b11) */
+		__m512d u_re = _mm512_add_pd(
+			_mm512_mul_pd(b00_re, b10_re),
+			_mm512_mul_pd(b00_im, b10_im));
+		__m512d u_im = _mm512_sub_pd(
+			_mm512_mul_pd(b00_im, b10_re),
+			_mm512_mul_pd(b00_re, b10_im));
+		__m512d v_re = _mm512_add_pd(
+			_mm512_mul_pd(b01_re, b11_re),
+			_mm512_mul_pd(b01_im, b11_im));
+		__m512d v_im = _mm512_sub_pd(
+			_mm512_mul_pd(b01_im, b11_re),
+			_mm512_mul_pd(b01_re, b11_im));
+		__m512d g01_re = _mm512_add_pd(u_re, v_re);
+		__m512d g01_im = _mm512_add_pd(u_im, v_im);
+		/* g11 = b10*adj(b10) + b11*adj(b11) */
+		__m512d g11_re = _mm512_add_pd(
+			_mm512_add_pd(
+				_mm512_mul_pd(b10_re, b10_re),
+				_mm512_mul_pd(b10_im, b10_im)),
+			_mm512_add_pd(
+				_mm512_mul_pd(b11_re, b11_re),
+				_mm512_mul_pd(b11_im, b11_im)));
+
+		_mm512_storeu_pd(p00 + i, g00_re);
+		_mm512_storeu_pd(p00 + i + hn, _mm512_setzero_pd());
+		_mm512_storeu_pd(p01 + i, g01_re);
+		_mm512_storeu_pd(p01 + i + hn, g01_im);
+		_mm512_storeu_pd(p10 + i, g11_re);
+		_mm512_storeu_pd(p10 + i + hn, _mm512_setzero_pd());
+	}
+}
+#endif
+
 /* 1/q and -1/q */
 #define INV_Q         FPR( 6004310871091074, -66)
 #define MINUS_INV_Q   FPR(-6004310871091074, -66)
@@ -2710,3 +4126,57 @@ fpoly_apply_basis(unsigned logn, fpr *t0, fpr *t1,
 	fpoly_mulconst(logn, t1, MINUS_INV_Q);
 	fpoly_mulconst(logn, t0, INV_Q);
 }
+
+#if FNDSA_AVX2_FPOLY
+/* see sign_inner.h */
+TARGET_AVX2
+void
+avx2_fpoly_apply_basis(unsigned logn, fpr *t0, fpr *t1,
+	fpr *b01, fpr *b11, const uint16_t *hm)
+{
+	if (logn < 4) {
+		fpoly_apply_basis(logn, t0, t1, b01, b11, hm);
+		return;
+	}
+	size_t n = (size_t)1 << logn;
+	double *dd = (double *)t0;
+	for (size_t i = 0; i < n; i += 4) {
+		__m128i x = _mm_cvtepu16_epi32(
+			_mm_loadl_epi64((const __m128i *)(hm + i)));
+		_mm256_storeu_pd(dd + i, _mm256_cvtepi32_pd(x));
+	}
+	avx2_fpoly_FFT(logn, t0);
+	avx2_fpoly_mul_fft(logn, b01, t0);
+	avx2_fpoly_mul_fft(logn, t0, b11);
+	memmove(t1, b01, n * sizeof(fpr));
+	avx2_fpoly_mulconst(logn, t1, MINUS_INV_Q);
+	avx2_fpoly_mulconst(logn, t0, INV_Q);
+}
+#endif
+
+#if FNDSA_AVX512_FPOLY
+/* see sign_inner.h */
+TARGET_AVX512
+void
+avx512_fpoly_apply_basis(unsigned logn, fpr *t0, fpr *t1,
+	fpr *b01, fpr *b11, const uint16_t *hm)
+{
+	if (logn < 5) {
+		avx2_fpoly_apply_basis(logn, t0, t1, b01, b11, hm);
+		return;
+	}
+	size_t n = (size_t)1 << logn;
+	double *dd = (double *)t0;
+	for (size_t i = 0; i < n; i += 8) {
+		__m256i x = _mm256_cvtepu16_epi32(
+			_mm_loadu_si128((const __m128i *)(hm + i)));
+		_mm512_storeu_pd(dd + i, _mm512_cvtepi32_pd(x));
+	}
+	avx512_fpoly_FFT(logn, t0);
+	avx512_fpoly_mul_fft(logn, b01, t0);
+	avx512_fpoly_mul_fft(logn, t0, b11);
+	memmove(t1, b01, n * sizeof(fpr));
+	avx512_fpoly_mulconst(logn, t1, MINUS_INV_Q);
+	avx512_fpoly_mulconst(logn, t0, INV_Q);
+}
+#endif
@@ -600,6 +600,96 @@ void fpoly_gram_fft(unsigned logn,
 void fpoly_apply_basis(unsigned logn, fpr *t0, fpr *t1,
 	fpr *b01, fpr *b11, const uint16_t *hm);
 
+/* AVX2 versions of the functions above. They compute exactly the same
+   values (same operations, in the same order, without any fused
+   multiply-add), and must be called only if the current CPU supports
+   AVX2 (see has_avx2()). They are used only along with the SSE2 code,
+   since without SSE2 the floating-point operations are emulated and the
+   rounding mode is not set by the signing code. */
+#if FNDSA_AVX2 && FNDSA_SSE2
+#define FNDSA_AVX2_FPOLY   1
+#else
+#define FNDSA_AVX2_FPOLY   0
+#endif
+#if FNDSA_AVX2_FPOLY
+#define avx2_fpoly_FFT                 fndsa_avx2_fpoly_FFT
+#define avx2_fpoly_iFFT                fndsa_avx2_fpoly_iFFT
+#define avx2_fpoly_set_small           fndsa_avx2_fpoly_set_small
+#define avx2_fpoly_add                 fndsa_avx2_fpoly_add
+#define avx2_fpoly_sub                 fndsa_avx2_fpoly_sub
+#define avx2_fpoly_neg                 fndsa_avx2_fpoly_neg
+#define avx2_fpoly_mul_fft             fndsa_avx2_fpoly_mul_fft
+#define avx2_fpoly_mulconst            fndsa_avx2_fpoly_mulconst
+#define avx2_fpoly_LDL_fft             fndsa_avx2_fpoly_LDL_fft
+#define avx2_fpoly_split_fft           fndsa_avx2_fpoly_split_fft
+#define avx2_fpoly_split_selfadj_fft   fndsa_avx2_fpoly_split_selfadj_fft
+#define avx2_fpoly_merge_fft           fndsa_avx2_fpoly_merge_fft
+#define avx2_fpoly_gram_fft            fndsa_avx2_fpoly_gram_fft
+#define avx2_fpoly_apply_basis         fndsa_avx2_fpoly_apply_basis
+void avx2_fpoly_FFT(unsigned logn, fpr *f);
+void avx2_fpoly_iFFT(unsigned logn, fpr *f);
+void avx2_fpoly_set_small(unsigned logn, fpr *d, const int8_t *f);
+void avx2_fpoly_add(unsigned logn, fpr *a, const fpr *b);
+void avx2_fpoly_sub(unsigned logn, fpr *a, const fpr *b);
+void avx2_fpoly_neg(unsigned logn, fpr *a);
+void avx2_fpoly_mul_fft(unsigned logn, fpr *a, const fpr *b);
+void avx2_fpoly_mulconst(unsigned logn, fpr *a, fpr x);
+void avx2_fpoly_LDL_fft(unsigned logn, const fpr *g00, fpr *g01, fpr *g11);
+void avx2_fpoly_split_fft(unsigned logn, fpr *f0, fpr *f1, const fpr *f);
+void avx2_fpoly_split_selfadj_fft(unsigned logn,
+	fpr *f0, fpr *f1, const fpr *f);
+void avx2_fpoly_merge_fft(unsigned logn,
+	fpr *f, const fpr *f0, const fpr *f1);
+void avx2_fpoly_gram_fft(unsigned logn,
+	fpr *b00, fpr *b01, fpr *b10, const fpr *b11);
+void avx2_fpoly_apply_basis(unsigned logn, fpr *t0, fpr *t1,
+	fpr *b01, fpr *b11, const uint16_t *hm);
+#endif
+
+/* AVX-512 versions of the functions above (eight values per register).
+   They also compute exactly the same values, and must be called only if
+   the current CPU supports AVX-512F (see has_avx512()). */
+#if FNDSA_AVX2_FPOLY && FNDSA_AVX512
+#define FNDSA_AVX512_FPOLY   1
+#else
+#define FNDSA_AVX512_FPOLY   0
+#endif
+#if FNDSA_AVX512_FPOLY
+#define avx512_fpoly_FFT               fndsa_avx512_fpoly_FFT
+#define avx512_fpoly_iFFT              fndsa_avx512_fpoly_iFFT
+#define avx512_fpoly_set_small         fndsa_avx512_fpoly_set_small
+#define avx512_fpoly_add               fndsa_avx512_fpoly_add
+#define avx512_fpoly_sub               fndsa_avx512_fpoly_sub
+#define avx512_fpoly_neg               fndsa_avx512_fpoly_neg
+#define avx512_fpoly_mul_fft           fndsa_avx512_fpoly_mul_fft
+#define avx512_fpoly_mulconst          fndsa_avx512_fpoly_mulconst
+#define avx512_fpoly_LDL_fft           fndsa_avx512_fpoly_LDL_fft
+#define avx512_fpoly_split_fft         fndsa_avx512_fpoly_split_fft
+#define avx512_fpoly_split_selfadj_fft fndsa_avx512_fpoly_split_selfadj_fft
+#define avx512_fpoly_merge_fft         fndsa_avx512_fpoly_merge_fft
+#define avx512_fpoly_gram_fft          fndsa_avx512_fpoly_gram_fft
+#define avx512_fpoly_apply_basis       fndsa_avx512_fpoly_apply_basis
+void avx512_fpoly_FFT(unsigned logn, fpr *f);
+void avx512_fpoly_iFFT(unsigned logn, fpr *f);
+void avx512_fpoly_set_small(unsigned logn, fpr *d, const int8_t *f);
+void avx512_fpoly_add(unsigned logn, fpr *a, const fpr *b);
+void avx512_fpoly_sub(unsigned logn, fpr *a, const fpr *b);
+void avx512_fpoly_neg(unsigned logn, fpr *a);
+void avx512_fpoly_mul_fft(unsigned logn, fpr *a, const fpr *b);
+void avx512_fpoly_mulconst(unsigned logn, fpr *a, fpr x);
+void avx512_fpoly_LDL_fft(unsigned logn,
+	const fpr *g00, fpr *g01, fpr *g11);
+void avx512_fpoly_split_fft(unsigned logn, fpr *f0, fpr *f1, const fpr *f);
+void avx512_fpoly_split_selfadj_fft(unsigned logn,
+	fpr *f0, fpr *f1, const fpr *f);
+void avx512_fpoly_merge_fft(unsigned logn,
+	fpr *f, const fpr *f0, const fpr *f1);
+void avx512_fpoly_gram_fft(unsigned logn,
+	fpr *b00, fpr *b01, fpr *b10, const fpr *b11);
+void avx512_fpoly_apply_basis(unsigned logn, fpr *t0, fpr *t1,
+	fpr *b01, fpr *b11, const uint16_t *hm);
+#endif
+
 /* ==================================================================== */
 /*
  * Gaussian sampling.
@@ -611,12 +701,22 @@ void fpoly_apply_basis(unsigned logn, fpr *t0, fpr *t1,
  * rejection sampling of the target distribution.
  */
 
+/* The sampler PRNG is SHAKE256 (or SHAKE256x4). It may optionally start
+   with a pre-expanded stream (see sampler_pre_expand()): the next
+   pre_num PRNG output blocks are then read from pre instead of being
+   computed. */
 typedef struct {
 #if FNDSA_SHAKE256X4
-	shake256x4_context pc;
+	shake256x4_context sc;
 #else
-	shake_context pc;
+	shake_context sc;
 #endif
+	const uint8_t *pre;
+	size_t pre_num;
+} sampler_prng;
+
+typedef struct {
+	sampler_prng pc;
 	unsigned logn;
 } sampler_state;
 
@@ -625,6 +725,27 @@ typedef struct {
 void sampler_init(sampler_state *ss, unsigned logn,
 	const void *seed, size_t seed_len);
 
+/* Size (in bytes) of a pre-expanded sampler stream for degree 2^logn.
+   The stream covers the PRNG output that a signing attempt consumes on
+   average, with some margin; if a signing attempt needs more, the PRNG
+   output continues seamlessly (but is then computed on the fly). */
+#define sampler_pre_size   fndsa_sampler_pre_size
+size_t sampler_pre_size(unsigned logn);
+
+/* Pre-expand the sampler PRNG output for the given seed into pre[]
+   (sampler_pre_size(logn) bytes, 8-byte aligned). A sampler initialized
+   with sampler_init_pre() on that stream produces the same output as a
+   sampler initialized with sampler_init() on the seed. */
+#define sampler_pre_expand   fndsa_sampler_pre_expand
+void sampler_pre_expand(unsigned logn, void *pre,
+	const void *seed, size_t seed_len);
+
+/* Initialize the sampler for a given degree, from a pre-expanded stream.
+   The stream is read in place and must not be modified as long as the
+   sampler is in use. */
+#define sampler_init_pre   fndsa_sampler_init_pre
+void sampler_init_pre(sampler_state *ss, unsigned logn, const void *pre);
+
 /* Sample the next small integer. Parameters are:
       ss       sampler state
       mu       distribution centre
@@ -649,6 +770,20 @@ int32_t sampler_next(sampler_state *ss, fpr mu, fpr isigma);
 #define ffsamp_fft   fndsa_ffsamp_fft
 void ffsamp_fft(sampler_state *ss, fpr *tmp);
 
+/* Same as ffsamp_fft(), but using the AVX2 polynomial functions. The
+   output is identical; the current CPU must support AVX2. */
+#if FNDSA_AVX2_FPOLY
+#define avx2_ffsamp_fft   fndsa_avx2_ffsamp_fft
+void avx2_ffsamp_fft(sampler_state *ss, fpr *tmp);
+#endif
+
+/* Same as ffsamp_fft(), but using the AVX-512 polynomial functions. The
+   output is identical; the current CPU must support AVX-512F. */
+#if FNDSA_AVX512_FPOLY
+#define avx512_ffsamp_fft   fndsa_avx512_ffsamp_fft
+void avx512_ffsamp_fft(sampler_state *ss, fpr *tmp);
+#endif
+
 /* This function is global on ARM Cortex M4 so that it can be called
    from assembly code. We define its global name here so that test code
    can override it (in test_sampler.c and test_sign.c). */
@@ -661,6 +796,25 @@ void ffsamp_fft(sampler_state *ss, fpr *tmp);
  * Internal signing function.
  */
 
+/* Signature generation may restart a few times (when the sampled vector
+   is too long, or cannot be encoded). With the default temporary area
+   (59*n+31 bytes), the key-dependent precomputations (basis in FFT
+   representation, Gram matrix) are redone at each restart, since there
+   is no room to keep them. If a larger area is available (110*n+31
+   bytes), then the key is first expanded into it, and sign_core_expanded()
+   is used; precomputations then run only once per signature.
+   FNDSA_SIGN_LARGE_TMP controls which size the stack-allocated temporary
+   areas (for the functions that do not take an explicit tmp buffer) use;
+   it is disabled by default, so that fndsa_sign() and the other
+   stack-allocating functions use at most 59*n+31 bytes of stack for
+   that area (60447 bytes at n = 1024), which fits in small thread stacks
+   (e.g. the 128 kB default of musl). Callers of the *_temp() functions
+   get the larger mode whenever they provide a large enough area. The
+   generated signatures are identical in both modes. */
+#ifndef FNDSA_SIGN_LARGE_TMP
+#define FNDSA_SIGN_LARGE_TMP   0
+#endif
+
 /* Internal signing function. The complete signing key (encoded for f,
    g and F, but skipping the leading header byte, and decoded for G) is
    provided, as well as the hashed verifying key, data to sign (context,
@@ -680,6 +834,54 @@ size_t sign_core(unsigned logn,
 	const char *id, const uint8_t *hv, size_t hv_len,
 	const uint8_t *seed, size_t seed_len, uint8_t *sig, void *tmp);
 
+/* Compute the lattice basis and the Gram matrix, for an expanded signing
+   key. Input is f, g, F and G, decoded, in that order (4*n bytes).
+   Output (6*n fpr slots, in FFT representation) is:
+      b00 (n)
+      b01 (n)
+      b10 (n)
+      b11 (n)
+      g01 (n)
+      g00 (hn)
+      g11 (hn)
+   with B = [[b00, b01], [b10, b11]] = [[g, -f], [G, -F]], and the Gram
+   matrix B*adj(B) = [[g00, g01], [adj(g01), g11]]. */
+#define sign_expand_basis   fndsa_sign_expand_basis
+void sign_expand_basis(unsigned logn, const int8_t *fgFG, fpr *dst);
+
+/* Internal signing function with an expanded signing key: fgFG contains
+   f, g, F and G, decoded (4*n bytes), and bg is the output of
+   sign_expand_basis() (6*n fpr slots). Other parameters are as in
+   sign_core(); for a given seed, the two functions produce the same
+   signature. If rp is not NULL, then the randomness for each signing
+   attempt is taken from that pool (for the same degree) when it has a
+   ready entry, and generated on the spot otherwise (seed is then
+   ignored).
+
+   tmp size: 58*n bytes  */
+#define sign_core_expanded   fndsa_sign_core_expanded
+size_t sign_core_expanded(unsigned logn, const int8_t *fgFG, const fpr *bg,
+	const uint8_t *hashed_vk, const uint8_t *ctx, size_t ctx_len,
+	const char *id, const uint8_t *hv, size_t hv_len,
+	const uint8_t *seed, size_t seed_len, fndsa_randpool *rp,
+	uint8_t *sig, void *tmp);
+
+/* Randomness pool access (see sign_randpool.c).
+   randpool_logn() returns the degree (logarithmic) of the pool.
+   randpool_take() takes the oldest ready entry: the nonce (40 bytes) is
+   copied into nonce[], *slot is set to the entry index, and a pointer to
+   the pre-expanded sampler stream (for sampler_init_pre()) is returned.
+   If no entry is ready, NULL is returned. The stream is read in place;
+   once the sampler is no longer used, the entry must be handed back with
+   randpool_release(), after which it is refilled with new values. */
+#define randpool_logn      fndsa_randpool_logn
+#define randpool_take      fndsa_randpool_take
+#define randpool_release   fndsa_randpool_release
+unsigned randpool_logn(fndsa_randpool *rp);
+const uint8_t *randpool_take(fndsa_randpool *rp,
+	uint8_t *nonce, size_t *slot);
+void randpool_release(fndsa_randpool *rp, size_t slot);
+
 /* ==================================================================== */
 
 #endif
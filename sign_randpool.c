@@ -0,0 +1,332 @@
+/*
+ * Pre-generated signing randomness pool.
+ */
+
+#include "sign_inner.h"
+
+#if FNDSA_SIGN_ENGINE
+
+#include <pthread.h>
+
+/*
+ * Each entry holds the randomness for one signing attempt: a 40-byte
+ * nonce (padded to 64 bytes), followed by the pre-expanded sampler
+ * stream (see sampler_pre_expand()). An entry is in one of four states:
+ *    free      listed in free_ids[], to be (re)filled by a worker
+ *    filling   owned by a worker
+ *    ready     listed in the ready_ids[] ring (oldest first)
+ *    in use    taken by a signer, which reads the stream in place, and
+ *              then erases the entry and hands it back (it becomes
+ *              free again)
+ * Transitions are done under the mutex, so that an entry is given to
+ * at most one signer between two refills; a worker always overwrites
+ * the whole entry before making it ready again.
+ *
+ * Entries and worker generators (see sysrng_shake_init()) are erased
+ * when the pool is destroyed.
+ */
+
+typedef struct {
+	fndsa_randpool *pool;
+	pthread_t thread;
+	shake_context rng;
+} randpool_worker;
+
+struct fndsa_randpool_ {
+	unsigned logn;
+	size_t entry_len;
+	size_t capacity;
+	size_t head;
+	size_t count;
+	size_t num_free;
+	size_t *ready_ids;
+	size_t *free_ids;
+	int stopping;
+	uint8_t *entries;
+	randpool_worker *workers;
+	unsigned num_threads;
+	pthread_mutex_t lock;
+	pthread_cond_t cond_free;
+};
+
+/* Size of an entry (nonce and sampler stream). */
+static size_t
+randpool_entry_len(unsigned logn)
+{
+	return 64 + ROUND64(sampler_pre_size(logn));
+}
+
+/* Fill an entry with a nonce and the stream expanded from a 56-byte
+   sampler sub-seed. */
+static void
+worker_fill(randpool_worker *w, uint8_t *entry)
+{
+	fndsa_randpool *rp = w->pool;
+	uint8_t buf[40 + 56];
+	shake_ratchet(&w->rng, buf, sizeof buf);
+	memcpy(entry, buf, 40);
+	sampler_pre_expand(rp->logn, entry + 64, buf + 40, 56);
+	secure_wipe(buf, sizeof buf);
+}
+
+static void *
+worker_main(void *arg)
+{
+	randpool_worker *w = arg;
+	fndsa_randpool *rp = w->pool;
+	for (;;) {
+		pthread_mutex_lock(&rp->lock);
+		while (rp->num_free == 0 && !rp->stopping) {
+			pthread_cond_wait(&rp->cond_free, &rp->lock);
+		}
+		if (rp->stopping) {
+			pthread_mutex_unlock(&rp->lock);
+			return NULL;
+		}
+		size_t id = rp->free_ids[-- rp->num_free];
+		pthread_mutex_unlock(&rp->lock);
+
+		worker_fill(w, rp->entries + id * rp->entry_len);
+
+		pthread_mutex_lock(&rp->lock);
+		size_t j = rp->head + rp->count;
+		if (j >= rp->capacity) {
+			j -= rp->capacity;
+		}
+		rp->ready_ids[j] = id;
+		rp->count ++;
+		pthread_mutex_unlock(&rp->lock);
+	}
+}
+
+/* Stop the first num workers and release the synchronization objects. */
+static void
+randpool_shutdown(fndsa_randpool *rp, unsigned num)
+{
+	pthread_mutex_lock(&rp->lock);
+	rp->stopping = 1;
+	pthread_cond_broadcast(&rp->cond_free);
+	pthread_mutex_unlock(&rp->lock);
+	for (unsigned i = 0; i < num; i ++) {
+		pthread_join(rp->workers[i].thread, NULL);
+	}
+	pthread_cond_destroy(&rp->cond_free);
+	pthread_mutex_destroy(&rp->lock);
+}
+
+/* Erase the worker generators and the entries. */
+static void
+randpool_wipe(fndsa_randpool *rp)
+{
+	secure_wipe(rp->workers, rp->num_threads * sizeof(randpool_worker));
+	secure_wipe(rp->entries, rp->capacity * rp->entry_len);
+}
+
+/* see fndsa.h */
+size_t
+fndsa_randpool_size(unsigned logn, size_t capacity, unsigned num_threads)
+{
+	if (logn < 2 || logn > 10) {
+		return 0;
+	}
+	if (capacity < 1 || capacity > 65536) {
+		return 0;
+	}
+	if (num_threads < 1 || num_threads > 256) {
+		return 0;
+	}
+	return 63 + ROUND64(sizeof(fndsa_randpool))
+		+ ROUND64(num_threads * sizeof(randpool_worker))
+		+ 2 * ROUND64(capacity * sizeof(size_t))
+		+ capacity * randpool_entry_len(logn);
+}
+
+/* see fndsa.h */
+fndsa_randpool *
+fndsa_randpool_create(unsigned logn, size_t capacity, unsigned num_threads,
+	void *mem, size_t mem_len)
+{
+	size_t len = fndsa_randpool_size(logn, capacity, num_threads);
+	if (len == 0 || mem == NULL || mem_len < len) {
+		return NULL;
+	}
+
+	/* Layout: pool structure, workers, entry lists, and entries; each
+	   element starts on a 64-byte boundary. */
+	uint8_t *buf = (uint8_t *)(((uintptr_t)mem + 63) & ~(uintptr_t)63);
+	fndsa_randpool *rp = (fndsa_randpool *)buf;
+	buf += ROUND64(sizeof(fndsa_randpool));
+	memset(rp, 0, sizeof *rp);
+	rp->logn = logn;
+	rp->entry_len = randpool_entry_len(logn);
+	rp->capacity = capacity;
+	rp->num_threads = num_threads;
+	rp->workers = (randpool_worker *)buf;
+	buf += ROUND64(num_threads * sizeof(randpool_worker));
+	rp->ready_ids = (size_t *)buf;
+	buf += ROUND64(capacity * sizeof(size_t));
+	rp->free_ids = (size_t *)buf;
+	buf += ROUND64(capacity * sizeof(size_t));
+	rp->entries = buf;
+
+	/* All entries are initially free; they are filled in ascending
+	   order. */
+	for (size_t i = 0; i < capacity; i ++) {
+		rp->free_ids[i] = capacity - 1 - i;
+	}
+	rp->num_free = capacity;
+	for (unsigned i = 0; i < num_threads; i ++) {
+		randpool_worker *w = &rp->workers[i];
+		w->pool = rp;
+		if (!sysrng_shake_init(&w->rng)) {
+			randpool_wipe(rp);
+			return NULL;
+		}
+	}
+
+	if (pthread_mutex_init(&rp->lock, NULL) != 0) {
+		randpool_wipe(rp);
+		return NULL;
+	}
+	if (pthread_cond_init(&rp->cond_free, NULL) != 0) {
+		pthread_mutex_destroy(&rp->lock);
+		randpool_wipe(rp);
+		return NULL;
+	}
+	for (unsigned i = 0; i < num_threads; i ++) {
+		randpool_worker *w = &rp->workers[i];
+		if (pthread_create(&w->thread, NULL, worker_main, w) != 0) {
+			randpool_shutdown(rp, i);
+			randpool_wipe(rp);
+			return NULL;
+		}
+	}
+	return rp;
+}
+
+/* see fndsa.h */
+size_t
+fndsa_randpool_available(fndsa_randpool *rp)
+{
+	pthread_mutex_lock(&rp->lock);
+	size_t count = rp->count;
+	pthread_mutex_unlock(&rp->lock);
+	return count;
+}
+
+/* see fndsa.h */
+void
+fndsa_randpool_destroy(fndsa_randpool *rp)
+{
+	randpool_shutdown(rp, rp->num_threads);
+	randpool_wipe(rp);
+}
+
+/* see sign_inner.h */
+unsigned
+randpool_logn(fndsa_randpool *rp)
+{
+	return rp->logn;
+}
+
+/* see sign_inner.h */
+const uint8_t *
+randpool_take(fndsa_randpool *rp, uint8_t *nonce, size_t *slot)
+{
+	pthread_mutex_lock(&rp->lock);
+	if (rp->count == 0) {
+		pthread_mutex_unlock(&rp->lock);
+		return NULL;
+	}
+	size_t id = rp->ready_ids[rp->head];
+	if (++ rp->head == rp->capacity) {
+		rp->head = 0;
+	}
+	rp->count --;
+	pthread_mutex_unlock(&rp->lock);
+	const uint8_t *entry = rp->entries + id * rp->entry_len;
+	memcpy(nonce, entry, 40);
+	*slot = id;
+	return entry + 64;
+}
+
+/* see sign_inner.h */
+void
+randpool_release(fndsa_randpool *rp, size_t slot)
+{
+	secure_wipe(rp->entries + slot * rp->entry_len, rp->entry_len);
+	pthread_mutex_lock(&rp->lock);
+	rp->free_ids[rp->num_free ++] = slot;
+	pthread_cond_signal(&rp->cond_free);
+	pthread_mutex_unlock(&rp->lock);
+}
+
+#else
+
+/* No thread support: the pool cannot be created. */
+
+/* see fndsa.h */
+size_t
+fndsa_randpool_size(unsigned logn, size_t capacity, unsigned num_threads)
+{
+	(void)logn;
+	(void)capacity;
+	(void)num_threads;
+	return 0;
+}
+
+/* see fndsa.h */
+fndsa_randpool *
+fndsa_randpool_create(unsigned logn, size_t capacity, unsigned num_threads,
+	void *mem, size_t mem_len)
+{
+	(void)logn;
+	(void)capacity;
+	(void)num_threads;
+	(void)mem;
+	(void)mem_len;
+	return NULL;
+}
+
+/* see fndsa.h */
+size_t
+fndsa_randpool_available(fndsa_randpool *rp)
+{
+	(void)rp;
+	return 0;
+}
+
+/* see fndsa.h */
+void
+fndsa_randpool_destroy(fndsa_randpool *rp)
+{
+	(void)rp;
+}
+
+/* see sign_inner.h */
+unsigned
+randpool_logn(fndsa_randpool *rp)
+{
+	(void)rp;
+	return 0;
+}
+
+/* see sign_inner.h */
+const uint8_t *
+randpool_take(fndsa_randpool *rp, uint8_t *nonce, size_t *slot)
+{
+	(void)rp;
+	(void)nonce;
+	(void)slot;
+	return NULL;
+}
+
+/* see sign_inner.h */
+void
+randpool_release(fndsa_randpool *rp, size_t slot)
+{
+	(void)rp;
+	(void)slot;
+}
+
+#endif
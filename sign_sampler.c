@@ -89,19 +89,164 @@ static const uint32_t GAUSS0[][3] = {
 /* We access the PRNG through macros so that they can be overridden by some
    compatiblity tests with the original Falcon implementation. */
 #ifndef prng_init
+
+/* PRNG output is produced by blocks: 136 bytes for SHAKE256 (the rate),
+   544 bytes for SHAKE256x4 (the output buffer). PRNG_LEFT() is the
+   number of bytes left in the current block. */
+#if FNDSA_SHAKE256X4
+#define PRNG_BLOCK_LEN   (4 * 136)
+#define PRNG_LEFT(p)     ((sizeof (p)->sc.buf) - (p)->sc.ptr)
+#else
+#define PRNG_BLOCK_LEN   136
+#define PRNG_LEFT(p)     ((size_t)((p)->sc.rate - (p)->sc.dptr))
+#endif
+
+/*
+ * A pre-expanded stream (see sampler_pre_expand()) consists of the first
+ * num-1 PRNG output blocks, followed by a copy of the PRNG context right
+ * after the production of block num. When the current block is exhausted,
+ * the next block is copied from the stream instead of being computed;
+ * the last one comes with the complete context, from which the PRNG then
+ * proceeds normally. For SHAKE256, blocks are stored as the first 17
+ * state words (in native representation), since the output bytes are
+ * read from the state.
+ */
+
+static void
+sampler_prng_init(sampler_prng *p, const void *seed, size_t seed_len)
+{
+#if FNDSA_SHAKE256X4
+	shake256x4_init(&p->sc, seed, seed_len);
+#else
+	shake_init(&p->sc, 256);
+	shake_inject(&p->sc, seed, seed_len);
+	shake_flip(&p->sc);
+#endif
+	p->pre = NULL;
+	p->pre_num = 0;
+}
+
+/* Number of blocks in a pre-expanded stream: a signing attempt uses a
+   bit more than 0.28*n SHAKE256 blocks on average, with a very small
+   variance; we cover 5*n/16 + 8 blocks. */
+static size_t
+sampler_pre_blocks(unsigned logn)
+{
+	size_t len = ((((size_t)5 << logn) >> 4) + 8) * 136;
+	return (len + PRNG_BLOCK_LEN - 1) / PRNG_BLOCK_LEN;
+}
+
+static void
+sampler_prng_init_pre(sampler_prng *p, unsigned logn, const void *pre)
+{
+	/* The current block is marked as exhausted, so that the first
+	   read gets the first block from the stream. */
 #if FNDSA_SHAKE256X4
-#define prng_init       shake256x4_init
-#define prng_next_u8    shake256x4_next_u8
-#define prng_next_u64   shake256x4_next_u64
+	p->sc.ptr = sizeof p->sc.buf;
 #else
-#define prng_init(pc, seed, seed_len)   do { \
-		shake_init(pc, 256); \
-		shake_inject(pc, seed, seed_len); \
-		shake_flip(pc); \
-	} while (0)
-#define prng_next_u8    shake_next_u8
-#define prng_next_u64   shake_next_u64
+	p->sc.rate = 136;
+	p->sc.dptr = 136;
 #endif
+	p->pre = (const uint8_t *)pre;
+	p->pre_num = sampler_pre_blocks(logn) - 1;
+}
+
+/* Get the next block from the pre-expanded stream. */
+static void
+sampler_prng_refill(sampler_prng *p)
+{
+	if (p->pre_num > 0) {
+#if FNDSA_SHAKE256X4
+		memcpy(p->sc.buf, p->pre, PRNG_BLOCK_LEN);
+		p->sc.ptr = 0;
+#else
+		memcpy(p->sc.A, p->pre, PRNG_BLOCK_LEN);
+		p->sc.dptr = 0;
+#endif
+		p->pre += PRNG_BLOCK_LEN;
+		p->pre_num --;
+	} else {
+		memcpy(&p->sc, p->pre, sizeof p->sc);
+		p->pre = NULL;
+	}
+}
+
+static inline uint8_t
+sampler_prng_next_u8(sampler_prng *p)
+{
+	if (PRNG_LEFT(p) == 0 && p->pre != NULL) {
+		sampler_prng_refill(p);
+	}
+#if FNDSA_SHAKE256X4
+	return shake256x4_next_u8(&p->sc);
+#else
+	return shake_next_u8(&p->sc);
+#endif
+}
+
+static inline uint64_t
+sampler_prng_next_u64(sampler_prng *p)
+{
+	if (PRNG_LEFT(p) < 8 && p->pre != NULL) {
+#if FNDSA_SHAKE256X4
+		/* SHAKE256x4 skips the last bytes of a block that cannot
+		   provide a complete word. */
+		sampler_prng_refill(p);
+#else
+		/* SHAKE256 words may span two blocks. */
+		uint64_t x = 0;
+		for (int i = 0; i < 64; i += 8) {
+			x |= (uint64_t)sampler_prng_next_u8(p) << i;
+		}
+		return x;
+#endif
+	}
+#if FNDSA_SHAKE256X4
+	return shake256x4_next_u64(&p->sc);
+#else
+	return shake_next_u64(&p->sc);
+#endif
+}
+
+#define prng_init       sampler_prng_init
+#define prng_init_pre   sampler_prng_init_pre
+#define prng_next_u8    sampler_prng_next_u8
+#define prng_next_u64   sampler_prng_next_u64
+#endif
+
+/* The AVX2 sampler reads ahead in the PRNG output buffer, and then
+   discards only the bytes that the plain sampler would have used:
+      prng_avail(pc)     number of bytes that can be obtained (in order)
+                         from the buffer by prng_next_u8() and
+                         prng_next_u64() calls, without any refill
+      prng_buf(pc)       pointer to the next buffer byte
+      prng_skip(pc, n)   discard n bytes (with n <= prng_avail(pc))
+      prng_dec64(buf)    decode a prng_next_u64() output from the buffer
+   prng_avail() may underestimate the buffered amount (a value of 0 is
+   always correct). */
+#ifndef prng_avail
+#if FNDSA_SHAKE256X4
+#define prng_avail(pc)      ((sizeof (pc)->sc.buf) - (pc)->sc.ptr)
+#define prng_buf(pc)        ((pc)->sc.buf + (pc)->sc.ptr)
+#define prng_skip(pc, n)    ((pc)->sc.ptr += (n))
+#elif FNDSA_LITTLE_ENDIAN
+#define prng_avail(pc)      ((size_t)((pc)->sc.rate - (pc)->sc.dptr))
+#define prng_buf(pc) \
+	((const uint8_t *)(void *)&(pc)->sc + (pc)->sc.dptr)
+#define prng_skip(pc, n)    ((pc)->sc.dptr += (n))
+#else
+#define prng_avail(pc)      ((size_t)0)
+#define prng_buf(pc)        ((const uint8_t *)NULL)
+#define prng_skip(pc, n)    ((void)(n))
+#endif
+#define prng_dec64(buf)     ((uint64_t)(buf)[0] \
+	| ((uint64_t)(buf)[1] << 8) \
+	| ((uint64_t)(buf)[2] << 16) \
+	| ((uint64_t)(buf)[3] << 24) \
+	| ((uint64_t)(buf)[4] << 32) \
+	| ((uint64_t)(buf)[5] << 40) \
+	| ((uint64_t)(buf)[6] << 48) \
+	| ((uint64_t)(buf)[7] << 56))
 #endif
 
 /* see sign_inner.h */
@@ -113,6 +258,60 @@ sampler_init(sampler_state *ss, unsigned logn,
 	ss->logn = logn;
 }
 
+/* The pre-expanded streams are supported only with the default PRNG. */
+#ifdef prng_init_pre
+
+/* see sign_inner.h */
+size_t
+sampler_pre_size(unsigned logn)
+{
+	size_t len = (sampler_pre_blocks(logn) - 1) * PRNG_BLOCK_LEN;
+	return len + ((sizeof(((sampler_prng *)0)->sc) + 7) & ~(size_t)7);
+}
+
+/* see sign_inner.h */
+void
+sampler_pre_expand(unsigned logn, void *pre,
+	const void *seed, size_t seed_len)
+{
+	uint8_t *buf = (uint8_t *)pre;
+	size_t num = sampler_pre_blocks(logn);
+#if FNDSA_SHAKE256X4
+	shake256x4_context sc;
+	shake256x4_init(&sc, seed, seed_len);
+	for (size_t i = 1; i < num; i ++) {
+		shake256x4_refill(&sc);
+		memcpy(buf, sc.buf, PRNG_BLOCK_LEN);
+		buf += PRNG_BLOCK_LEN;
+	}
+	shake256x4_refill(&sc);
+#else
+	shake_context sc;
+	shake_init(&sc, 256);
+	shake_inject(&sc, seed, seed_len);
+	shake_flip(&sc);
+	for (size_t i = 1; i < num; i ++) {
+		shake_extract(&sc, NULL, PRNG_BLOCK_LEN);
+		memcpy(buf, sc.A, PRNG_BLOCK_LEN);
+		buf += PRNG_BLOCK_LEN;
+	}
+	shake_extract(&sc, NULL, PRNG_BLOCK_LEN);
+	sc.dptr = 0;
+#endif
+	memcpy(buf, &sc, sizeof sc);
+	secure_wipe(&sc, sizeof sc);
+}
+
+/* see sign_inner.h */
+void
+sampler_init_pre(sampler_state *ss, unsigned logn, const void *pre)
+{
+	prng_init_pre(&ss->pc, logn, pre);
+	ss->logn = logn;
+}
+
+#endif
+
 #if FNDSA_ASM_CORTEXM4
 int32_t fndsa_gaussian0_helper(uint64_t lo, uint32_t hi);
 #endif
@@ -186,36 +385,34 @@ mtwop63(__m128d x)
 #endif
 }
 
-/* Compute ccs*exp(-x)*2^63, rounded to an integer. This function assumes
-   that 0 <= x < log(2), and 0 <= ccs <= 1. It returns a value in [0,2^63]. */
-TARGET_SSE2
+/* The polynomial approximation of exp(-x) is from FACCT:
+      https://eprint.iacr.org/2018/1234
+   Specifically, the values are extracted from the implementation
+   referenced by the FACCT paper, available at:
+      https://github.com/raykzhao/gaussian  */
+static const uint64_t EXPM_COEFFS[] = {
+	0x00000004741183A3,
+	0x00000036548CFC06,
+	0x0000024FDCBF140A,
+	0x0000171D939DE045,
+	0x0000D00CF58F6F84,
+	0x000680681CF796E3,
+	0x002D82D8305B0FEA,
+	0x011111110E066FD0,
+	0x0555555555070F00,
+	0x155555555581FF00,
+	0x400000000002B400,
+	0x7FFFFFFFFFFF4800,
+	0x8000000000000000
+};
+
+/* Polynomial approximation of exp(-x)*ccs, in fixed-point: z and w are
+   x*2^64 and ccs*2^64, truncated (0 <= x < log(2), 0 <= ccs <= 1). The
+   returned value is ccs*exp(-x)*2^63, in [0,2^63]. */
 static inline uint64_t
-expm_p63(__m128d x, __m128d ccs)
+expm_poly(uint64_t z, uint64_t w)
 {
-	/* The polynomial approximation of exp(-x) is from FACCT:
-	      https://eprint.iacr.org/2018/1234
-	   Specifically, the values are extracted from the implementation
-	   referenced by the FACCT paper, available at:
-	      https://github.com/raykzhao/gaussian  */
-	static const uint64_t EXPM_COEFFS[] = {
-		0x00000004741183A3,
-		0x00000036548CFC06,
-		0x0000024FDCBF140A,
-		0x0000171D939DE045,
-		0x0000D00CF58F6F84,
-		0x000680681CF796E3,
-		0x002D82D8305B0FEA,
-		0x011111110E066FD0,
-		0x0555555555070F00,
-		0x155555555581FF00,
-		0x400000000002B400,
-		0x7FFFFFFFFFFF4800,
-		0x8000000000000000
-	};
-
 	uint64_t y = EXPM_COEFFS[0];
-	uint64_t z = (uint64_t)mtwop63(x) << 1;
-	uint64_t w = (uint64_t)mtwop63(ccs) << 1;
 #if FNDSA_64
 	/* On 64-bit x86, we have 64x64->128 multiplication, then we can use
 	   it, it's normally constant-time.
@@ -262,6 +459,16 @@ expm_p63(__m128d x, __m128d ccs)
 	return y;
 }
 
+/* Compute ccs*exp(-x)*2^63, rounded to an integer. This function assumes
+   that 0 <= x < log(2), and 0 <= ccs <= 1. It returns a value in [0,2^63]. */
+TARGET_SSE2
+static inline uint64_t
+expm_p63(__m128d x, __m128d ccs)
+{
+	return expm_poly((uint64_t)mtwop63(x) << 1,
+		(uint64_t)mtwop63(ccs) << 1);
+}
+
 /* Sample a bit with probability ccs*exp(-x) (for x >= 0). */
 TARGET_SSE2
 static inline int
@@ -395,6 +602,254 @@ sampler_next(sampler_state *ss, fpr mu, fpr isigma)
 		_mm_load_sd((double *)&isigma));
 }
 
+#if FNDSA_AVX2_FPOLY
+/* For four candidates with values z and z0 (as in sampler_next_sse2())
+   and centre r, compute the value x, then, as in ber_exp(), the
+   saturated exponent s (into sh[]) and mtwop63(r) << 1 (into x63[]).
+   Only the low halves of z and zsq = z0^2 (four 32-bit values) are
+   used. */
+TARGET_AVX2
+static inline void
+avx2_sampler_eval_x(__m256i z, __m256i zsq, __m256d r,
+	__m256d dss, uint64_t *x63, uint32_t *sh)
+{
+	__m256d x = _mm256_sub_pd(
+		_mm256_cvtepi32_pd(_mm256_castsi256_si128(z)), r);
+	x = _mm256_mul_pd(_mm256_mul_pd(x, x), dss);
+	x = _mm256_sub_pd(x, _mm256_mul_pd(
+		_mm256_cvtepi32_pd(_mm256_castsi256_si128(zsq)),
+		_mm256_castsi256_pd(_mm256_set1_epi64x(
+			(int64_t)INV_2SQRSIGMA0))));
+
+	/* x = s*log(2) + r, with s saturated at 63. */
+	__m128i si = _mm256_cvttpd_epi32(_mm256_mul_pd(x,
+		_mm256_castsi256_pd(_mm256_set1_epi64x((int64_t)INV_LOG2))));
+	__m256d rx = _mm256_sub_pd(x, _mm256_mul_pd(_mm256_cvtepi32_pd(si),
+		_mm256_castsi256_pd(_mm256_set1_epi64x((int64_t)LOG2))));
+	si = _mm_or_si128(si, _mm_srli_epi32(
+		_mm_sub_epi32(_mm_set1_epi32(63), si), 26));
+	_mm_storeu_si128((__m128i *)sh,
+		_mm_and_si128(si, _mm_set1_epi32(63)));
+
+	/* mtwop63(rx): truncation of rx*2^63 to an integer, computed from
+	   the bits of rx (AVX2 has no conversion to 64-bit integers).
+	   Shift counts are 64 or more for zero and subnormal values,
+	   which then yield 0. */
+	__m256i bx = _mm256_castpd_si256(rx);
+	__m256i e = _mm256_and_si256(_mm256_srli_epi64(bx, 52),
+		_mm256_set1_epi64x(0x7FF));
+	__m256i m = _mm256_or_si256(
+		_mm256_and_si256(bx, _mm256_set1_epi64x(((int64_t)1 << 52) - 1)),
+		_mm256_set1_epi64x((int64_t)1 << 52));
+	__m256i e0 = _mm256_set1_epi64x(1012);
+	m = _mm256_or_si256(
+		_mm256_sllv_epi64(m, _mm256_sub_epi64(e, e0)),
+		_mm256_srlv_epi64(m, _mm256_sub_epi64(e0, e)));
+	__m256i sg = _mm256_cmpgt_epi64(_mm256_setzero_si256(), bx);
+	m = _mm256_sub_epi64(_mm256_xor_si256(m, sg), sg);
+	_mm256_storeu_si256((__m256i *)x63, _mm256_slli_epi64(m, 1));
+}
+
+/* Evaluate eight candidates for sampler_next_sse2(). For lane i, lo[i]
+   and hb[i] contain the prng_next_u64() output for gaussian0(), and the
+   two next bytes (high bits for gaussian0(), and the sign bit). The
+   candidate value (z in sampler_next_sse2()) is written into zv[i].
+   For each of the num_r centres r[j], the inputs of expm_p63() for
+   ber_exp() are written into x63[8*j + i] and sh[8*j + i] (see
+   avx2_sampler_eval_x()). All operations are the same as in gaussian0(),
+   sampler_next_sse2() and ber_exp() (including the floating-point
+   rounding), so that the results are identical. */
+TARGET_AVX2
+static void
+avx2_sampler_eval(const uint64_t *lo, const uint32_t *hb,
+	const __m128d *r, int num_r, __m256d dss,
+	int32_t *zv, uint64_t *x63, uint32_t *sh)
+{
+	/* gaussian0(), with eight 32-bit lanes. */
+	__m256i m24 = _mm256_set1_epi32(0xFFFFFF);
+	__m256i pk = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+	__m256i qa = _mm256_permutevar8x32_epi32(
+		_mm256_loadu_si256((const __m256i *)lo), pk);
+	__m256i qb = _mm256_permutevar8x32_epi32(
+		_mm256_loadu_si256((const __m256i *)(lo + 4)), pk);
+	__m256i lw = _mm256_permute2x128_si256(qa, qb, 0x20);
+	__m256i hw = _mm256_permute2x128_si256(qa, qb, 0x31);
+	__m256i vh = _mm256_loadu_si256((const __m256i *)hb);
+	__m256i v0 = _mm256_and_si256(lw, m24);
+	__m256i v1 = _mm256_and_si256(_mm256_or_si256(
+		_mm256_srli_epi32(lw, 24), _mm256_slli_epi32(hw, 8)), m24);
+	__m256i v2 = _mm256_or_si256(_mm256_srli_epi32(hw, 16),
+		_mm256_slli_epi32(_mm256_and_si256(vh,
+			_mm256_set1_epi32(0xFF)), 16));
+	__m256i z0 = _mm256_setzero_si256();
+	for (size_t i = 0; i < (sizeof GAUSS0) / sizeof(GAUSS0[0]); i ++) {
+		__m256i cc;
+		cc = _mm256_srli_epi32(_mm256_sub_epi32(v0,
+			_mm256_set1_epi32((int32_t)GAUSS0[i][2])), 31);
+		cc = _mm256_srli_epi32(_mm256_sub_epi32(_mm256_sub_epi32(v1,
+			_mm256_set1_epi32((int32_t)GAUSS0[i][1])), cc), 31);
+		cc = _mm256_srli_epi32(_mm256_sub_epi32(_mm256_sub_epi32(v2,
+			_mm256_set1_epi32((int32_t)GAUSS0[i][0])), cc), 31);
+		z0 = _mm256_add_epi32(z0, cc);
+	}
+
+	/* z = b + (2*b - 1)*z0 */
+	__m256i one = _mm256_set1_epi32(1);
+	__m256i b = _mm256_and_si256(_mm256_srli_epi32(vh, 8), one);
+	__m256i nb = _mm256_sub_epi32(b, one);
+	__m256i z = _mm256_add_epi32(b,
+		_mm256_sub_epi32(_mm256_xor_si256(z0, nb), nb));
+	__m256i zsq = _mm256_mullo_epi32(z0, z0);
+	_mm256_storeu_si256((__m256i *)zv, z);
+
+	__m256i zh = _mm256_permute2x128_si256(z, z, 0x11);
+	__m256i zsqh = _mm256_permute2x128_si256(zsq, zsq, 0x11);
+	for (int j = 0; j < num_r; j ++) {
+		__m256d rj = _mm256_broadcastsd_pd(r[j]);
+		avx2_sampler_eval_x(z, zsq, rj, dss,
+			x63 + (j << 3), sh + (j << 3));
+		avx2_sampler_eval_x(zh, zsqh, rj, dss,
+			x63 + (j << 3) + 4, sh + (j << 3) + 4);
+	}
+}
+
+/* Get the value that ber_exp() compares with a uniform 64-bit integer,
+   from the outputs of avx2_sampler_eval() and mtwop63(ccs) << 1. */
+static inline uint64_t
+sampler_expm_threshold(uint64_t x63, uint32_t sh, uint64_t ccs63)
+{
+	return fpr_ursh((expm_poly(x63, ccs63) << 1) - 1, (int)sh);
+}
+
+/* Sample two values with the same standard deviation (1/isigma) and
+   centres mu[0] and mu[1] (low and high halves of mu); this returns the
+   same values, and consumes the same PRNG bytes, as two successive
+   calls to sampler_next_sse2().
+
+   Each candidate in sampler_next_sse2() uses 11 bytes: 8+1 bytes for
+   gaussian0(), one byte for the sign, and one byte for the comparison
+   in ber_exp(), which goes on with further bytes only with probability
+   2^(-8). We read up to eight such candidates from the PRNG buffer, and
+   evaluate gaussian0() and the inputs of the exponential for all of
+   them, and for both centres, with avx2_sampler_eval(). The candidates
+   are then processed in order, and only the used bytes are removed
+   from the buffer. If a comparison needs further bytes, or if the
+   buffer does not contain a complete candidate, then the next candidate
+   is processed sequentially, as in sampler_next_sse2(). The evaluation
+   does not depend on the candidate values; as in sampler_next_sse2(),
+   only the rejection decisions (and the number of consumed bytes) are
+   visible. */
+TARGET_AVX2
+static void
+avx2_sampler_next_x2(sampler_state *ss,
+	__m128d mu, __m128d isigma, int32_t *z)
+{
+	static union { fpr f[2]; __m128d x; }
+		HALF_u = { {
+			FPR(4503599627370496, -53),
+			FPR(4503599627370496, -53)
+		} },
+		INV_2SQRSIGMA0_u = { {
+			INV_2SQRSIGMA0, INV_2SQRSIGMA0
+		} };
+
+	/* Split the centres into integral and fractional parts. */
+	int32_t s[2];
+	__m128d r[2];
+	for (int k = 0; k < 2; k ++) {
+		__m128d m = k == 0 ? mu : _mm_unpackhi_pd(mu, mu);
+		s[k] = _mm_cvttsd_si32(m);
+		s[k] -= _mm_comilt_sd(m, _mm_cvtsi32_sd(_mm_setzero_pd(), s[k]));
+		r[k] = _mm_sub_sd(m, _mm_cvtsi32_sd(_mm_setzero_pd(), s[k]));
+	}
+	__m128d dss = _mm_mul_sd(_mm_mul_sd(isigma, isigma), HALF_u.x);
+	__m128d ccs = _mm_mul_sd(isigma,
+		_mm_load_sd((const double *)SIGMA_MIN + ss->logn));
+	uint64_t ccs63 = (uint64_t)mtwop63(ccs) << 1;
+
+	int k = 0;
+	while (k < 2) {
+		size_t num = prng_avail(&ss->pc) / 11;
+		if (num == 0) {
+			/* Not enough buffered bytes: next candidate is
+			   processed as in sampler_next_sse2(). */
+			int32_t z0 = gaussian0(ss);
+			int32_t b = prng_next_u8(&ss->pc) & 1;
+			int32_t zc = b + ((b << 1) - 1) * z0;
+			__m128d x = _mm_sub_sd(
+				_mm_cvtsi32_sd(_mm_setzero_pd(), zc), r[k]);
+			x = _mm_mul_sd(_mm_mul_sd(x, x), dss);
+			x = _mm_sub_sd(x, _mm_mul_sd(
+				_mm_cvtsi32_sd(_mm_setzero_pd(), z0 * z0),
+				INV_2SQRSIGMA0_u.x));
+			if (ber_exp(ss, x, ccs)) {
+				z[k] = s[k] + zc;
+				k ++;
+			}
+			continue;
+		}
+
+		/* Get and evaluate the next candidates. */
+		const uint8_t *buf = prng_buf(&ss->pc);
+		uint64_t lo[8];
+		uint32_t hb[8];
+		if (num > 8) {
+			num = 8;
+		}
+		for (size_t j = 0; j < 8; j ++) {
+			if (j < num) {
+				const uint8_t *p = buf + 11 * j;
+				lo[j] = prng_dec64(p);
+				hb[j] = (uint32_t)p[8] | ((uint32_t)p[9] << 8);
+			} else {
+				lo[j] = 0;
+				hb[j] = 0;
+			}
+		}
+		int32_t zv[8];
+		uint64_t x63[16];
+		uint32_t sh[16];
+		avx2_sampler_eval(lo, hb, r + k, 2 - k,
+			_mm256_broadcastsd_pd(dss), zv, x63, sh);
+
+		/* Process the candidates in order. */
+		int k0 = k;
+		size_t j = 0;
+		while (j < num && k < 2) {
+			size_t lane = ((size_t)(k - k0) << 3) + j;
+			uint64_t t = sampler_expm_threshold(
+				x63[lane], sh[lane], ccs63);
+			unsigned w = buf[11 * j + 10];
+			unsigned bz = (unsigned)(t >> 56);
+			int accept;
+			j ++;
+			if (w != bz) {
+				accept = w < bz;
+			} else {
+				/* The comparison goes on with the next bytes;
+				   the next candidates are then shifted. */
+				prng_skip(&ss->pc, 11 * j);
+				num = j = 0;
+				accept = 0;
+				for (int i = 48; i >= 0; i -= 8) {
+					w = prng_next_u8(&ss->pc);
+					bz = (unsigned)(t >> i) & 0xFF;
+					if (w != bz) {
+						accept = w < bz;
+						break;
+					}
+				}
+			}
+			if (accept) {
+				z[k] = s[k] + zv[lane & 7];
+				k ++;
+			}
+		}
+		prng_skip(&ss->pc, 11 * j);
+	}
+}
+#endif
+
 #elif FNDSA_NEON
 /* ========================= NEON IMPLEMENTATION ========================= */
 
@@ -948,18 +1403,45 @@ sampler_next(sampler_state *ss, fpr mu, fpr isigma)
 }
 #endif
 
-#if !FNDSA_ASM_CORTEXM4
-TARGET_SSE2 TARGET_NEON static
+#if FNDSA_SSE2
+/* Sample two values with the same standard deviation (1/isigma) and
+   centres mu[0] and mu[1] (low and high halves of mu); the values are
+   returned as floating-point numbers. If avx2 is non-zero, then
+   avx2_sampler_next_x2() is used (the caller must have checked that
+   the CPU supports AVX2); the output is the same in both cases. */
+TARGET_SSE2
+static inline __m128d
+sampler_next_x2_sse2(sampler_state *ss, __m128d mu, __m128d isigma, int avx2)
+{
+	int32_t z[2];
+#if FNDSA_AVX2_FPOLY
+	if (avx2) {
+		avx2_sampler_next_x2(ss, mu, isigma, z);
+	} else {
+		z[0] = sampler_next_sse2(ss, mu, isigma);
+		z[1] = sampler_next_sse2(ss,
+			_mm_shuffle_pd(mu, mu, 3), isigma);
+	}
+#else
+	(void)avx2;
+	z[0] = sampler_next_sse2(ss, mu, isigma);
+	z[1] = sampler_next_sse2(ss, _mm_shuffle_pd(mu, mu, 3), isigma);
 #endif
-void
-ffsamp_fft_deepest(sampler_state *ss, fpr *tmp)
+	return _mm_setr_pd((double)z[0], (double)z[1]);
+}
+
+/* SSE2 implementation of ffsamp_fft_deepest(); the pairs of samples
+   are obtained with sampler_next_x2_sse2() (with the provided avx2
+   flag). */
+TARGET_SSE2
+static inline void
+ffsamp_fft_deepest_sse2(sampler_state *ss, fpr *tmp, int avx2)
 {
 	fpr *t0 = tmp;
 	fpr *t1 = tmp + 2;
 	fpr *g01 = tmp + 4;
 	fpr *g00 = tmp + 6;
 	fpr *g11 = tmp + 7;
-#if FNDSA_SSE2
 	static const union {
 		fpr f[2];
 		__m128d x;
@@ -989,25 +1471,19 @@ ffsamp_fft_deepest(sampler_state *ss, fpr *tmp)
 	     - right sub-tree:  d11_re, zero, d11_re
 	   t1 split is trivial. */
 	__m128d w = _mm_loadu_pd((double *)t1);
-	__m128d w0 = w;
-	__m128d w1 = _mm_shuffle_pd(w, w, 3);
 	__m128d leaf = _mm_mul_sd(
 		_mm_sqrt_sd(_mm_setzero_pd(), d11_re),
 		_mm_load_sd((const double *)INV_SIGMA + ss->logn));
-	__m128d y0 = _mm_cvtsi32_sd(_mm_setzero_pd(),
-		sampler_next_sse2(ss, w0, leaf));
-	__m128d y1 = _mm_cvtsi32_sd(_mm_setzero_pd(),
-		sampler_next_sse2(ss, w1, leaf));
+	__m128d y = sampler_next_x2_sse2(ss, w, leaf, avx2);
 
 	/* Merge is trivial, since logn = 1. */
 
 	/* At this point:
 	     t0 and t1 are unmodified; t1 is also [w0, w1]
 	     l10 is in [l10_re, l10_im]
-	     z1 is [y0, y1]
+	     z1 is [y0, y1] (in y)
 	   Compute tb0 = t0 + (t1 - z1)*l10  (into [x0, x1]).
 	   z1 is moved into t1. */
-	__m128d y = _mm_shuffle_pd(y0, y1, 0);
 	__m128d a = _mm_sub_pd(w, y);
 	__m128d b1 = _mm_mul_pd(a, _mm_xor_pd(cz, l01));
 	__m128d b2 = _mm_mul_pd(a, _mm_shuffle_pd(l01, l01, 1));
@@ -1020,18 +1496,28 @@ ffsamp_fft_deepest(sampler_state *ss, fpr *tmp)
 	/* Second recursive invocation, on the split tb0, using
 	   the left sub-tree. tb0 is [x0, x1], and the split is
 	   trivial since logn = 1. */
-	__m128d x0 = x;
-	__m128d x1 = _mm_shuffle_pd(x, x, 3);
 	leaf = _mm_mul_sd(
 		_mm_sqrt_sd(_mm_setzero_pd(), d00_re),
 		_mm_load_sd((const double *)INV_SIGMA + ss->logn));
-	x0 = _mm_cvtsi32_sd(_mm_setzero_pd(),
-		sampler_next_sse2(ss, x0, leaf));
-	x1 = _mm_cvtsi32_sd(_mm_setzero_pd(),
-		sampler_next_sse2(ss, x1, leaf));
-	_mm_store_sd((double *)t0, x0);
-	_mm_store_sd((double *)t0 + 1, x1);
-#elif FNDSA_NEON
+	_mm_storeu_pd((double *)t0, sampler_next_x2_sse2(ss, x, leaf, avx2));
+}
+#endif
+
+#if !FNDSA_ASM_CORTEXM4
+TARGET_SSE2 TARGET_NEON static
+#endif
+void
+ffsamp_fft_deepest(sampler_state *ss, fpr *tmp)
+{
+#if FNDSA_SSE2
+	ffsamp_fft_deepest_sse2(ss, tmp, 0);
+#else
+	fpr *t0 = tmp;
+	fpr *t1 = tmp + 2;
+	fpr *g01 = tmp + 4;
+	fpr *g00 = tmp + 6;
+	fpr *g11 = tmp + 7;
+#if FNDSA_NEON
 	static const fpr_u one_u = { FPR_ONE };
 	static const union { fpr f[2]; float64x2_t x; }
 		cz = { { FPR_ZERO, FPR_NZERO } };
@@ -1212,6 +1698,7 @@ ffsamp_fft_deepest(sampler_state *ss, fpr *tmp)
 	leaf = fpr_mul(fpr_sqrt(d00_re), INV_SIGMA[ss->logn].f);
 	t0[0] = fpr_of32(sampler_next(ss, x0, leaf));
 	t0[1] = fpr_of32(sampler_next(ss, x1, leaf));
+#endif
 #endif
 	return;
 }
@@ -1335,3 +1822,105 @@ ffsamp_fft(sampler_state *ss, fpr *tmp)
 {
 	ffsamp_fft_inner(ss, ss->logn, tmp);
 }
+
+#if FNDSA_AVX2_FPOLY
+/* Same as ffsamp_fft_inner(), with the AVX2 polynomial functions (for
+   small degrees, these use the plain functions) and, at the deepest
+   level, the AVX2 sampler. See ffsamp_fft_inner() for the layout. */
+TARGET_AVX2
+static void
+avx2_ffsamp_fft_inner(sampler_state *ss, unsigned logn, fpr *tmp)
+{
+	if (logn == 1) {
+		ffsamp_fft_deepest_sse2(ss, tmp, 1);
+		return;
+	}
+
+#define qc(off)   (tmp + ((off) << (logn - 2)))
+
+	/* Decompose G into LDL, and split d11 into the right sub-tree. */
+	avx2_fpoly_LDL_fft(logn, qc(12), qc(8), qc(14));
+	avx2_fpoly_split_selfadj_fft(logn, qc(20), qc(18), qc(14));
+	memcpy(qc(21), qc(20), sizeof(fpr) << (logn - 2));
+
+	/* First recursive call, on the split t1; z1 goes to 18..21. */
+	avx2_fpoly_split_fft(logn, qc(14), qc(16), qc(4));
+	avx2_ffsamp_fft_inner(ss, logn - 1, qc(14));
+	avx2_fpoly_merge_fft(logn, qc(18), qc(14), qc(16));
+
+	/* tb0 = t0 + (t1 - z1)*l10 (into t0), and z1 is moved into t1. */
+	memcpy(qc(14), qc(4), sizeof(fpr) << logn);
+	avx2_fpoly_sub(logn, qc(14), qc(18));
+	memcpy(qc(4), qc(18), sizeof(fpr) << logn);
+	avx2_fpoly_mul_fft(logn, qc(14), qc(8));
+	avx2_fpoly_add(logn, qc(0), qc(14));
+
+	/* Split d00 into the left sub-tree, and perform the second
+	   recursive call on the split tb0; z0 is written into t0. */
+	avx2_fpoly_split_selfadj_fft(logn, qc(20), qc(18), qc(12));
+	memcpy(qc(21), qc(20), sizeof(fpr) << (logn - 2));
+	avx2_fpoly_split_fft(logn, qc(14), qc(16), qc(0));
+	avx2_ffsamp_fft_inner(ss, logn - 1, qc(14));
+	avx2_fpoly_merge_fft(logn, qc(0), qc(14), qc(16));
+
+#undef qc
+}
+
+/* see sign_inner.h */
+void
+avx2_ffsamp_fft(sampler_state *ss, fpr *tmp)
+{
+	avx2_ffsamp_fft_inner(ss, ss->logn, tmp);
+}
+#endif
+
+#if FNDSA_AVX512_FPOLY
+/* Same as ffsamp_fft_inner(), with the AVX-512 polynomial functions;
+   for small degrees, the AVX2 variant is used. See ffsamp_fft_inner()
+   for the layout. */
+TARGET_AVX512
+static void
+avx512_ffsamp_fft_inner(sampler_state *ss, unsigned logn, fpr *tmp)
+{
+	if (logn <= 4) {
+		avx2_ffsamp_fft_inner(ss, logn, tmp);
+		return;
+	}
+
+#define qc(off)   (tmp + ((off) << (logn - 2)))
+
+	/* Decompose G into LDL, and split d11 into the right sub-tree. */
+	avx512_fpoly_LDL_fft(logn, qc(12), qc(8), qc(14));
+	avx512_fpoly_split_selfadj_fft(logn, qc(20), qc(18), qc(14));
+	memcpy(qc(21), qc(20), sizeof(fpr) << (logn - 2));
+
+	/* First recursive call, on the split t1; z1 goes to 18..21. */
+	avx512_fpoly_split_fft(logn, qc(14), qc(16), qc(4));
+	avx512_ffsamp_fft_inner(ss, logn - 1, qc(14));
+	avx512_fpoly_merge_fft(logn, qc(18), qc(14), qc(16));
+
+	/* tb0 = t0 + (t1 - z1)*l10 (into t0), and z1 is moved into t1. */
+	memcpy(qc(14), qc(4), sizeof(fpr) << logn);
+	avx512_fpoly_sub(logn, qc(14), qc(18));
+	memcpy(qc(4), qc(18), sizeof(fpr) << logn);
+	avx512_fpoly_mul_fft(logn, qc(14), qc(8));
+	avx512_fpoly_add(logn, qc(0), qc(14));
+
+	/* Split d00 into the left sub-tree, and perform the second
+	   recursive call on the split tb0; z0 is written into t0. */
+	avx512_fpoly_split_selfadj_fft(logn, qc(20), qc(18), qc(12));
+	memcpy(qc(21), qc(20), sizeof(fpr) << (logn - 2));
+	avx512_fpoly_split_fft(logn, qc(14), qc(16), qc(0));
+	avx512_ffsamp_fft_inner(ss, logn - 1, qc(14));
+	avx512_fpoly_merge_fft(logn, qc(0), qc(14), qc(16));
+
+#undef qc
+}
+
+/* see sign_inner.h */
+void
+avx512_ffsamp_fft(sampler_state *ss, fpr *tmp)
+{
+	avx512_ffsamp_fft_inner(ss, ss->logn, tmp);
+}
+#endif
@@ -76,6 +76,51 @@
  *    perf stat -o /dev/null ./speed_fndsa
  * The perf tool must be kept in sync with the exact kernel version, and
  * if you use a custom kernel then you might have to recompile it.
+ *
+ * SIMD tiers:
+ * ===========
+ * When invoked as 'speed_fndsa tiers', key pair generation and
+ * signature generation are measured, once for each SIMD tier supported
+ * by the current CPU: the base tier selected at compile-time (SSE2, NEON
+ * or plain scalar code), then AVX2 and AVX-512 (x86 only). Key pair
+ * generation uses fixed seeds, so that all tiers compute the same keys.
+ * The plain scalar code is used on x86 only when compiling with
+ * '-DFNDSA_SSE2=0 -DFNDSA_AVX2=0'.
+ *
+ * Computations modulo q:
+ * ======================
+ * When invoked as 'speed_fndsa mq', the functions used in signature
+ * verification (NTT, inverse NTT, multiplication, division, subtraction
+ * and squared norms) are measured individually for n = 512 and 1024,
+ * with each implementation supported by the current CPU (base, AVX2,
+ * AVX-512BW).
+ *
+ * Batch signing:
+ * ==============
+ * When invoked as 'speed_fndsa batch', the cost per signature (in
+ * cycles) of fndsa_sign_batch() is measured for several batch sizes.
+ *
+ * Key pair generation:
+ * =====================
+ * When invoked as 'speed_fndsa kgstats', key pair generation statistics
+ * are printed for n = 512 and 1024: the average number of candidate (f,g)
+ * pairs sampled per key pair, the fraction of candidates rejected by each
+ * test (norm, invertibility modulo q, orthogonalized norm, NTRU solving),
+ * and the cost (in cycles) of sampling one polynomial, for each supported
+ * implementation. The size of the twiddle cache (NTT tables kept across
+ * key pair generations, see FNDSA_KEYGEN_CACHE) is also printed, along
+ * with the key pair generation cost with and without the cache.
+ *
+ * When invoked as 'speed_fndsa keygen [N]', the wall-clock time of
+ * multi-threaded key pair generation is measured with 1 to N threads
+ * (default N is the number of online CPUs).
+ *
+ * Signing engine:
+ * ===============
+ * When invoked as 'speed_fndsa threads [N]', the throughput (signatures
+ * per second, measured with the wall clock) of the multi-threaded signing
+ * engine is measured with 1 to N worker threads (default N is the number
+ * of online CPUs).
  */
 
 #include <stdio.h>
@@ -83,6 +128,13 @@
 #include <string.h>
 
 #include "fndsa.h"
+#include "kgen_inner.h"
+
+#if FNDSA_SIGN_ENGINE
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#endif
 
 #if defined __x86_64__ || defined _M_X64 || defined __i386__ || defined _M_IX86
 #include <immintrin.h>
@@ -196,8 +248,73 @@ bench_sign(unsigned logn, unsigned *x)
 	return (double)tt[50];
 }
 
+/* Expanded keys are kept in a static buffer to avoid a large stack
+   frame at n = 1024. */
+static uint8_t esk_buf[FNDSA_SIGN_KEY_EXPANDED_SIZE(10)];
+
 static double
-bench_verify(unsigned logn, unsigned *x)
+bench_sign_key_expand(unsigned logn, unsigned *x)
+{
+	uint64_t z = core_cycles();
+	uint8_t seed[8];
+	for (int i = 0; i < 8; i ++) {
+		seed[i] = (uint8_t)(z >> (i << 3));
+	}
+	uint8_t sk[FNDSA_SIGN_KEY_SIZE(10)];
+	uint8_t vk[FNDSA_VRFY_KEY_SIZE(10)];
+	fndsa_keygen_seeded(logn, seed, sizeof seed, sk, vk);
+	uint64_t tt[100];
+	for (int i = 0; i < 120; i ++) {
+		uint64_t begin = core_cycles();
+		fndsa_sign_key_expand(sk, FNDSA_SIGN_KEY_SIZE(logn),
+			esk_buf, sizeof esk_buf);
+		seed[1] ^= esk_buf[i];
+		uint64_t end = core_cycles();
+		if (i >= 20) {
+			tt[i - 20] = end - begin;
+		}
+	}
+	qsort(tt, 100, sizeof(uint64_t), &cmp_u64);
+	*x ^= seed[1];
+	return (double)tt[50];
+}
+
+static double
+bench_sign_expanded(unsigned logn, unsigned *x)
+{
+	uint64_t z = core_cycles();
+	uint8_t seed[8];
+	for (int i = 0; i < 8; i ++) {
+		seed[i] = (uint8_t)(z >> (i << 3));
+	}
+	uint8_t sk[FNDSA_SIGN_KEY_SIZE(10)];
+	uint8_t vk[FNDSA_VRFY_KEY_SIZE(10)];
+	fndsa_keygen_seeded(logn, seed, sizeof seed, sk, vk);
+	fndsa_sign_key_expand(sk, FNDSA_SIGN_KEY_SIZE(logn),
+		esk_buf, sizeof esk_buf);
+	seed[0] ^= 0x01;
+	uint64_t tt[100];
+	uint8_t sig[FNDSA_SIGNATURE_SIZE(10)];
+	for (int i = 0; i < 120; i ++) {
+		uint64_t begin = core_cycles();
+		fndsa_sign_expanded_seeded(esk_buf, sizeof esk_buf,
+			NULL, 0, FNDSA_HASH_ID_RAW, "test", 4,
+			seed, sizeof seed, sig, FNDSA_SIGNATURE_SIZE(logn));
+		seed[1] ^= sig[1];
+		uint64_t end = core_cycles();
+		if (i >= 20) {
+			tt[i - 20] = end - begin;
+		}
+	}
+	qsort(tt, 100, sizeof(uint64_t), &cmp_u64);
+	*x ^= seed[0] ^ seed[1];
+	return (double)tt[50];
+}
+
+/* If prepared is non-zero, then the verifying key is prepared once, and
+   verification uses fndsa_verify_prepared(). */
+static double
+bench_verify(unsigned logn, int prepared, unsigned *x)
 {
 	uint64_t z = core_cycles();
 	uint8_t seed[8];
@@ -216,12 +333,24 @@ bench_verify(unsigned logn, unsigned *x)
 			seed, sizeof seed, sig[i], FNDSA_SIGNATURE_SIZE(logn));
 		seed[2] ++;
 	}
+	uint8_t pvk[FNDSA_VRFY_KEY_PREPARED_SIZE(10)];
+	if (prepared) {
+		fndsa_verify_key_prepare(vk, FNDSA_VRFY_KEY_SIZE(logn),
+			pvk, sizeof pvk);
+	}
 	uint8_t msg[4] = "test";
 	for (int i = 0; i < 120; i ++) {
 		uint64_t begin = core_cycles();
-		int r = fndsa_verify(sig[i], FNDSA_SIGNATURE_SIZE(logn),
-			vk, FNDSA_VRFY_KEY_SIZE(logn),
-			NULL, 0, FNDSA_HASH_ID_RAW, msg, 4);
+		int r;
+		if (prepared) {
+			r = fndsa_verify_prepared(sig[i],
+				FNDSA_SIGNATURE_SIZE(logn), pvk, sizeof pvk,
+				NULL, 0, FNDSA_HASH_ID_RAW, msg, 4);
+		} else {
+			r = fndsa_verify(sig[i], FNDSA_SIGNATURE_SIZE(logn),
+				vk, FNDSA_VRFY_KEY_SIZE(logn),
+				NULL, 0, FNDSA_HASH_ID_RAW, msg, 4);
+		}
 		msg[0] ^= r;
 		uint64_t end = core_cycles();
 		if (i >= 20) {
@@ -233,17 +362,645 @@ bench_verify(unsigned logn, unsigned *x)
 	return (double)tt[50];
 }
 
+/* Batch verification: 64 signatures with the same key; returned value
+   is the cost per signature. */
+#define VRFY_BATCH   64
+static uint8_t vrfy_batch_sigs[VRFY_BATCH][FNDSA_SIGNATURE_SIZE(10)];
+
+static double
+bench_verify_batch(unsigned logn, unsigned *x)
+{
+	uint64_t z = core_cycles();
+	uint8_t seed[8];
+	for (int i = 0; i < 8; i ++) {
+		seed[i] = (uint8_t)(z >> (i << 3));
+	}
+	uint8_t sk[FNDSA_SIGN_KEY_SIZE(10)];
+	uint8_t vk[FNDSA_VRFY_KEY_SIZE(10)];
+	fndsa_keygen_seeded(logn, seed, sizeof seed, sk, vk);
+	seed[0] ^= 0x01;
+	fndsa_verify_msg vm[VRFY_BATCH];
+	for (int i = 0; i < VRFY_BATCH; i ++) {
+		fndsa_sign_seeded(sk, FNDSA_SIGN_KEY_SIZE(logn),
+			NULL, 0, FNDSA_HASH_ID_RAW, "test", 4,
+			seed, sizeof seed, vrfy_batch_sigs[i],
+			FNDSA_SIGNATURE_SIZE(logn));
+		seed[2] ++;
+		vm[i].sig = vrfy_batch_sigs[i];
+		vm[i].sig_len = FNDSA_SIGNATURE_SIZE(logn);
+		vm[i].vrfy_key = vk;
+		vm[i].vrfy_key_len = FNDSA_VRFY_KEY_SIZE(logn);
+		vm[i].ctx = NULL;
+		vm[i].ctx_len = 0;
+		vm[i].id = FNDSA_HASH_ID_RAW;
+		vm[i].hv = "test";
+		vm[i].hv_len = 4;
+	}
+	uint64_t tt[20];
+	uint8_t res[VRFY_BATCH / 8];
+	for (int i = 0; i < 25; i ++) {
+		uint64_t begin = core_cycles();
+		size_t r = fndsa_verify_batch(vm, VRFY_BATCH, res);
+		seed[3] ^= (uint8_t)r ^ res[i & 7];
+		uint64_t end = core_cycles();
+		if (i >= 5) {
+			tt[i - 5] = end - begin;
+		}
+	}
+	qsort(tt, 20, sizeof(uint64_t), &cmp_u64);
+	*x ^= seed[3];
+	return (double)tt[10] / VRFY_BATCH;
+}
+
+/* Messages and output buffer for batch signing. */
+#define BATCH_MAX   256
+static fndsa_sign_msg batch_msgs[BATCH_MAX];
+static uint8_t batch_hv[BATCH_MAX][8];
+static uint8_t batch_sigs[BATCH_MAX * FNDSA_SIGNATURE_SIZE(10)];
+
+static double
+bench_sign_batch(unsigned logn, size_t num, unsigned *x)
+{
+	uint64_t z = core_cycles();
+	uint8_t seed[8];
+	for (int i = 0; i < 8; i ++) {
+		seed[i] = (uint8_t)(z >> (i << 3));
+	}
+	uint8_t sk[FNDSA_SIGN_KEY_SIZE(10)];
+	uint8_t vk[FNDSA_VRFY_KEY_SIZE(10)];
+	fndsa_keygen_seeded(logn, seed, sizeof seed, sk, vk);
+	for (size_t i = 0; i < num; i ++) {
+		memcpy(batch_hv[i], seed, 8);
+		batch_hv[i][0] ^= (uint8_t)i;
+		batch_msgs[i].ctx = NULL;
+		batch_msgs[i].ctx_len = 0;
+		batch_msgs[i].id = FNDSA_HASH_ID_RAW;
+		batch_msgs[i].hv = batch_hv[i];
+		batch_msgs[i].hv_len = 8;
+	}
+	uint64_t tt[20];
+	for (int i = 0; i < 22; i ++) {
+		uint64_t begin = core_cycles();
+		fndsa_sign_batch(sk, FNDSA_SIGN_KEY_SIZE(logn),
+			batch_msgs, num, batch_sigs, sizeof batch_sigs);
+		seed[1] ^= batch_sigs[1];
+		uint64_t end = core_cycles();
+		if (i >= 2) {
+			tt[i - 2] = end - begin;
+		}
+	}
+	qsort(tt, 20, sizeof(uint64_t), &cmp_u64);
+	*x ^= seed[1];
+	return (double)tt[10] / (double)num;
+}
+
+static void
+bench_sign_batches(unsigned *x)
+{
+	for (unsigned logn = 9; logn <= 10; logn ++) {
+		for (size_t num = 1; num <= BATCH_MAX; num <<= 2) {
+			printf("FN-DSA sign batch (n = %4u, %3zu msgs) %13.2f\n",
+				1u << logn, num, bench_sign_batch(logn, num, x));
+		}
+	}
+}
+
+/* Returned value is the median cost (in cycles) of sampling one
+   polynomial with sample_f() (or its AVX2 version). */
+static double
+bench_sample_f(unsigned logn, int avx2, unsigned *x)
+{
+	int8_t f[1024];
+	uint8_t seed = (uint8_t)logn;
+#if FNDSA_SHAKE256X4
+	shake256x4_context pc;
+	shake256x4_init(&pc, &seed, 1);
+#else
+	shake_context pc;
+	shake_init(&pc, 256);
+	shake_inject(&pc, &seed, 1);
+	shake_flip(&pc);
+#endif
+	uint64_t tt[100];
+	for (int i = 0; i < 120; i ++) {
+		uint64_t begin = core_cycles();
+#if FNDSA_AVX2
+		if (avx2) {
+			avx2_sample_f(logn, &pc, f);
+		} else {
+			sample_f(logn, &pc, f);
+		}
+#else
+		(void)avx2;
+		sample_f(logn, &pc, f);
+#endif
+		uint64_t end = core_cycles();
+		if (i >= 20) {
+			tt[i - 20] = end - begin;
+		}
+		*x ^= (unsigned)f[0];
+	}
+	qsort(tt, 100, sizeof(uint64_t), &cmp_u64);
+	return (double)tt[50];
+}
+
+#define KGSTATS_KEYS   100
+
+/* Returned value is the average cost (in cycles) of a key pair
+   generation, over a fixed sequence of seeds (so that two calls can be
+   compared despite the variable number of candidates per key pair). */
+static double
+bench_keygen_fixed(unsigned logn, unsigned num, unsigned *x)
+{
+	uint8_t sk[FNDSA_SIGN_KEY_SIZE(10)];
+	uint8_t vk[FNDSA_VRFY_KEY_SIZE(10)];
+	uint8_t seed[4] = { (uint8_t)logn, 'F', 0, 0 };
+	fndsa_keygen_seeded(logn, seed, sizeof seed, sk, vk);
+	uint64_t total = 0;
+	for (unsigned i = 0; i < num; i ++) {
+		seed[2] = (uint8_t)i;
+		seed[3] = (uint8_t)(i >> 8);
+		uint64_t begin = core_cycles();
+		fndsa_keygen_seeded(logn, seed, sizeof seed, sk, vk);
+		uint64_t end = core_cycles();
+		total += end - begin;
+		*x ^= sk[1];
+	}
+	return (double)total / (double)num;
+}
+
+static void
+bench_keygen_stats(unsigned *x)
+{
+	uint8_t sk[FNDSA_SIGN_KEY_SIZE(10)];
+	uint8_t vk[FNDSA_VRFY_KEY_SIZE(10)];
+	for (unsigned logn = 9; logn <= 10; logn ++) {
+		keygen_stats st;
+		memset(&st, 0, sizeof st);
+		uint8_t seed[4] = { (uint8_t)logn, 0, 0, 0 };
+		for (unsigned i = 0; i < KGSTATS_KEYS; i ++) {
+			seed[1] = (uint8_t)i;
+			seed[2] = (uint8_t)(i >> 8);
+			keygen_seeded_stats(logn, seed, sizeof seed, sk, vk, &st);
+			*x ^= sk[1];
+		}
+		double c = (double)st.candidates;
+		printf("keygen (n = %4u): %.2f candidates per key pair\n",
+			1u << logn, c / (double)KGSTATS_KEYS);
+		printf("  rejected by norm:          %6.2f%%\n",
+			100.0 * (double)st.rej_norm / c);
+		printf("  rejected by invertibility: %6.2f%%\n",
+			100.0 * (double)st.rej_invert / c);
+		printf("  rejected by ortho. norm:   %6.2f%%\n",
+			100.0 * (double)st.rej_ortho / c);
+		printf("  rejected by NTRU solving:  %6.2f%%\n",
+			100.0 * (double)st.rej_solve / c);
+		printf("  sample_f (base)          %13.2f\n",
+			bench_sample_f(logn, 0, x));
+#if FNDSA_AVX2
+		if (has_avx2()) {
+			printf("  sample_f (AVX2)          %13.2f\n",
+				bench_sample_f(logn, 1, x));
+		}
+#endif
+	}
+
+	/* Cost of recomputing the NTT tables on each key pair generation,
+	   measured by disabling the twiddle cache. */
+	size_t cache_len = mp_twiddle_cache_size();
+	if (cache_len == 0) {
+		printf("twiddle cache: disabled\n");
+		return;
+	}
+	printf("twiddle cache: %zu bytes\n", cache_len);
+	for (unsigned logn = 9; logn <= 10; logn ++) {
+		double c1 = bench_keygen_fixed(logn, KGSTATS_KEYS, x);
+		mp_twiddle_cache_enable(0);
+		double c0 = bench_keygen_fixed(logn, KGSTATS_KEYS, x);
+		mp_twiddle_cache_enable(1);
+		printf("  keygen (n = %4u, cached)   %13.2f\n", 1u << logn, c1);
+		printf("  keygen (n = %4u, uncached) %13.2f\n", 1u << logn, c0);
+		printf("  saved: %.2f cycles (%.2f%%)\n",
+			c0 - c1, 100.0 * (c0 - c1) / c0);
+	}
+}
+
+#if FNDSA_SIGN_ENGINE
+#define ENGINE_JOBS   1024
+static fndsa_sign_job engine_jobs[ENGINE_JOBS];
+static uint8_t engine_sigs[ENGINE_JOBS][FNDSA_SIGNATURE_SIZE(10)];
+
+static double
+wall_clock(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000.0;
+}
+
+/* Returned value is the number of signatures per second. */
+static double
+bench_sign_engine(unsigned logn, unsigned num_threads, unsigned *x)
+{
+	size_t mem_len = fndsa_sign_engine_size(logn, num_threads, 256);
+	void *mem = malloc(mem_len);
+	if (mem == NULL) {
+		return 0.0;
+	}
+	fndsa_sign_engine *e = fndsa_sign_engine_start(logn,
+		num_threads, 256, mem, mem_len);
+	if (e == NULL) {
+		free(mem);
+		return 0.0;
+	}
+	uint8_t seed[8];
+	uint64_t z = core_cycles();
+	for (int i = 0; i < 8; i ++) {
+		seed[i] = (uint8_t)(z >> (i << 3));
+	}
+	uint8_t sk[FNDSA_SIGN_KEY_SIZE(10)];
+	uint8_t vk[FNDSA_VRFY_KEY_SIZE(10)];
+	fndsa_keygen_seeded(logn, seed, sizeof seed, sk, vk);
+
+	/* 32 signatures per thread, after a warmup round of the same
+	   size. */
+	size_t num = (size_t)32 * num_threads;
+	if (num > ENGINE_JOBS) {
+		num = ENGINE_JOBS;
+	}
+	double begin = 0.0;
+	for (int r = 0; r < 2; r ++) {
+		if (r == 1) {
+			begin = wall_clock();
+		}
+		for (size_t i = 0; i < num; i ++) {
+			fndsa_sign_job *job = &engine_jobs[i];
+			job->sign_key = sk;
+			job->sign_key_len = FNDSA_SIGN_KEY_SIZE(logn);
+			job->ctx = NULL;
+			job->ctx_len = 0;
+			job->id = FNDSA_HASH_ID_RAW;
+			job->hv = seed;
+			job->hv_len = sizeof seed;
+			job->sig = engine_sigs[i];
+			job->max_sig_len = FNDSA_SIGNATURE_SIZE(logn);
+			job->callback = NULL;
+			while (!fndsa_sign_engine_submit(e, job)) {
+				sched_yield();
+			}
+		}
+		for (size_t i = 0; i < num; i ++) {
+			while (!fndsa_sign_job_done(&engine_jobs[i])) {
+				sched_yield();
+			}
+			*x ^= engine_sigs[i][1];
+		}
+	}
+	double end = wall_clock();
+	fndsa_sign_engine_stop(e);
+	free(mem);
+	return (double)num / (end - begin);
+}
+
+static void
+bench_sign_engine_scaling(unsigned max_threads, unsigned *x)
+{
+	for (unsigned logn = 9; logn <= 10; logn ++) {
+		for (unsigned t = 1; t <= max_threads; t ++) {
+			printf("FN-DSA engine (n = %4u, %3u threads) %10.1f sig/s\n",
+				1u << logn, t, bench_sign_engine(logn, t, x));
+		}
+	}
+}
+
+/* Returned value is the median wall-clock time of a key pair generation,
+   in milliseconds. */
+static double
+bench_keygen_mt(unsigned logn, unsigned num_threads, unsigned *x)
+{
+	uint64_t z = core_cycles();
+	uint8_t seed[8];
+	for (int i = 0; i < 8; i ++) {
+		seed[i] = (uint8_t)(z >> (i << 3));
+	}
+	uint8_t sk[FNDSA_SIGN_KEY_SIZE(10)];
+	uint8_t vk[FNDSA_VRFY_KEY_SIZE(10)];
+	uint64_t tt[20];
+	for (int i = 0; i < 25; i ++) {
+		double begin = wall_clock();
+		fndsa_keygen_seeded_mt(logn, num_threads,
+			seed, sizeof seed, sk, vk);
+		seed[0] ^= sk[FNDSA_SIGN_KEY_SIZE(logn) - 1];
+		seed[1] ^= vk[FNDSA_SIGN_KEY_SIZE(logn) - 1];
+		double end = wall_clock();
+		if (i >= 5) {
+			tt[i - 5] = (uint64_t)((end - begin) * 1000000000.0);
+		}
+	}
+	qsort(tt, 20, sizeof(uint64_t), &cmp_u64);
+	*x ^= seed[0] ^ seed[1];
+	return (double)tt[10] / 1000000.0;
+}
+
+/* Returned value is the median cost (in cycles) of taking a key pair
+   from a filled key pair pool. */
+static double
+bench_keypool_take(unsigned logn, unsigned *x)
+{
+	size_t mem_len = fndsa_keypool_size(logn, 16, 1);
+	void *mem = malloc(mem_len);
+	if (mem == NULL) {
+		return 0.0;
+	}
+	fndsa_keypool *kp = fndsa_keypool_create(logn, 16, 1, mem, mem_len);
+	if (kp == NULL) {
+		free(mem);
+		return 0.0;
+	}
+	uint8_t sk[FNDSA_SIGN_KEY_SIZE(10)];
+	uint8_t vk[FNDSA_VRFY_KEY_SIZE(10)];
+	uint64_t tt[15];
+	while (fndsa_keypool_available(kp) < 16) {
+		sched_yield();
+	}
+	for (int i = 0; i < 16; i ++) {
+		uint64_t begin = core_cycles();
+		fndsa_keypool_take(kp, sk, vk, 1);
+		uint64_t end = core_cycles();
+		if (i >= 1) {
+			tt[i - 1] = end - begin;
+		}
+		*x ^= sk[1];
+	}
+	fndsa_keypool_destroy(kp);
+	free(mem);
+	qsort(tt, 15, sizeof(uint64_t), &cmp_u64);
+	return (double)tt[7];
+}
+
+static void
+bench_keygen_scaling(unsigned max_threads, unsigned *x)
+{
+	for (unsigned logn = 9; logn <= 10; logn ++) {
+		for (unsigned t = 1; t <= max_threads; t ++) {
+			printf("FN-DSA keygen (n = %4u, %3u threads) %10.2f ms\n",
+				1u << logn, t, bench_keygen_mt(logn, t, x));
+		}
+	}
+	for (unsigned logn = 9; logn <= 10; logn ++) {
+		printf("FN-DSA key pool take (n = %4u)  %13.2f\n",
+			1u << logn, bench_keypool_take(logn, x));
+	}
+}
+#endif
+
+static const char *
+simd_tier_name(unsigned tier)
+{
+	switch (tier) {
+	case SIMD_TIER_AVX2:
+		return "AVX2";
+	case SIMD_TIER_AVX512:
+		return "AVX-512";
+	default:
+#if FNDSA_SSE2
+		return "SSE2";
+#elif FNDSA_NEON
+		return "NEON";
+#else
+		return "scalar";
+#endif
+	}
+}
+
+/* Number of key pairs per degree and tier for 'speed_fndsa tiers'. */
+#define TIERS_KEYS   20
+
+static void
+bench_tiers(unsigned *x)
+{
+	unsigned max_tier = SIMD_TIER_BASE;
+#if FNDSA_AVX2
+	if (has_avx2()) {
+		max_tier = SIMD_TIER_AVX2;
+	}
+#endif
+#if FNDSA_AVX512
+	if (has_avx512()) {
+		max_tier = SIMD_TIER_AVX512;
+	}
+#endif
+	for (unsigned tier = SIMD_TIER_BASE; tier <= max_tier; tier ++) {
+#if FNDSA_AVX2
+		set_simd_tier_max(tier);
+#endif
+		const char *name = simd_tier_name(tier);
+		printf("FN-DSA keygen (n = 512, %-7s)     %13.2f\n",
+			name, bench_keygen_fixed(9, TIERS_KEYS, x));
+		printf("FN-DSA keygen (n = 1024, %-7s)    %13.2f\n",
+			name, bench_keygen_fixed(10, TIERS_KEYS, x));
+		printf("FN-DSA sign (n = 512, %-7s)       %13.2f\n",
+			name, bench_sign(9, x));
+		printf("FN-DSA sign (n = 1024, %-7s)      %13.2f\n",
+			name, bench_sign(10, x));
+		printf("FN-DSA sign exp. (n = 512, %-7s)  %13.2f\n",
+			name, bench_sign_expanded(9, x));
+		printf("FN-DSA sign exp. (n = 1024, %-7s) %13.2f\n",
+			name, bench_sign_expanded(10, x));
+	}
+#if FNDSA_AVX2
+	set_simd_tier_max(SIMD_TIER_AVX512);
+#endif
+}
+
+/* Computations modulo q (as used in signature verification), each
+   benchmarked on its own for a given implementation tier. */
+#define MQ_OPS   7
+static const char *const mq_op_names[MQ_OPS] = {
+	"int_to_ntt", "ntt_to_int", "mul_ntt", "div_ntt", "sub",
+	"sqnorm_signed", "sqnorm_ext"
+};
+
+static uint32_t
+mq_op(unsigned tier, int op, unsigned logn, uint16_t *a, const uint16_t *b)
+{
+#if FNDSA_AVX512
+	if (tier >= SIMD_TIER_AVX512) {
+		switch (op) {
+		case 0: avx512_mqpoly_int_to_ntt(logn, a); return a[0];
+		case 1: avx512_mqpoly_ntt_to_int(logn, a); return a[0];
+		case 2: avx512_mqpoly_mul_ntt(logn, a, b); return a[0];
+		case 3: return avx512_mqpoly_div_ntt(logn, a, b);
+		case 4: avx512_mqpoly_sub(logn, a, b); return a[0];
+		case 5: return avx512_mqpoly_sqnorm_signed(logn, b);
+		default: return avx512_mqpoly_sqnorm_ext(logn, b);
+		}
+	}
+#endif
+#if FNDSA_AVX2
+	if (tier >= SIMD_TIER_AVX2) {
+		switch (op) {
+		case 0: avx2_mqpoly_int_to_ntt(logn, a); return a[0];
+		case 1: avx2_mqpoly_ntt_to_int(logn, a); return a[0];
+		case 2: avx2_mqpoly_mul_ntt(logn, a, b); return a[0];
+		case 3: return avx2_mqpoly_div_ntt(logn, a, b);
+		case 4: avx2_mqpoly_sub(logn, a, b); return a[0];
+		case 5: return avx2_mqpoly_sqnorm_signed(logn, b);
+		default: return avx2_mqpoly_sqnorm_ext(logn, b);
+		}
+	}
+#endif
+	(void)tier;
+	switch (op) {
+	case 0: mqpoly_int_to_ntt(logn, a); return a[0];
+	case 1: mqpoly_ntt_to_int(logn, a); return a[0];
+	case 2: mqpoly_mul_ntt(logn, a, b); return a[0];
+	case 3: return mqpoly_div_ntt(logn, a, b);
+	case 4: mqpoly_sub(logn, a, b); return a[0];
+	case 5: return mqpoly_sqnorm_signed(logn, b);
+	default: return mqpoly_sqnorm_ext(logn, b);
+	}
+}
+
+static double
+bench_mq_op(unsigned tier, int op, unsigned logn, unsigned *x)
+{
+	static uint16_t a[1024], b[1024];
+	size_t n = (size_t)1 << logn;
+	for (size_t i = 0; i < n; i ++) {
+		a[i] = (uint16_t)(1 + ((i * 7919) % 12289));
+		b[i] = (uint16_t)(1 + ((i * 104729) % 12288));
+	}
+	uint64_t tt[100];
+	for (int i = 0; i < 120; i ++) {
+		uint64_t begin = core_cycles();
+		*x += mq_op(tier, op, logn, a, b);
+		uint64_t end = core_cycles();
+		if (i >= 20) {
+			tt[i - 20] = end - begin;
+		}
+	}
+	qsort(tt, 100, sizeof(uint64_t), &cmp_u64);
+	return (double)tt[50];
+}
+
+static void
+bench_mq(unsigned *x)
+{
+	unsigned max_tier = SIMD_TIER_BASE;
+#if FNDSA_AVX2
+	if (has_avx2()) {
+		max_tier = SIMD_TIER_AVX2;
+	}
+#endif
+#if FNDSA_AVX512
+	if (has_avx512bw()) {
+		max_tier = SIMD_TIER_AVX512;
+	}
+#endif
+	for (unsigned logn = 9; logn <= 10; logn ++) {
+		for (int op = 0; op < MQ_OPS; op ++) {
+			for (unsigned tier = SIMD_TIER_BASE;
+				tier <= max_tier; tier ++)
+			{
+				printf("mq %-13s (n = %4u, %-7s) %13.2f\n",
+					mq_op_names[op], 1u << logn,
+					simd_tier_name(tier),
+					bench_mq_op(tier, op, logn, x));
+			}
+		}
+	}
+}
+
 int
-main(void)
+main(int argc, char *argv[])
 {
 	unsigned x;
 
+	if (argc >= 2 && strcmp(argv[1], "tiers") == 0) {
+		bench_tiers(&x);
+		printf("%u\n", x);
+		return 0;
+	}
+	if (argc >= 2 && strcmp(argv[1], "mq") == 0) {
+		bench_mq(&x);
+		printf("%u\n", x);
+		return 0;
+	}
+	if (argc >= 2 && strcmp(argv[1], "batch") == 0) {
+		bench_sign_batches(&x);
+		printf("%u\n", x);
+		return 0;
+	}
+	if (argc >= 2 && strcmp(argv[1], "threads") == 0) {
+#if FNDSA_SIGN_ENGINE
+		long max_threads = sysconf(_SC_NPROCESSORS_ONLN);
+		if (argc >= 3) {
+			max_threads = strtol(argv[2], NULL, 10);
+		}
+		if (max_threads < 1) {
+			max_threads = 1;
+		} else if (max_threads > 256) {
+			max_threads = 256;
+		}
+		bench_sign_engine_scaling((unsigned)max_threads, &x);
+		printf("%u\n", x);
+		return 0;
+#else
+		fprintf(stderr, "signing engine not supported\n");
+		return EXIT_FAILURE;
+#endif
+	}
+
+	if (argc >= 2 && strcmp(argv[1], "kgstats") == 0) {
+		bench_keygen_stats(&x);
+		printf("%u\n", x);
+		return 0;
+	}
+	if (argc >= 2 && strcmp(argv[1], "keygen") == 0) {
+#if FNDSA_SIGN_ENGINE
+		long max_threads = sysconf(_SC_NPROCESSORS_ONLN);
+		if (argc >= 3) {
+			max_threads = strtol(argv[2], NULL, 10);
+		}
+		if (max_threads < 1) {
+			max_threads = 1;
+		} else if (max_threads > 64) {
+			max_threads = 64;
+		}
+		bench_keygen_scaling((unsigned)max_threads, &x);
+		printf("%u\n", x);
+		return 0;
+#else
+		fprintf(stderr, "threads not supported\n");
+		return EXIT_FAILURE;
+#endif
+	}
+
 	printf("FN-DSA keygen (n = 512)        %13.2f\n", bench_keygen(9, &x));
 	printf("FN-DSA keygen (n = 1024)       %13.2f\n", bench_keygen(10, &x));
 	printf("FN-DSA sign (n = 512)          %13.2f\n", bench_sign(9, &x));
 	printf("FN-DSA sign (n = 1024)         %13.2f\n", bench_sign(10, &x));
-	printf("FN-DSA verify (n = 512)        %13.2f\n", bench_verify(9, &x));
-	printf("FN-DSA verify (n = 1024)       %13.2f\n", bench_verify(10, &x));
+	printf("FN-DSA expand key (n = 512)    %13.2f\n",
+		bench_sign_key_expand(9, &x));
+	printf("FN-DSA expand key (n = 1024)   %13.2f\n",
+		bench_sign_key_expand(10, &x));
+	printf("FN-DSA sign exp. (n = 512)     %13.2f\n",
+		bench_sign_expanded(9, &x));
+	printf("FN-DSA sign exp. (n = 1024)    %13.2f\n",
+		bench_sign_expanded(10, &x));
+	printf("FN-DSA verify (n = 512)        %13.2f\n",
+		bench_verify(9, 0, &x));
+	printf("FN-DSA verify (n = 1024)       %13.2f\n",
+		bench_verify(10, 0, &x));
+	printf("FN-DSA verify prep. (n = 512)  %13.2f\n",
+		bench_verify(9, 1, &x));
+	printf("FN-DSA verify prep. (n = 1024) %13.2f\n",
+		bench_verify(10, 1, &x));
+	printf("FN-DSA verify batch (n = 512)  %13.2f\n",
+		bench_verify_batch(9, &x));
+	printf("FN-DSA verify batch (n = 1024) %13.2f\n",
+		bench_verify_batch(10, &x));
 
 	printf("%u\n", x);
 	return 0;
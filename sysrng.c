@@ -4,13 +4,20 @@
 
 #include "inner.h"
 
-/* On Linux (glibc-2.25+), FreeBSD 12+ and OpenBSD, we can use
-   getentropy(). */
+/* On Linux (glibc-2.25+), we can use getrandom(), which has no length
+   limit (for lengths up to 256 bytes, it cannot be interrupted). */
+#ifndef FNDSA_RNG_GETRANDOM
+#if defined __linux__ && defined __GLIBC__ \
+	&& (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 25))
+#define FNDSA_RNG_GETRANDOM   1
+#else
+#define FNDSA_RNG_GETRANDOM   0
+#endif
+#endif
+
+/* On FreeBSD 12+ and OpenBSD, we can use getentropy(). */
 #ifndef FNDSA_RNG_GETENTROPY
-#if (defined __linux__ && defined __GLIBC__ \
-	&& (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 25))) \
-	|| (defined __FreeBSD__ && __FreeBSD__ >= 12) \
-	|| defined __OpenBSD__
+#if (defined __FreeBSD__ && __FreeBSD__ >= 12) || defined __OpenBSD__
 #define FNDSA_RNG_GETENTROPY   1
 #else
 #define FNDSA_RNG_GETENTROPY   0
@@ -43,16 +50,41 @@
 #endif
 #endif
 
-#if FNDSA_RNG_GETENTROPY
+/* If FNDSA_RNG_BUFFERED is 1, then sysrng() serves small requests from
+   a per-thread buffer filled by a fast-key-erasure generator, which is
+   seeded (and periodically reseeded) from the operating system. This
+   requires thread-local storage and pthread_atfork(), to detect fork()
+   calls; it is enabled by default on the same systems as the signing
+   engine. */
+#ifndef FNDSA_RNG_BUFFERED
+#if (defined __GNUC__ || defined __clang__) \
+	&& (defined __linux__ \
+	|| defined __FreeBSD__ \
+	|| defined __NetBSD__ \
+	|| defined __OpenBSD__ \
+	|| defined __DragonFly__ \
+	|| (defined __APPLE__ && defined __MACH__))
+#define FNDSA_RNG_BUFFERED   1
+#else
+#define FNDSA_RNG_BUFFERED   0
+#endif
+#endif
+
+#if FNDSA_RNG_GETRANDOM
+#include <sys/random.h>
+#endif
+#if FNDSA_RNG_GETRANDOM || FNDSA_RNG_URANDOM
+#include <errno.h>
+#endif
+#if FNDSA_RNG_GETENTROPY || FNDSA_RNG_URANDOM
 #include <unistd.h>
 #endif
 #if FNDSA_RNG_URANDOM
 #include <sys/types.h>
-#if !FNDSA_RNG_GETENTROPY
-#include <unistd.h>
-#endif
 #include <fcntl.h>
-#include <errno.h>
+#endif
+#if FNDSA_RNG_BUFFERED
+#include <pthread.h>
 #endif
 #if FNDSA_RNG_WIN32
 #include <windows.h>
@@ -62,16 +94,36 @@
 #pragma comment(lib, "advapi32")
 #endif
 
-/* see inner.h */
-int
-sysrng(void *dst, size_t len)
+/* Get randomness directly from the operating system. */
+static int
+sysrng_os(void *dst, size_t len)
 {
 	(void)dst;
 	if (len == 0) {
 		return 1;
 	}
+#if FNDSA_RNG_GETRANDOM
+	{
+		uint8_t *buf = dst;
+		size_t rem = len;
+		while (rem > 0) {
+			ssize_t rlen = getrandom(buf, rem, 0);
+			if (rlen < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				break;
+			}
+			buf += rlen;
+			rem -= (size_t)rlen;
+		}
+		if (rem == 0) {
+			return 1;
+		}
+	}
+#endif
 #if FNDSA_RNG_GETENTROPY
-	if (getentropy(dst, len) == 0) {
+	if (len <= 256 && getentropy(dst, len) == 0) {
 		return 1;
 	}
 #endif
@@ -102,3 +154,183 @@ sysrng(void *dst, size_t len)
 #endif
 	return 0;
 }
+
+#if FNDSA_RNG_BUFFERED
+
+/* Each refill of the per-thread buffer runs SHAKE256 over the current
+   key, and extracts the next key followed by SYSRNG_POOL_LEN bytes of
+   output (for a total of four Keccak-f blocks). Output bytes are erased
+   from the buffer as they are returned, and the key is replaced on each
+   refill, so that the thread state never allows recomputing bytes that
+   were already returned. Every SYSRNG_RESEED refills, fresh bytes from
+   the operating system are mixed into the key.
+
+   A fork() copies the thread state into the child; the child would then
+   produce the same bytes as the parent. A pthread_atfork() handler
+   increments a global counter in the child, and a state with a stale
+   counter value is discarded and reseeded. Processes created with raw
+   clone() system calls bypass that handler, and must not share the
+   state of their parent.
+
+   The state of a thread is erased when the thread exits, through a
+   pthread key destructor. Destructors are not invoked for the thread
+   that terminates the process (return from main() or exit()), so the
+   state of that thread is left in memory until the process ends. */
+#define SYSRNG_POOL_LEN   512
+#define SYSRNG_RESEED     256
+
+typedef struct {
+	uint8_t key[32];
+	uint8_t buf[SYSRNG_POOL_LEN];
+	size_t ptr;
+	unsigned long fork_gen;
+	unsigned refills;
+	int ready;
+} sysrng_pool;
+
+static __thread sysrng_pool sysrng_tls;
+static unsigned long sysrng_fork_gen;
+static int sysrng_atfork_ok;
+static int sysrng_key_ok;
+static pthread_key_t sysrng_key;
+static pthread_once_t sysrng_once = PTHREAD_ONCE_INIT;
+
+static void
+sysrng_atfork_child(void)
+{
+	__atomic_add_fetch(&sysrng_fork_gen, 1, __ATOMIC_SEQ_CST);
+}
+
+static void
+sysrng_thread_exit(void *arg)
+{
+	secure_wipe(arg, sizeof(sysrng_pool));
+}
+
+static void
+sysrng_register(void)
+{
+	sysrng_atfork_ok =
+		pthread_atfork(NULL, NULL, sysrng_atfork_child) == 0;
+	sysrng_key_ok =
+		pthread_key_create(&sysrng_key, sysrng_thread_exit) == 0;
+}
+
+/* Refill the buffer; if reseed is non-zero, then the key is first
+   replaced with fresh bytes from the operating system. */
+static int
+sysrng_refill(sysrng_pool *p, int reseed)
+{
+	shake_context sc;
+	uint8_t seed[32];
+
+	shake_init(&sc, 256);
+	if (reseed) {
+		if (!sysrng_os(seed, sizeof seed)) {
+			return 0;
+		}
+		shake_inject(&sc, seed, sizeof seed);
+		secure_wipe(seed, sizeof seed);
+		p->refills = 0;
+	}
+	shake_inject(&sc, p->key, sizeof p->key);
+	shake_flip(&sc);
+	shake_extract(&sc, p->key, sizeof p->key);
+	shake_extract(&sc, p->buf, sizeof p->buf);
+	secure_wipe(&sc, sizeof sc);
+	p->ptr = 0;
+	p->refills ++;
+	return 1;
+}
+
+/* see inner.h */
+int
+sysrng(void *dst, size_t len)
+{
+	pthread_once(&sysrng_once, &sysrng_register);
+	if (!sysrng_atfork_ok || len > SYSRNG_POOL_LEN) {
+		return sysrng_os(dst, len);
+	}
+
+	sysrng_pool *p = &sysrng_tls;
+	unsigned long gen = __atomic_load_n(&sysrng_fork_gen, __ATOMIC_SEQ_CST);
+	if (!p->ready || p->fork_gen != gen) {
+		memset(p, 0, sizeof *p);
+		if (!sysrng_refill(p, 1)) {
+			return 0;
+		}
+		p->fork_gen = gen;
+		p->ready = 1;
+		if (sysrng_key_ok) {
+			(void)pthread_setspecific(sysrng_key, p);
+		}
+	}
+	uint8_t *buf = dst;
+	while (len > 0) {
+		if (p->ptr == sizeof p->buf) {
+			if (!sysrng_refill(p, p->refills >= SYSRNG_RESEED)) {
+				p->ready = 0;
+				return 0;
+			}
+		}
+		size_t clen = sizeof p->buf - p->ptr;
+		if (clen > len) {
+			clen = len;
+		}
+		memcpy(buf, p->buf + p->ptr, clen);
+		memset(p->buf + p->ptr, 0, clen);
+		p->ptr += clen;
+		buf += clen;
+		len -= clen;
+	}
+	return 1;
+}
+
+#else
+
+/* see inner.h */
+int
+sysrng(void *dst, size_t len)
+{
+	return sysrng_os(dst, len);
+}
+
+#endif
+
+/* see inner.h */
+void
+secure_wipe(void *buf, size_t len)
+{
+	volatile uint8_t *p = buf;
+	for (size_t i = 0; i < len; i ++) {
+		p[i] = 0;
+	}
+}
+
+/* see inner.h */
+int
+sysrng_shake_init(shake_context *rng)
+{
+	uint8_t seed[48];
+	if (!sysrng(seed, sizeof seed)) {
+		return 0;
+	}
+	shake_init(rng, 256);
+	shake_inject(rng, seed, sizeof seed);
+	shake_flip(rng);
+	secure_wipe(seed, sizeof seed);
+	return 1;
+}
+
+/* see inner.h */
+void
+shake_ratchet(shake_context *rng, void *dst, size_t len)
+{
+	uint8_t seed[32];
+	shake_extract(rng, dst, len);
+	shake_extract(rng, seed, sizeof seed);
+	shake_init(rng, 256);
+	shake_inject(rng, seed, sizeof seed);
+	shake_flip(rng);
+	secure_wipe(seed, sizeof seed);
+}
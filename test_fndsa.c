@@ -7,6 +7,18 @@
 #include "kgen_inner.h"
 #include "sign_inner.h"
 
+#if defined __unix__ || (defined __APPLE__ && defined __MACH__)
+#include <unistd.h>
+#include <sys/wait.h>
+#define TEST_FORK   1
+#else
+#define TEST_FORK   0
+#endif
+
+#if FNDSA_KEYGEN_MT || FNDSA_SIGN_ENGINE
+#include <time.h>
+#endif
+
 /* GCC and Clang tend to be a bit trigger-happy with inlining function,
    with a side effect of increasing stack space usage. We try to mark the
    test_*() functions as not inlinable. */
@@ -457,6 +469,102 @@ test_SHAKE256x4(void)
 	fflush(stdout);
 }
 
+NOINLINE
+static void
+test_SHAKE256_mb(void)
+{
+	printf("Test SHAKE256 multi-buffer: ");
+	fflush(stdout);
+
+	uint8_t *data = xmalloc(8 * 700);
+	uint8_t *b1 = xmalloc(8 * 500);
+	uint8_t *b2 = xmalloc(500);
+	shake_context sc;
+	shake_init(&sc, 256);
+	shake_flip(&sc);
+	shake_extract(&sc, data, 8 * 700);
+	for (int t = 0; t < 40; t ++) {
+		size_t len[8], len1[8], len2[8];
+		const void *in[8];
+		void *out[8];
+		for (size_t j = 0; j < 8; j ++) {
+			/* Lengths differ between lanes; some are zero, some
+			   are exact multiples of the rate (136). */
+			len[j] = ((size_t)t * 37 + j * 61) % 700;
+			if (((t + (int)j) % 11) == 0) {
+				len[j] = 0;
+			} else if (((t + (int)j) % 7) == 0) {
+				len[j] = 136 * (j & 3);
+			}
+			len1[j] = (len[j] * (size_t)(t % 5)) / 4;
+			len2[j] = len[j] - len1[j];
+			out[j] = b1 + 500 * j;
+		}
+
+		memset(b1, 0, 8 * 500);
+		if ((t & 1) == 0) {
+			fndsa_shake256_x4_context sx;
+			fndsa_shake256_x4_init(&sx);
+			for (size_t j = 0; j < 4; j ++) {
+				in[j] = data + 700 * j;
+			}
+			fndsa_shake256_x4_inject(&sx, in, len1);
+			for (size_t j = 0; j < 4; j ++) {
+				in[j] = data + 700 * j + len1[j];
+			}
+			fndsa_shake256_x4_inject(&sx, in, len2);
+			fndsa_shake256_x4_flip(&sx);
+			fndsa_shake256_x4_extract(&sx, out, 1);
+			for (size_t j = 0; j < 4; j ++) {
+				out[j] = b1 + 500 * j + 1;
+			}
+			fndsa_shake256_x4_extract(&sx, out, 135);
+			for (size_t j = 0; j < 4; j ++) {
+				out[j] = b1 + 500 * j + 136;
+			}
+			fndsa_shake256_x4_extract(&sx, out, 364);
+		} else {
+			fndsa_shake256_x8_context sx;
+			fndsa_shake256_x8_init(&sx);
+			for (size_t j = 0; j < 8; j ++) {
+				in[j] = data + 700 * j;
+			}
+			fndsa_shake256_x8_inject(&sx, in, len1);
+			for (size_t j = 0; j < 8; j ++) {
+				in[j] = data + 700 * j + len1[j];
+			}
+			fndsa_shake256_x8_inject(&sx, in, len2);
+			fndsa_shake256_x8_flip(&sx);
+			fndsa_shake256_x8_extract(&sx, out, 3);
+			for (size_t j = 0; j < 8; j ++) {
+				out[j] = b1 + 500 * j + 3;
+			}
+			fndsa_shake256_x8_extract(&sx, out, 300);
+			for (size_t j = 0; j < 8; j ++) {
+				out[j] = b1 + 500 * j + 303;
+			}
+			fndsa_shake256_x8_extract(&sx, out, 197);
+		}
+
+		size_t nl = (t & 1) == 0 ? 4 : 8;
+		for (size_t j = 0; j < nl; j ++) {
+			shake_init(&sc, 256);
+			shake_inject(&sc, data + 700 * j, len[j]);
+			shake_flip(&sc);
+			shake_extract(&sc, b2, 500);
+			check_eq(b1 + 500 * j, b2, 500, "OUT");
+		}
+		printf(".");
+		fflush(stdout);
+	}
+	xfree(data);
+	xfree(b1);
+	xfree(b2);
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
 /* Each pair of lines is an input and a corresponding output. The output
    size governs which SHA-3 variant is used. */
 static const char *const KAT_SHA3[] = {
@@ -1892,6 +2000,87 @@ test_SHA3(void)
 	fflush(stdout);
 }
 
+NOINLINE
+static void
+test_sysrng(void)
+{
+	printf("Test sysrng: ");
+	fflush(stdout);
+
+	/* Requests of various lengths, both below and above the size of
+	   the internal buffer, must all succeed and yield distinct
+	   values. */
+	static const size_t lens[] = { 1, 32, 96, 500, 700, 2000, 0 };
+	uint8_t buf1[2000], buf2[2000];
+	for (size_t i = 0; lens[i] != 0; i ++) {
+		size_t len = lens[i];
+		for (int j = 0; j < 20; j ++) {
+			memset(buf1, 0, sizeof buf1);
+			memset(buf2, 0, sizeof buf2);
+			if (!sysrng(buf1, len) || !sysrng(buf2, len)) {
+				fprintf(stderr, "sysrng() failed\n");
+				exit(EXIT_FAILURE);
+			}
+			if (len >= 32 && memcmp(buf1, buf2, len) == 0) {
+				fprintf(stderr, "sysrng() repeated output\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+		printf(".");
+		fflush(stdout);
+	}
+
+#if TEST_FORK
+	/* After a fork(), the child and the parent must obtain different
+	   values. */
+	int fd[2];
+	if (pipe(fd) != 0) {
+		fprintf(stderr, "pipe() failed\n");
+		exit(EXIT_FAILURE);
+	}
+	pid_t pid = fork();
+	if (pid < 0) {
+		fprintf(stderr, "fork() failed\n");
+		exit(EXIT_FAILURE);
+	}
+	if (pid == 0) {
+		close(fd[0]);
+		int ok = sysrng(buf2, 32)
+			&& write(fd[1], buf2, 32) == 32;
+		_exit(ok ? 0 : 1);
+	}
+	close(fd[1]);
+	if (!sysrng(buf1, 32)) {
+		fprintf(stderr, "sysrng() failed\n");
+		exit(EXIT_FAILURE);
+	}
+	size_t rlen = 0;
+	while (rlen < 32) {
+		ssize_t r = read(fd[0], buf2 + rlen, 32 - rlen);
+		if (r <= 0) {
+			break;
+		}
+		rlen += (size_t)r;
+	}
+	close(fd[0]);
+	int status;
+	waitpid(pid, &status, 0);
+	if (rlen != 32 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+		fprintf(stderr, "sysrng() failed in child\n");
+		exit(EXIT_FAILURE);
+	}
+	if (memcmp(buf1, buf2, 32) == 0) {
+		fprintf(stderr, "sysrng() repeated output after fork()\n");
+		exit(EXIT_FAILURE);
+	}
+	printf("F");
+	fflush(stdout);
+#endif
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
 NOINLINE
 static void
 test_modq_codec(void)
@@ -1903,6 +2092,7 @@ test_modq_codec(void)
 		size_t n = (size_t)1 << logn;
 		size_t elen = (size_t)7 << (logn - 2);
 		uint8_t *d = xmalloc(elen);
+		uint8_t *d2 = xmalloc(elen);
 		uint16_t *t1 = xmalloc(n * sizeof *t1);
 		uint16_t *t2 = xmalloc(n * sizeof *t2);
 
@@ -1923,43 +2113,88 @@ test_modq_codec(void)
 				w %= 12289;
 				t1[j] = w;
 			}
-			size_t k = mqpoly_encode(logn, t1, d);
-			if (k != elen) {
-				fprintf(stderr, "ERR encode: %zu (exp: %zu)\n",
-					k, elen);
-				exit(EXIT_FAILURE);
-			}
-			k = mqpoly_decode(logn, d, t2);
-			if (k != elen) {
-				fprintf(stderr, "ERR decode: %zu (exp: %zu)\n",
-					k, elen);
-				exit(EXIT_FAILURE);
-			}
-			for (size_t j = 0; j < n; j ++) {
-				if (t1[j] != t2[j]) {
-					fprintf(stderr, "ERR enc/dec:"
-						" j=%zu: %u -> %u\n",
-						j, t1[j], t2[j]);
+			/* All SIMD tiers must produce the same encoding. */
+			int first = 1;
+#if FNDSA_AVX2
+			for (unsigned tier = SIMD_TIER_BASE;
+				tier <= SIMD_TIER_AVX2; tier ++)
+			{
+				set_simd_tier_max(tier);
+#else
+			{
+#endif
+				size_t k = mqpoly_encode(logn, t1, d);
+				if (k != elen) {
+					fprintf(stderr, "ERR encode:"
+						" %zu (exp: %zu)\n", k, elen);
 					exit(EXIT_FAILURE);
 				}
-			}
+				if (first) {
+					memcpy(d2, d, elen);
+				} else {
+					check_eq(d, d2, elen,
+						"mqpoly_encode (SIMD)");
+				}
+				k = mqpoly_decode(logn, d, t2);
+				if (k != elen) {
+					fprintf(stderr, "ERR decode:"
+						" %zu (exp: %zu)\n", k, elen);
+					exit(EXIT_FAILURE);
+				}
+				for (size_t j = 0; j < n; j ++) {
+					if (t1[j] != t2[j]) {
+						fprintf(stderr, "ERR enc/dec:"
+							" j=%zu: %u -> %u\n",
+							j, t1[j], t2[j]);
+						exit(EXIT_FAILURE);
+					}
+				}
+				k = mqpoly_decode_int(logn, d, t2);
+				if (k != elen) {
+					fprintf(stderr, "ERR decode_int:"
+						" %zu (exp: %zu)\n", k, elen);
+					exit(EXIT_FAILURE);
+				}
+				for (size_t j = 0; j < n; j ++) {
+					unsigned w = t1[j] == 0 ? 12289 : t1[j];
+					if (t2[j] != w) {
+						fprintf(stderr, "ERR enc/dec_int:"
+							" j=%zu: %u -> %u\n",
+							j, t1[j], t2[j]);
+						exit(EXIT_FAILURE);
+					}
+				}
 
-			/* Set element i mod n to 12289; this should
-			   trigger overflow detection.
-			   Note: we here assume that _encoding_ an
-			   invalid value is possible (the encode function
-			   is not validating its input) */
-			t1[i % n] = 12289;
-			mqpoly_encode(logn, t1, d);
-			k = mqpoly_decode(logn, d, t2);
-			if (k != 0) {
-				fprintf(stderr, "ERR decode: "
-					" undetected overflow, i = %d\n", i);
-				exit(EXIT_FAILURE);
+				/* Set element i mod n to 12289 or more; this
+				   should trigger overflow detection.
+				   Note: we here assume that _encoding_ an
+				   invalid value is possible (the encode
+				   function is not validating its input) */
+				uint16_t w0 = t1[i % n];
+				t1[i % n] = 12289 + (i & 0x3FF);
+				mqpoly_encode(logn, t1, d);
+				k = mqpoly_decode(logn, d, t2);
+				if (k != 0) {
+					fprintf(stderr, "ERR decode: undetected"
+						" overflow, i = %d\n", i);
+					exit(EXIT_FAILURE);
+				}
+				k = mqpoly_decode_int(logn, d, t2);
+				if (k != 0) {
+					fprintf(stderr, "ERR decode_int: undetected"
+						" overflow, i = %d\n", i);
+					exit(EXIT_FAILURE);
+				}
+				t1[i % n] = w0;
+				first = 0;
 			}
+#if FNDSA_AVX2
+			set_simd_tier_max(SIMD_TIER_AVX512);
+#endif
 		}
 
 		xfree(d);
+		xfree(d2);
 		xfree(t1);
 		xfree(t2);
 
@@ -1971,6 +2206,219 @@ test_modq_codec(void)
 	fflush(stdout);
 }
 
+/* Encode and decode f1 (values in [-lim,+lim]) with trim_i8_encode() and
+   trim_i8_decode(), with the current SIMD tier. If ref is non-zero, the
+   encoded output is saved into d2; otherwise, it is compared with d2.
+   f2 and d are scratch buffers. The forbidden value is then set at
+   index i, and decoding must fail. */
+static void
+check_trim_codec(unsigned logn, unsigned nbits, int8_t *f1, int8_t *f2,
+	uint8_t *d, uint8_t *d2, int ref, size_t i)
+{
+	size_t n = (size_t)1 << logn;
+	size_t elen = ((size_t)nbits << logn) >> 3;
+	size_t k = trim_i8_encode(logn, f1, nbits, d);
+	if (k != elen) {
+		fprintf(stderr, "ERR trim encode: %zu (exp: %zu)\n",
+			k, elen);
+		exit(EXIT_FAILURE);
+	}
+	if (ref) {
+		memcpy(d2, d, elen);
+	} else {
+		check_eq(d, d2, elen, "trim_i8_encode (SIMD)");
+	}
+	memset(f2, 0, n);
+	k = trim_i8_decode(logn, d, f2, nbits);
+	if (k != elen) {
+		fprintf(stderr, "ERR trim decode: %zu (exp: %zu)\n",
+			k, elen);
+		exit(EXIT_FAILURE);
+	}
+	check_eq(f1, f2, n, "trim_i8 enc/dec");
+
+	int8_t w0 = f1[i];
+	f1[i] = (int8_t)-(1 << (nbits - 1));
+	trim_i8_encode(logn, f1, nbits, d);
+	if (trim_i8_decode(logn, d, f2, nbits) != 0) {
+		fprintf(stderr, "ERR trim decode: undetected forbidden"
+			" value, i = %zu\n", i);
+		exit(EXIT_FAILURE);
+	}
+	f1[i] = w0;
+}
+
+NOINLINE
+static void
+test_trim_codec(void)
+{
+	printf("Test codec (small): ");
+	fflush(stdout);
+
+	shake_context rng;
+	shake_init(&rng, 256);
+	shake_inject(&rng, "trim", 4);
+	shake_flip(&rng);
+	for (unsigned logn = 2; logn <= 10; logn ++) {
+		size_t n = (size_t)1 << logn;
+		int8_t *f1 = xmalloc(n);
+		int8_t *f2 = xmalloc(n);
+		uint8_t *d = xmalloc(n);
+		uint8_t *d2 = xmalloc(n);
+
+		for (unsigned nbits = 5; nbits <= 8; nbits ++) {
+			if ((((size_t)nbits << logn) & 7) != 0) {
+				continue;
+			}
+			int lim = (1 << (nbits - 1)) - 1;
+			for (size_t i = 0; i < 20; i ++) {
+				for (size_t j = 0; j < n; j ++) {
+					uint8_t v;
+					shake_extract(&rng, &v, 1);
+					f1[j] = (int8_t)((int)v
+						% (2 * lim + 1) - lim);
+				}
+				size_t u = (i * 37) % n;
+				check_trim_codec(logn, nbits,
+					f1, f2, d, d2, 1, u);
+#if FNDSA_AVX2
+				/* All SIMD tiers must produce the same
+				   encoding. */
+				set_simd_tier_max(SIMD_TIER_BASE);
+				check_trim_codec(logn, nbits,
+					f1, f2, d, d2, 1, u);
+				set_simd_tier_max(SIMD_TIER_AVX2);
+				check_trim_codec(logn, nbits,
+					f1, f2, d, d2, 0, u);
+				set_simd_tier_max(SIMD_TIER_AVX512);
+#endif
+			}
+		}
+
+		xfree(f1);
+		xfree(f2);
+		xfree(d);
+		xfree(d2);
+
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+/* Reference byte-at-a-time implementation of comp_encode(). */
+static int
+ref_comp_encode(unsigned logn, const int16_t *s, uint8_t *d, size_t dlen)
+{
+	size_t n = (size_t)1 << logn;
+	uint32_t acc = 0;
+	unsigned acc_len = 0;
+	size_t j = 0;
+	for (size_t i = 0; i < n; i ++) {
+		int32_t x = s[i];
+		if (x < -2047 || x > +2047) {
+			return 0;
+		}
+		uint32_t sw = (uint32_t)(x >> 16);
+		uint32_t w = ((uint32_t)x ^ sw) - sw;
+		acc = (acc << 8) | (sw & 0x80) | (w & 0x7F);
+		acc_len += 8;
+		unsigned wh = (w >> 7) + 1;
+		acc = (acc << wh) | 1;
+		acc_len += wh;
+		while (acc_len >= 8) {
+			acc_len -= 8;
+			if (j >= dlen) {
+				return 0;
+			}
+			d[j ++] = (uint8_t)(acc >> acc_len);
+		}
+	}
+	if (acc_len > 0) {
+		if (j >= dlen) {
+			return 0;
+		}
+		d[j ++] = (uint8_t)(acc << (8 - acc_len));
+	}
+	while (j < dlen) {
+		d[j ++] = 0;
+	}
+	return 1;
+}
+
+/* Reference bit-at-a-time implementation of comp_decode(). */
+static int
+ref_comp_decode(unsigned logn, const uint8_t *d, size_t dlen, int16_t *s)
+{
+	size_t n = (size_t)1 << logn;
+	uint32_t acc = 0;
+	unsigned acc_len = 0;
+	size_t j = 0;
+	for (size_t i = 0; i < n; i ++) {
+		if (j >= dlen) {
+			return 0;
+		}
+		acc = (acc << 8) | d[j ++];
+		uint32_t m = acc >> acc_len;
+		uint32_t t = (m >> 7) & 1;
+		m &= 0x7F;
+		for (;;) {
+			if (acc_len == 0) {
+				if (j >= dlen) {
+					return 0;
+				}
+				acc = (acc << 8) | d[j ++];
+				acc_len = 8;
+			}
+			acc_len --;
+			if (((acc >> acc_len) & 1) != 0) {
+				break;
+			}
+			m += 0x80;
+			if (m > 2047) {
+				return 0;
+			}
+		}
+		if (m == 0 && t != 0) {
+			return 0;
+		}
+		m = (m ^ -t) + t;
+		s[i] = (int16_t)*(int32_t *)&m;
+	}
+	if (acc_len > 0) {
+		if ((acc & ((1 << acc_len) - 1)) != 0) {
+			return 0;
+		}
+	}
+	while (j < dlen) {
+		if (d[j ++] != 0) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/* Decode with both comp_decode() and ref_comp_decode(), and check that
+   they agree (on the status, and on the values on success). */
+static int
+check_comp_decode(unsigned logn, const uint8_t *d, size_t dlen,
+	int16_t *t1, int16_t *t2)
+{
+	size_t n = (size_t)1 << logn;
+	int r1 = ref_comp_decode(logn, d, dlen, t1);
+	int r2 = comp_decode(logn, d, dlen, t2);
+	if (r1 != r2) {
+		fprintf(stderr, "ERR decode status: %d / %d\n", r1, r2);
+		exit(EXIT_FAILURE);
+	}
+	if (r1) {
+		check_eq(t1, t2, n * sizeof *t1, "comp_decode");
+	}
+	return r1;
+}
+
 NOINLINE
 static void
 test_comp_codec(void)
@@ -1982,6 +2430,7 @@ test_comp_codec(void)
 		size_t n = (size_t)1 << logn;
 		size_t dlen = n * 3 + 1;
 		uint8_t *d = xmalloc(dlen);
+		uint8_t *d2 = xmalloc(dlen);
 		int16_t *t1 = xmalloc(n * sizeof *t1);
 		int16_t *t2 = xmalloc(n * sizeof *t2);
 
@@ -2007,6 +2456,11 @@ test_comp_codec(void)
 				fprintf(stderr, "ERR encode\n");
 				exit(EXIT_FAILURE);
 			}
+			if (!ref_comp_encode(logn, t1, d2, dlen)) {
+				fprintf(stderr, "ERR ref encode\n");
+				exit(EXIT_FAILURE);
+			}
+			check_eq(d, d2, dlen, "comp_encode");
 			if (!comp_decode(logn, d, dlen, t2)) {
 				fprintf(stderr, "ERR decode\n");
 				exit(EXIT_FAILURE);
@@ -2062,9 +2516,62 @@ test_comp_codec(void)
 			   covered in the signature verification (where we
 			   try flipping all bits one by one; heuristically
 			   signature values contain zeros). */
+
+			/* Encoding into buffers which are too short must
+			   fail, as in the reference code. */
+			comp_encode(logn, t1, d, dlen);
+			size_t mlen = dlen;
+			while (d[mlen - 1] == 0) {
+				mlen --;
+			}
+			size_t elen = mlen - 1 - (size_t)(i % 3);
+			if (ref_comp_encode(logn, t1, d2, elen)
+				|| comp_encode(logn, t1, d2, elen))
+			{
+				fprintf(stderr, "ERR short encode\n");
+				exit(EXIT_FAILURE);
+			}
+
+			/* Decoding of truncated, extended and corrupted
+			   encodings must match the reference code. */
+			check_comp_decode(logn, d, mlen - 1, t1, t2);
+			check_comp_decode(logn, d,
+				mlen + 9 < dlen ? mlen + 9 : dlen, t1, t2);
+			for (int r = 0; r < 8; r ++) {
+				uint8_t v[3];
+				shake_extract(&sc, v, sizeof v);
+				size_t u = (v[0] | ((size_t)v[1] << 8)) % mlen;
+				memcpy(d2, d, dlen);
+				d2[u] ^= (uint8_t)(1 << (v[2] & 7));
+				check_comp_decode(logn, d2, dlen, t1, t2);
+			}
+			shake_extract(&sc, d2, dlen);
+			check_comp_decode(logn, d2, dlen, t1, t2);
+		}
+
+		/* Extreme values (longest codes), "-0" and the shortest
+		   buffer that can hold them. */
+		for (size_t j = 0; j < n; j ++) {
+			t1[j] = (j & 1) != 0 ? -2047 : 2047;
+		}
+		size_t xlen = (n * 24) >> 3;
+		if (!comp_encode(logn, t1, d, xlen)
+			|| !check_comp_decode(logn, d, xlen, t1, t2)
+			|| check_comp_decode(logn, d, xlen - 1, t1, t2))
+		{
+			fprintf(stderr, "ERR extreme values\n");
+			exit(EXIT_FAILURE);
+		}
+		memset(t1, 0, n * sizeof *t1);
+		comp_encode(logn, t1, d, dlen);
+		d[0] ^= 0x80;
+		if (check_comp_decode(logn, d, dlen, t1, t2)) {
+			fprintf(stderr, "ERR minus zero\n");
+			exit(EXIT_FAILURE);
 		}
 
 		xfree(d);
+		xfree(d2);
 		xfree(t1);
 		xfree(t2);
 
@@ -2098,43 +2605,211 @@ inrange_mq_int(uint32_t x)
 
 NOINLINE
 static void
-test_mq(void)
+test_simd_tier(void)
 {
-	printf("Test modulo q: ");
+	printf("Test SIMD tiers: ");
 	fflush(stdout);
 
-	for (unsigned logn = 2; logn <= 10; logn ++) {
-		size_t n = (size_t)1 << logn;
-		uint16_t *t1 = xmalloc((sizeof *t1) << logn);
-		uint16_t *t2 = xmalloc((sizeof *t2) << logn);
-		uint16_t *t3 = xmalloc((sizeof *t3) << logn);
-		uint16_t *t4 = xmalloc((sizeof *t4) << logn);
+	unsigned tier = fndsa_get_simd_tier();
+	if (tier > FNDSA_SIMD_TIER_AVX512) {
+		fprintf(stderr, "invalid tier: %u\n", tier);
+		exit(EXIT_FAILURE);
+	}
+	for (unsigned cap = FNDSA_SIMD_TIER_BASE;
+		cap <= FNDSA_SIMD_TIER_AVX512; cap ++)
+	{
+		fndsa_set_simd_tier_max(cap);
+		unsigned t2 = fndsa_get_simd_tier();
+		if (t2 != (tier < cap ? tier : cap)) {
+			fprintf(stderr, "cap %u: tier %u (max: %u)\n",
+				cap, t2, tier);
+			exit(EXIT_FAILURE);
+		}
+		printf(".");
+		fflush(stdout);
+	}
+	if (fndsa_get_simd_tier() != tier) {
+		fprintf(stderr, "tier not restored\n");
+		exit(EXIT_FAILURE);
+	}
 
-		for (int i = 0; i < 32 << (10 - logn); i ++) {
-			uint8_t seed[3];
-			seed[0] = (uint8_t)logn;
-			seed[1] = (uint8_t)i;
-			seed[2] = (uint8_t)(i >> 8);
-			shake_context sc;
-			shake_init(&sc, 256);
-			shake_inject(&sc, seed, sizeof seed);
-			shake_flip(&sc);
+	printf(" done.\n");
+	fflush(stdout);
+}
 
-			int8_t *tb = (int8_t *)t4;
-			shake_extract(&sc, tb, n);
-			for (size_t j = 0; j < n; j ++) {
-				if (tb[j] == -128) {
-					tb[j] = -127;
+/* Reference hash_to_point() (plain rejection sampling, byte by byte). */
+static void
+ref_hash_to_point(unsigned logn, const uint8_t *nonce, const uint8_t *hk,
+	const void *hv, size_t hv_len, uint16_t *c)
+{
+	shake_context sc;
+	shake_init(&sc, 256);
+	hash_to_point_start(&sc, nonce, hk, NULL, 0,
+		FNDSA_HASH_ID_RAW, hv, hv_len);
+	size_t n = (size_t)1 << logn;
+	for (size_t i = 0; i < n;) {
+		unsigned w = (unsigned)shake_next_u8(&sc) << 8;
+		w |= shake_next_u8(&sc);
+		if (w < 61445) {
+			c[i ++] = w % 12289;
+		}
+	}
+}
+
+NOINLINE
+static void
+test_hash_to_point(void)
+{
+	printf("Test hash_to_point: ");
+	fflush(stdout);
+
+	uint8_t seed[40 + 64 + 100];
+	uint16_t c1[1024], c2[1024];
+	shake_context rng;
+	shake_init(&rng, 256);
+	shake_flip(&rng);
+	for (unsigned logn = 2; logn <= 10; logn ++) {
+		size_t n = (size_t)1 << logn;
+		for (int t = 0; t < 20; t ++) {
+			shake_extract(&rng, seed, sizeof seed);
+			const uint8_t *nonce = seed;
+			const uint8_t *hk = seed + 40;
+			const uint8_t *hv = seed + 104;
+			size_t hv_len = (size_t)t * 5;
+			ref_hash_to_point(logn, nonce, hk, hv, hv_len, c1);
+#if FNDSA_AVX2
+			for (unsigned tier = SIMD_TIER_BASE;
+				tier <= SIMD_TIER_AVX512; tier ++)
+			{
+				set_simd_tier_max(tier);
+#else
+			{
+#endif
+				memset(c2, 0, sizeof c2);
+				hash_to_point(logn, nonce, hk, NULL, 0,
+					FNDSA_HASH_ID_RAW, hv, hv_len, c2);
+				check_eq(c1, c2, n * sizeof(uint16_t), "H2P");
+
+				shake_context sc[4];
+				uint16_t *cc[4];
+				unsigned ln[4];
+				for (int k = 0; k < 4; k ++) {
+					shake_init(&sc[k], 256);
+					hash_to_point_start(&sc[k], nonce, hk,
+						NULL, 0, FNDSA_HASH_ID_RAW,
+						hv, hv_len);
+					ln[k] = logn;
+					cc[k] = c2;
 				}
+				memset(c2, 0, sizeof c2);
+				hash_to_point_x4(sc, 1, ln, cc);
+				check_eq(c1, c2, n * sizeof(uint16_t), "H2Px4");
 			}
-			mqpoly_small_to_int(logn, tb, t1);
-			for (size_t j = 0; j < n; j ++) {
-				int32_t xf = tb[j];
-				uint32_t x1 = t1[j];
-				int32_t y = xf <= 0 ? xf + 12289 : xf;
-				if (!same_mq_int((uint32_t)y, x1)) {
-					fprintf(stderr, "ERR small_to_int:"
-						" %d -> %u (exp: %d)\n",
+#if FNDSA_AVX2
+			set_simd_tier_max(SIMD_TIER_AVX512);
+#endif
+		}
+		printf(".");
+		fflush(stdout);
+	}
+
+	/* hash_to_point_x4() with 2 to 4 active lanes, distinct messages
+	   and mixed degrees (so that lanes complete at different times);
+	   lanes beyond num must not be written. */
+	uint16_t cx[4][1024];
+	for (int t = 0; t < 36; t ++) {
+		size_t num = 2 + (size_t)t % 3;
+		uint8_t lseed[4][40 + 64 + 16];
+		unsigned ln[4];
+		uint16_t *cc[4];
+		for (size_t k = 0; k < 4; k ++) {
+			shake_extract(&rng, lseed[k], sizeof lseed[k]);
+			ln[k] = 2 + ((unsigned)t + 4 * (unsigned)k) % 9;
+			cc[k] = cx[k];
+		}
+#if FNDSA_AVX2
+		for (unsigned tier = SIMD_TIER_BASE;
+			tier <= SIMD_TIER_AVX512; tier ++)
+		{
+			set_simd_tier_max(tier);
+#else
+		{
+#endif
+			shake_context sc[4];
+			for (size_t k = 0; k < 4; k ++) {
+				shake_init(&sc[k], 256);
+				hash_to_point_start(&sc[k],
+					lseed[k], lseed[k] + 40, NULL, 0,
+					FNDSA_HASH_ID_RAW, lseed[k] + 104, 16);
+			}
+			memset(cx, 0xFF, sizeof cx);
+			hash_to_point_x4(sc, num, ln, cc);
+			for (size_t k = 0; k < 4; k ++) {
+				size_t n = (size_t)1 << ln[k];
+				if (k >= num) {
+					memset(c1, 0xFF, n * sizeof(uint16_t));
+				} else {
+					hash_to_point(ln[k],
+						lseed[k], lseed[k] + 40,
+						NULL, 0, FNDSA_HASH_ID_RAW,
+						lseed[k] + 104, 16, c1);
+				}
+				check_eq(c1, cx[k], n * sizeof(uint16_t),
+					"H2Px4 lanes");
+			}
+		}
+#if FNDSA_AVX2
+		set_simd_tier_max(SIMD_TIER_AVX512);
+#endif
+		if (t % 9 == 8) {
+			printf(".");
+			fflush(stdout);
+		}
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+NOINLINE
+static void
+test_mq(void)
+{
+	printf("Test modulo q: ");
+	fflush(stdout);
+
+	for (unsigned logn = 2; logn <= 10; logn ++) {
+		size_t n = (size_t)1 << logn;
+		uint16_t *t1 = xmalloc((sizeof *t1) << logn);
+		uint16_t *t2 = xmalloc((sizeof *t2) << logn);
+		uint16_t *t3 = xmalloc((sizeof *t3) << logn);
+		uint16_t *t4 = xmalloc((sizeof *t4) << logn);
+
+		for (int i = 0; i < 32 << (10 - logn); i ++) {
+			uint8_t seed[3];
+			seed[0] = (uint8_t)logn;
+			seed[1] = (uint8_t)i;
+			seed[2] = (uint8_t)(i >> 8);
+			shake_context sc;
+			shake_init(&sc, 256);
+			shake_inject(&sc, seed, sizeof seed);
+			shake_flip(&sc);
+
+			int8_t *tb = (int8_t *)t4;
+			shake_extract(&sc, tb, n);
+			for (size_t j = 0; j < n; j ++) {
+				if (tb[j] == -128) {
+					tb[j] = -127;
+				}
+			}
+			mqpoly_small_to_int(logn, tb, t1);
+			for (size_t j = 0; j < n; j ++) {
+				int32_t xf = tb[j];
+				uint32_t x1 = t1[j];
+				int32_t y = xf <= 0 ? xf + 12289 : xf;
+				if (!same_mq_int((uint32_t)y, x1)) {
+					fprintf(stderr, "ERR small_to_int:"
+						" %d -> %u (exp: %d)\n",
 						xf, x1, y);
 					exit(EXIT_FAILURE);
 				}
@@ -2300,6 +2975,47 @@ test_mq(void)
 					exit(EXIT_FAILURE);
 				}
 			}
+
+			/* Division in ntt representation; in some iterations,
+			   a coefficient of the divisor is forced to zero. */
+			if ((i & 3) == 3) {
+				t4[(size_t)i & (n - 1)] = 12289;
+			}
+			memcpy(t3, t1, 2 * n);
+			int dr1 = mqpoly_div_ntt(logn, t3, t4);
+			int dr2 = 1;
+			for (size_t j = 0; j < n; j ++) {
+				uint32_t x1 = t1[j] % 12289;
+				uint32_t x3 = t3[j] % 12289;
+				uint32_t x4 = t4[j] % 12289;
+				int ok;
+				if (x4 == 0) {
+					dr2 = 0;
+					ok = (x3 == 0);
+				} else {
+					ok = ((x3 * x4) % 12289 == x1);
+				}
+				if (!ok) {
+					fprintf(stderr, "ERR div: %u / %u -> %u\n",
+						x1, x4, x3);
+					exit(EXIT_FAILURE);
+				}
+			}
+			if (dr1 != dr2) {
+				fprintf(stderr, "ERR div (status): %d (exp: %d)\n",
+					dr1, dr2);
+				exit(EXIT_FAILURE);
+			}
+#if FNDSA_AVX2
+			if (has_avx2()) {
+				memcpy(t2, t1, 2 * n);
+				if (avx2_mqpoly_div_ntt(logn, t2, t4) != dr1) {
+					fprintf(stderr, "ERR div (AVX2 status)\n");
+					exit(EXIT_FAILURE);
+				}
+				check_eq(t2, t3, 2 * n, "div (AVX2)");
+			}
+#endif
 		}
 
 		xfree(t1);
@@ -2362,6 +3078,112 @@ check_add_sub(fpr x, fpr y)
 	}
 }
 
+#if FNDSA_AVX512
+/* Compare the AVX-512BW implementations of the mqpoly functions with
+   the AVX2 ones. */
+NOINLINE
+static void
+test_mq_avx512(void)
+{
+	printf("Test modulo q (AVX-512): ");
+	fflush(stdout);
+	if (!has_avx512bw()) {
+		printf("not supported.\n");
+		fflush(stdout);
+		return;
+	}
+
+	uint16_t a1[1024], a2[1024], b1[1024], b2[1024];
+	for (unsigned logn = 2; logn <= 10; logn ++) {
+		size_t n = (size_t)1 << logn;
+		for (int i = 0; i < 20; i ++) {
+			uint8_t seed[3];
+			seed[0] = (uint8_t)logn;
+			seed[1] = (uint8_t)i;
+			seed[2] = 0x55;
+			shake_context sc;
+			shake_init(&sc, 256);
+			shake_inject(&sc, seed, sizeof seed);
+			shake_flip(&sc);
+
+			/* Signed values (last test uses the extreme values). */
+			for (size_t j = 0; j < n; j ++) {
+				uint8_t v[2];
+				shake_extract(&sc, v, 2);
+				int32_t x = (int32_t)((v[0] | (v[1] << 8)) % 4095)
+					- 2047;
+				if (i == 19) {
+					x = (j & 1) != 0 ? 2047 : -2047;
+				}
+				a1[j] = (uint16_t)x;
+			}
+			memcpy(a2, a1, 2 * n);
+			if (avx2_mqpoly_sqnorm_signed(logn, a1)
+				!= avx512_mqpoly_sqnorm_signed(logn, a2))
+			{
+				fprintf(stderr, "ERR sqnorm_signed\n");
+				exit(EXIT_FAILURE);
+			}
+			avx2_mqpoly_signed_to_int(logn, a1);
+			avx512_mqpoly_signed_to_int(logn, a2);
+			check_eq(a1, a2, 2 * n, "signed_to_int");
+
+			/* NTT and inverse NTT. */
+			avx2_mqpoly_int_to_ntt(logn, a1);
+			avx512_mqpoly_int_to_ntt(logn, a2);
+			check_eq(a1, a2, 2 * n, "int_to_ntt");
+
+			/* External values; the last test uses q-1 (largest
+			   norm) and includes zeros in b. */
+			for (size_t j = 0; j < n; j ++) {
+				uint8_t v[4];
+				shake_extract(&sc, v, 4);
+				b1[j] = (v[0] | (v[1] << 8)) % 12289;
+				if (i == 19) {
+					b1[j] = (j & 3) != 0 ? 12288 : 0;
+				}
+			}
+			memcpy(b2, b1, 2 * n);
+			if (avx2_mqpoly_sqnorm_ext(logn, b1)
+				!= avx512_mqpoly_sqnorm_ext(logn, b2))
+			{
+				fprintf(stderr, "ERR sqnorm_ext\n");
+				exit(EXIT_FAILURE);
+			}
+			avx2_mqpoly_ext_to_int(logn, b1);
+			avx512_mqpoly_ext_to_int(logn, b2);
+			check_eq(b1, b2, 2 * n, "ext_to_int");
+
+			avx2_mqpoly_mul_ntt(logn, a1, b1);
+			avx512_mqpoly_mul_ntt(logn, a2, b2);
+			check_eq(a1, a2, 2 * n, "mul_ntt");
+			int r1 = avx2_mqpoly_div_ntt(logn, a1, b1);
+			int r2 = avx512_mqpoly_div_ntt(logn, a2, b2);
+			if (r1 != r2) {
+				fprintf(stderr, "ERR div_ntt (status)\n");
+				exit(EXIT_FAILURE);
+			}
+			check_eq(a1, a2, 2 * n, "div_ntt");
+
+			avx2_mqpoly_ntt_to_int(logn, a1);
+			avx512_mqpoly_ntt_to_int(logn, a2);
+			check_eq(a1, a2, 2 * n, "ntt_to_int");
+			avx2_mqpoly_sub(logn, a1, b1);
+			avx512_mqpoly_sub(logn, a2, b2);
+			check_eq(a1, a2, 2 * n, "sub");
+			avx2_mqpoly_int_to_ext(logn, a1);
+			avx512_mqpoly_int_to_ext(logn, a2);
+			check_eq(a1, a2, 2 * n, "int_to_ext");
+		}
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+#endif
+
 NOINLINE
 static void
 test_fpr(void)
@@ -2615,6 +3437,20 @@ inner_test_sample_f(unsigned logn, const char *sref)
 	uint8_t *t = xmalloc(n);
 	hextobin(t, n, sref);
 	check_eq(f, t, n, "OUT");
+#if FNDSA_AVX2
+	if (has_avx2()) {
+#if FNDSA_SHAKE256X4
+		shake256x4_init(&pc, &x, 1);
+#else
+		shake_init(&pc, 256);
+		shake_inject(&pc, &x, 1);
+		shake_flip(&pc);
+#endif
+		memset(f, 0, n);
+		avx2_sample_f(logn, &pc, f);
+		check_eq(f, t, n, "OUT (AVX2)");
+	}
+#endif
 	xfree(f);
 	xfree(t);
 
@@ -2744,6 +3580,68 @@ check_keypair(unsigned logn, const uint8_t *skey, const uint8_t *vkey,
 	xfree(tmp);
 }
 
+NOINLINE
+static void
+test_twiddle_cache(void)
+{
+	printf("Test twiddle cache: ");
+	fflush(stdout);
+
+	uint32_t *gm = xmalloc(1024 * sizeof *gm);
+	uint32_t *igm = xmalloc(1024 * sizeof *igm);
+	uint32_t *buf1 = xmalloc(1024 * sizeof *buf1);
+	uint32_t *buf2 = xmalloc(1024 * sizeof *buf2);
+	for (unsigned logn = 1; logn <= 10; logn ++) {
+		size_t n = (size_t)1 << logn;
+		for (size_t i = 0; i < 308; i ++) {
+			uint32_t p = PRIMES[i].p;
+			uint32_t p0i = PRIMES[i].p0i;
+			mp_mkgmigm(logn, gm, igm,
+				PRIMES[i].g, PRIMES[i].ig, p, p0i);
+			const uint32_t *t1 = mp_get_gm(logn, i, buf1);
+			const uint32_t *t2 = mp_get_igm(logn, i, buf2);
+			check_eq(t1, gm, n * sizeof *gm, "gm");
+			check_eq(t2, igm, n * sizeof *igm, "igm");
+			mp_get_gmigm(logn, i, &t1, &t2, buf1, buf2);
+			check_eq(t1, gm, n * sizeof *gm, "gm (2)");
+			check_eq(t2, igm, n * sizeof *igm, "igm (2)");
+#if FNDSA_AVX2
+			if (has_avx2()) {
+				t1 = avx2_mp_get_gm(logn, i, buf1);
+				t2 = avx2_mp_get_igm(logn, i, buf2);
+				check_eq(t1, gm, n * sizeof *gm, "gm (AVX2)");
+				check_eq(t2, igm, n * sizeof *igm, "igm (AVX2)");
+				avx2_mp_get_gmigm(logn, i, &t1, &t2, buf1, buf2);
+				check_eq(t1, gm, n * sizeof *gm, "gm (AVX2 2)");
+				check_eq(t2, igm, n * sizeof *igm,
+					"igm (AVX2 2)");
+			}
+#endif
+		}
+		printf(".");
+		fflush(stdout);
+	}
+	xfree(gm);
+	xfree(igm);
+	xfree(buf1);
+	xfree(buf2);
+
+	/* Key pair generation must not depend on the cache. */
+	uint8_t sk1[FNDSA_SIGN_KEY_SIZE(9)];
+	uint8_t vk1[FNDSA_VRFY_KEY_SIZE(9)];
+	uint8_t sk2[FNDSA_SIGN_KEY_SIZE(9)];
+	uint8_t vk2[FNDSA_VRFY_KEY_SIZE(9)];
+	fndsa_keygen_seeded(9, "twiddle", 7, sk1, vk1);
+	mp_twiddle_cache_enable(0);
+	fndsa_keygen_seeded(9, "twiddle", 7, sk2, vk2);
+	mp_twiddle_cache_enable(1);
+	check_eq(sk1, sk2, sizeof sk1, "keygen sk");
+	check_eq(vk1, vk2, sizeof vk1, "keygen vk");
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
 NOINLINE
 static void
 test_keygen_self(void)
@@ -2788,6 +3686,246 @@ test_keygen_self(void)
 	fflush(stdout);
 }
 
+NOINLINE
+static void
+test_keygen_mt(void)
+{
+	printf("Test keygen (multi-threaded):");
+	fflush(stdout);
+
+	for (unsigned logn = 2; logn <= 10; logn ++) {
+		printf(" ");
+		fflush(stdout);
+
+		size_t sk_len = FNDSA_SIGN_KEY_SIZE(logn);
+		size_t vk_len = FNDSA_VRFY_KEY_SIZE(logn);
+		uint8_t *sk1 = xmalloc(sk_len);
+		uint8_t *vk1 = xmalloc(vk_len);
+		uint8_t *sk2 = xmalloc(sk_len);
+		uint8_t *vk2 = xmalloc(vk_len);
+		for (int i = 0; i < 3; i ++) {
+			uint8_t seed[3];
+
+			seed[0] = 'M';
+			seed[1] = logn;
+			seed[2] = i;
+			fndsa_keygen_seeded(logn, seed, sizeof seed, sk1, vk1);
+			for (unsigned nt = 0; nt <= 4; nt ++) {
+				fndsa_keygen_seeded_mt(logn, nt,
+					seed, sizeof seed, sk2, vk2);
+				check_eq(sk1, sk2, sk_len, "keygen_mt sk");
+				check_eq(vk1, vk2, vk_len, "keygen_mt vk");
+			}
+			printf(".");
+			fflush(stdout);
+		}
+		if (!fndsa_keygen_mt(logn, 3, sk2, vk2)) {
+			fprintf(stderr, "keygen_mt failed\n");
+			exit(EXIT_FAILURE);
+		}
+		xfree(sk1);
+		xfree(vk1);
+		xfree(sk2);
+		xfree(vk2);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+#if FNDSA_AVX512
+/* Compare the AVX-512F key pair generation code with the AVX2 one. */
+NOINLINE
+static void
+test_keygen_avx512(void)
+{
+	printf("Test keygen (AVX-512): ");
+	fflush(stdout);
+	if (!has_avx512()) {
+		printf("not supported.\n");
+		fflush(stdout);
+		return;
+	}
+
+	/* Reduction of big integers modulo small primes; the first tests
+	   use integers with all bits set. */
+	uint32_t *d = xmalloc(320 * 64 * sizeof *d);
+	uint32_t r1[64], r2[64];
+	shake_context sc;
+	shake_init(&sc, 256);
+	shake_inject(&sc, "zint", 4);
+	shake_flip(&sc);
+	for (int t = 0; t < 300; t ++) {
+		uint32_t v[3];
+		shake_extract(&sc, v, sizeof v);
+		size_t len = 1 + v[0] % 320;
+		size_t num = 1 + v[1] % 64;
+		size_t i = v[2] % 308;
+		shake_extract(&sc, d, len * num * sizeof *d);
+		for (size_t j = 0; j < len * num; j ++) {
+			d[j] = t < 10 ? 0x7FFFFFFF : (d[j] & 0x7FFFFFFF);
+		}
+		uint32_t p = PRIMES[i].p;
+		uint32_t p0i = PRIMES[i].p0i;
+		uint32_t R2 = PRIMES[i].R2;
+		uint32_t Rx = mp_Rx31((unsigned)len, p, p0i, R2);
+
+		set_simd_tier_max(SIMD_TIER_AVX2);
+		for (size_t j = 0; j < num; j ++) {
+			r1[j] = zint_mod_small_signed(d + j, len, num,
+				p, p0i, R2, Rx);
+		}
+		set_simd_tier_max(SIMD_TIER_AVX512);
+		for (size_t j = 0; j < num; j ++) {
+			r2[j] = zint_mod_small_signed(d + j, len, num,
+				p, p0i, R2, Rx);
+		}
+		check_eq(r1, r2, num * sizeof *r1, "mod_small_signed");
+		memset(r2, 0, sizeof r2);
+		avx2_zint_mod_small_signed_row(r2, d, len, num, num,
+			p, p0i, R2, Rx);
+		check_eq(r1, r2, num * sizeof *r1, "mod_small_signed_row");
+		if (t % 30 == 0) {
+			printf(".");
+			fflush(stdout);
+		}
+	}
+	xfree(d);
+
+	/* Key pair generation must yield the same keys. */
+	for (unsigned logn = 2; logn <= 10; logn ++) {
+		size_t sk_len = FNDSA_SIGN_KEY_SIZE(logn);
+		size_t vk_len = FNDSA_VRFY_KEY_SIZE(logn);
+		uint8_t *sk1 = xmalloc(sk_len);
+		uint8_t *vk1 = xmalloc(vk_len);
+		uint8_t *sk2 = xmalloc(sk_len);
+		uint8_t *vk2 = xmalloc(vk_len);
+		for (int i = 0; i < 3; i ++) {
+			uint8_t seed[3];
+
+			seed[0] = 'X';
+			seed[1] = logn;
+			seed[2] = i;
+			set_simd_tier_max(SIMD_TIER_AVX2);
+			fndsa_keygen_seeded(logn, seed, sizeof seed, sk1, vk1);
+			set_simd_tier_max(SIMD_TIER_AVX512);
+			fndsa_keygen_seeded(logn, seed, sizeof seed, sk2, vk2);
+			check_eq(sk1, sk2, sk_len, "keygen AVX-512 sk");
+			check_eq(vk1, vk2, vk_len, "keygen AVX-512 vk");
+		}
+		printf(".");
+		fflush(stdout);
+		xfree(sk1);
+		xfree(vk1);
+		xfree(sk2);
+		xfree(vk2);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+#endif
+
+#if FNDSA_KEYGEN_MT || FNDSA_SIGN_ENGINE
+/* Wait until a pool (key pair pool or randomness pool) reports at least
+   k available entries, sleeping between checks. The test fails if this
+   takes more than a minute (e.g. if a worker thread died). */
+static void
+wait_available(size_t (*available)(void *pool), void *pool, size_t k,
+	const char *name)
+{
+	struct timespec ts;
+	ts.tv_sec = 0;
+	ts.tv_nsec = 1000000;
+	for (int i = 0; i < 60000; i ++) {
+		if (available(pool) >= k) {
+			return;
+		}
+		nanosleep(&ts, NULL);
+	}
+	fprintf(stderr, "%s: timeout waiting for %zu entries\n", name, k);
+	exit(EXIT_FAILURE);
+}
+#endif
+
+#if FNDSA_KEYGEN_MT
+static size_t
+keypool_available(void *pool)
+{
+	return fndsa_keypool_available(pool);
+}
+#endif
+
+NOINLINE
+static void
+test_keypool(void)
+{
+	printf("Test key pair pool: ");
+	fflush(stdout);
+
+#if FNDSA_KEYGEN_MT
+	size_t mem_len = fndsa_keypool_size(9, 3, 2);
+	if (mem_len == 0 || fndsa_keypool_size(9, 0, 2) != 0
+		|| fndsa_keypool_size(9, 3, 0) != 0
+		|| fndsa_keypool_size(11, 3, 2) != 0)
+	{
+		fprintf(stderr, "wrong key pool size\n");
+		exit(EXIT_FAILURE);
+	}
+	void *mem = xmalloc(mem_len);
+	if (fndsa_keypool_create(9, 3, 2, mem, mem_len - 1) != NULL) {
+		fprintf(stderr, "undersized key pool area accepted\n");
+		exit(EXIT_FAILURE);
+	}
+	fndsa_keypool *kp = fndsa_keypool_create(9, 3, 2, mem, mem_len);
+	if (kp == NULL) {
+		fprintf(stderr, "key pool creation failed\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/* Take more key pairs than the ring capacity; all must be valid
+	   and distinct. */
+	uint8_t sk[8][FNDSA_SIGN_KEY_SIZE(9)];
+	uint8_t vk[8][FNDSA_VRFY_KEY_SIZE(9)];
+	int8_t f[512], g[512], F[512], G[512];
+	for (int i = 0; i < 8; i ++) {
+		if (!fndsa_keypool_take(kp, sk[i], vk[i], 1)) {
+			fprintf(stderr, "key pool take failed\n");
+			exit(EXIT_FAILURE);
+		}
+		check_keypair(9, sk[i], vk[i], f, g, F, G);
+		for (int j = 0; j < i; j ++) {
+			if (memcmp(vk[i], vk[j], sizeof vk[i]) == 0) {
+				fprintf(stderr, "duplicate key pair\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+		printf(".");
+		fflush(stdout);
+	}
+
+	/* The ring fills up to its capacity. */
+	wait_available(keypool_available, kp, 3, "key pool");
+	if (fndsa_keypool_available(kp) != 3
+		|| !fndsa_keypool_take(kp, sk[0], NULL, 0)
+		|| !fndsa_keypool_take(kp, NULL, vk[0], 0))
+	{
+		fprintf(stderr, "key pool not filled\n");
+		exit(EXIT_FAILURE);
+	}
+	fndsa_keypool_destroy(kp);
+	xfree(mem);
+#else
+	if (fndsa_keypool_size(9, 3, 2) != 0) {
+		fprintf(stderr, "key pool should not be supported\n");
+		exit(EXIT_FAILURE);
+	}
+#endif
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
 #if FNDSA_SHAKE256X4
 static const char *const KAT_KG256[] = {
 	"77ebf1d3458617076b4bf2d536f773a35c70ebb698c0dacb1c37e5d3874967b1",
@@ -4262,7 +5400,24 @@ inner_test_verify(unsigned logn, const char *s_vk,
 		fprintf(stderr, "verification failed\n");
 		exit(EXIT_FAILURE);
 	}
-	msg[0] ^= 0x01;
+
+	/* Streaming verification, with the message in two chunks. */
+	fndsa_verify_context vc;
+	if (!fndsa_verify_init(&vc, sig, sig_len, vk, vk_len,
+		NULL, 0, "\xFF"))
+	{
+		fprintf(stderr, "streaming verification init failed\n");
+		exit(EXIT_FAILURE);
+	}
+	fndsa_verify_update(&vc, msg, msg_len >> 1);
+	fndsa_verify_update(&vc, msg + (msg_len >> 1),
+		msg_len - (msg_len >> 1));
+	if (!fndsa_verify_final(&vc)) {
+		fprintf(stderr, "streaming verification failed\n");
+		exit(EXIT_FAILURE);
+	}
+
+	msg[0] ^= 0x01;
 	if (fndsa_verify_temp(sig, sig_len, vk, vk_len,
 		NULL, 0, "\xFF", msg, msg_len, tmp, tmp_len))
 	{
@@ -4408,6 +5563,1250 @@ test_self(void)
 	fflush(stdout);
 }
 
+NOINLINE
+static void
+test_verify_prepared(void)
+{
+	printf("Test verify prepared: ");
+	fflush(stdout);
+
+	for (unsigned logn = 2; logn <= 10; logn ++) {
+		printf("[%u]", logn);
+		fflush(stdout);
+		size_t sk_len = FNDSA_SIGN_KEY_SIZE(logn);
+		size_t vk_len = FNDSA_VRFY_KEY_SIZE(logn);
+		size_t sig_len = FNDSA_SIGNATURE_SIZE(logn);
+		size_t pvk_len = FNDSA_VRFY_KEY_PREPARED_SIZE(logn);
+		uint8_t *sk = xmalloc(sk_len);
+		uint8_t *vk = xmalloc(vk_len);
+		uint8_t *sig = xmalloc(sig_len);
+		uint8_t *pvk = xmalloc(pvk_len + 1);
+		size_t kgentmp_len = ((size_t)26 << logn) + 31;
+		size_t signtmp_len = ((size_t)59 << logn) + 31;
+		size_t vrfytmp_len = ((size_t)4 << logn) + 31;
+		void *tmp = xmalloc(signtmp_len);
+		int weak = logn <= 8;
+		for (int i = 0; i < 5; i ++) {
+			if (!fndsa_keygen_temp(logn,
+				sk, vk, tmp, kgentmp_len))
+			{
+				fprintf(stderr, "keygen failed\n");
+				exit(EXIT_FAILURE);
+			}
+
+			/* Preparation into an undersized buffer must fail;
+			   we use an unaligned buffer. */
+			if (fndsa_verify_key_prepare(vk, vk_len,
+				pvk + 1, pvk_len - 1))
+			{
+				fprintf(stderr, "prepare should have failed\n");
+				exit(EXIT_FAILURE);
+			}
+			if (!fndsa_verify_key_prepare(vk, vk_len,
+				pvk + 1, pvk_len))
+			{
+				fprintf(stderr, "prepare failed\n");
+				exit(EXIT_FAILURE);
+			}
+
+			size_t j;
+			if (weak) {
+				j = fndsa_sign_weak_temp(sk, sk_len,
+					"ctx", 3, FNDSA_HASH_ID_RAW,
+					"test", 4, sig, sig_len,
+					tmp, signtmp_len);
+			} else {
+				j = fndsa_sign_temp(sk, sk_len,
+					"ctx", 3, FNDSA_HASH_ID_RAW,
+					"test", 4, sig, sig_len,
+					tmp, signtmp_len);
+			}
+			if (j != sig_len) {
+				fprintf(stderr, "signature failed\n");
+				exit(EXIT_FAILURE);
+			}
+
+			/* Prepared verification must agree with the plain
+			   verification, including on altered signatures. */
+			for (size_t k = 0; k <= 16; k ++) {
+				size_t bit = 0;
+				if (k > 0) {
+					bit = (size_t)(k * 977) % (sig_len << 3);
+					sig[bit >> 3] ^= 1 << (bit & 7);
+				}
+				const char *msg = (k & 1) ? "blah" : "test";
+				int r0, r1, r2;
+				if (weak) {
+					r0 = fndsa_verify_weak_temp(sig,
+						sig_len, vk, vk_len, "ctx", 3,
+						FNDSA_HASH_ID_RAW, msg, 4,
+						tmp, vrfytmp_len);
+					r1 = fndsa_verify_weak_prepared(sig,
+						sig_len, pvk + 1, pvk_len,
+						"ctx", 3, FNDSA_HASH_ID_RAW,
+						msg, 4);
+					r2 = fndsa_verify_weak_prepared_temp(
+						sig, sig_len, pvk + 1, pvk_len,
+						"ctx", 3, FNDSA_HASH_ID_RAW,
+						msg, 4, tmp, vrfytmp_len);
+				} else {
+					r0 = fndsa_verify_temp(sig, sig_len,
+						vk, vk_len, "ctx", 3,
+						FNDSA_HASH_ID_RAW, msg, 4,
+						tmp, vrfytmp_len);
+					r1 = fndsa_verify_prepared(sig,
+						sig_len, pvk + 1, pvk_len,
+						"ctx", 3, FNDSA_HASH_ID_RAW,
+						msg, 4);
+					r2 = fndsa_verify_prepared_temp(
+						sig, sig_len, pvk + 1, pvk_len,
+						"ctx", 3, FNDSA_HASH_ID_RAW,
+						msg, 4, tmp, vrfytmp_len);
+				}
+				if (r0 != (k == 0) || r1 != r0 || r2 != r0) {
+					fprintf(stderr, "prepared verify"
+						" mismatch (%zu: %d %d %d)\n",
+						k, r0, r1, r2);
+					exit(EXIT_FAILURE);
+				}
+				if (k > 0) {
+					sig[bit >> 3] ^= 1 << (bit & 7);
+				}
+			}
+
+			/* The degree category is enforced. */
+			int r;
+			if (weak) {
+				r = fndsa_verify_prepared(sig, sig_len,
+					pvk + 1, pvk_len, "ctx", 3,
+					FNDSA_HASH_ID_RAW, "test", 4);
+			} else {
+				r = fndsa_verify_weak_prepared(sig, sig_len,
+					pvk + 1, pvk_len, "ctx", 3,
+					FNDSA_HASH_ID_RAW, "test", 4);
+			}
+			if (r) {
+				fprintf(stderr, "verify should have failed"
+					" (wrong degree)\n");
+				exit(EXIT_FAILURE);
+			}
+			printf(".");
+			fflush(stdout);
+		}
+
+		xfree(sk);
+		xfree(vk);
+		xfree(sig);
+		xfree(pvk);
+		xfree(tmp);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+NOINLINE
+static void
+test_verify_batch(void)
+{
+	printf("Test verify batch: ");
+	fflush(stdout);
+
+	for (unsigned logn = 2; logn <= 10; logn ++) {
+		printf("[%u]", logn);
+		fflush(stdout);
+		size_t sk_len = FNDSA_SIGN_KEY_SIZE(logn);
+		size_t vk_len = FNDSA_VRFY_KEY_SIZE(logn);
+		size_t sig_len = FNDSA_SIGNATURE_SIZE(logn);
+		int weak = logn <= 8;
+
+		/* Three keys; signatures use keys in sequences, so that
+		   both key reuse and key changes are exercised. The other
+		   degree category is represented by a key for logn = 9
+		   (or 8). */
+		uint8_t *sk = xmalloc(3 * sk_len);
+		uint8_t *vk = xmalloc(3 * vk_len);
+		unsigned logn_x = weak ? 9 : 8;
+		uint8_t *sk_x = xmalloc(FNDSA_SIGN_KEY_SIZE(logn_x));
+		uint8_t *vk_x = xmalloc(FNDSA_VRFY_KEY_SIZE(logn_x));
+		uint8_t *sig_x = xmalloc(FNDSA_SIGNATURE_SIZE(logn_x));
+		for (int j = 0; j < 3; j ++) {
+			fndsa_keygen(logn, sk + j * sk_len, vk + j * vk_len);
+		}
+		fndsa_keygen(logn_x, sk_x, vk_x);
+		if (weak) {
+			fndsa_sign(sk_x, FNDSA_SIGN_KEY_SIZE(logn_x),
+				NULL, 0, FNDSA_HASH_ID_RAW, "x", 1,
+				sig_x, FNDSA_SIGNATURE_SIZE(logn_x));
+		} else {
+			fndsa_sign_weak(sk_x, FNDSA_SIGN_KEY_SIZE(logn_x),
+				NULL, 0, FNDSA_HASH_ID_RAW, "x", 1,
+				sig_x, FNDSA_SIGNATURE_SIZE(logn_x));
+		}
+
+#define NUM_BATCH   19
+		static const uint8_t key_idx[NUM_BATCH] = {
+			0, 0, 0, 0, 0, 1, 1, 0, 2, 2, 2, 1, 0, 0, 1, 2, 2, 0, 0
+		};
+		uint8_t *sig = xmalloc(NUM_BATCH * sig_len);
+		uint8_t msg[NUM_BATCH][5];
+		fndsa_verify_msg vm[NUM_BATCH];
+		for (size_t i = 0; i < NUM_BATCH; i ++) {
+			unsigned kk = key_idx[i];
+			msg[i][0] = 'm';
+			msg[i][1] = (uint8_t)i;
+			msg[i][2] = (uint8_t)logn;
+			msg[i][3] = (uint8_t)kk;
+			msg[i][4] = 0;
+			size_t j;
+			if (weak) {
+				j = fndsa_sign_weak(sk + kk * sk_len, sk_len,
+					"c", 1, FNDSA_HASH_ID_RAW,
+					msg[i], 5 - (i & 1),
+					sig + i * sig_len, sig_len);
+			} else {
+				j = fndsa_sign(sk + kk * sk_len, sk_len,
+					"c", 1, FNDSA_HASH_ID_RAW,
+					msg[i], 5 - (i & 1),
+					sig + i * sig_len, sig_len);
+			}
+			if (j != sig_len) {
+				fprintf(stderr, "signature failed\n");
+				exit(EXIT_FAILURE);
+			}
+			vm[i].sig = sig + i * sig_len;
+			vm[i].sig_len = sig_len;
+			vm[i].vrfy_key = vk + kk * vk_len;
+			vm[i].vrfy_key_len = vk_len;
+			vm[i].ctx = "c";
+			vm[i].ctx_len = 1;
+			vm[i].id = FNDSA_HASH_ID_RAW;
+			vm[i].hv = msg[i];
+			vm[i].hv_len = 5 - (i & 1);
+		}
+
+		/* Invalid entries: altered signature, altered message,
+		   wrong key, and a signature of the other degree category. */
+		sig[3 * sig_len + sig_len / 2] ^= 0x04;
+		msg[6][0] ^= 0x01;
+		vm[10].vrfy_key = vk;
+		vm[13].sig = sig_x;
+		vm[13].sig_len = FNDSA_SIGNATURE_SIZE(logn_x);
+		vm[13].vrfy_key = vk_x;
+		vm[13].vrfy_key_len = FNDSA_VRFY_KEY_SIZE(logn_x);
+
+		for (size_t num = 1; num <= NUM_BATCH; num += 3) {
+			uint8_t res[(NUM_BATCH + 7) >> 3];
+			size_t r;
+			memset(res, 0xFF, sizeof res);
+			if (weak) {
+				r = fndsa_verify_weak_batch(vm, num, res);
+			} else {
+				r = fndsa_verify_batch(vm, num, res);
+			}
+			size_t good = 0;
+			for (size_t i = 0; i < num; i ++) {
+				int r1;
+				if (weak) {
+					r1 = fndsa_verify_weak(vm[i].sig,
+						vm[i].sig_len, vm[i].vrfy_key,
+						vm[i].vrfy_key_len, "c", 1,
+						FNDSA_HASH_ID_RAW, vm[i].hv,
+						vm[i].hv_len);
+				} else {
+					r1 = fndsa_verify(vm[i].sig,
+						vm[i].sig_len, vm[i].vrfy_key,
+						vm[i].vrfy_key_len, "c", 1,
+						FNDSA_HASH_ID_RAW, vm[i].hv,
+						vm[i].hv_len);
+				}
+				int expected = i != 3 && i != 6
+					&& i != 10 && i != 13;
+				int r2 = (res[i >> 3] >> (i & 7)) & 1;
+				if (r1 != expected || r2 != expected) {
+					fprintf(stderr, "batch verify mismatch"
+						" (num=%zu i=%zu: %d %d %d)\n",
+						num, i, expected, r1, r2);
+					exit(EXIT_FAILURE);
+				}
+				good += (size_t)expected;
+			}
+			for (size_t i = num; i < ((num + 7) & ~(size_t)7); i ++) {
+				if (((res[i >> 3] >> (i & 7)) & 1) != 0) {
+					fprintf(stderr, "batch verify:"
+						" spurious bit %zu\n", i);
+					exit(EXIT_FAILURE);
+				}
+			}
+			if (r != good) {
+				fprintf(stderr, "batch verify: wrong count"
+					" (%zu / %zu)\n", r, good);
+				exit(EXIT_FAILURE);
+			}
+			printf(".");
+			fflush(stdout);
+		}
+#undef NUM_BATCH
+
+		xfree(sk);
+		xfree(vk);
+		xfree(sk_x);
+		xfree(vk_x);
+		xfree(sig_x);
+		xfree(sig);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+/* Verify a signature with the streaming API, injecting the message in
+   chunks whose lengths are taken (cyclically) from chunks[]. */
+static int
+verify_stream_chunks(int weak, const uint8_t *sig, size_t sig_len,
+	const uint8_t *vk, size_t vk_len, const char *id,
+	const uint8_t *msg, size_t msg_len,
+	const size_t *chunks, size_t num_chunks)
+{
+	fndsa_verify_context vc;
+	if (weak) {
+		fndsa_verify_weak_init(&vc, sig, sig_len, vk, vk_len,
+			"ctx", 3, id);
+	} else {
+		fndsa_verify_init(&vc, sig, sig_len, vk, vk_len,
+			"ctx", 3, id);
+	}
+	size_t u = 0;
+	for (size_t off = 0; off < msg_len;) {
+		size_t clen = chunks[u];
+		u = (u + 1) % num_chunks;
+		if (clen > msg_len - off) {
+			clen = msg_len - off;
+		}
+		fndsa_verify_update(&vc, msg + off, clen);
+		off += clen;
+	}
+	return fndsa_verify_final(&vc);
+}
+
+NOINLINE
+static void
+test_verify_stream(void)
+{
+	printf("Test verify stream: ");
+	fflush(stdout);
+
+	static const size_t chunks1[] = { 1 };
+	static const size_t chunks2[] = { 136 };
+	static const size_t chunks3[] = { 3, 0, 135, 137, 1, 500, 7 };
+	static const size_t chunks4[] = { 100000 };
+	static const struct {
+		const size_t *c;
+		size_t num;
+	} chunk_seqs[] = {
+		{ chunks1, 1 }, { chunks2, 1 }, { chunks3, 7 }, { chunks4, 1 }
+	};
+
+	size_t msg_len = 1500;
+	uint8_t *msg = xmalloc(msg_len);
+	for (size_t i = 0; i < msg_len; i ++) {
+		msg[i] = (uint8_t)(i * 17 + 5);
+	}
+	for (unsigned logn = 2; logn <= 10; logn ++) {
+		printf("[%u]", logn);
+		fflush(stdout);
+		size_t sk_len = FNDSA_SIGN_KEY_SIZE(logn);
+		size_t vk_len = FNDSA_VRFY_KEY_SIZE(logn);
+		size_t sig_len = FNDSA_SIGNATURE_SIZE(logn);
+		uint8_t *sk = xmalloc(sk_len);
+		uint8_t *vk = xmalloc(vk_len);
+		uint8_t *sig = xmalloc(sig_len);
+		int weak = logn <= 8;
+		fndsa_keygen(logn, sk, vk);
+
+		for (int i = 0; i < 4; i ++) {
+			/* Even iterations use a raw message, odd ones a
+			   pre-hashed message (with SHA3-256). */
+			const char *id;
+			size_t mlen;
+			if ((i & 1) == 0) {
+				id = FNDSA_HASH_ID_RAW;
+				mlen = msg_len - (size_t)i * 100;
+			} else {
+				id = FNDSA_HASH_ID_SHA3_256;
+				mlen = 32;
+			}
+			size_t j;
+			if (weak) {
+				j = fndsa_sign_weak(sk, sk_len, "ctx", 3,
+					id, msg, mlen, sig, sig_len);
+			} else {
+				j = fndsa_sign(sk, sk_len, "ctx", 3,
+					id, msg, mlen, sig, sig_len);
+			}
+			if (j != sig_len) {
+				fprintf(stderr, "signature failed\n");
+				exit(EXIT_FAILURE);
+			}
+
+			/* Streaming verification must agree with the plain
+			   verification, including on altered signatures and
+			   messages. */
+			for (size_t k = 0; k <= 6; k ++) {
+				size_t bit = 0;
+				if (k >= 1 && k <= 3) {
+					bit = (k * 977) % (sig_len << 3);
+					sig[bit >> 3] ^= 1 << (bit & 7);
+				} else if (k >= 4) {
+					bit = (k * 1231) % (mlen << 3);
+					msg[bit >> 3] ^= 1 << (bit & 7);
+				}
+				int r0;
+				if (weak) {
+					r0 = fndsa_verify_weak(sig, sig_len,
+						vk, vk_len, "ctx", 3,
+						id, msg, mlen);
+				} else {
+					r0 = fndsa_verify(sig, sig_len,
+						vk, vk_len, "ctx", 3,
+						id, msg, mlen);
+				}
+				if (r0 != (k == 0)) {
+					fprintf(stderr, "verify: wrong result"
+						" (%zu: %d)\n", k, r0);
+					exit(EXIT_FAILURE);
+				}
+				for (size_t u = 0; u < 4; u ++) {
+					int r1 = verify_stream_chunks(weak,
+						sig, sig_len, vk, vk_len, id,
+						msg, mlen, chunk_seqs[u].c,
+						chunk_seqs[u].num);
+					if (r1 != r0) {
+						fprintf(stderr, "stream verify"
+							" mismatch (%zu, %zu:"
+							" %d %d)\n",
+							k, u, r0, r1);
+						exit(EXIT_FAILURE);
+					}
+				}
+				if (k >= 1 && k <= 3) {
+					sig[bit >> 3] ^= 1 << (bit & 7);
+				} else if (k >= 4) {
+					msg[bit >> 3] ^= 1 << (bit & 7);
+				}
+			}
+
+			/* The degree category is enforced, and a context
+			   that failed initialization never validates. A
+			   context cannot be finalized twice. */
+			fndsa_verify_context vc;
+			int r;
+			if (weak) {
+				r = fndsa_verify_init(&vc, sig, sig_len,
+					vk, vk_len, "ctx", 3, id);
+			} else {
+				r = fndsa_verify_weak_init(&vc, sig, sig_len,
+					vk, vk_len, "ctx", 3, id);
+			}
+			fndsa_verify_update(&vc, msg, mlen);
+			if (r || fndsa_verify_final(&vc)) {
+				fprintf(stderr, "stream verify should have"
+					" failed (wrong degree)\n");
+				exit(EXIT_FAILURE);
+			}
+			if (weak) {
+				r = fndsa_verify_weak_init(&vc, sig, sig_len,
+					vk, vk_len, "ctx", 3, id);
+			} else {
+				r = fndsa_verify_init(&vc, sig, sig_len,
+					vk, vk_len, "ctx", 3, id);
+			}
+			fndsa_verify_update(&vc, msg, mlen);
+			if (!r || !fndsa_verify_final(&vc)
+				|| fndsa_verify_final(&vc))
+			{
+				fprintf(stderr, "stream verify: wrong"
+					" finalization\n");
+				exit(EXIT_FAILURE);
+			}
+			printf(".");
+			fflush(stdout);
+		}
+
+		xfree(sk);
+		xfree(vk);
+		xfree(sig);
+	}
+	xfree(msg);
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+static const char *const KAT_PREHASH[] = {
+	/* identifier index, message, hash value */
+	"0", "abc",
+	"ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+	"0", "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+	"248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+	"1", "abc",
+	"cb00753f45a35e8bb5a03d699ac65007272c32ab0eded1631a8b605a43ff5bed"
+	"8086072ba1e7cc2358baeca134c825a7",
+	"2", "abc",
+	"ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+	"2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f",
+	"2", "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmn"
+	"hijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu",
+	"8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018"
+	"501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909",
+	"3", "abc",
+	"53048e2681941ef99b2e29b76b4c7dabe4c2d0c634fc6d46e0e2f13107e7af23",
+	"4", "abc",
+	"3a985da74fe225b2045c172d6bd390bd855f086e3e9d525b46bfe24511431532",
+	"5", "abc",
+	"ec01498288516fc926459f58e2c6ad8df9b473cb0fc08c2596da7cf0e49be4b2"
+	"98d88cea927ac7f539f1edf228376d25",
+	"6", "abc",
+	"b751850b1a57168a5693cd924b6b096e08f621827444f70d884f5d0240d2712e"
+	"10e116e9192af3c91a7ec57647e3934057340b4cf408d5a56592f8274eec53f0",
+	"7", "abc",
+	"5881092dd818bf5cf8a3ddb793fbcba74097d5c526a6d35f97b83351940f2cc8",
+	"8", "abc",
+	"483366601360a8771c6863080cc4114d8db44530f8f1e1ee4f94ea37e78b5739"
+	"d5a15bef186a5386c75744c0527e1faa9f8726e462a12a4feb06bd8801e751e4",
+	NULL
+};
+
+NOINLINE
+static void
+test_prehash(void)
+{
+	printf("Test prehash: ");
+	fflush(stdout);
+
+	static const char *const ids[] = {
+		FNDSA_HASH_ID_SHA256, FNDSA_HASH_ID_SHA384,
+		FNDSA_HASH_ID_SHA512, FNDSA_HASH_ID_SHA512_256,
+		FNDSA_HASH_ID_SHA3_256, FNDSA_HASH_ID_SHA3_384,
+		FNDSA_HASH_ID_SHA3_512, FNDSA_HASH_ID_SHAKE128,
+		FNDSA_HASH_ID_SHAKE256
+	};
+	fndsa_prehash_context pc;
+
+	/* Unsupported identifiers are rejected. */
+	if (fndsa_prehash_init(&pc, FNDSA_HASH_ID_RAW)
+		|| fndsa_prehash_init(&pc,
+		"\x06\x09\x60\x86\x48\x01\x65\x03\x04\x02\x07"))
+	{
+		fprintf(stderr, "prehash: unsupported id accepted\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/* Known-answer tests; the message is also injected byte by byte
+	   (the context is reset after finalization). */
+	for (size_t i = 0; KAT_PREHASH[i] != NULL; i += 3) {
+		const char *id = ids[KAT_PREHASH[i][0] - '0'];
+		const char *msg = KAT_PREHASH[i + 1];
+		size_t msg_len = strlen(msg);
+		uint8_t ref[64], tmp[64];
+		size_t ref_len = hextobin(ref, sizeof ref, KAT_PREHASH[i + 2]);
+		if (!fndsa_prehash_init(&pc, id)) {
+			fprintf(stderr, "prehash: init failed\n");
+			exit(EXIT_FAILURE);
+		}
+		fndsa_prehash_update(&pc, msg, msg_len);
+		if (fndsa_prehash_final(&pc, tmp) != ref_len) {
+			fprintf(stderr, "prehash: wrong output length\n");
+			exit(EXIT_FAILURE);
+		}
+		check_eq(tmp, ref, ref_len, "KAT prehash 1");
+		for (size_t j = 0; j < msg_len; j ++) {
+			fndsa_prehash_update(&pc, msg + j, 1);
+		}
+		fndsa_prehash_final(&pc, tmp);
+		check_eq(tmp, ref, ref_len, "KAT prehash 2");
+		printf(".");
+		fflush(stdout);
+	}
+
+	/* Chunked input must match one-shot processing; for SHA-256, the
+	   output must match the reference implementation for all code
+	   paths (with and without the SHA extensions). */
+	size_t msg_len = 1000;
+	uint8_t *msg = xmalloc(msg_len);
+	for (size_t i = 0; i < msg_len; i ++) {
+		msg[i] = (uint8_t)(i * 31 + 7);
+	}
+	for (size_t u = 0; u < (sizeof ids) / (sizeof ids[0]); u ++) {
+		for (size_t len = 0; len <= msg_len; len += 37) {
+			uint8_t h1[64], h2[64];
+			fndsa_prehash_init(&pc, ids[u]);
+			fndsa_prehash_update(&pc, msg, len);
+			size_t hlen = fndsa_prehash_final(&pc, h1);
+			for (size_t j = 0; j < len;) {
+				size_t clen = (j * 7 + len) % 150;
+				if (clen > len - j) {
+					clen = len - j;
+				}
+				fndsa_prehash_update(&pc, msg + j, clen);
+				j += clen;
+			}
+			fndsa_prehash_final(&pc, h2);
+			check_eq(h1, h2, hlen, "prehash chunked");
+			if (u != 0) {
+				continue;
+			}
+			sha256_context sc;
+			sha256_init(&sc);
+			sha256_update(&sc, msg, len);
+			sha256_close(&sc, h2);
+			check_eq(h1, h2, 32, "prehash SHA-256 (ref)");
+			for (unsigned tier = SIMD_TIER_BASE;
+				tier <= SIMD_TIER_AVX2; tier ++)
+			{
+				set_simd_tier_max(tier);
+				fndsa_prehash_init(&pc, ids[u]);
+				fndsa_prehash_update(&pc, msg, len);
+				fndsa_prehash_final(&pc, h2);
+				check_eq(h1, h2, 32, "prehash SHA-256 (tier)");
+			}
+			set_simd_tier_max(SIMD_TIER_AVX512);
+		}
+		printf(".");
+		fflush(stdout);
+	}
+
+	/* Signing and verifying from a pre-hash context is equivalent to
+	   the pre-hashed mode with the hash value. */
+	for (unsigned logn = 8; logn <= 9; logn ++) {
+		size_t sk_len = FNDSA_SIGN_KEY_SIZE(logn);
+		size_t vk_len = FNDSA_VRFY_KEY_SIZE(logn);
+		size_t sig_len = FNDSA_SIGNATURE_SIZE(logn);
+		uint8_t *sk = xmalloc(sk_len);
+		uint8_t *vk = xmalloc(vk_len);
+		uint8_t *sig = xmalloc(sig_len);
+		int weak = logn <= 8;
+		fndsa_keygen(logn, sk, vk);
+		for (size_t u = 0; u < (sizeof ids) / (sizeof ids[0]); u ++) {
+			uint8_t hv[64];
+			fndsa_prehash_init(&pc, ids[u]);
+			fndsa_prehash_update(&pc, msg, msg_len);
+			size_t hv_len = fndsa_prehash_final(&pc, hv);
+			fndsa_prehash_update(&pc, msg, msg_len);
+			size_t j;
+			if (weak) {
+				j = fndsa_sign_weak_prehash(sk, sk_len,
+					"ctx", 3, &pc, sig, sig_len);
+			} else {
+				j = fndsa_sign_prehash(sk, sk_len,
+					"ctx", 3, &pc, sig, sig_len);
+			}
+			if (j != sig_len) {
+				fprintf(stderr, "prehash: signature failed\n");
+				exit(EXIT_FAILURE);
+			}
+			int r0, r1, r2;
+			if (weak) {
+				r0 = fndsa_verify_weak(sig, sig_len, vk, vk_len,
+					"ctx", 3, ids[u], hv, hv_len);
+			} else {
+				r0 = fndsa_verify(sig, sig_len, vk, vk_len,
+					"ctx", 3, ids[u], hv, hv_len);
+			}
+			fndsa_prehash_update(&pc, msg, msg_len);
+			if (weak) {
+				r1 = fndsa_verify_weak_prehash(sig, sig_len,
+					vk, vk_len, "ctx", 3, &pc);
+			} else {
+				r1 = fndsa_verify_prehash(sig, sig_len,
+					vk, vk_len, "ctx", 3, &pc);
+			}
+			fndsa_prehash_update(&pc, msg, msg_len - 1);
+			if (weak) {
+				r2 = fndsa_verify_weak_prehash(sig, sig_len,
+					vk, vk_len, "ctx", 3, &pc);
+			} else {
+				r2 = fndsa_verify_prehash(sig, sig_len,
+					vk, vk_len, "ctx", 3, &pc);
+			}
+			if (!r0 || !r1 || r2) {
+				fprintf(stderr, "prehash: verify failed"
+					" (%d %d %d)\n", r0, r1, r2);
+				exit(EXIT_FAILURE);
+			}
+		}
+		xfree(sk);
+		xfree(vk);
+		xfree(sig);
+		printf(".");
+		fflush(stdout);
+	}
+	xfree(msg);
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+NOINLINE
+static void
+test_sign_expanded(void)
+{
+	printf("Test sign expanded: ");
+	fflush(stdout);
+
+	for (unsigned logn = 2; logn <= 10; logn ++) {
+		printf("[%u]", logn);
+		fflush(stdout);
+		size_t sk_len = FNDSA_SIGN_KEY_SIZE(logn);
+		size_t vk_len = FNDSA_VRFY_KEY_SIZE(logn);
+		size_t sig_len = FNDSA_SIGNATURE_SIZE(logn);
+		size_t esk_len = FNDSA_SIGN_KEY_EXPANDED_SIZE(logn);
+		uint8_t *sk = xmalloc(sk_len);
+		uint8_t *vk = xmalloc(vk_len);
+		uint8_t *sig1 = xmalloc(sig_len);
+		uint8_t *sig2 = xmalloc(sig_len);
+		uint8_t *esk = xmalloc(esk_len + 1);
+		size_t signtmp_len = ((size_t)59 << logn) + 31;
+		void *tmp = xmalloc(signtmp_len);
+		for (int i = 0; i < 10; i ++) {
+			uint8_t seed[10];
+			seed[0] = (uint8_t)logn;
+			seed[1] = (uint8_t)i;
+			memcpy(seed + 2, "expanded", 8);
+			fndsa_keygen_seeded(logn, seed, sizeof seed, sk, vk);
+
+			/* Use an odd offset to exercise the internal
+			   realignment of the expanded key. */
+			if (fndsa_sign_key_expand(sk, sk_len,
+				esk + (i & 1), esk_len - 1) != 0)
+			{
+				fprintf(stderr, "undersized expansion accepted\n");
+				exit(EXIT_FAILURE);
+			}
+			if (!fndsa_sign_key_expand(sk, sk_len,
+				esk + (i & 1), esk_len))
+			{
+				fprintf(stderr, "key expansion failed\n");
+				exit(EXIT_FAILURE);
+			}
+
+			size_t j1, j2, j3;
+			if (logn <= 8) {
+				j1 = fndsa_sign_weak_seeded_temp(sk, sk_len,
+					NULL, 0, FNDSA_HASH_ID_RAW, "test", 4,
+					seed, sizeof seed, sig1, sig_len,
+					tmp, signtmp_len);
+				j2 = fndsa_sign_weak_expanded_seeded(
+					esk + (i & 1), esk_len,
+					NULL, 0, FNDSA_HASH_ID_RAW, "test", 4,
+					seed, sizeof seed, sig2, sig_len);
+				j3 = fndsa_sign_expanded(
+					esk + (i & 1), esk_len,
+					NULL, 0, FNDSA_HASH_ID_RAW, "test", 4,
+					sig2, sig_len);
+			} else {
+				j1 = fndsa_sign_seeded_temp(sk, sk_len,
+					NULL, 0, FNDSA_HASH_ID_RAW, "test", 4,
+					seed, sizeof seed, sig1, sig_len,
+					tmp, signtmp_len);
+				j2 = fndsa_sign_expanded_seeded(
+					esk + (i & 1), esk_len,
+					NULL, 0, FNDSA_HASH_ID_RAW, "test", 4,
+					seed, sizeof seed, sig2, sig_len);
+				j3 = fndsa_sign_weak_expanded(
+					esk + (i & 1), esk_len,
+					NULL, 0, FNDSA_HASH_ID_RAW, "test", 4,
+					sig2, sig_len);
+			}
+			if (j1 != sig_len || j2 != sig_len) {
+				fprintf(stderr, "signature failed\n");
+				exit(EXIT_FAILURE);
+			}
+			if (j3 != 0) {
+				fprintf(stderr, "wrong degree class accepted\n");
+				exit(EXIT_FAILURE);
+			}
+			check_eq(sig1, sig2, sig_len, "expanded seeded");
+
+			/* Signature with the system RNG and an explicit
+			   temporary area; it must verify. */
+			size_t exptmp_len = ((size_t)58 << logn) + 31;
+			if (logn <= 8) {
+				j1 = fndsa_sign_weak_expanded_temp(
+					esk + (i & 1), esk_len,
+					NULL, 0, FNDSA_HASH_ID_RAW, "test", 4,
+					sig1, sig_len, tmp, exptmp_len);
+			} else {
+				j1 = fndsa_sign_expanded_temp(
+					esk + (i & 1), esk_len,
+					NULL, 0, FNDSA_HASH_ID_RAW, "test", 4,
+					sig1, sig_len, tmp, exptmp_len);
+			}
+			if (j1 != sig_len) {
+				fprintf(stderr, "signature failed\n");
+				exit(EXIT_FAILURE);
+			}
+			int r;
+			if (logn <= 8) {
+				r = fndsa_verify_weak(sig1, sig_len,
+					vk, vk_len, NULL, 0,
+					FNDSA_HASH_ID_RAW, "test", 4);
+			} else {
+				r = fndsa_verify(sig1, sig_len,
+					vk, vk_len, NULL, 0,
+					FNDSA_HASH_ID_RAW, "test", 4);
+			}
+			if (!r) {
+				fprintf(stderr, "verify failed\n");
+				exit(EXIT_FAILURE);
+			}
+			printf(".");
+			fflush(stdout);
+		}
+
+		xfree(sk);
+		xfree(vk);
+		xfree(sig1);
+		xfree(sig2);
+		xfree(esk);
+		xfree(tmp);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+NOINLINE
+static void
+test_sign_batch(void)
+{
+	printf("Test sign batch: ");
+	fflush(stdout);
+
+	for (unsigned logn = 2; logn <= 10; logn ++) {
+		printf("[%u]", logn);
+		fflush(stdout);
+		size_t sk_len = FNDSA_SIGN_KEY_SIZE(logn);
+		size_t vk_len = FNDSA_VRFY_KEY_SIZE(logn);
+		size_t sig_len = FNDSA_SIGNATURE_SIZE(logn);
+		uint8_t *sk = xmalloc(sk_len);
+		uint8_t *vk = xmalloc(vk_len);
+		uint8_t *sigs = xmalloc(5 * sig_len);
+		size_t signtmp_len = ((size_t)110 << logn) + 31;
+		void *tmp = xmalloc(signtmp_len);
+
+		/* Messages use distinct contexts and data. */
+		static const char *const ctxs[] = {
+			"", "ctx1", "ctx2", "", "ctx4"
+		};
+		static const char *const hvs[] = {
+			"test", "message", "", "another message", "test"
+		};
+		fndsa_sign_msg msgs[5];
+		for (int k = 0; k < 5; k ++) {
+			msgs[k].ctx = ctxs[k];
+			msgs[k].ctx_len = strlen(ctxs[k]);
+			msgs[k].id = FNDSA_HASH_ID_RAW;
+			msgs[k].hv = hvs[k];
+			msgs[k].hv_len = strlen(hvs[k]);
+		}
+
+		for (int i = 0; i < 6; i ++) {
+			uint8_t seed[7];
+			seed[0] = (uint8_t)logn;
+			seed[1] = (uint8_t)i;
+			memcpy(seed + 2, "batch", 5);
+			fndsa_keygen_seeded(logn, seed, sizeof seed, sk, vk);
+
+			/* Alternate between the stack-allocated area, the
+			   minimal temporary area, and the large temporary
+			   area (shared key expansion). */
+			size_t j1, j2, j3;
+			size_t tl = (i % 3) == 1
+				? ((size_t)59 << logn) + 31 : signtmp_len;
+			void *t = (i % 3) == 0 ? NULL : tmp;
+			if (logn <= 8) {
+				j1 = fndsa_sign_weak_batch_temp(sk, sk_len,
+					msgs, 5, sigs, 5 * sig_len, t, tl);
+				j2 = fndsa_sign_weak_batch(sk, sk_len,
+					msgs, 5, sigs, 5 * sig_len - 1);
+				j3 = fndsa_sign_batch(sk, sk_len,
+					msgs, 5, sigs, 5 * sig_len);
+			} else {
+				j1 = fndsa_sign_batch_temp(sk, sk_len,
+					msgs, 5, sigs, 5 * sig_len, t, tl);
+				j2 = fndsa_sign_batch(sk, sk_len,
+					msgs, 5, sigs, 5 * sig_len - 1);
+				j3 = fndsa_sign_weak_batch(sk, sk_len,
+					msgs, 5, sigs, 5 * sig_len);
+			}
+			if (j1 != 5) {
+				fprintf(stderr, "batch signature failed\n");
+				exit(EXIT_FAILURE);
+			}
+			if (j2 != 0) {
+				fprintf(stderr, "undersized output accepted\n");
+				exit(EXIT_FAILURE);
+			}
+			if (j3 != 0) {
+				fprintf(stderr, "wrong degree class accepted\n");
+				exit(EXIT_FAILURE);
+			}
+
+			/* Each signature must verify for its own message,
+			   and not for the next one. */
+			for (int k = 0; k < 5; k ++) {
+				const fndsa_sign_msg *m1 = &msgs[k];
+				const fndsa_sign_msg *m2 = &msgs[(k + 1) % 5];
+				const uint8_t *sig = sigs + k * sig_len;
+				int r1, r2;
+				if (logn <= 8) {
+					r1 = fndsa_verify_weak(sig, sig_len,
+						vk, vk_len,
+						m1->ctx, m1->ctx_len, m1->id,
+						m1->hv, m1->hv_len);
+					r2 = fndsa_verify_weak(sig, sig_len,
+						vk, vk_len,
+						m2->ctx, m2->ctx_len, m2->id,
+						m2->hv, m2->hv_len);
+				} else {
+					r1 = fndsa_verify(sig, sig_len,
+						vk, vk_len,
+						m1->ctx, m1->ctx_len, m1->id,
+						m1->hv, m1->hv_len);
+					r2 = fndsa_verify(sig, sig_len,
+						vk, vk_len,
+						m2->ctx, m2->ctx_len, m2->id,
+						m2->hv, m2->hv_len);
+				}
+				if (!r1) {
+					fprintf(stderr, "verify failed\n");
+					exit(EXIT_FAILURE);
+				}
+				if (r2) {
+					fprintf(stderr,
+						"verify should have failed\n");
+					exit(EXIT_FAILURE);
+				}
+			}
+			printf(".");
+			fflush(stdout);
+		}
+
+		xfree(sk);
+		xfree(vk);
+		xfree(sigs);
+		xfree(tmp);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+#if FNDSA_SIGN_ENGINE
+static void
+engine_callback(fndsa_sign_job *job)
+{
+	__atomic_add_fetch((unsigned *)job->user, 1, __ATOMIC_RELAXED);
+}
+#endif
+
+NOINLINE
+static void
+test_sign_engine(void)
+{
+	printf("Test sign engine: ");
+	fflush(stdout);
+
+#if FNDSA_SIGN_ENGINE
+	size_t mem_len = fndsa_sign_engine_size(9, 3, 4);
+	if (mem_len == 0 || fndsa_sign_engine_size(9, 3, 6) != 0
+		|| fndsa_sign_engine_size(8, 3, 4) != 0)
+	{
+		fprintf(stderr, "wrong engine size\n");
+		exit(EXIT_FAILURE);
+	}
+	void *mem = xmalloc(mem_len);
+	if (fndsa_sign_engine_start(9, 3, 4, mem, mem_len - 1) != NULL) {
+		fprintf(stderr, "undersized engine area accepted\n");
+		exit(EXIT_FAILURE);
+	}
+	fndsa_sign_engine *e = fndsa_sign_engine_start(9, 3, 4, mem, mem_len);
+	if (e == NULL) {
+		fprintf(stderr, "engine start failed\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/* Two keys: one for n = 512, and one for n = 1024, which is too
+	   large for this engine (signing must fail). */
+	uint8_t sk[FNDSA_SIGN_KEY_SIZE(9)], vk[FNDSA_VRFY_KEY_SIZE(9)];
+	uint8_t sk10[FNDSA_SIGN_KEY_SIZE(10)], vk10[FNDSA_VRFY_KEY_SIZE(10)];
+	fndsa_keygen_seeded(9, "engine", 6, sk, vk);
+	fndsa_keygen_seeded(10, "engine", 6, sk10, vk10);
+
+	/* More jobs than queue slots: the submission loop must sometimes
+	   wait for the workers. Even jobs use a callback. */
+	fndsa_sign_job jobs[12];
+	uint8_t sigs[12][FNDSA_SIGNATURE_SIZE(10)];
+	uint8_t hvs[12][4];
+	unsigned num_cb = 0;
+	for (int i = 0; i < 12; i ++) {
+		fndsa_sign_job *job = &jobs[i];
+		memcpy(hvs[i], "job", 3);
+		hvs[i][3] = (uint8_t)i;
+		if (i == 7) {
+			job->sign_key = sk10;
+			job->sign_key_len = sizeof sk10;
+		} else {
+			job->sign_key = sk;
+			job->sign_key_len = sizeof sk;
+		}
+		job->ctx = "engine";
+		job->ctx_len = 6;
+		job->id = FNDSA_HASH_ID_RAW;
+		job->hv = hvs[i];
+		job->hv_len = 4;
+		job->sig = sigs[i];
+		job->max_sig_len = sizeof sigs[i];
+		job->callback = (i & 1) == 0 ? engine_callback : NULL;
+		job->user = &num_cb;
+		while (!fndsa_sign_engine_submit(e, job)) {
+			/* queue is full */
+		}
+	}
+	for (int i = 0; i < 12; i ++) {
+		while (!fndsa_sign_job_done(&jobs[i])) {
+			/* wait */
+		}
+	}
+	fndsa_sign_engine_stop(e);
+	xfree(mem);
+
+	if (num_cb != 6) {
+		fprintf(stderr, "wrong callback count: %u\n", num_cb);
+		exit(EXIT_FAILURE);
+	}
+	for (int i = 0; i < 12; i ++) {
+		if (i == 7) {
+			if (jobs[i].sig_len != 0) {
+				fprintf(stderr, "oversized key accepted\n");
+				exit(EXIT_FAILURE);
+			}
+			continue;
+		}
+		if (jobs[i].sig_len != FNDSA_SIGNATURE_SIZE(9)) {
+			fprintf(stderr, "engine signature failed\n");
+			exit(EXIT_FAILURE);
+		}
+		if (!fndsa_verify(sigs[i], jobs[i].sig_len, vk, sizeof vk,
+			"engine", 6, FNDSA_HASH_ID_RAW, hvs[i], 4))
+		{
+			fprintf(stderr, "verify failed\n");
+			exit(EXIT_FAILURE);
+		}
+		printf(".");
+		fflush(stdout);
+	}
+#else
+	if (fndsa_sign_engine_size(9, 3, 4) != 0) {
+		fprintf(stderr, "engine reported without thread support\n");
+		exit(EXIT_FAILURE);
+	}
+#endif
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+NOINLINE
+static void
+test_sampler_pre(void)
+{
+	printf("Test sampler pre-expansion: ");
+	fflush(stdout);
+
+	/* A sampler that reads a pre-expanded stream must produce the same
+	   values as a sampler on the same seed, including after the end of
+	   the stream (we draw enough samples to go past it). */
+	for (unsigned logn = 2; logn <= 10; logn ++) {
+		size_t pre_len = sampler_pre_size(logn);
+		uint64_t *pre = xmalloc(pre_len);
+		uint8_t seed[56];
+		for (size_t i = 0; i < sizeof seed; i ++) {
+			seed[i] = (uint8_t)(i + 13 * logn);
+		}
+		sampler_pre_expand(logn, pre, seed, sizeof seed);
+		sampler_state ss1, ss2;
+		sampler_init(&ss1, logn, seed, sizeof seed);
+		sampler_init_pre(&ss2, logn, pre);
+		fpr isigma = FPR(0x15555555555555, -53);  /* 2/3 */
+		for (size_t i = 0; i < pre_len / 4; i ++) {
+			fpr mu = fpr_scaled(
+				(int64_t)(i * 37 % 1001) - 500, -3);
+			int32_t z1 = sampler_next(&ss1, mu, isigma);
+			int32_t z2 = sampler_next(&ss2, mu, isigma);
+			if (z1 != z2) {
+				fprintf(stderr, "sampler mismatch (%u, %zu):"
+					" %ld / %ld\n", logn, i,
+					(long)z1, (long)z2);
+				exit(EXIT_FAILURE);
+			}
+		}
+		xfree(pre);
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+#if FNDSA_SIGN_ENGINE
+static size_t
+randpool_available(void *pool)
+{
+	return fndsa_randpool_available(pool);
+}
+#endif
+
+NOINLINE
+static void
+test_randpool(void)
+{
+	printf("Test randomness pool: ");
+	fflush(stdout);
+
+#if FNDSA_SIGN_ENGINE
+	size_t mem_len = fndsa_randpool_size(9, 4, 2);
+	if (mem_len == 0 || fndsa_randpool_size(9, 0, 2) != 0
+		|| fndsa_randpool_size(9, 4, 0) != 0
+		|| fndsa_randpool_size(11, 4, 2) != 0)
+	{
+		fprintf(stderr, "wrong randomness pool size\n");
+		exit(EXIT_FAILURE);
+	}
+	void *mem = xmalloc(mem_len);
+	if (fndsa_randpool_create(9, 4, 2, mem, mem_len - 1) != NULL) {
+		fprintf(stderr, "undersized randomness pool area accepted\n");
+		exit(EXIT_FAILURE);
+	}
+	fndsa_randpool *rp = fndsa_randpool_create(9, 4, 2, mem, mem_len);
+	if (rp == NULL) {
+		fprintf(stderr, "randomness pool creation failed\n");
+		exit(EXIT_FAILURE);
+	}
+
+	uint8_t sk[FNDSA_SIGN_KEY_SIZE(9)], vk[FNDSA_VRFY_KEY_SIZE(9)];
+	fndsa_keygen_seeded(9, "randpool", 8, sk, vk);
+	size_t esk_len = FNDSA_SIGN_KEY_EXPANDED_SIZE(9);
+	uint8_t *esk = xmalloc(esk_len);
+	if (!fndsa_sign_key_expand(sk, sizeof sk, esk, esk_len)) {
+		fprintf(stderr, "key expansion failed\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/* Sign more messages than the pool capacity, on all SIMD tiers;
+	   some signatures are made when the pool is full, others when it
+	   is empty (fresh randomness is then used). All signatures must be
+	   valid, and all nonces distinct. */
+	uint8_t sigs[24][FNDSA_SIGNATURE_SIZE(9)];
+	for (int i = 0; i < 24; i ++) {
+		uint8_t hv[4];
+		memcpy(hv, "msg", 3);
+		hv[3] = (uint8_t)i;
+		set_simd_tier_max((unsigned)i % 3);
+		if ((i & 7) == 0) {
+			wait_available(randpool_available, rp, 4,
+				"randomness pool");
+		}
+		size_t j = fndsa_sign_expanded_pooled(rp, esk, esk_len,
+			"pool", 4, FNDSA_HASH_ID_RAW, hv, 4,
+			sigs[i], sizeof sigs[i]);
+		if (j != FNDSA_SIGNATURE_SIZE(9)) {
+			fprintf(stderr, "pooled signature failed\n");
+			exit(EXIT_FAILURE);
+		}
+		if (!fndsa_verify(sigs[i], j, vk, sizeof vk,
+			"pool", 4, FNDSA_HASH_ID_RAW, hv, 4))
+		{
+			fprintf(stderr, "pooled signature invalid\n");
+			exit(EXIT_FAILURE);
+		}
+		for (int k = 0; k < i; k ++) {
+			if (memcmp(sigs[i] + 1, sigs[k] + 1, 40) == 0) {
+				fprintf(stderr, "nonce reused\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+		printf(".");
+		fflush(stdout);
+	}
+	set_simd_tier_max(SIMD_TIER_AVX512);
+
+	/* Without a pool, fresh randomness is used; a pool for another
+	   degree is rejected. */
+	if (fndsa_sign_expanded_pooled(NULL, esk, esk_len,
+		"pool", 4, FNDSA_HASH_ID_RAW, "x", 1,
+		sigs[0], sizeof sigs[0]) != FNDSA_SIGNATURE_SIZE(9)
+		|| !fndsa_verify(sigs[0], FNDSA_SIGNATURE_SIZE(9),
+		vk, sizeof vk, "pool", 4, FNDSA_HASH_ID_RAW, "x", 1))
+	{
+		fprintf(stderr, "signature without pool failed\n");
+		exit(EXIT_FAILURE);
+	}
+	uint8_t sk8[FNDSA_SIGN_KEY_SIZE(8)], vk8[FNDSA_VRFY_KEY_SIZE(8)];
+	fndsa_keygen_seeded(8, "randpool", 8, sk8, vk8);
+	size_t esk8_len = FNDSA_SIGN_KEY_EXPANDED_SIZE(8);
+	uint8_t *esk8 = xmalloc(esk8_len);
+	fndsa_sign_key_expand(sk8, sizeof sk8, esk8, esk8_len);
+	if (fndsa_sign_weak_expanded_pooled(rp, esk8, esk8_len,
+		"pool", 4, FNDSA_HASH_ID_RAW, "x", 1,
+		sigs[0], sizeof sigs[0]) != 0)
+	{
+		fprintf(stderr, "pool of wrong degree accepted\n");
+		exit(EXIT_FAILURE);
+	}
+	fndsa_randpool_destroy(rp);
+	xfree(mem);
+
+	/* Weak degree, with a pool for that degree. */
+	mem_len = fndsa_randpool_size(8, 2, 1);
+	mem = xmalloc(mem_len);
+	rp = fndsa_randpool_create(8, 2, 1, mem, mem_len);
+	if (rp == NULL) {
+		fprintf(stderr, "randomness pool creation failed\n");
+		exit(EXIT_FAILURE);
+	}
+	for (int i = 0; i < 4; i ++) {
+		wait_available(randpool_available, rp, 1, "randomness pool");
+		size_t j = fndsa_sign_weak_expanded_pooled(rp, esk8, esk8_len,
+			"pool", 4, FNDSA_HASH_ID_RAW, "y", 1,
+			sigs[i], sizeof sigs[i]);
+		if (j != FNDSA_SIGNATURE_SIZE(8)
+			|| !fndsa_verify_weak(sigs[i], j, vk8, sizeof vk8,
+			"pool", 4, FNDSA_HASH_ID_RAW, "y", 1))
+		{
+			fprintf(stderr, "weak pooled signature failed\n");
+			exit(EXIT_FAILURE);
+		}
+		printf(".");
+		fflush(stdout);
+	}
+	fndsa_randpool_destroy(rp);
+	xfree(mem);
+	xfree(esk);
+	xfree(esk8);
+#else
+	if (fndsa_randpool_size(9, 4, 2) != 0) {
+		fprintf(stderr, "randomness pool should not be supported\n");
+		exit(EXIT_FAILURE);
+	}
+#endif
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
 /*
  * Test vectors:
  * KAT_n[] contains 10 vectors for n = 2^logn
@@ -4842,10 +7241,18 @@ run_tests(void)
 	selftest_sha256();
 	test_SHAKE256();
 	test_SHAKE256x4();
+	test_SHAKE256_mb();
 	test_SHA3();
+	test_sysrng();
 	test_modq_codec();
+	test_trim_codec();
 	test_comp_codec();
+	test_simd_tier();
+	test_hash_to_point();
 	test_mq();
+#if FNDSA_AVX512
+	test_mq_avx512();
+#endif
 	test_fpr();
 	test_fpoly();
 	test_sample_f();
@@ -4859,10 +7266,25 @@ run_tests(void)
 	test_sign_core();
 	test_chacha20rng();
 #endif
+	test_twiddle_cache();
 	test_keygen_ref();
 	test_keygen_self();
+	test_keygen_mt();
+#if FNDSA_AVX512
+	test_keygen_avx512();
+#endif
+	test_keypool();
 	test_verify();
 	test_self();
+	test_verify_prepared();
+	test_verify_batch();
+	test_verify_stream();
+	test_prehash();
+	test_sign_expanded();
+	test_sign_batch();
+	test_sign_engine();
+	test_sampler_pre();
+	test_randpool();
 	test_kat();
 }
 
@@ -13,6 +13,7 @@
 typedef struct {
 	const uint8_t *rndbuf;
 	size_t ptr, len;
+	size_t win;
 } test_rng_context;
 
 typedef struct {
@@ -25,6 +26,10 @@ typedef struct {
 #define prng_init       test_prng_init
 #define prng_next_u8    test_prng_next_u8
 #define prng_next_u64   test_prng_next_u64
+#define prng_avail      test_prng_avail
+#define prng_buf(pc)    ((pc)->rndbuf + (pc)->ptr)
+#define prng_skip(pc, n)   ((pc)->ptr += (n))
+#define prng_dec64      test_prng_dec64
 
 static void
 test_prng_init(test_rng_context *pc, const void *seed, size_t seed_len)
@@ -32,6 +37,7 @@ test_prng_init(test_rng_context *pc, const void *seed, size_t seed_len)
 	pc->rndbuf = seed;
 	pc->ptr = 0;
 	pc->len = seed_len;
+	pc->win = 0;
 }
 
 static inline uint8_t
@@ -54,6 +60,28 @@ test_prng_next_u64(test_rng_context *pc)
 	return x;
 }
 
+/* If win is not zero, the buffered bytes reported to the AVX2 sampler
+   stop at the next multiple of win, to exercise the sequential reads. */
+static inline size_t
+test_prng_avail(test_rng_context *pc)
+{
+	size_t n = pc->len - pc->ptr;
+	if (pc->win != 0 && n > pc->win - (pc->ptr % pc->win)) {
+		n = pc->win - (pc->ptr % pc->win);
+	}
+	return n;
+}
+
+static inline uint64_t
+test_prng_dec64(const uint8_t *buf)
+{
+	uint64_t x = 0;
+	for (int i = 0; i < 8; i ++) {
+		x = (x << 8) | (uint64_t)buf[i];
+	}
+	return x;
+}
+
 #undef sampler_init
 #define sampler_init         test_sampler_init
 #undef sampler_next
@@ -62,6 +90,10 @@ test_prng_next_u64(test_rng_context *pc)
 #define ffsamp_fft           test_ffsamp_fft
 #undef ffsamp_fft_deepest
 #define ffsamp_fft_deepest   test_ffsamp_fft_deepest
+#undef avx2_ffsamp_fft
+#define avx2_ffsamp_fft      test_avx2_ffsamp_fft
+#undef avx512_ffsamp_fft
+#define avx512_ffsamp_fft    test_avx512_ffsamp_fft
 
 #include "sign_sampler.c"
 
@@ -2826,6 +2858,24 @@ static const int32_t KAT512_OUT[] = {
 	 -36,  119,   65,  629
 };
 
+#if FNDSA_AVX2_FPOLY
+/* Sample the values for the next two test vectors with the AVX2 sampler
+   (both have the same standard deviation). */
+TARGET_SSE2
+static void
+sample_pair_avx2(sampler_state *ss, const fpr *mu_isigma, int32_t *z)
+{
+	double y[2];
+	__m128d mu = _mm_castsi128_pd(_mm_set_epi64x(
+		(int64_t)mu_isigma[2], (int64_t)mu_isigma[0]));
+	__m128d isigma = _mm_castsi128_pd(_mm_set_epi64x(
+		0, (int64_t)mu_isigma[1]));
+	_mm_storeu_pd(y, sampler_next_x2_sse2(ss, mu, isigma, 1));
+	z[0] = (int32_t)y[0];
+	z[1] = (int32_t)y[1];
+}
+#endif
+
 void
 test_sampler(void)
 {
@@ -2857,6 +2907,42 @@ test_sampler(void)
 			" (%zu vs %zu)\n", ss.pc.ptr, rndlen);
 		exit(EXIT_FAILURE);
 	}
+
+#if FNDSA_AVX2_FPOLY
+	/* The AVX2 sampler must produce the same values and consume the
+	   same bytes, including when the buffered bytes do not contain
+	   all the candidates. */
+	if (has_avx2()) {
+		static const size_t wins[] = { 0, 136, 23, 7 };
+		for (size_t k = 0; k < sizeof wins / sizeof wins[0]; k ++) {
+			sampler_init(&ss, 9, rndbuf, rndlen);
+			ss.pc.win = wins[k];
+			for (size_t i = 0; i < num; i += 2) {
+				int32_t z[2];
+				sample_pair_avx2(&ss,
+					KAT512_MU_INVSIGMA + (i << 1), z);
+				for (int j = 0; j < 2; j ++) {
+					int32_t w = KAT512_OUT[i + j];
+					if (z[j] != w) {
+						fprintf(stderr, "FAIL: AVX2 out"
+							" mismatch (win=%zu):"
+							" %d vs %d\n",
+							wins[k], z[j], w);
+						exit(EXIT_FAILURE);
+					}
+				}
+			}
+			if (ss.pc.ptr != rndlen) {
+				fprintf(stderr, "FAIL: AVX2 consumed %zu"
+					" bytes (expected: %zu)\n",
+					ss.pc.ptr, rndlen);
+				exit(EXIT_FAILURE);
+			}
+			printf("+");
+			fflush(stdout);
+		}
+	}
+#endif
 	xfree(rndbuf);
 
 	printf(" done.\n");
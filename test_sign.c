@@ -29,6 +29,10 @@ typedef struct {
 #define prng_init       chacha20rng_init
 #define prng_next_u8    chacha20rng_next_u8
 #define prng_next_u64   chacha20rng_next_u64
+#define prng_avail      chacha20rng_avail
+#define prng_buf(pc)    ((pc)->buf + (pc)->ptr)
+#define prng_skip(pc, n)   ((pc)->ptr += (n))
+#define prng_dec64      dec64le
 
 static inline uint32_t
 dec32le(const void *src)
@@ -168,6 +172,15 @@ chacha20rng_next_u64(chacha20rng_context *pc)
 		| ((uint64_t)pc->buf[i + 7] << 56);
 }
 
+/* Number of bytes that can be read without a refill (the last bytes of
+   the buffer are never used by chacha20rng_next_u64()). */
+static inline size_t
+chacha20rng_avail(chacha20rng_context *pc)
+{
+	return pc->ptr < (sizeof pc->buf) - 2
+		? (sizeof pc->buf) - 2 - pc->ptr : 0;
+}
+
 #undef sampler_init
 #define sampler_init         chacha20_sampler_init
 #undef sampler_next
@@ -176,11 +189,25 @@ chacha20rng_next_u64(chacha20rng_context *pc)
 #define ffsamp_fft           chacha20_ffsamp_fft
 #undef ffsamp_fft_deepest
 #define ffsamp_fft_deepest   chacha20_ffsamp_fft_deepest
+#undef avx2_ffsamp_fft
+#define avx2_ffsamp_fft      chacha20_avx2_ffsamp_fft
+#undef avx512_ffsamp_fft
+#define avx512_ffsamp_fft    chacha20_avx512_ffsamp_fft
+
+/* Pre-expanded sampler streams are not supported with this PRNG; they are
+   used only with a randomness pool, which the tests below do not use. */
+#undef sampler_init_pre
+#define sampler_init_pre(ss, logn, pre) \
+	((void)(ss), (void)(logn), (void)(pre))
 
 #include "sign_sampler.c"
 
 #undef sign_core
 #define sign_core   chacha20_sign_core
+#undef sign_core_expanded
+#define sign_core_expanded   chacha20_sign_core_expanded
+#undef sign_expand_basis
+#define sign_expand_basis   chacha20_sign_expand_basis
 
 #include "sign_core.c"
 
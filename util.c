@@ -6,11 +6,9 @@
 
 /* see inner.h */
 void
-hash_to_point(unsigned logn,
+hash_to_point_begin(shake_context *sc,
         const uint8_t *nonce, const uint8_t *hashed_vrfy_key,
-        const void *ctx, size_t ctx_len,
-        const char *hash_id, const void *hv, size_t hv_len,
-        uint16_t *c)
+        const void *ctx, size_t ctx_len, const char *hash_id)
 {
 	/*
 	 * If hash_id starts with a single byte of value 0xFF then we
@@ -24,14 +22,9 @@ hash_to_point(unsigned logn,
 	 * Original Falcon:
 	 *   nonce || message
 	 */
-	shake_context sc;
-	shake_init(&sc, 256);
-	shake_inject(&sc, nonce, 40);
-	if (*(const uint8_t *)hash_id == 0xFF) {
-		/* Original Falcon mode */
-		shake_inject(&sc, hv, hv_len);
-	} else {
-		shake_inject(&sc, hashed_vrfy_key, 64);
+	shake_inject(sc, nonce, 40);
+	if (*(const uint8_t *)hash_id != 0xFF) {
+		shake_inject(sc, hashed_vrfy_key, 64);
 		uint8_t hb[2];
 		size_t id_len;
 		if (hash_id[0] == 0x00) {
@@ -45,81 +38,543 @@ hash_to_point(unsigned logn,
 			id_len = hash_id[1] + 2;
 		}
 		hb[1] = ctx_len;
-		shake_inject(&sc, &hb, 2);
-		shake_inject(&sc, ctx, ctx_len);
-		shake_inject(&sc, hash_id, id_len);
-		shake_inject(&sc, hv, hv_len);
+		shake_inject(sc, &hb, 2);
+		shake_inject(sc, ctx, ctx_len);
+		shake_inject(sc, hash_id, id_len);
 	}
-	shake_flip(&sc);
+}
 
+/* see inner.h */
+void
+hash_to_point_start(shake_context *sc,
+        const uint8_t *nonce, const uint8_t *hashed_vrfy_key,
+        const void *ctx, size_t ctx_len,
+        const char *hash_id, const void *hv, size_t hv_len)
+{
+	hash_to_point_begin(sc, nonce, hashed_vrfy_key,
+		ctx, ctx_len, hash_id);
+	shake_inject(sc, hv, hv_len);
+	shake_flip(sc);
+}
+
+/* Rejection sampling for hash_to_point(): the 16-bit big-endian words
+   of buf[] (len bytes, len is even) which are lower than 61445 are
+   reduced modulo q and appended to d[], starting at index i, until n
+   values have been obtained. The new value of i is returned. */
+static size_t
+h2p_sample(const uint8_t *buf, size_t len, uint16_t *d, size_t i, size_t n)
+{
+	for (size_t j = 0; j < len && i < n; j += 2) {
+		unsigned w = ((unsigned)buf[j] << 8) | buf[j + 1];
+		if (w < 61445) {
+			while (w >= 12289) {
+				w -= 12289;
+			}
+			d[i ++] = w;
+		}
+	}
+	return i;
+}
+
+#if FNDSA_AVX2
+/* For an 8-bit mask m, H2P_PACK[m] contains, in its low bytes (in
+   little-endian order), the indices of the bits of value 1 in m. */
+static const uint64_t H2P_PACK[256] = {
+	0x0000000000000000, 0x0000000000000000, 0x0000000000000001,
+	0x0000000000000100, 0x0000000000000002, 0x0000000000000200,
+	0x0000000000000201, 0x0000000000020100, 0x0000000000000003,
+	0x0000000000000300, 0x0000000000000301, 0x0000000000030100,
+	0x0000000000000302, 0x0000000000030200, 0x0000000000030201,
+	0x0000000003020100, 0x0000000000000004, 0x0000000000000400,
+	0x0000000000000401, 0x0000000000040100, 0x0000000000000402,
+	0x0000000000040200, 0x0000000000040201, 0x0000000004020100,
+	0x0000000000000403, 0x0000000000040300, 0x0000000000040301,
+	0x0000000004030100, 0x0000000000040302, 0x0000000004030200,
+	0x0000000004030201, 0x0000000403020100, 0x0000000000000005,
+	0x0000000000000500, 0x0000000000000501, 0x0000000000050100,
+	0x0000000000000502, 0x0000000000050200, 0x0000000000050201,
+	0x0000000005020100, 0x0000000000000503, 0x0000000000050300,
+	0x0000000000050301, 0x0000000005030100, 0x0000000000050302,
+	0x0000000005030200, 0x0000000005030201, 0x0000000503020100,
+	0x0000000000000504, 0x0000000000050400, 0x0000000000050401,
+	0x0000000005040100, 0x0000000000050402, 0x0000000005040200,
+	0x0000000005040201, 0x0000000504020100, 0x0000000000050403,
+	0x0000000005040300, 0x0000000005040301, 0x0000000504030100,
+	0x0000000005040302, 0x0000000504030200, 0x0000000504030201,
+	0x0000050403020100, 0x0000000000000006, 0x0000000000000600,
+	0x0000000000000601, 0x0000000000060100, 0x0000000000000602,
+	0x0000000000060200, 0x0000000000060201, 0x0000000006020100,
+	0x0000000000000603, 0x0000000000060300, 0x0000000000060301,
+	0x0000000006030100, 0x0000000000060302, 0x0000000006030200,
+	0x0000000006030201, 0x0000000603020100, 0x0000000000000604,
+	0x0000000000060400, 0x0000000000060401, 0x0000000006040100,
+	0x0000000000060402, 0x0000000006040200, 0x0000000006040201,
+	0x0000000604020100, 0x0000000000060403, 0x0000000006040300,
+	0x0000000006040301, 0x0000000604030100, 0x0000000006040302,
+	0x0000000604030200, 0x0000000604030201, 0x0000060403020100,
+	0x0000000000000605, 0x0000000000060500, 0x0000000000060501,
+	0x0000000006050100, 0x0000000000060502, 0x0000000006050200,
+	0x0000000006050201, 0x0000000605020100, 0x0000000000060503,
+	0x0000000006050300, 0x0000000006050301, 0x0000000605030100,
+	0x0000000006050302, 0x0000000605030200, 0x0000000605030201,
+	0x0000060503020100, 0x0000000000060504, 0x0000000006050400,
+	0x0000000006050401, 0x0000000605040100, 0x0000000006050402,
+	0x0000000605040200, 0x0000000605040201, 0x0000060504020100,
+	0x0000000006050403, 0x0000000605040300, 0x0000000605040301,
+	0x0000060504030100, 0x0000000605040302, 0x0000060504030200,
+	0x0000060504030201, 0x0006050403020100, 0x0000000000000007,
+	0x0000000000000700, 0x0000000000000701, 0x0000000000070100,
+	0x0000000000000702, 0x0000000000070200, 0x0000000000070201,
+	0x0000000007020100, 0x0000000000000703, 0x0000000000070300,
+	0x0000000000070301, 0x0000000007030100, 0x0000000000070302,
+	0x0000000007030200, 0x0000000007030201, 0x0000000703020100,
+	0x0000000000000704, 0x0000000000070400, 0x0000000000070401,
+	0x0000000007040100, 0x0000000000070402, 0x0000000007040200,
+	0x0000000007040201, 0x0000000704020100, 0x0000000000070403,
+	0x0000000007040300, 0x0000000007040301, 0x0000000704030100,
+	0x0000000007040302, 0x0000000704030200, 0x0000000704030201,
+	0x0000070403020100, 0x0000000000000705, 0x0000000000070500,
+	0x0000000000070501, 0x0000000007050100, 0x0000000000070502,
+	0x0000000007050200, 0x0000000007050201, 0x0000000705020100,
+	0x0000000000070503, 0x0000000007050300, 0x0000000007050301,
+	0x0000000705030100, 0x0000000007050302, 0x0000000705030200,
+	0x0000000705030201, 0x0000070503020100, 0x0000000000070504,
+	0x0000000007050400, 0x0000000007050401, 0x0000000705040100,
+	0x0000000007050402, 0x0000000705040200, 0x0000000705040201,
+	0x0000070504020100, 0x0000000007050403, 0x0000000705040300,
+	0x0000000705040301, 0x0000070504030100, 0x0000000705040302,
+	0x0000070504030200, 0x0000070504030201, 0x0007050403020100,
+	0x0000000000000706, 0x0000000000070600, 0x0000000000070601,
+	0x0000000007060100, 0x0000000000070602, 0x0000000007060200,
+	0x0000000007060201, 0x0000000706020100, 0x0000000000070603,
+	0x0000000007060300, 0x0000000007060301, 0x0000000706030100,
+	0x0000000007060302, 0x0000000706030200, 0x0000000706030201,
+	0x0000070603020100, 0x0000000000070604, 0x0000000007060400,
+	0x0000000007060401, 0x0000000706040100, 0x0000000007060402,
+	0x0000000706040200, 0x0000000706040201, 0x0000070604020100,
+	0x0000000007060403, 0x0000000706040300, 0x0000000706040301,
+	0x0000070604030100, 0x0000000706040302, 0x0000070604030200,
+	0x0000070604030201, 0x0007060403020100, 0x0000000000070605,
+	0x0000000007060500, 0x0000000007060501, 0x0000000706050100,
+	0x0000000007060502, 0x0000000706050200, 0x0000000706050201,
+	0x0000070605020100, 0x0000000007060503, 0x0000000706050300,
+	0x0000000706050301, 0x0000070605030100, 0x0000000706050302,
+	0x0000070605030200, 0x0000070605030201, 0x0007060503020100,
+	0x0000000007060504, 0x0000000706050400, 0x0000000706050401,
+	0x0000070605040100, 0x0000000706050402, 0x0000070605040200,
+	0x0000070605040201, 0x0007060504020100, 0x0000000706050403,
+	0x0000070605040300, 0x0000070605040301, 0x0007060504030100,
+	0x0000070605040302, 0x0007060504030200, 0x0007060504030201,
+	0x0706050403020100
+};
+
+/* Number of bits of value 1 in x. */
+static inline unsigned
+bit_count32(uint32_t x)
+{
+	x = x - ((x >> 1) & 0x55555555);
+	x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+	x = (x + (x >> 4)) & 0x0F0F0F0F;
+	return (x * 0x01010101) >> 24;
+}
+
+/* Write the 16-bit words of x whose index is set in the 8-bit mask m
+   at d[i], d[i + 1]... (16 bytes are written); the new value of i is
+   returned. */
+TARGET_AVX2
+static inline size_t
+avx2_h2p_pack(__m128i x, unsigned m, uint16_t *d, size_t i)
+{
+	__m128i s = _mm_loadl_epi64((const __m128i *)&H2P_PACK[m]);
+	s = _mm_add_epi8(s, s);
+	s = _mm_unpacklo_epi8(s, _mm_add_epi8(s, _mm_set1_epi8(1)));
+	_mm_storeu_si128((__m128i *)(d + i), _mm_shuffle_epi8(x, s));
+	return i + bit_count32(m);
+}
+
+/* AVX2 version of h2p_sample(), with 16 words per iteration. For
+   w < 61445, floor((w*5) / 2^16) is either floor(w/q) or floor(w/q) - 1,
+   so that a single conditional subtraction completes the reduction. */
+TARGET_AVX2
+static size_t
+avx2_h2p_sample(const uint8_t *buf, size_t len,
+	uint16_t *d, size_t i, size_t n)
+{
+	const __m256i ybswap = _mm256_setr_epi8(
+		1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+		1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+	const __m256i ylim = _mm256_set1_epi16(61444);
+	const __m256i yq = _mm256_set1_epi16(12289);
+	const __m256i y5 = _mm256_set1_epi16(5);
+	size_t j = 0;
+	while ((len - j) >= 32 && (n - i) >= 16) {
+		__m256i yw = _mm256_shuffle_epi8(
+			_mm256_loadu_si256((const __m256i *)(buf + j)), ybswap);
+		j += 32;
+		__m256i ya = _mm256_cmpeq_epi16(_mm256_min_epu16(yw, ylim), yw);
+		__m256i yr = _mm256_sub_epi16(yw, _mm256_mullo_epi16(
+			_mm256_mulhi_epu16(yw, y5), yq));
+		yr = _mm256_min_epu16(yr, _mm256_sub_epi16(yr, yq));
+		uint32_t m = (uint32_t)_mm256_movemask_epi8(
+			_mm256_packs_epi16(ya, ya));
+		i = avx2_h2p_pack(_mm256_castsi256_si128(yr), m & 0xFF, d, i);
+		i = avx2_h2p_pack(_mm256_extracti128_si256(yr, 1),
+			(m >> 16) & 0xFF, d, i);
+	}
+	return h2p_sample(buf + j, len - j, d, i, n);
+}
+#endif
+
+#if FNDSA_AVX512
+/* AVX-512 version of h2p_sample(), with 32 words per iteration; the
+   accepted words are left-packed with the AVX-512VBMI2 compress opcode. */
+TARGET_AVX512VBMI2
+static size_t
+avx512_h2p_sample(const uint8_t *buf, size_t len,
+	uint16_t *d, size_t i, size_t n)
+{
+	const __m512i zbswap = _mm512_broadcast_i32x4(_mm_setr_epi8(
+		1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14));
+	const __m512i zlim = _mm512_set1_epi16(61445);
+	const __m512i zq = _mm512_set1_epi16(12289);
+	const __m512i z5 = _mm512_set1_epi16(5);
+	size_t j = 0;
+	while ((len - j) >= 64 && (n - i) >= 32) {
+		__m512i zw = _mm512_shuffle_epi8(
+			_mm512_loadu_si512((const void *)(buf + j)), zbswap);
+		j += 64;
+		__mmask32 ma = _mm512_cmplt_epu16_mask(zw, zlim);
+		__m512i zr = _mm512_sub_epi16(zw, _mm512_mullo_epi16(
+			_mm512_mulhi_epu16(zw, z5), zq));
+		zr = _mm512_min_epu16(zr, _mm512_sub_epi16(zr, zq));
+		_mm512_storeu_si512((void *)(d + i),
+			_mm512_maskz_compress_epi16(ma, zr));
+		i += bit_count32((uint32_t)ma);
+	}
+	return avx2_h2p_sample(buf + j, len - j, d, i, n);
+}
+#endif
+
+/* Get the SIMD tier to use for hash_to_point(). */
+static unsigned
+h2p_tier(void)
+{
+#if FNDSA_AVX512
+	if (has_avx512vbmi2()) {
+		return SIMD_TIER_AVX512;
+	}
+#endif
+#if FNDSA_AVX2
+	if (has_avx2()) {
+		return SIMD_TIER_AVX2;
+	}
+#endif
+	return SIMD_TIER_BASE;
+}
+
+/* h2p_sample() with the implementation for the provided SIMD tier. */
+static inline size_t
+h2p_sample_tier(unsigned tier, const uint8_t *buf, size_t len,
+	uint16_t *d, size_t i, size_t n)
+{
+#if FNDSA_AVX512
+	if (tier >= SIMD_TIER_AVX512) {
+		return avx512_h2p_sample(buf, len, d, i, n);
+	}
+#endif
+#if FNDSA_AVX2
+	if (tier >= SIMD_TIER_AVX2) {
+		return avx2_h2p_sample(buf, len, d, i, n);
+	}
+#endif
+	(void)tier;
+	return h2p_sample(buf, len, d, i, n);
+}
+
+/* see inner.h */
+void
+hash_to_point(unsigned logn,
+        const uint8_t *nonce, const uint8_t *hashed_vrfy_key,
+        const void *ctx, size_t ctx_len,
+        const char *hash_id, const void *hv, size_t hv_len,
+        uint16_t *c)
+{
+	shake_context sc;
+	shake_init(&sc, 256);
+	hash_to_point_start(&sc, nonce, hashed_vrfy_key,
+		ctx, ctx_len, hash_id, hv, hv_len);
+	hash_to_point_finish(logn, &sc, c);
+}
+
+/* see inner.h */
+void
+hash_to_point_finish(unsigned logn, shake_context *sc, uint16_t *c)
+{
 	size_t n = (size_t)1 << logn;
 	size_t i = 0;
+	unsigned tier = h2p_tier();
 #if FNDSA_ASM_CORTEXM4
-	uint8_t *sbuf = (uint8_t *)(void *)&sc;
-	size_t j = 136;
+	uint8_t *sbuf = (uint8_t *)(void *)sc;
 #else
 	uint8_t sbuf[136];
-	size_t j = sizeof sbuf;
 #endif
 	while (i < n) {
-		if (j == 136) {
 #if FNDSA_ASM_CORTEXM4
-			shake_extract(&sc, NULL, j);
+		shake_extract(sc, NULL, 136);
 #else
-			shake_extract(&sc, sbuf, j);
+		shake_extract(sc, sbuf, 136);
 #endif
-			j = 0;
-		}
-		unsigned w = ((unsigned)sbuf[j] << 8) | sbuf[j + 1];
-		j += 2;
-		if (w < 61445) {
-			while (w >= 12289) {
-				w -= 12289;
+		i = h2p_sample_tier(tier, sbuf, 136, c, i, n);
+	}
+}
+
+/* see inner.h */
+void
+hash_to_point_x4(shake_context *sc, size_t num,
+	const unsigned *logn, uint16_t *const *c)
+{
+	fndsa_shake256_x4_context sx;
+	uint8_t sbuf[4 * 136];
+	void *out[4] = { sbuf, sbuf + 136, sbuf + 2 * 136, sbuf + 3 * 136 };
+	size_t cnt[4];
+	size_t rem = num;
+	unsigned tier = h2p_tier();
+	for (size_t k = 0; k < num; k ++) {
+		cnt[k] = 0;
+	}
+	shake256_x4_set(&sx, sc);
+	while (rem > 0) {
+		fndsa_shake256_x4_extract(&sx, out, 136);
+		for (size_t k = 0; k < num; k ++) {
+			size_t n = (size_t)1 << logn[k];
+			size_t i = cnt[k];
+			if (i == n) {
+				continue;
+			}
+			i = h2p_sample_tier(tier, sbuf + 136 * k, 136, c[k], i, n);
+			cnt[k] = i;
+			if (i == n) {
+				rem --;
 			}
-			c[i ++] = w;
 		}
 	}
 }
 
 #if FNDSA_AVX2
+#include <stdlib.h>
+
+/* Get the feature flags from CPUID leaf 7 (EBX and ECX registers), and
+   the enabled register states (XCR0). If leaf 7 is not available, then
+   0 is returned for all three. XCR0 is read only if CPUID.1:ECX.OSXSAVE
+   (bit 27) is set, since XGETBV is otherwise an invalid opcode; 0 is
+   returned for XCR0 in that case. */
 #if defined __GNUC__ || defined __clang__
 #include <cpuid.h>
 __attribute__((target("xsave")))
-int
-has_avx2(void)
+static void
+cpu_features(uint32_t *ebx7, uint32_t *ecx7, uint32_t *xcr0)
 {
 	/* __get_cpuid_count() includes a check that CPUID is callable,
 	   and that the requested leaf number is available. */
 	unsigned eax, ebx, ecx, edx;
 	if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
-		/* Check AVX2 support by the hardware. */
-		if ((ebx & (1 << 5)) != 0) {
-			/* Also check that YMM registers have not been
-			   disabled by the OS. */
-			return (_xgetbv(0) & 0x06) == 0x06;
+		*ebx7 = ebx;
+		*ecx7 = ecx;
+		__get_cpuid(1, &eax, &ebx, &ecx, &edx);
+		if ((ecx & ((unsigned)1 << 27)) != 0) {
+			*xcr0 = (uint32_t)_xgetbv(0);
+		} else {
+			*xcr0 = 0;
 		}
+	} else {
+		*ebx7 = 0;
+		*ecx7 = 0;
+		*xcr0 = 0;
 	}
-	return 0;
 }
 #elif _MSC_VER
-int
-has_avx2(void)
+static void
+cpu_features(uint32_t *ebx7, uint32_t *ecx7, uint32_t *xcr0)
 {
 	int rr[4];
 	/* Check that CPUID leaf 7 is accessible. */
 	__cpuid(rr, 0);
 	if (rr[0] < 7) {
-		return 0;
+		*ebx7 = 0;
+		*ecx7 = 0;
+		*xcr0 = 0;
+		return;
 	}
-	/* Check that the hardware supports AVX2. */
 	__cpuidex(rr, 7, 0);
-	if ((rr[1] & (1 << 5)) == 0) {
-		return 0;
+	*ebx7 = (uint32_t)rr[1];
+	*ecx7 = (uint32_t)rr[2];
+	__cpuid(rr, 1);
+	if (((uint32_t)rr[2] & ((uint32_t)1 << 27)) != 0) {
+		*xcr0 = (uint32_t)_xgetbv(0);
+	} else {
+		*xcr0 = 0;
 	}
-	/* Check that the YMM registers have not been disabled by the OS. */
-	return (_xgetbv(0) & 0x06) == 0x06;
 }
 #else
 #error Missing has_avx2() implementation (not GCC/Clang/MSVC)
 #endif
+
+/* CPU features, resolved once (the CPU_RESOLVED bit is then set). */
+#define CPU_AVX2          0x01
+#define CPU_AVX512        0x02
+#define CPU_AVX512VBMI2   0x04
+#define CPU_AVX512BW      0x08
+#define CPU_SHANI         0x10
+#define CPU_RESOLVED      0x80
+static uint32_t cpu_state;
+
+/* Concurrent resolutions all compute and store the same value, so that
+   relaxed accesses are sufficient. On x86, aligned 32-bit accesses are
+   atomic anyway; the GCC/Clang builtins keep the compiler aware of it. */
+#if defined __GNUC__ || defined __clang__
+#define cpu_state_load()    __atomic_load_n(&cpu_state, __ATOMIC_RELAXED)
+#define cpu_state_store(x)  __atomic_store_n(&cpu_state, (x), __ATOMIC_RELAXED)
+#else
+#define cpu_state_load()    (*(volatile uint32_t *)&cpu_state)
+#define cpu_state_store(x)  (*(volatile uint32_t *)&cpu_state = (x))
+#endif
+
+/* Run CPUID, and apply the FNDSA_SIMD_TIER environment variable (if
+   set, features above the named tier are hidden). */
+static uint32_t
+cpu_resolve(void)
+{
+	uint32_t ebx7, ecx7, xcr0;
+	cpu_features(&ebx7, &ecx7, &xcr0);
+
+	/* AVX2 needs the YMM registers to be enabled by the OS; AVX-512
+	   also needs the ZMM and opmask registers. */
+	uint32_t f = CPU_RESOLVED;
+	if ((ebx7 & ((uint32_t)1 << 5)) != 0 && (xcr0 & 0x06) == 0x06) {
+		f |= CPU_AVX2;
+		if ((ebx7 & ((uint32_t)1 << 29)) != 0) {
+			f |= CPU_SHANI;
+		}
+		if ((ebx7 & ((uint32_t)1 << 16)) != 0
+			&& (xcr0 & 0xE6) == 0xE6)
+		{
+			f |= CPU_AVX512;
+			if ((ebx7 & ((uint32_t)1 << 30)) != 0) {
+				f |= CPU_AVX512BW;
+				if ((ecx7 & ((uint32_t)1 << 6)) != 0) {
+					f |= CPU_AVX512VBMI2;
+				}
+			}
+		}
+	}
+
+	const char *env = getenv("FNDSA_SIMD_TIER");
+	if (env != NULL) {
+		if (strcmp(env, "base") == 0) {
+			f &= CPU_RESOLVED;
+		} else if (strcmp(env, "avx2") == 0) {
+			f &= CPU_RESOLVED | CPU_AVX2 | CPU_SHANI;
+		}
+	}
+	cpu_state_store(f);
+	return f;
+}
+
+/* Get the CPU features (resolved on first call). */
+static inline uint32_t
+cpu_flags(void)
+{
+	uint32_t f = cpu_state_load();
+	if (f == 0) {
+		f = cpu_resolve();
+	}
+	return f;
+}
+
+#if defined __GNUC__ || defined __clang__
+/* Resolve the features at load time, so that the first calls do not
+   pay for CPUID (which is serializing, and very slow in some VMs). This
+   runs in every program linked with the library, even one that never
+   uses the SIMD code: cpu_features() must not use any opcode that can
+   fault (XGETBV is guarded by the OSXSAVE bit). */
+__attribute__((constructor))
+static void
+cpu_init(void)
+{
+	(void)cpu_flags();
+}
+#endif
+
+/* Cap on the reported SIMD tiers (see fndsa_set_simd_tier_max()). */
+static unsigned simd_tier_max = SIMD_TIER_AVX512;
+
+/* see inner.h */
+int
+has_avx2(void)
+{
+	return simd_tier_max >= SIMD_TIER_AVX2
+		&& (cpu_flags() & CPU_AVX2) != 0;
+}
+
+/* see inner.h */
+int
+has_shani(void)
+{
+	return simd_tier_max >= SIMD_TIER_AVX2
+		&& (cpu_flags() & CPU_SHANI) != 0;
+}
+
+#if FNDSA_AVX512
+/* see inner.h */
+int
+has_avx512(void)
+{
+	return simd_tier_max >= SIMD_TIER_AVX512
+		&& (cpu_flags() & CPU_AVX512) != 0;
+}
+
+/* see inner.h */
+int
+has_avx512bw(void)
+{
+	return simd_tier_max >= SIMD_TIER_AVX512
+		&& (cpu_flags() & CPU_AVX512BW) != 0;
+}
+
+/* see inner.h */
+int
+has_avx512vbmi2(void)
+{
+	return simd_tier_max >= SIMD_TIER_AVX512
+		&& (cpu_flags() & CPU_AVX512VBMI2) != 0;
+}
+#endif
+#endif
+
+/* see fndsa.h */
+void
+set_simd_tier_max(unsigned tier)
+{
+#if FNDSA_AVX2
+	simd_tier_max = tier;
+#else
+	(void)tier;
+#endif
+}
+
+/* see fndsa.h */
+unsigned
+fndsa_get_simd_tier(void)
+{
+#if FNDSA_AVX512
+	if (has_avx512()) {
+		return SIMD_TIER_AVX512;
+	}
+#endif
+#if FNDSA_AVX2
+	if (has_avx2()) {
+		return SIMD_TIER_AVX2;
+	}
 #endif
+	return SIMD_TIER_BASE;
+}
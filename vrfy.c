@@ -4,6 +4,91 @@
 
 #include "inner.h"
 
+/* In the AVX2 code paths, the AVX-512BW implementations of the mqpoly
+   functions are used when the CPU supports them (the check is cheap,
+   since CPU features are detected only once). */
+#if FNDSA_AVX512
+#define AVX_MQPOLY(name)   (has_avx512bw() \
+	? avx512_mqpoly_ ## name : avx2_mqpoly_ ## name)
+#elif FNDSA_AVX2
+#define AVX_MQPOLY(name)   avx2_mqpoly_ ## name
+#endif
+
+/*
+ * First verification step: decode s2 from the signature sigbuf (of the
+ * proper length for degree logn) into t2, and replace it with s2*h (in
+ * internal representation); h is the verifying key polynomial, in NTT
+ * representation. The squared norm of s2 is written into *norm2. On
+ * decoding error, 0 is returned.
+ */
+static int
+verify_s2h(unsigned logn, const uint8_t *sigbuf, size_t sig_len,
+	const uint16_t *h, uint16_t *t2, uint32_t *norm2)
+{
+	/* t2 <- s2 (signature, decoded, converted to ntt)
+	   Also get the squared norm of s2. */
+	if (!comp_decode(logn, sigbuf + 41, sig_len - 41, (int16_t *)t2)) {
+		return 0;
+	}
+	*norm2 = mqpoly_sqnorm_signed(logn, t2);
+	mqpoly_signed_to_int(logn, t2);
+	mqpoly_int_to_ntt(logn, t2);
+
+	/* t2 <- s2*h (converted to int) */
+	mqpoly_mul_ntt(logn, t2, h);
+	mqpoly_ntt_to_int(logn, t2);
+	return 1;
+}
+
+/*
+ * Second verification step: t1 contains the hashed message c (output of
+ * hash_to_point()), t2 and norm2 are the outputs of verify_s2h(). This
+ * returns 1 if the signature is valid, 0 otherwise.
+ */
+static int
+verify_finish(unsigned logn, uint16_t *t1, const uint16_t *t2,
+	uint32_t norm2)
+{
+	/* c (in t1) is converted to int */
+	mqpoly_ext_to_int(logn, t1);
+
+	/* t1 <- s1 = c - s2*h (converted to ext), and compute its norm. */
+	mqpoly_sub(logn, t1, t2);
+	mqpoly_int_to_ext(logn, t1);
+	uint32_t norm1 = mqpoly_sqnorm_ext(logn, t1);
+
+	/* Signature is valid if the total squared norm of (s1,s2) is
+	   small enough. Beware overflows. */
+	if (norm1 >= -norm2) {
+		return 0;
+	}
+	return mqpoly_sqnorm_is_acceptable(logn, norm1 + norm2);
+}
+
+/*
+ * Verification core: sigbuf is the signature (of the proper length for
+ * degree logn), hk the hashed verifying key, and h the verifying key
+ * polynomial, in NTT representation. t1 and t2 are temporary arrays of
+ * n elements each; t1 may be the same array as h.
+ */
+static int
+verify_core(unsigned logn, const uint8_t *sigbuf, size_t sig_len,
+	const uint8_t *hk, const uint16_t *h,
+        const void *ctx, size_t ctx_len,
+        const char *id, const void *hv, size_t hv_len,
+	uint16_t *t1, uint16_t *t2)
+{
+	uint32_t norm2;
+	if (!verify_s2h(logn, sigbuf, sig_len, h, t2, &norm2)) {
+		return 0;
+	}
+
+	/* Hash message into polynomial c (into t1) */
+	hash_to_point(logn, sigbuf + 1, hk,
+		ctx, ctx_len, id, hv, hv_len, t1);
+	return verify_finish(logn, t1, t2, norm2);
+}
+
 /*
  * Inner verification function; it enforces a specific degree range.
  */
@@ -61,44 +146,67 @@ inner_verify(unsigned logn_min, unsigned logn_max,
 	uint16_t *t2 = t1 + n;
 
 	/* t1 <- h (verifying key, decoded, converted to ntt) */
-	if (mqpoly_decode(logn, vkbuf + 1, t1) != vrfy_key_len - 1) {
+	if (mqpoly_decode_int(logn, vkbuf + 1, t1) != vrfy_key_len - 1) {
 		return 0;
 	}
-	mqpoly_ext_to_int(logn, t1);
 	mqpoly_int_to_ntt(logn, t1);
 
-	/* t2 <- s2 (signature, decoded, converted to ntt)
-	   Also get the squared norm of s2. */
+	return verify_core(logn, sigbuf, sig_len, hk, t1,
+		ctx, ctx_len, id, hv, hv_len, t1, t2);
+}
+
+#if FNDSA_AVX2
+/* Same as verify_s2h(), with AVX2 optimizations. */
+TARGET_AVX2
+static int
+avx2_verify_s2h(unsigned logn, const uint8_t *sigbuf, size_t sig_len,
+	const uint16_t *h, uint16_t *t2, uint32_t *norm2)
+{
 	if (!comp_decode(logn, sigbuf + 41, sig_len - 41, (int16_t *)t2)) {
 		return 0;
 	}
-	uint32_t norm2 = mqpoly_sqnorm_signed(logn, t2);
-	mqpoly_signed_to_int(logn, t2);
-	mqpoly_int_to_ntt(logn, t2);
-
-	/* t2 <- s2*h (converted to int) */
-	mqpoly_mul_ntt(logn, t2, t1);
-	mqpoly_ntt_to_int(logn, t2);
-
-	/* Hash message into polynomial c (into t1, converted to int) */
-	hash_to_point(logn, sigbuf + 1, hk,
-		ctx, ctx_len, id, hv, hv_len, t1);
-	mqpoly_ext_to_int(logn, t1);
-
-	/* t1 <- s1 = c - s2*h (converted to ext), and compute its norm. */
-	mqpoly_sub(logn, t1, t2);
-	mqpoly_int_to_ext(logn, t1);
-	uint32_t norm1 = mqpoly_sqnorm_ext(logn, t1);
+	*norm2 = AVX_MQPOLY(sqnorm_signed)(logn, t2);
+	AVX_MQPOLY(signed_to_int)(logn, t2);
+	AVX_MQPOLY(int_to_ntt)(logn, t2);
+	AVX_MQPOLY(mul_ntt)(logn, t2, h);
+	AVX_MQPOLY(ntt_to_int)(logn, t2);
+	return 1;
+}
 
-	/* Signature is valid if the total squared norm of (s1,s2) is
-	   small enough. Beware overflows. */
+/* Same as verify_finish(), with AVX2 optimizations. */
+TARGET_AVX2
+static int
+avx2_verify_finish(unsigned logn, uint16_t *t1, const uint16_t *t2,
+	uint32_t norm2)
+{
+	AVX_MQPOLY(ext_to_int)(logn, t1);
+	AVX_MQPOLY(sub)(logn, t1, t2);
+	AVX_MQPOLY(int_to_ext)(logn, t1);
+	uint32_t norm1 = AVX_MQPOLY(sqnorm_ext)(logn, t1);
 	if (norm1 >= -norm2) {
 		return 0;
 	}
 	return mqpoly_sqnorm_is_acceptable(logn, norm1 + norm2);
 }
 
-#if FNDSA_AVX2
+/* Same as verify_core(), with AVX2 optimizations. */
+TARGET_AVX2
+static int
+avx2_verify_core(unsigned logn, const uint8_t *sigbuf, size_t sig_len,
+	const uint8_t *hk, const uint16_t *h,
+        const void *ctx, size_t ctx_len,
+        const char *id, const void *hv, size_t hv_len,
+	uint16_t *t1, uint16_t *t2)
+{
+	uint32_t norm2;
+	if (!avx2_verify_s2h(logn, sigbuf, sig_len, h, t2, &norm2)) {
+		return 0;
+	}
+	hash_to_point(logn, sigbuf + 1, hk,
+		ctx, ctx_len, id, hv, hv_len, t1);
+	return avx2_verify_finish(logn, t1, t2, norm2);
+}
+
 TARGET_AVX2
 static int
 avx2_inner_verify(unsigned logn_min, unsigned logn_max,
@@ -129,24 +237,10 @@ avx2_inner_verify(unsigned logn_min, unsigned logn_max,
 	uint16_t t1[1024], t2[1024];
 
 	/* t1 <- h (verifying key, decoded, converted to ntt) */
-	if (mqpoly_decode(logn, vkbuf + 1, t1) != vrfy_key_len - 1) {
-		return 0;
-	}
-	avx2_mqpoly_ext_to_int(logn, t1);
-	avx2_mqpoly_int_to_ntt(logn, t1);
-
-	/* t2 <- s2 (signature, decoded, converted to ntt)
-	   Also get the squared norm of s2. */
-	if (!comp_decode(logn, sigbuf + 41, sig_len - 41, (int16_t *)t2)) {
+	if (mqpoly_decode_int(logn, vkbuf + 1, t1) != vrfy_key_len - 1) {
 		return 0;
 	}
-	uint32_t norm2 = avx2_mqpoly_sqnorm_signed(logn, t2);
-	avx2_mqpoly_signed_to_int(logn, t2);
-	avx2_mqpoly_int_to_ntt(logn, t2);
-
-	/* t2 <- s2*h (converted to int) */
-	avx2_mqpoly_mul_ntt(logn, t2, t1);
-	avx2_mqpoly_ntt_to_int(logn, t2);
+	AVX_MQPOLY(int_to_ntt)(logn, t1);
 
 	/* Hash verifying key (SHAKE256, 64-byte output). */
 	uint8_t hk[64];
@@ -156,22 +250,8 @@ avx2_inner_verify(unsigned logn_min, unsigned logn_max,
 	shake_flip(&sc);
 	shake_extract(&sc, hk, sizeof hk);
 
-	/* Hash message into polynomial c (into t1, converted to int) */
-	hash_to_point(logn, sigbuf + 1, hk,
-		ctx, ctx_len, id, hv, hv_len, t1);
-	avx2_mqpoly_ext_to_int(logn, t1);
-
-	/* t1 <- s1 = c - s2*h (converted to ext), and compute its norm. */
-	avx2_mqpoly_sub(logn, t1, t2);
-	avx2_mqpoly_int_to_ext(logn, t1);
-	uint32_t norm1 = avx2_mqpoly_sqnorm_ext(logn, t1);
-
-	/* Signature is valid if the total squared norm of (s1,s2) is
-	   small enough. Beware overflows. */
-	if (norm1 >= -norm2) {
-		return 0;
-	}
-	return mqpoly_sqnorm_is_acceptable(logn, norm1 + norm2);
+	return avx2_verify_core(logn, sigbuf, sig_len, hk, t1,
+		ctx, ctx_len, id, hv, hv_len, t1, t2);
 }
 #endif
 
@@ -240,3 +320,449 @@ fndsa_verify_weak_temp(const void *sig, size_t sig_len,
 		sig, sig_len, vrfy_key, vrfy_key_len,
 		ctx, ctx_len, id, hv, hv_len, tmp, tmp_len);
 }
+
+/* see fndsa.h */
+int
+fndsa_verify_key_prepare(const void *vrfy_key, size_t vrfy_key_len,
+	void *pvk, size_t pvk_len)
+{
+	if (vrfy_key_len == 0) {
+		return 0;
+	}
+	const uint8_t *vkbuf = (const uint8_t *)vrfy_key;
+	unsigned logn = vkbuf[0];
+	if (logn < 2 || logn > 10) {
+		return 0;
+	}
+	if (vrfy_key_len != FNDSA_VRFY_KEY_SIZE(logn)
+		|| pvk_len < FNDSA_VRFY_KEY_PREPARED_SIZE(logn))
+	{
+		return 0;
+	}
+
+	/* Layout: hashed key (64 bytes), header byte at offset 64, and h
+	   (NTT representation) at offset 96. The header byte is set only
+	   on success, so that a failed preparation cannot be used. */
+	uint8_t *buf = (uint8_t *)(((uintptr_t)pvk + 31) & ~(uintptr_t)31);
+	uint16_t *h = (uint16_t *)(buf + 96);
+	buf[64] = 0;
+	if (mqpoly_decode_int(logn, vkbuf + 1, h) != vrfy_key_len - 1) {
+		return 0;
+	}
+#if FNDSA_AVX2
+	if (has_avx2()) {
+		AVX_MQPOLY(int_to_ntt)(logn, h);
+	} else {
+		mqpoly_int_to_ntt(logn, h);
+	}
+#else
+	mqpoly_int_to_ntt(logn, h);
+#endif
+	shake_context sc;
+	shake_init(&sc, 256);
+	shake_inject(&sc, vrfy_key, vrfy_key_len);
+	shake_flip(&sc);
+	shake_extract(&sc, buf, 64);
+	buf[64] = logn;
+	return 1;
+}
+
+/* Verify a signature against a prepared key; the degree must be in the
+   provided range. */
+static int
+inner_verify_prepared(unsigned logn_min, unsigned logn_max,
+	const void *sig, size_t sig_len,
+	const void *pvk, size_t pvk_len,
+        const void *ctx, size_t ctx_len,
+        const char *id, const void *hv, size_t hv_len,
+	void *tmp, size_t tmp_len)
+{
+	if (sig_len == 0 || pvk_len < FNDSA_VRFY_KEY_PREPARED_SIZE(2)) {
+		return 0;
+	}
+	const uint8_t *sigbuf = (const uint8_t *)sig;
+	const uint8_t *buf = (const uint8_t *)(((uintptr_t)pvk + 31)
+		& ~(uintptr_t)31);
+	unsigned logn = buf[64];
+	if (logn < logn_min || logn > logn_max || sigbuf[0] != 0x30 + logn) {
+		return 0;
+	}
+	if (sig_len != FNDSA_SIGNATURE_SIZE(logn)
+		|| pvk_len < FNDSA_VRFY_KEY_PREPARED_SIZE(logn))
+	{
+		return 0;
+	}
+
+	/* Check that temporary area is large enough. */
+	size_t n = (size_t)1 << logn;
+	if (tmp_len < (n * 4 + 31)) {
+		return 0;
+	}
+	uint16_t *t1 = (uint16_t *)(((uintptr_t)tmp + 31) & ~(uintptr_t)31);
+	uint16_t *t2 = t1 + n;
+	const uint16_t *h = (const uint16_t *)(buf + 96);
+#if FNDSA_AVX2
+	if (has_avx2()) {
+		return avx2_verify_core(logn, sigbuf, sig_len, buf, h,
+			ctx, ctx_len, id, hv, hv_len, t1, t2);
+	}
+#endif
+	return verify_core(logn, sigbuf, sig_len, buf, h,
+		ctx, ctx_len, id, hv, hv_len, t1, t2);
+}
+
+/* see fndsa.h */
+int
+fndsa_verify_prepared(const void *sig, size_t sig_len,
+	const void *pvk, size_t pvk_len,
+        const void *ctx, size_t ctx_len,
+        const char *id, const void *hv, size_t hv_len)
+{
+	uint8_t tmp[4 * 1024 + 31];
+	return inner_verify_prepared(9, 10, sig, sig_len, pvk, pvk_len,
+		ctx, ctx_len, id, hv, hv_len, tmp, sizeof tmp);
+}
+
+/* see fndsa.h */
+int
+fndsa_verify_weak_prepared(const void *sig, size_t sig_len,
+	const void *pvk, size_t pvk_len,
+        const void *ctx, size_t ctx_len,
+        const char *id, const void *hv, size_t hv_len)
+{
+	uint8_t tmp[4 * 256 + 31];
+	return inner_verify_prepared(2, 8, sig, sig_len, pvk, pvk_len,
+		ctx, ctx_len, id, hv, hv_len, tmp, sizeof tmp);
+}
+
+/* see fndsa.h */
+int
+fndsa_verify_prepared_temp(const void *sig, size_t sig_len,
+	const void *pvk, size_t pvk_len,
+        const void *ctx, size_t ctx_len,
+        const char *id, const void *hv, size_t hv_len,
+	void *tmp, size_t tmp_len)
+{
+	return inner_verify_prepared(9, 10, sig, sig_len, pvk, pvk_len,
+		ctx, ctx_len, id, hv, hv_len, tmp, tmp_len);
+}
+
+/* see fndsa.h */
+int
+fndsa_verify_weak_prepared_temp(const void *sig, size_t sig_len,
+	const void *pvk, size_t pvk_len,
+        const void *ctx, size_t ctx_len,
+        const char *id, const void *hv, size_t hv_len,
+	void *tmp, size_t tmp_len)
+{
+	return inner_verify_prepared(2, 8, sig, sig_len, pvk, pvk_len,
+		ctx, ctx_len, id, hv, hv_len, tmp, tmp_len);
+}
+
+/* Decode a verifying key into h (NTT representation) and its hash hk.
+   The key header and length must have been checked by the caller. */
+static int
+verify_key_decode(unsigned logn, const uint8_t *vkbuf, size_t vrfy_key_len,
+	uint16_t *h, uint8_t *hk)
+{
+	if (mqpoly_decode_int(logn, vkbuf + 1, h) != vrfy_key_len - 1) {
+		return 0;
+	}
+#if FNDSA_AVX2
+	if (has_avx2()) {
+		AVX_MQPOLY(int_to_ntt)(logn, h);
+	} else {
+		mqpoly_int_to_ntt(logn, h);
+	}
+#else
+	mqpoly_int_to_ntt(logn, h);
+#endif
+	shake_context sc;
+	shake_init(&sc, 256);
+	shake_inject(&sc, vkbuf, vrfy_key_len);
+	shake_flip(&sc);
+	shake_extract(&sc, hk, 64);
+	return 1;
+}
+
+/*
+ * Batch verification. Signatures are processed by groups of four: the
+ * s2*h products are computed for each signature, then the four
+ * hash_to_point() instances run together (with AVX2, their Keccak-f
+ * invocations are interleaved), and the norms are checked. Decoded
+ * verifying keys are kept in four slots; a signature whose key is equal
+ * to the one of a previous signature reuses its decoded value. Slot k is
+ * written only by lane k, and lane k only looks at slots 0 to k, so
+ * that a slot is never overwritten while in use by the current group.
+ */
+typedef struct {
+	uint16_t h[1024];
+	uint16_t t1[1024];
+	uint16_t t2[1024];
+	uint8_t hk[64];
+	const uint8_t *vk;
+	size_t vk_len;
+} verify_batch_lane;
+
+static size_t
+inner_verify_batch(unsigned logn_min, unsigned logn_max,
+	const fndsa_verify_msg *msgs, size_t num, uint8_t *results)
+{
+	verify_batch_lane lanes[4];
+	shake_context sc[4];
+#if FNDSA_AVX2
+	int avx2 = has_avx2();
+#endif
+
+	memset(results, 0, (num + 7) >> 3);
+	for (int k = 0; k < 4; k ++) {
+		lanes[k].vk = NULL;
+		lanes[k].vk_len = 0;
+	}
+	size_t good = 0;
+	for (size_t i = 0; i < num; i += 4) {
+		size_t idx[4];
+		unsigned logn[4];
+		uint32_t norm2[4];
+		uint16_t *c[4];
+		uint16_t *t2[4];
+		size_t m = 0;
+
+		for (int k = 0; k < 4 && i + k < num; k ++) {
+			const fndsa_verify_msg *vm = &msgs[i + k];
+			if (vm->sig_len == 0 || vm->vrfy_key_len == 0) {
+				continue;
+			}
+			const uint8_t *sigbuf = (const uint8_t *)vm->sig;
+			const uint8_t *vkbuf = (const uint8_t *)vm->vrfy_key;
+			unsigned ln = vkbuf[0];
+			if (ln < logn_min || ln > logn_max
+				|| sigbuf[0] != 0x30 + ln
+				|| vm->sig_len != FNDSA_SIGNATURE_SIZE(ln)
+				|| vm->vrfy_key_len != FNDSA_VRFY_KEY_SIZE(ln))
+			{
+				continue;
+			}
+
+			/* Find or decode the key. */
+			verify_batch_lane *kl = NULL;
+			for (int j = 0; j <= k; j ++) {
+				if (lanes[j].vk_len == vm->vrfy_key_len
+					&& (lanes[j].vk == vkbuf
+					|| memcmp(lanes[j].vk, vkbuf,
+						vm->vrfy_key_len) == 0))
+				{
+					kl = &lanes[j];
+					break;
+				}
+			}
+			if (kl == NULL) {
+				kl = &lanes[k];
+				kl->vk = NULL;
+				kl->vk_len = 0;
+				if (!verify_key_decode(ln, vkbuf,
+					vm->vrfy_key_len, kl->h, kl->hk))
+				{
+					continue;
+				}
+				kl->vk = vkbuf;
+				kl->vk_len = vm->vrfy_key_len;
+			}
+
+			/* Compute s2*h, and start hashing the message. */
+			int r;
+#if FNDSA_AVX2
+			if (avx2) {
+				r = avx2_verify_s2h(ln, sigbuf, vm->sig_len,
+					kl->h, lanes[k].t2, &norm2[m]);
+			} else {
+				r = verify_s2h(ln, sigbuf, vm->sig_len,
+					kl->h, lanes[k].t2, &norm2[m]);
+			}
+#else
+			r = verify_s2h(ln, sigbuf, vm->sig_len,
+				kl->h, lanes[k].t2, &norm2[m]);
+#endif
+			if (!r) {
+				continue;
+			}
+			shake_init(&sc[m], 256);
+			hash_to_point_start(&sc[m], sigbuf + 1, kl->hk,
+				vm->ctx, vm->ctx_len, vm->id,
+				vm->hv, vm->hv_len);
+			idx[m] = i + k;
+			logn[m] = ln;
+			c[m] = lanes[k].t1;
+			t2[m] = lanes[k].t2;
+			m ++;
+		}
+		if (m == 0) {
+			continue;
+		}
+
+		/* Hash the messages together, and check the norms. */
+		for (size_t k = m; k < 4; k ++) {
+			shake_init(&sc[k], 256);
+			shake_flip(&sc[k]);
+		}
+		hash_to_point_x4(sc, m, logn, c);
+		for (size_t k = 0; k < m; k ++) {
+			int r;
+#if FNDSA_AVX2
+			if (avx2) {
+				r = avx2_verify_finish(logn[k],
+					c[k], t2[k], norm2[k]);
+			} else {
+				r = verify_finish(logn[k],
+					c[k], t2[k], norm2[k]);
+			}
+#else
+			r = verify_finish(logn[k], c[k], t2[k], norm2[k]);
+#endif
+			if (r) {
+				results[idx[k] >> 3] |= 1u << (idx[k] & 7);
+				good ++;
+			}
+		}
+	}
+	return good;
+}
+
+/* see fndsa.h */
+size_t
+fndsa_verify_batch(const fndsa_verify_msg *msgs, size_t num,
+	uint8_t *results)
+{
+	return inner_verify_batch(9, 10, msgs, num, results);
+}
+
+/* see fndsa.h */
+size_t
+fndsa_verify_weak_batch(const fndsa_verify_msg *msgs, size_t num,
+	uint8_t *results)
+{
+	return inner_verify_batch(2, 8, msgs, num, results);
+}
+
+/*
+ * Streaming verification. s2*h and the norm of s2 are computed when the
+ * context is initialized; the SHAKE256 context receives the start of the
+ * hash_to_point() input, then the message chunks. A zero logn marks a
+ * context that cannot yield a valid signature (failed initialization, or
+ * already finalized).
+ */
+typedef struct {
+	shake_context sc;
+	uint32_t norm2;
+	unsigned logn;
+	uint16_t t2[1024];
+} verify_stream_state;
+
+/* The public context type must be large enough. */
+typedef char verify_stream_size_check[
+	(sizeof(fndsa_verify_context) >= sizeof(verify_stream_state))
+	? 1 : -1];
+
+static int
+inner_verify_init(unsigned logn_min, unsigned logn_max,
+	fndsa_verify_context *vc,
+	const void *sig, size_t sig_len,
+	const void *vrfy_key, size_t vrfy_key_len,
+	const void *ctx, size_t ctx_len, const char *id)
+{
+	verify_stream_state *vs = (verify_stream_state *)(void *)vc;
+	vs->logn = 0;
+	if (sig_len == 0 || vrfy_key_len == 0) {
+		return 0;
+	}
+	const uint8_t *sigbuf = (const uint8_t *)sig;
+	const uint8_t *vkbuf = (const uint8_t *)vrfy_key;
+	unsigned logn = vkbuf[0];
+	if (logn < logn_min || logn > logn_max || sigbuf[0] != 0x30 + logn) {
+		return 0;
+	}
+	if (sig_len != FNDSA_SIGNATURE_SIZE(logn)
+		|| vrfy_key_len != FNDSA_VRFY_KEY_SIZE(logn))
+	{
+		return 0;
+	}
+
+	uint16_t h[1024];
+	uint8_t hk[64];
+	if (!verify_key_decode(logn, vkbuf, vrfy_key_len, h, hk)) {
+		return 0;
+	}
+	int r;
+#if FNDSA_AVX2
+	if (has_avx2()) {
+		r = avx2_verify_s2h(logn, sigbuf, sig_len,
+			h, vs->t2, &vs->norm2);
+	} else {
+		r = verify_s2h(logn, sigbuf, sig_len,
+			h, vs->t2, &vs->norm2);
+	}
+#else
+	r = verify_s2h(logn, sigbuf, sig_len, h, vs->t2, &vs->norm2);
+#endif
+	if (!r) {
+		return 0;
+	}
+	shake_init(&vs->sc, 256);
+	hash_to_point_begin(&vs->sc, sigbuf + 1, hk, ctx, ctx_len, id);
+	vs->logn = logn;
+	return 1;
+}
+
+/* see fndsa.h */
+int
+fndsa_verify_init(fndsa_verify_context *vc,
+	const void *sig, size_t sig_len,
+	const void *vrfy_key, size_t vrfy_key_len,
+	const void *ctx, size_t ctx_len, const char *id)
+{
+	return inner_verify_init(9, 10, vc, sig, sig_len,
+		vrfy_key, vrfy_key_len, ctx, ctx_len, id);
+}
+
+/* see fndsa.h */
+int
+fndsa_verify_weak_init(fndsa_verify_context *vc,
+	const void *sig, size_t sig_len,
+	const void *vrfy_key, size_t vrfy_key_len,
+	const void *ctx, size_t ctx_len, const char *id)
+{
+	return inner_verify_init(2, 8, vc, sig, sig_len,
+		vrfy_key, vrfy_key_len, ctx, ctx_len, id);
+}
+
+/* see fndsa.h */
+void
+fndsa_verify_update(fndsa_verify_context *vc, const void *data, size_t len)
+{
+	verify_stream_state *vs = (verify_stream_state *)(void *)vc;
+	if (vs->logn != 0) {
+		shake_inject(&vs->sc, data, len);
+	}
+}
+
+/* see fndsa.h */
+int
+fndsa_verify_final(fndsa_verify_context *vc)
+{
+	verify_stream_state *vs = (verify_stream_state *)(void *)vc;
+	unsigned logn = vs->logn;
+	if (logn == 0) {
+		return 0;
+	}
+	vs->logn = 0;
+
+	uint16_t t1[1024];
+	shake_flip(&vs->sc);
+	hash_to_point_finish(logn, &vs->sc, t1);
+#if FNDSA_AVX2
+	if (has_avx2()) {
+		return avx2_verify_finish(logn, t1, vs->t2, vs->norm2);
+	}
+#endif
+	return verify_finish(logn, t1, vs->t2, vs->norm2);
+}